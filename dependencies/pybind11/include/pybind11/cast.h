@@ -434,14 +434,29 @@ PYBIND11_NOINLINE inline std::string error_string() {
             trace = trace->tb_next;
 
         PyFrameObject *frame = trace->tb_frame;
+        Py_XINCREF(frame);
         errorString += "\n\nAt:\n";
         while (frame) {
+#if PY_VERSION_HEX >= 0x030900B1
+            PyCodeObject *f_code = PyFrame_GetCode(frame);
+#else
+            PyCodeObject *f_code = frame->f_code;
+            Py_INCREF(f_code);
+#endif
             int lineno = PyFrame_GetLineNumber(frame);
             errorString +=
-                "  " + handle(frame->f_code->co_filename).cast<std::string>() +
+                "  " + handle(f_code->co_filename).cast<std::string>() +
                 "(" + std::to_string(lineno) + "): " +
-                handle(frame->f_code->co_name).cast<std::string>() + "\n";
-            frame = frame->f_back;
+                handle(f_code->co_name).cast<std::string>() + "\n";
+            Py_DECREF(f_code);
+#if PY_VERSION_HEX >= 0x030900B1
+            PyFrameObject *b_frame = PyFrame_GetBack(frame);
+#else
+            PyFrameObject *b_frame = frame->f_back;
+            Py_XINCREF(b_frame);
+#endif
+            Py_DECREF(frame);
+            frame = b_frame;
         }
     }
 #endif
@@ -1595,7 +1595,8 @@ template <typename InputType, typename OutputType> void implicitly_convertible()
         ~set_flag() { flag = false; }
     };
     auto implicit_caster = [](PyObject *obj, PyTypeObject *type) -> PyObject * {
-        static bool currently_used = false;
+        // The conversion can run Python code, which lets other threads run: the flag must be per thread
+        static thread_local bool currently_used = false;
         if (currently_used) // implicit conversions are non-reentrant
             return nullptr;
         set_flag flag_helper(currently_used);
@@ -1749,6 +1750,15 @@ public:
         auto const &internals = detail::get_internals();
         tstate = (PyThreadState *) PYBIND11_TLS_GET_VALUE(internals.tstate);
 
+        if (!tstate) {
+            /* Check if the GIL was acquired using the PyGILState_* API instead (e.g. if
+               calling from a Python thread). Since we use a different key, this ensures
+               we don't create a new thread state and deadlock in PyEval_AcquireThread
+               below. Note we don't save this state with internals.tstate, since we don't
+               create it we would fail to clear it (its reference count should be > 0). */
+            tstate = PyGILState_GetThisThreadState();
+        }
+
         if (!tstate) {
             tstate = PyThreadState_New(internals.istate);
             #if !defined(NDEBUG)
@@ -1886,7 +1896,26 @@ inline function get_type_overload(const void *this_ptr, const detail::type_info
 
     /* Don't call dispatch code if invoked from overridden function.
        Unfortunately this doesn't work on PyPy. */
-#if !defined(PYPY_VERSION)
+#if !defined(PYPY_VERSION) && PY_VERSION_HEX >= 0x03090000
+    PyFrameObject *frame = PyThreadState_GetFrame(PyThreadState_Get());
+    if (frame) {
+        PyCodeObject *f_code = PyFrame_GetCode(frame);
+        bool same = false;
+        if ((std::string) str(f_code->co_name) == name && f_code->co_argcount > 0) {
+            PyObject *locals = PyEval_GetLocals();
+            PyObject *co_varnames = PyObject_GetAttrString((PyObject *) f_code, "co_varnames");
+            if (locals && co_varnames) {
+                PyObject *self_caller = PyDict_GetItem(locals, PyTuple_GET_ITEM(co_varnames, 0));
+                same = self_caller == self.ptr();
+            }
+            Py_XDECREF(co_varnames);
+        }
+        Py_DECREF(f_code);
+        Py_DECREF(frame);
+        if (same)
+            return function();
+    }
+#elif !defined(PYPY_VERSION)
     PyFrameObject *frame = PyThreadState_Get()->frame;
     if (frame && (std::string) str(frame->f_code->co_name) == name &&
         frame->f_code->co_argcount > 0) {
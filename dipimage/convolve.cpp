@@ -32,16 +32,26 @@ inline std::vector< dip::dfloat > GetRealOrComplexArray( mxArray const* mx ) {
       dip::uint k = isComplex ? 2 : 1;
       dip::uint n = mxGetNumberOfElements( mx );
       std::vector< dip::dfloat > out( k * n );
+#if MX_HAS_INTERLEAVED_COMPLEX
+      if( isComplex ) {
+         // Already interleaved
+         double const* data = reinterpret_cast< double const* >( mxGetComplexDoubles( mx ));
+         std::copy( data, data + k * n, out.begin() );
+         return out;
+      }
+#endif
       double* data = mxGetPr( mx );
       for( dip::uint ii = 0; ii < n; ++ii ) {
          out[ k * ii ] = data[ ii ];
       }
+#if !MX_HAS_INTERLEAVED_COMPLEX
       if( isComplex ) {
          data = mxGetPi( mx );
          for( dip::uint ii = 0; ii < n; ++ii ) {
             out[ k * ii + 1 ] = data[ ii ];
          }
       }
+#endif
       return out;
    }
    DIP_THROW( "Real- or complex-valued floating-point array expected" );
@@ -95,20 +105,7 @@ void mexFunction( int /*nlhs*/, mxArray* plhs[], int nrhs, const mxArray* prhs[]
       if( mxIsNumeric( mxFilter ) || mxIsClass( mxFilter, "dip_image" )) {
 
          dip::Image const filter = dml::GetImage( mxFilter );
-         filterArray = dip::SeparateFilter( filter );
-         if( filterArray.empty() ) {
-
-            if( filter.NumberOfPixels() > 7 * 7 ) { // note that this is an arbitrary threshold, and should probably depend also on log2(image size)
-               dip::ConvolveFT( in, filter, out );
-            } else {
-               dip::GeneralConvolution( in, filter, out, bc );
-            }
-
-         } else {
-
-            dip::SeparableConvolution( in, out, filterArray, bc );
-
-         }
+         dip::Convolution( in, filter, out, dip::S::BEST, bc );
 
       } else {
 
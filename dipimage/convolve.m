@@ -11,9 +11,8 @@
 %  in the spatial domain using NDIMS(IMAGE_IN) one-dimensional convolutions.
 %  If it is not separable, the convolution is computed either through the
 %  Fourier Domain or by direct implementation of the convolution sum,
-%  depending on the size of the kernel. Currently, a kernel with more than
-%  49 elements (i.e. larger than a 7x7 kernel) is computed through the
-%  Fourier Domain.
+%  depending on the sizes of the kernel and the image, and the number of
+%  threads used. The method estimated to be the fastest is chosen.
 %  For example:
 %      a = readim('cermet');
 %      k = ones(5,5);
@@ -32,9 +31,7 @@
 %
 %  BOUNDARY_CONDITION is a string or a cell array of strings (one per image
 %  dimension) specifying how the convolution handles pixel values outside
-%  of the image domain. See HELP BOUNDARY_CONDITION. It is ignored if the
-%  convolution is best computed through the Fourier Domain, where the boundary
-%  condition is always 'periodic' by construction.
+%  of the image domain. See HELP BOUNDARY_CONDITION.
 %
 % DEFAULTS:
 %  bounary_condition = 'mirror'
@@ -34,10 +34,9 @@
 
 #include <mex.h>
 
-// If compiling MEX-files with the -R2018a flag, the code in this file will not work as intended.
-#if MX_HAS_INTERLEAVED_COMPLEX
-#error "This DIPlib-MATLAB interface does not support compiling MEX-files with the -R2018a flag"
-#endif
+// MEX-files can be compiled with or without the -R2018a flag. With it, MATLAB stores complex arrays interleaved,
+// as DIPlib does, and complex input arrays do not need to be copied. `MX_HAS_INTERLEAVED_COMPLEX` is defined by
+// MATLAB's headers in either case.
 
 // MSVC 2015-2017 has a problem linking std::codecvt_utf8_utf16< char16_t >. Here's a workaround.
 // MSVC version numbers from https://sourceforge.net/p/predef/wiki/Compilers/#microsoft-visual-c
@@ -109,6 +108,27 @@ static_assert( sizeof( mxLogical ) == sizeof( dip::bin ), "mxLogical is not one
                   catch( std::exception const& e ) { mexErrMsgIdAndTxt( "DIPlib:StandardException", e.what() ); }
 
 
+/// \brief The number of times that pixel data was copied when passing images between *MATLAB* and *DIPlib*.
+///
+/// `dml::GetImage` copies complex arrays if the MEX-file was not compiled with the interleaved complex API
+/// (`-R2018a`), and `dml::GetArray` copies images that are not stored in an `mxArray` in the expected layout.
+/// This counter is incremented in both cases, and can be reset by assigning to it. Each MEX-file has its own
+/// counter.
+///
+/// If the MEX-file is compiled with `DML_REPORT_COPIES` defined, `dml::MatlabInterface` writes this count
+/// into the *MATLAB* global variable `DML_COPY_COUNT` when it is destroyed, and resets it. This allows
+/// testing from *MATLAB* that a function does not copy its output:
+/// ```matlab
+///     global DML_COPY_COUNT
+///     out = gaussf(img);
+///     assert(DML_COPY_COUNT == 0)
+/// ```
+inline dip::uint& NumberOfCopies() {
+   static dip::uint count = 0;
+   return count;
+}
+
+
 /// \brief True if array is scalar (has single value)
 // We define this function because mxIsScalar is too new.
 inline bool IsScalar( mxArray const* mx ) {
@@ -155,12 +175,20 @@ inline dip::dfloat GetFloat( mxArray const* mx ) {
 /// \brief Convert a complex floating-point number from `mxArray` to `dip::dcomplex` by copy.
 inline dip::dcomplex GetComplex( mxArray const* mx ) {
    if( IsScalar( mx ) && mxIsDouble( mx )) {
+#if MX_HAS_INTERLEAVED_COMPLEX
+      if( mxIsComplex( mx )) {
+         mxComplexDouble* pc = mxGetComplexDoubles( mx );
+         return { pc->real, pc->imag };
+      }
+      return { *mxGetDoubles( mx ), 0 };
+#else
       double* pr = mxGetPr( mx );
       double* pi = mxGetPi( mx );
       dip::dcomplex out{ 0, 0 };
       if( pr ) { out.real( *pr ); }
       if( pi ) { out.imag( *pi ); }
       return out;
+#endif
    }
    DIP_THROW( "Complex floating-point value expected" );
 }
@@ -502,11 +530,18 @@ inline dip::Image::Pixel GetPixel( mxArray const* mx ) {
    dip::uint n = mxGetNumberOfElements( mx );
    if( mxIsComplex( mx )) {
       dip::Image::Pixel out( dip::DT_DCOMPLEX, n );
+#if MX_HAS_INTERLEAVED_COMPLEX
+      mxComplexDouble* pc = mxGetComplexDoubles( mx );
+      for( dip::uint ii = 0; ii < n; ++ii ) {
+         out[ ii ] = dip::dcomplex( pc[ ii ].real, pc[ ii ].imag );
+      }
+#else
       double* pr = mxGetPr( mx );
       double* pi = mxGetPi( mx );
       for( dip::uint ii = 0; ii < n; ++ii ) {
          out[ ii ] = dip::dcomplex( pr[ ii ], pi[ ii ] );
       }
+#endif
       return out;
    } else {
       dip::Image::Pixel out( dip::DT_DFLOAT, n );
@@ -619,8 +654,12 @@ inline mxArray* GetArray( dip::dfloat in ) {
 /// \brief Convert a complex floating-point number from `dip::dcomplex` to `mxArray` by copy.
 inline mxArray* GetArray( dip::dcomplex in ) {
    mxArray* mx = mxCreateDoubleMatrix( 1, 1, mxCOMPLEX );
+#if MX_HAS_INTERLEAVED_COMPLEX
+   *( mxGetComplexDoubles( mx )) = { in.real(), in.imag() };
+#else
    *( mxGetPr( mx )) = in.real();
    *( mxGetPi( mx )) = in.imag();
+#endif
    return mx;
 }
 
@@ -704,10 +743,15 @@ inline mxArray* GetArray( dip::Image::Pixel const& in ) {
       map = in; // copy samples over
    } else if( in.DataType().IsComplex() ) { // double complex array
       out = mxCreateDoubleMatrix( 1, in.TensorElements(), mxCOMPLEX );
+#if MX_HAS_INTERLEAVED_COMPLEX
+      dip::Image::Pixel map( mxGetComplexDoubles( out ), dip::DT_DCOMPLEX, in.Tensor(), 1 );
+      map = in; // copy samples over
+#else
       dip::Image::Pixel mapReal( mxGetPr( out ), dip::DT_DFLOAT, in.Tensor(), 1 );
       dip::Image::Pixel mapImag( mxGetPi( out ), dip::DT_DFLOAT, in.Tensor(), 1 );
       mapReal = in.Real(); // copy samples over
       mapImag = in.Imaginary(); // copy samples over
+#endif
    } else { // integer or floating-point : double array
       out = mxCreateDoubleMatrix( 1, in.TensorElements(), mxREAL );
       dip::Image::Pixel map( mxGetPr( out ), dip::DT_DFLOAT, in.Tensor(), 1 );
@@ -848,9 +892,11 @@ enum class ArrayConversionMode {
 ///
 /// This function "converts" an `mxArray` with image data to a dip::Image object.
 /// The dip::Image object will point to the data in the `mxArray`, unless
-/// the array contains complex numbers. Complex data needs to be copied because
-/// *MATLAB* represents it internally as two separate data blocks. In that
-/// case, the dip::Image object will own its own data block.
+/// the array contains complex numbers and the MEX-file was compiled without the
+/// `-R2018a` flag. Complex data then needs to be copied because *MATLAB* represents
+/// it internally as two separate data blocks. In that case, the dip::Image object
+/// will own its own data block. `dip_image` objects always store complex data
+/// interleaved, and are never copied.
 ///
 /// When calling GetImage with a `prhs` argument in `mexFunction()`, use a const
 /// modifier for the output argument. This should prevent accidentally modifying
@@ -949,11 +995,13 @@ inline dip::Image GetImage(
       type = mxGetClassID( mxdata );
       maybeCast = ( ndims == 0 ) && ( type == mxDOUBLE_CLASS ); // If it's a scalar double, we might want to cast it to single instead.
       complex = mxIsComplex( mxdata );
+#if !MX_HAS_INTERLEAVED_COMPLEX
       if( complex ) {
          // The complex data in an mxArray is stored as two separate memory blocks, and need to be copied to be
          // compatible with DIPlib storage
          needCopy = true;
       }
+#endif
       if( conversion == ArrayConversionMode::TENSOR_OPERATOR ) {
          // If the last dimension is short, mark it so that we'll turn it into a tensor dimension at the end.
          lastDimToTensor = ( sizes.size() == 1 ) && ( sizes.back() <= 5 );
@@ -1011,6 +1059,7 @@ inline dip::Image GetImage(
    if( needCopy ) {
       // Create 2 temporary Image objects for the real and complex component,
       // then copy them over into a new image.
+      ++NumberOfCopies();
       dip::Image out( sizes, 1, datatype );
       dip::DataType dt = datatype.Real();
       void* p_real = mxGetData( mxdata );
@@ -1020,7 +1069,11 @@ inline dip::Image GetImage(
       } else {
          out.Real().Fill( 0 );
       }
+#if MX_HAS_INTERLEAVED_COMPLEX
+      void* p_imag = nullptr; // Not reached, we don't copy interleaved complex data
+#else
       void* p_imag = mxGetImagData( mxdata );
+#endif
       if( p_imag ) {
          dip::Image imag( dip::NonOwnedRefToDataSegment( p_imag ), p_imag, dt, sizes, strides, tensor, tstride );
          out.Imaginary().Copy( imag );
@@ -1438,6 +1491,16 @@ class MatlabInterface : public dip::ExternalInterface {
          out.SetExternalInterface( this );
          return out;
       }
+
+#ifdef DML_REPORT_COPIES
+      // Writes `dml::NumberOfCopies` to the global variable `DML_COPY_COUNT`, see there.
+      ~MatlabInterface() {
+         mxArray* count = mxCreateDoubleScalar( static_cast< double >( NumberOfCopies() ));
+         mexPutVariable( "global", "DML_COPY_COUNT", count );
+         mxDestroyArray( count );
+         NumberOfCopies() = 0;
+      }
+#endif
 };
 
 /// \brief Find the `mxArray` that holds the data for the dip::Image `img`.
@@ -1482,6 +1545,7 @@ mxArray* GetArrayAsArray( dip::Image const& img, bool doNotSetToTrue = false ) {
    // If the image points to a modified view, or a non-MATLAB array, make a copy
    if( needCopy ) {
       //mexPrintf( "GetArrayAsArray: Copying data from dip::Image to mxArray\n" );
+      ++NumberOfCopies();
       dip::IntegerArray strides;
       dip::sint tStride = 1;
       mxArray* newmat = detail::CreateMxArray( img.DataType(), img.Sizes(), strides, img.Tensor(), tStride );
@@ -22,6 +22,7 @@
 #define DIP_ANALYSIS_H
 
 #include "diplib.h"
+#include "diplib/linear.h"
 #include "distribution.h"
 
 
@@ -244,6 +245,66 @@ DIP_EXPORT FloatArray FindShift(
       UnsignedArray maxShift = {}
 );
 
+/// \brief Estimates the (sub-pixel) global shift of many images with respect to a single reference image.
+///
+/// `dip::FindShift` computes the Fourier transform of both its input images on every call. When many images
+/// need to be registered to the same reference image, for example for the drift correction of a time series,
+/// a `%ShiftEstimator` object computes the Fourier transform of the reference image only once, in its constructor.
+/// All Fourier transforms are computed in single precision.
+///
+/// `method`, `parameter` and `maxShift` are as in `dip::FindShift`, and are used for all images registered.
+/// The `"integer only"`, `"CC"`, `"NCC"` and `"PC"` methods use only the cached spectrum of the reference image.
+/// The `"CPF"`, `"MTS"`, `"ITER"` and `"PROJ"` methods use it to find the integer shift, then crop both images
+/// to their common part to compute the sub-pixel shift as `dip::FindShift` does. If the integer shift is zero,
+/// `"CPF"` uses the cached spectrum here too.
+///
+/// If `window` is not an empty string, the reference image and each image registered are multiplied by
+/// this window before being Fourier transformed. See `dip::ApplyWindow` for the valid values of `window` and
+/// `windowParameter`. The sub-pixel refinement of the `"MTS"`, `"ITER"` and `"PROJ"` methods, which does not
+/// use the Fourier transform, uses the images without windowing.
+///
+/// The member functions are `const`, a single object can be shared by multiple threads. The `FindShift`
+/// overload that takes an array of images registers these in parallel.
+///
+/// ```cpp
+/// dip::ShiftEstimator estimator( frames[ 0 ], "NCC" );
+/// std::vector< dip::FloatArray > shifts = estimator.FindShift( frames );
+/// ```
+class DIP_NO_EXPORT ShiftEstimator {
+   public:
+      /// \brief Prepares for the registration of images to `reference`.
+      DIP_EXPORT ShiftEstimator(
+            Image const& reference,
+            String const& method = "MTS",
+            dfloat parameter = 0,
+            UnsignedArray maxShift = {},
+            String const& window = "",
+            dfloat windowParameter = 0.5
+      );
+
+      /// \brief Estimates the shift of `in` with respect to the reference image, see `dip::FindShift`.
+      ///
+      /// `in` must be a real-valued scalar image of the same sizes as the reference image.
+      DIP_EXPORT FloatArray FindShift( Image const& in ) const;
+
+      /// \brief Estimates the shift of each image in `in` with respect to the reference image. The images are
+      /// processed in parallel.
+      DIP_EXPORT std::vector< FloatArray > FindShift( ImageConstRefArray const& in ) const;
+      std::vector< FloatArray > FindShift( ImageArray const& in ) const {
+         return FindShift( CreateImageConstRefArray( in ));
+      }
+
+   private:
+      Image reference_;       // The reference image, for the spatial-domain sub-pixel refinement
+      Image referenceFT_;     // The Fourier transform of the windowed reference image, DT_SCOMPLEX
+      Image referenceNorm_;   // The square modulus of `referenceFT_` (modulus for the "PC" method)
+      String method_;
+      dfloat parameter_;
+      UnsignedArray maxShift_;
+      String window_;
+      dfloat windowParameter_;
+};
+
 
 /// \brief Finds the scaling, translation and rotation between two 2D images using the Fourier Mellin transform
 ///
@@ -468,6 +529,54 @@ inline ImageArray StructureTensorAnalysis(
    return out;
 }
 
+/// \brief Computes the outputs of `dip::StructureTensorAnalysis` directly from a scalar image.
+///
+/// This function produces the same result as
+/// ```cpp
+///     dip::Image st = dip::StructureTensor( in, mask, gradientSigmas, tensorSigmas, method, boundaryCondition, truncation );
+///     dip::StructureTensorAnalysis( st, out, outputs );
+/// ```
+/// but does not store the full gradient and structure tensor images. Instead, the image is processed in slabs along
+/// the last dimension, each extended with enough of the neighboring slabs for the filters to produce exact results.
+/// Peak memory use is thus close to that of the output images alone, rather than the 9 full images (in 3D) that the
+/// gradient, structure tensor and their temporaries require.
+///
+/// `in` must be scalar, real-valued, and either 2D or 3D. See `dip::StructureTensor` for the meaning of the
+/// parameters `mask`, `gradientSigmas`, `tensorSigmas`, `method`, `boundaryCondition` and `truncation`, and
+/// `dip::StructureTensorAnalysis` for the meaning of `out` and `outputs`.
+///
+/// The slab-wise processing requires the filters to have a finite support. Therefore, this is only done if
+/// `method` is `"gaussFIR"`, or if `method` is `"best"` and all sigmas are in the range where the FIR
+/// implementation is used (see `dip::Gauss`). In all other cases, and for small images, the full structure
+/// tensor is computed.
+DIP_EXPORT void FusedStructureTensorAnalysis(
+      Image const& in,
+      Image const& mask,
+      ImageRefArray& out,
+      StringArray const& outputs,
+      FloatArray const& gradientSigmas = { 1.0 },
+      FloatArray const& tensorSigmas = { 5.0 },
+      String const& method = S::BEST,
+      StringArray const& boundaryCondition = {},
+      dfloat truncation = 3
+);
+inline ImageArray FusedStructureTensorAnalysis(
+      Image const& in,
+      Image const& mask,
+      StringArray const& outputs,
+      FloatArray const& gradientSigmas = { 1.0 },
+      FloatArray const& tensorSigmas = { 5.0 },
+      String const& method = S::BEST,
+      StringArray const& boundaryCondition = {},
+      dfloat truncation = 3
+) {
+   dip::uint nOut = outputs.size();
+   ImageArray out( nOut );
+   ImageRefArray refOut = CreateImageRefArray( out );
+   DIP_STACK_TRACE_THIS( FusedStructureTensorAnalysis( in, mask, refOut, outputs, gradientSigmas, tensorSigmas, method, boundaryCondition, truncation ));
+   return out;
+}
+
 
 /// \brief Analyzes the local structure of the image at multiple scales.
 ///
@@ -548,6 +657,16 @@ inline Image MonogenicSignal(
    return out;
 }
 
+/// \brief Creates a filter bank that computes the monogenic signal for images of sizes `sizes`.
+///
+/// Applying the filter bank produces the same result as `dip::MonogenicSignal` with the same parameters.
+/// See `dip::FourierFilterBank`.
+DIP_EXPORT FourierFilterBank CreateMonogenicFilterBank(
+      UnsignedArray const& sizes,
+      FloatArray const& wavelengths = { 3.0, 24.0 },
+      dfloat bandwidth = 0.41
+);
+
 /// \brief Computes useful image parameters from the monogenic signal.
 ///
 /// `in` is a tensor image produced by `dip::MonogenicSignal`, for which `in.TensorRows() == in.Dimensionality() + 1`,
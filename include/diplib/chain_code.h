@@ -613,6 +613,19 @@ struct DIP_NO_EXPORT Polygon {
    DIP_EXPORT dip::ConvexHull ConvexHull() const;
 };
 
+/// \brief Describes a rotated rectangle, as returned by `dip::ConvexHull::MinimumBoundingRectangle`.
+struct DIP_NO_EXPORT BoundingRectangle {
+   VertexFloat center;     ///< The center of the rectangle
+   dfloat length = 0.0;    ///< The length of the longest side
+   dfloat width = 0.0;     ///< The length of the shortest side
+   dfloat angle = 0.0;     ///< The angle of the longest side, in the range [0,&pi;)
+
+   /// Returns the area of the rectangle
+   dfloat Area() const {
+      return length * width;
+   }
+};
+
 /// \brief A convex hull as a sequence of vertices (i.e. a closed polygon).
 class DIP_NO_EXPORT ConvexHull {
    public:
@@ -651,6 +664,12 @@ class DIP_NO_EXPORT ConvexHull {
       /// Returns the %Feret diameters of the convex hull
       DIP_EXPORT FeretValues Feret() const;
 
+      /// \brief Returns the rectangle with the smallest area that contains the convex hull.
+      ///
+      /// The rectangle is found with the rotating calipers algorithm in linear time: one of the sides of the
+      /// minimum-area rectangle is collinear with an edge of the convex hull.
+      DIP_EXPORT BoundingRectangle MinimumBoundingRectangle() const;
+
       /// Returns the centroid of the convex hull
       VertexFloat Centroid() const {
          return vertices_.Centroid();
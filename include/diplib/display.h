@@ -23,6 +23,7 @@
 
 #include "diplib.h"
 #include "diplib/color.h"
+#include "diplib/geometry.h"
 
 
 /// \file
@@ -210,6 +211,9 @@ class DIP_NO_EXPORT ImageDisplay {
             // Update dimensions
             dim1_ = dim1;
             dim2_ = dim2;
+            if( level_ > 0 ) {
+               sizeIsDirty_ = true; // The pyramid level shown might change, let's not bother figuring out if it does
+            }
             sliceIsDirty_ = true;
             // Make sure projection mode is always "slice" if ndims(img)==ndims(out)
             if( twoDimOut_ && nDim == 2 ) {
@@ -424,6 +428,15 @@ class DIP_NO_EXPORT ImageDisplay {
          }
       }
 
+      /// \brief Sets the zoom factor with which `Output` is shown on screen.
+      ///
+      /// For a zoom factor of 0.5 or smaller, the slice is taken from a lower-resolution level of a
+      /// `dip::ImagePyramid` (using the `"mean"` method), such that `Output` still has at least one pixel for
+      /// each screen pixel. The pyramid levels are computed when first needed. `Output` and `Pixel` then refer
+      /// to the pixels of that level, use `GetScaleFactors` to map their coordinates to the input image.
+      /// The default zoom factor is 1.
+      DIP_EXPORT void SetZoom( dfloat zoom );
+
       /// \brief Get the projection/slicing direction. The two values returned are identical when output is 1D.
       std::pair< dip::uint, dip::uint > GetDirection() const { return { dim1_, dim2_ }; };
 
@@ -491,6 +504,17 @@ class DIP_NO_EXPORT ImageDisplay {
       /// \brief Get the current global stretch mode.
       bool GetGlobalStretch() const { return globalStretch_; }
 
+      /// \brief Get the current zoom factor.
+      dfloat GetZoom() const { return zoom_; }
+
+      /// \brief Get the pyramid level the slice is taken from. 0 is the input image.
+      dip::uint GetLevel() const { return level_; }
+
+      /// \brief Get the subsampling factors, for each image dimension, of the slice with respect to the input image.
+      UnsignedArray GetScaleFactors() const {
+         return level_ == 0 ? UnsignedArray( image_.Dimensionality(), 1 ) : pyramid_.ScaleFactors( level_ );
+      }
+
    private:
 
       // A copy of the original image, so we're not dependent on the original image still existing. This is where
@@ -533,6 +557,11 @@ class DIP_NO_EXPORT ImageDisplay {
       MappingMode mappingMode_ = MappingMode::MANUAL;
       Limits range_ = { 0.0, 255.0 };
       bool globalStretch_ = false;
+      dfloat zoom_ = 1.0;
+
+      // Lower-resolution versions of `image_`, created when zooming out far enough.
+      ImagePyramid pyramid_;
+      dip::uint level_ = 0;       // pyramid level that `slice_` is taken from (0 is `image_`)
 
       // Information about the image:
       //    sliceLimits_[ (int)REAL ].maxMin -> max and min values to use when in REAL complex mapping mode.
@@ -544,6 +573,32 @@ class DIP_NO_EXPORT ImageDisplay {
       std::array< LimitsLists, 4 > sliceLimits_;  // Limits to use when !globalStretch_
       std::array< LimitsLists, 4 > globalLimits_; // Limits to use when globalStretch_
 
+      // Projections computed so far, so that changing the direction back and forth doesn't recompute them.
+      // The image never changes, so entries never become invalid. There are at most nDims*nDims*2 of them.
+      struct CachedProjection {
+         dip::uint level;
+         dip::uint dim1;
+         dip::uint dim2;
+         ProjectionMode mode;
+         Image projection; // not permuted
+      };
+      std::vector< CachedProjection > projectionCache_;
+
+      // Per-slice limits for all slices along the current direction, computed in a single pass over the image
+      // the second time the limits for a different slice are requested. `lower` and `upper` have the sizes of
+      // the image, except along `dim1` and `dim2`, where they have a size of 1. Only used for scalar images
+      // in "slice" projection mode, at pyramid level 0.
+      struct SliceLimitsTable {
+         dip::uint dim1;
+         dip::uint dim2;
+         ComplexMode complexMode;
+         bool percentile;
+         UnsignedArray firstCoordinates; // the slice for which limits were requested first
+         Image lower;                    // not forged until the limits for a second slice are requested
+         Image upper;
+      };
+      std::vector< SliceLimitsTable > sliceLimitsTables_;
+
       bool IsComplex() { return image_.DataType().IsComplex(); }
       bool IsBinary() { return image_.DataType().IsBinary(); }
       bool IsInteger() { return image_.DataType().IsInteger(); }
@@ -554,6 +609,13 @@ class DIP_NO_EXPORT ImageDisplay {
 
       DIP_NO_EXPORT void InvalidateSliceLimits();
 
+      // Looks up the limits for the current slice in `sliceLimitsTables_`, computing the table if appropriate.
+      // Returns false if the limits must be computed from the slice itself.
+      DIP_NO_EXPORT bool SliceLimitsFromTable( Limits& lims );
+
+      // Returns the pyramid level to use for the current zoom and direction.
+      DIP_NO_EXPORT dip::uint LevelForZoom();
+
       DIP_EXPORT void UpdateSlice();
       DIP_NO_EXPORT void UpdateRgbSlice();
       DIP_EXPORT void UpdateOutput();
@@ -137,6 +137,100 @@ inline Image Subsampling(
 }
 
 
+/// \brief A multi-resolution representation of an image, where lower-resolution levels are computed on demand.
+///
+/// Level 0 is the input image. Each subsequent level halves the size of the image along the dimensions
+/// where the pixel size is smallest. For an image with isotropic pixels, all dimensions are halved at each level.
+/// For anisotropic pixels (as given by the image's `dip::PixelSize`), only the dimensions where the
+/// pixel size is less than twice the smallest pixel size are halved. This way, the finest dimensions are
+/// subsampled first, until the pixels are approximately isotropic. Dimensions of size 1 are never halved.
+/// Levels are added until all dimensions have a size of at most `minimumSize`.
+///
+/// `method` determines how a level is computed from the previous one:
+///  - `"mean"`: each output pixel is the mean of the 2, 4, 8, etc. input pixels it covers. If the size
+///    along a halved dimension is odd, the last pixel is ignored.
+///  - `"gaussian"`: the image is smoothed with a Gaussian of sigma 1 along the halved dimensions, and
+///    every other pixel is kept.
+///
+/// Binary images are always subsampled without filtering. Levels have the same data type as the input image.
+///
+/// The sizes of all levels are known at construction, but the pixel data of a level are computed only when
+/// first requested through `Level` or `Region`, from the previous level (which is computed first if needed).
+/// Each level is computed using the library's multithreaded filters and arithmetic. This object is not
+/// thread safe: do not request levels from multiple threads simultaneously.
+///
+/// `Save` writes each level to an ICS file, and `Load` creates a pyramid from these files, reading levels
+/// from disk only when requested. `Region` reads only the requested part of a level from the file, which
+/// allows to access small regions of very large pyramids without loading a full level into memory.
+///
+/// The pyramid shares the data of the input image; modifying the input image's pixel values after creating
+/// the pyramid will not update levels already computed.
+class DIP_NO_EXPORT ImagePyramid {
+   public:
+
+      /// \brief The default pyramid has no levels.
+      ImagePyramid() = default;
+
+      /// \brief Creates a pyramid for `image`.
+      DIP_EXPORT explicit ImagePyramid( Image const& image, String const& method = S::MEAN, dip::uint minimumSize = 1 );
+
+      /// \brief Creates a pyramid from files written by `Save`. Levels are read from disk as they are needed.
+      DIP_EXPORT static ImagePyramid Load( String const& filename );
+
+      /// \brief Writes each level to an ICS file, computing levels that were not yet computed.
+      ///
+      /// Level `k` is written to a file `filename` + `"_k.ics"` (an ".ics" extension in `filename` is removed).
+      /// The files are not compressed, so that `Region` can read parts of them efficiently.
+      DIP_EXPORT void Save( String const& filename );
+
+      /// \brief Returns the number of levels, including level 0.
+      dip::uint NumberOfLevels() const { return sizes_.size(); }
+
+      /// \brief Returns the method used to compute the levels.
+      String const& Method() const { return method_; }
+
+      /// \brief Returns the sizes of image at level `level`, without computing it.
+      UnsignedArray const& Sizes( dip::uint level ) const {
+         DIP_THROW_IF( level >= NumberOfLevels(), E::INDEX_OUT_OF_RANGE );
+         return sizes_[ level ];
+      }
+
+      /// \brief Returns the subsampling factor, along each dimension, of level `level` with respect to level 0.
+      ///
+      /// A pixel at coordinates `x` in level 0 is represented by the pixel at coordinates `x / ScaleFactors( level )`
+      /// (using integer division) in level `level`.
+      UnsignedArray const& ScaleFactors( dip::uint level ) const {
+         DIP_THROW_IF( level >= NumberOfLevels(), E::INDEX_OUT_OF_RANGE );
+         return factors_[ level ];
+      }
+
+      /// \brief Returns the image at level `level`, computing or reading it if necessary.
+      DIP_EXPORT Image const& Level( dip::uint level );
+
+      /// \brief Returns a region of the image at level `level`. If the level is not in memory and the pyramid
+      /// was loaded from file, only the region is read from file.
+      DIP_EXPORT Image Region( dip::uint level, RangeArray const& roi );
+
+      /// \brief Computes all levels that are not yet in memory.
+      DIP_EXPORT void ComputeAll();
+
+      /// \brief Returns the lowest-resolution level for which the scale factor along dimensions `dims`
+      /// is not larger than `1 / zoom`. That is, the level that, displayed with a zoom factor of `zoom`
+      /// with respect to level 0, has at least one pixel for each screen pixel. If `dims` is empty, all
+      /// dimensions are considered.
+      DIP_EXPORT dip::uint LevelForZoom( dfloat zoom, UnsignedArray const& dims = {} ) const;
+
+   private:
+      String method_;
+      std::vector< UnsignedArray > sizes_;    // sizes of each level
+      std::vector< UnsignedArray > factors_;  // scale factors of each level w.r.t. level 0
+      std::vector< Image > levels_;           // not forged if not yet computed or read
+      String filename_;                       // base name of the files to read levels from, if loaded
+
+      DIP_NO_EXPORT void Plan( UnsignedArray const& sizes, PixelSize const& pixelSize, dip::uint minimumSize );
+};
+
+
 /// \brief Resamples an image with the given zoom factor and sub-pixel shift.
 ///
 /// The shift is applied first, and causes part of the image to shift out of the field of view.
@@ -0,0 +1,105 @@
+/*
+ * DIPlib 3.0
+ * This file contains support for selecting code compiled for different instruction sets at run time.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+//
+// NOTE!
+// Unlike other files in diplib/library, this file is NOT included through diplib.h.
+// However, it contains no publicly documented functionality.
+//
+
+
+#ifndef DIP_CPU_DISPATCH_H
+#define DIP_CPU_DISPATCH_H
+
+#include "diplib.h"
+
+
+// `DIP__HAS_CPU_DISPATCH` is 1 if the compiler can generate code for instruction sets other than the one selected
+// at compile time (GCC and Clang on x86-64). Define it to 0 before including this file to disable the dispatch.
+#ifndef DIP__HAS_CPU_DISPATCH
+#  if defined(__x86_64__) && ( defined(__clang__) || ( defined(__GNUC__) && ( __GNUC__ >= 6 )))
+#     define DIP__HAS_CPU_DISPATCH 1
+#  else
+#     define DIP__HAS_CPU_DISPATCH 0
+#  endif
+#endif
+
+
+namespace dip {
+namespace detail {
+
+// The instruction set levels we compile code for.
+enum class CpuLevel {
+      BASELINE = 0, // Whatever the compiler was told to target, typically SSE2 on x86-64
+      AVX2 = 1,
+      AVX512 = 2    // AVX-512 F, BW, DQ and VL
+};
+
+// The instruction set level that `CpuDispatch` uses. It is determined when the library is loaded, as the highest
+// level supported by the CPU. The environment variable `DIP_CPU_LEVEL` can be set to "baseline", "avx2" or
+// "avx512" to select a lower level (a level higher than what the CPU supports is ignored).
+CpuLevel GetCpuLevel();
+
+// Changes the instruction set level, but not beyond what the CPU supports. Returns the previous level. This is
+// meant for testing only, and is not thread safe.
+CpuLevel SetCpuLevel( CpuLevel level );
+
+#if DIP__HAS_CPU_DISPATCH
+
+// `flatten` inlines everything that `func` calls, so that the whole computation is compiled for the given
+// instruction set.
+template< typename F >
+__attribute__(( target( "avx2" ), flatten ))
+void CallForAVX2( F const& func ) {
+   func();
+}
+
+template< typename F >
+__attribute__(( target( "avx512f,avx512bw,avx512dq,avx512vl" ), flatten ))
+void CallForAVX512( F const& func ) {
+   func();
+}
+
+#endif
+
+// Calls `func()`, a function without arguments that typically contains a loop the compiler can vectorize (usually
+// a lambda). `func` and all the functions it calls are compiled once for each instruction set level, and the
+// version for `GetCpuLevel()` is executed. On compilers that don't support this, `func` is simply called.
+template< typename F >
+inline void CpuDispatch( F const& func ) {
+#if DIP__HAS_CPU_DISPATCH
+   switch( GetCpuLevel() ) {
+      case CpuLevel::AVX512:
+         CallForAVX512( func );
+         return;
+      case CpuLevel::AVX2:
+         CallForAVX2( func );
+         return;
+      default:
+         break;
+   }
+#endif
+   func();
+}
+
+} // namespace detail
+} // namespace dip
+
+#endif // DIP_CPU_DISPATCH_H
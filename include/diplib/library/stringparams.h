@@ -44,6 +44,8 @@ constexpr char const* MAXIMUM = "maximum";
 constexpr char const* FIRST = "first";
 constexpr char const* LAST = "last";
 constexpr char const* STABLE = "stable";
+constexpr char const* EXACT = "exact";
+constexpr char const* APPROXIMATE = "approximate";
 constexpr char const* DIRECTIONAL = "directional";
 constexpr char const* OTSU = "otsu";
 constexpr char const* INCLUDE = "include";
@@ -148,6 +150,8 @@ constexpr char const* FOURIER = "fourier";
 constexpr char const* SPATIAL = "spatial";
 constexpr char const* FREQUENCY = "frequency";
 constexpr char const* BEST = "best";
+constexpr char const* DIRECT = "direct";
+constexpr char const* OVERLAP_SAVE = "overlap save";
 constexpr char const* EVEN = "even";
 constexpr char const* ODD = "odd";
 constexpr char const* CONJ = "conj";
@@ -254,6 +258,9 @@ constexpr char const* BOX = "box";
 constexpr char const* BOX_SHELL = "box shell";
 constexpr char const* CUSTOM = "custom";
 
+// Image pyramid methods (also `GAUSSIAN`)
+constexpr char const* MEAN = "mean";
+
 } // namespace S
 
 } // namespace dip
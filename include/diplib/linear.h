@@ -168,14 +168,15 @@ inline Image ConvolveFT(
 /// Note that this is a really expensive way to compute the convolution for any `filter` that has more than a
 /// small amount of non-zero values. It is always advantageous to try to separate your filter into a set of 1D
 /// filters (see `dip::SeparateFilter` and `dip::SeparableConvolution`). If this is not possible, use
-/// `dip::ConvolveFT` with larger filters to compute the convolution in the Fourier domain.
+/// `dip::ConvolveFT` with larger filters to compute the convolution in the Fourier domain. `dip::Convolution`
+/// makes this choice automatically.
 ///
 /// Also, if all non-zero filter weights have the same value, `dip::Uniform` implements a more efficient
 /// algorithm. If `filter` is a binary image, `dip::Uniform` is called.
 ///
 /// `boundaryCondition` indicates how the boundary should be expanded in each dimension. See `dip::BoundaryCondition`.
 ///
-/// \see dip::ConvolveFT, dip::SeparableConvolution, dip::SeparateFilter, dip::Uniform
+/// \see dip::Convolution, dip::ConvolveFT, dip::SeparableConvolution, dip::SeparateFilter, dip::Uniform
 DIP_EXPORT void GeneralConvolution(
       Image const& in,
       Image const& filter,
@@ -192,6 +193,53 @@ inline Image GeneralConvolution(
    return out;
 }
 
+/// \brief Applies a convolution with a filter kernel (PSF), choosing the most efficient implementation.
+///
+/// `filter` is a scalar image, and must not have more dimensions than `in`. As elsewhere, the origin of
+/// `filter` is in the middle of the image, on the pixel to the right of the center in case of an even-sized
+/// image.
+///
+/// `method` selects the implementation:
+///
+/// - `"separable"`: the filter is decomposed with `dip::SeparateFilter` and applied with
+///   `dip::SeparableConvolution`. An exception is thrown if the filter is not separable.
+/// - `"direct"`: the convolution sum is computed directly, using `dip::GeneralConvolution`.
+/// - `"fourier"`: the convolution is computed through the Fourier transform, using `dip::ConvolveFT`.
+///   Unlike when calling `dip::ConvolveFT` directly, the image is first extended using `boundaryCondition`,
+///   and padded to a size for which the Fourier transform is efficient (see `dip::GetOptimalDFTSize`).
+/// - `"overlap save"`: the convolution is computed through the Fourier transform, tile by tile, using the
+///   overlap-save method. Tiles are extended using `boundaryCondition` where they touch the image edge, and
+///   are processed in parallel. The scratch memory needed is proportional to the tile size and the number
+///   of threads, rather than to the image size. Tile sizes are chosen to be efficient for the Fourier
+///   transform, and large enough for the filter.
+/// - `"best"`: tries `dip::SeparateFilter` first. It then selects among the four methods above using a
+///   cost model that takes into account the image and filter sizes, the number of non-zero filter weights,
+///   and the number of threads that will be used (see `dip::SetNumberOfThreads`).
+///
+/// Each of these methods yields the same result, up to rounding errors. A binary `filter` is always applied
+/// through `dip::Uniform` with the `"direct"` and `"best"` methods.
+///
+/// `boundaryCondition` indicates how the boundary should be expanded in each dimension. See `dip::BoundaryCondition`.
+///
+/// \see dip::SeparableConvolution, dip::GeneralConvolution, dip::ConvolveFT, dip::SeparateFilter
+DIP_EXPORT void Convolution(
+      Image const& in,
+      Image const& filter,
+      Image& out,
+      String const& method = S::BEST,
+      StringArray const& boundaryCondition = {}
+);
+inline Image Convolution(
+      Image const& in,
+      Image const& filter,
+      String const& method = S::BEST,
+      StringArray const& boundaryCondition = {}
+) {
+   Image out;
+   Convolution( in, filter, out, method, boundaryCondition );
+   return out;
+}
+
 /// \brief Applies a convolution with a kernel with uniform weights, leading to an average (mean) filter.
 ///
 /// The size and shape of the kernel is given by `kernel`, which you can define through a default
@@ -1312,6 +1360,77 @@ inline Image LogGaborFilterBank(
    return out;
 }
 
+/// \brief A bank of filters defined in the frequency domain, to be applied to many images of the same sizes.
+///
+/// The filters are computed once, when the object is created, and stored as the tensor elements of a single
+/// frequency-domain image. `Apply` computes the Fourier transform of the input image once, multiplies it with all
+/// filters, and computes the inverse transforms of all the results together. The filters are stored in
+/// single precision, and the output is single precision.
+///
+/// `dip::CreateLogGaborFilterBank` and `dip::CreateMonogenicFilterBank` create filter banks that produce the same
+/// results as `dip::LogGaborFilterBank` and `dip::MonogenicSignal`.
+///
+/// The `Apply` member functions are `const`, a single object can be shared by multiple threads. The `Apply`
+/// overload that takes arrays of images processes these in parallel.
+class DIP_NO_EXPORT FourierFilterBank {
+   public:
+      /// \brief Creates a filter bank from the frequency-domain filters in the tensor elements of `filters`.
+      ///
+      /// `filters` must be real-valued or complex-valued. Set `conjugateSymmetric` if all filters are the
+      /// Fourier transforms of real-valued kernels; this allows the output to be real-valued when the input is.
+      DIP_EXPORT FourierFilterBank( Image const& filters, bool conjugateSymmetric );
+
+      /// \brief Applies all filters to `in`, producing a tensor image `out` with the same tensor shape as the filters.
+      ///
+      /// `in` must be scalar and have the sizes of the filters. If `inRepresentation` is `"frequency"`, `in` is
+      /// assumed to be Fourier transformed already. If `outRepresentation` is `"frequency"`, `out` is not inverse
+      /// transformed. `out` is real-valued if `in` is real-valued and in the spatial domain, `outRepresentation`
+      /// is `"spatial"`, and the filter bank was created with `conjugateSymmetric` set.
+      DIP_EXPORT void Apply(
+            Image const& in,
+            Image& out,
+            String const& inRepresentation = S::SPATIAL,
+            String const& outRepresentation = S::SPATIAL
+      ) const;
+      Image Apply(
+            Image const& in,
+            String const& inRepresentation = S::SPATIAL,
+            String const& outRepresentation = S::SPATIAL
+      ) const {
+         Image out;
+         Apply( in, out, inRepresentation, outRepresentation );
+         return out;
+      }
+
+      /// \brief Applies all filters to each of the images in `in`, see above. The images are processed in parallel.
+      DIP_EXPORT void Apply(
+            ImageConstRefArray const& in,
+            ImageRefArray& out,
+            String const& inRepresentation = S::SPATIAL,
+            String const& outRepresentation = S::SPATIAL
+      ) const;
+
+      /// \brief Returns the frequency-domain filters.
+      Image const& Filters() const { return filters_; }
+
+      /// \brief Returns the sizes of the images the filter bank can be applied to.
+      UnsignedArray const& Sizes() const { return filters_.Sizes(); }
+
+   private:
+      Image filters_;            // DT_SFLOAT or DT_SCOMPLEX, one tensor element per filter
+      bool conjugateSymmetric_;  // if true, all filters are Fourier transforms of real-valued kernels
+};
+
+/// \brief Creates a log-Gabor filter bank for images of sizes `sizes`.
+///
+/// Applying the filter bank produces the same result as `dip::LogGaborFilterBank` with the same parameters.
+DIP_EXPORT FourierFilterBank CreateLogGaborFilterBank(
+      UnsignedArray const& sizes,
+      FloatArray const& wavelengths = { 3.0, 6.0, 12.0, 24.0 },
+      dfloat bandwidth = 0.75,
+      dip::uint nOrientations = 6
+);
+
 
 /// \brief Computes the normalized convolution with a Gaussian kernel: a Gaussian convolution for missing or
 /// uncertain data.
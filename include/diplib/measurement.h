@@ -728,7 +728,8 @@ class DIP_CLASS_EXPORT ChainCodeBased : public Base {
    public:
       explicit ChainCodeBased( Information const& information ) : Base( information, Type::CHAINCODE_BASED ) {};
 
-      /// \brief Called once for each object
+      /// \brief Called once for each object. This function is called in parallel for different objects,
+      /// and hence needs to be thread-safe. `output` points to the object's values in the measurement table.
       virtual void Measure( ChainCode const& chainCode, Measurement::ValueIterator output ) = 0;
 };
 
@@ -737,7 +738,8 @@ class DIP_CLASS_EXPORT PolygonBased : public Base {
    public:
       explicit PolygonBased( Information const& information ) : Base( information, Type::POLYGON_BASED ) {};
 
-      /// \brief Called once for each object
+      /// \brief Called once for each object. This function is called in parallel for different objects,
+      /// and hence needs to be thread-safe. `output` points to the object's values in the measurement table.
       virtual void Measure( Polygon const& polygon, Measurement::ValueIterator output ) = 0;
 };
 
@@ -746,7 +748,8 @@ class DIP_CLASS_EXPORT ConvexHullBased : public Base {
    public:
       explicit ConvexHullBased( Information const& information ) : Base( information, Type::CONVEXHULL_BASED ) {};
 
-      /// \brief Called once for each object
+      /// \brief Called once for each object. This function is called in parallel for different objects,
+      /// and hence needs to be thread-safe. `output` points to the object's values in the measurement table.
       virtual void Measure( ConvexHull const& convexHull, Measurement::ValueIterator output ) = 0;
 };
 
@@ -22,6 +22,10 @@
 #ifndef DIP_MULTITHREADING_H
 #define DIP_MULTITHREADING_H
 
+#include <functional>
+#include <map>
+#include <memory>
+
 #include "diplib/library/types.h"
 
 #ifdef _OPENMP
@@ -66,16 +70,240 @@ DIP_EXPORT void SetNumberOfThreads( dip::uint nThreads );
 /// Returns the value given in the last call to `dip::SetNumberOfThreads`, or the default maximum value if that
 /// function was never called.
 ///
+/// When called from within an OpenMP parallel region, and nested parallelism is not enabled, returns 1, since
+/// any parallel region started there would run on a single thread. Likewise, returns 1 when called from within
+/// a task run by `dip::ParallelFor`. Never returns more than the concurrency of the current `dip::TaskScheduler`.
+///
 /// If DIPlib was compiled without OpenMP support, this function always returns 1.
 DIP_EXPORT dip::uint GetNumberOfThreads();
 
 
+/// \brief Runs the parallel work of DIPlib.
+///
+/// The image processing frameworks, and other parallel algorithms in DIPlib, split their work into independent
+/// tasks, and hand them to the current task scheduler through `dip::ParallelFor`. By default this is a
+/// `dip::WorkStealingTaskScheduler`. An application that manages its own threads can install a
+/// different scheduler with `dip::SetTaskScheduler`, so that DIPlib does not start threads of its own
+/// competing with the application's threads for the CPU. `dip::ExecutorTaskScheduler` adapts any executor
+/// to this interface.
+///
+/// A derived class must be thread safe: `Run` can be called concurrently from different threads.
+class DIP_CLASS_EXPORT TaskScheduler {
+   public:
+      virtual ~TaskScheduler() = default;
+
+      /// \brief Returns the maximum number of tasks this scheduler runs concurrently. DIPlib does not split
+      /// its work into more chunks than this.
+      virtual dip::uint Concurrency() const = 0;
+
+      /// \brief Calls `task( ii )` for each `ii` in the range [0, `nTasks`), and returns when all calls have
+      /// finished. The calls can happen in any order, in any thread, and concurrently. `task` does not throw.
+      virtual void Run( dip::uint nTasks, std::function< void( dip::uint ) > const& task ) = 0;
+};
+
+/// \brief The default `dip::TaskScheduler`, a pool of threads that steal work from each other.
+///
+/// `Run` splits the tasks into equal contiguous ranges, one for each participating thread. The calling thread
+/// participates too. A thread that finishes its range steals half of the remaining tasks of another thread.
+/// Thus, tasks with very different costs are balanced, and a thread that is busy elsewhere (for example
+/// because `Run` is called concurrently from different threads) does not delay the work: its range is
+/// taken over by the others.
+///
+/// The pool has `nThreads - 1` threads, which are started on the first call to `Run` that can use them.
+/// `Run` never uses more threads than allowed by `dip::SetNumberOfThreads`.
+class DIP_CLASS_EXPORT WorkStealingTaskScheduler : public TaskScheduler {
+   public:
+      DIP_EXPORT explicit WorkStealingTaskScheduler( dip::uint nThreads );
+      DIP_EXPORT ~WorkStealingTaskScheduler() override;
+      WorkStealingTaskScheduler( WorkStealingTaskScheduler const& ) = delete;
+      WorkStealingTaskScheduler& operator=( WorkStealingTaskScheduler const& ) = delete;
+
+      virtual dip::uint Concurrency() const override { return concurrency_; }
+
+      DIP_EXPORT virtual void Run( dip::uint nTasks, std::function< void( dip::uint ) > const& task ) override;
+
+   private:
+      class Pool;
+      std::unique_ptr< Pool > pool_;
+      dip::uint concurrency_;
+};
+
+/// \brief A `dip::TaskScheduler` that hands tasks to a caller-provided executor, such as an application's
+/// thread pool.
+///
+/// `submit` is called with a function that must be executed at some point, in any thread. `concurrency`
+/// is the number of threads the executor has available. For example, with a pool that has a `post` method:
+///
+/// ```cpp
+///     dip::SetTaskScheduler( std::make_shared< dip::ExecutorTaskScheduler >(
+///           [ &pool ]( std::function< void() > job ) { pool.post( std::move( job )); }, pool.size() ));
+/// ```
+///
+/// The thread that calls `Run` executes tasks too, rather than waiting idle for the executor. Thus, `Run`
+/// does not deadlock when called from within one of the executor's threads, even if all other threads are
+/// busy. Functions submitted after all tasks have been claimed return immediately.
+class DIP_CLASS_EXPORT ExecutorTaskScheduler : public TaskScheduler {
+   public:
+      using Executor = std::function< void( std::function< void() > ) >;
+
+      ExecutorTaskScheduler( Executor submit, dip::uint concurrency )
+            : submit_( std::move( submit )), concurrency_( std::max< dip::uint >( concurrency, 1 )) {}
+
+      virtual dip::uint Concurrency() const override { return concurrency_; }
+
+      DIP_EXPORT virtual void Run( dip::uint nTasks, std::function< void( dip::uint ) > const& task ) override;
+
+   private:
+      Executor submit_;
+      dip::uint concurrency_;
+};
+
+/// \brief Sets the task scheduler used by DIPlib for all its parallel work. Pass `nullptr` to restore the
+/// default scheduler, a `dip::WorkStealingTaskScheduler` with as many threads as the default value for
+/// `dip::SetNumberOfThreads`.
+///
+/// Do not change the scheduler while DIPlib functions are running in other threads.
+DIP_EXPORT void SetTaskScheduler( std::shared_ptr< TaskScheduler > scheduler );
+
+/// \brief Gets the task scheduler used by DIPlib for all its parallel work.
+DIP_EXPORT TaskScheduler& GetTaskScheduler();
+
+
+/// \brief Calls `function( ii )` for each `ii` in the range [0, `n`), distributing the calls over up to
+/// `dip::GetNumberOfThreads` threads.
+///
+/// The calls are run by the current `dip::TaskScheduler`. The default scheduler balances calls with very
+/// different costs by letting idle threads steal calls from busy ones. DIPlib functions called from within
+/// `function` will run in a single thread; the parallelism is over the calls, not within them. This is the most
+/// efficient way to apply the same operation to many small images.
+///
+/// If `function` throws an exception, calls not yet started are skipped, and the first exception thrown is
+/// rethrown once all threads have finished.
+DIP_EXPORT void ParallelFor( dip::uint n, std::function< void( dip::uint ) > const& function );
+
+
+/// \brief How `dip::Framework::Scan` and `dip::Framework::Full` divide the image lines among threads.
+///
+/// `WorkSchedule` constant | Meaning
+/// ----------------------- | --------
+/// `WorkSchedule::Static`  | The lines are split into one chunk per thread, of equal size. This has the least overhead.
+/// `WorkSchedule::Dynamic` | The lines are split into many small chunks of equal size, which threads pick up as they become idle.
+/// `WorkSchedule::Guided`  | Like `Dynamic`, but the chunks start out large and become smaller towards the end.
+///
+/// `Dynamic` and `Guided` balance the load when the cost per line varies, for example with a mask or with
+/// a line filter that can stop early, or when some of the cores are busy with other work. Each thread still
+/// has a unique index (`thread` in the line filter parameters), but a thread no longer processes a contiguous
+/// section of the image. Line filters that accumulate floating-point values per thread can therefore produce
+/// slightly different results from run to run.
+enum class WorkSchedule {
+      Static,
+      Dynamic,
+      Guided
+};
+
+/// \brief Sets how the frameworks divide work among threads. The default is `dip::WorkSchedule::Static`.
+///
+/// Do not change the schedule while DIPlib functions are running in other threads.
+DIP_EXPORT void SetWorkSchedule( WorkSchedule schedule );
+
+/// \brief Gets how the frameworks divide work among threads.
+DIP_EXPORT WorkSchedule GetWorkSchedule();
+
+/// \brief Time spent by one thread within a framework function, as reported to a `dip::ThreadTimingHook`.
+struct ThreadTiming {
+   dip::uint chunks = 0;      ///< Number of chunks processed by the thread.
+   dip::uint lines = 0;       ///< Number of image lines (or 1D sections) processed by the thread.
+   dfloat seconds = 0;        ///< Wall-clock time spent by the thread, in seconds.
+};
+
+/// \brief Function called by `dip::Framework::Scan` and `dip::Framework::Full` after processing an image.
+///
+/// `framework` is the name of the framework function, `timing` has one element per thread used. The hook is
+/// called from the thread that called the framework function. It is not called if the processing failed.
+using ThreadTimingHook = std::function< void( String const& framework, std::vector< ThreadTiming > const& timing ) >;
+
+/// \brief Sets an instrumentation hook that is called with per-thread timing information each time a framework
+/// function completes. Pass an empty function to remove the hook. Timing is only measured when a hook is set.
+///
+/// Do not change the hook while DIPlib functions are running in other threads.
+DIP_EXPORT void SetThreadTimingHook( ThreadTimingHook hook );
+
+/// \brief Gets the current thread timing instrumentation hook, see `dip::SetThreadTimingHook`.
+DIP_EXPORT ThreadTimingHook const& GetThreadTimingHook();
+
+
 // Undocumented constant: how many operations (clock cycles) it takes to make it worth going into multiple threads.
 // (experimentally determined on Cris' computer, might be different elsewhere).
 // I also noticed that going to 2 threads or 4 threads does not make a huge difference in overhead, so this is a
 // threshold for single vs multithreaded computation, not a threshold per thread created.
+// The frameworks use `dip::ThreadingCostModel` instead, whose default values are derived from this constant.
 constexpr dip::uint threadingThreshold = 70000;
 
+
+/// \brief Model for the cost of multithreading, used by the frameworks to choose how many threads to use.
+///
+/// The frameworks estimate the work to be done as a number of operations, through the line filter's
+/// `GetNumberOfOperations` method. The model converts this into a time \f$W\f$ in seconds, using `operationCost`
+/// multiplied by the factor in `filterCostFactors` for the line filter (or 1 if it's not listed). Using \f$n\f$
+/// threads is then expected to take \f$W/n + s + (n-1)t\f$ seconds, with \f$s\f$ the `startupCost` and \f$t\f$
+/// the `threadCost`. The frameworks use the number of threads that minimizes this time.
+///
+/// The default values reproduce the fixed threshold of `dip::threadingThreshold` operations for two threads.
+/// `dip::CalibrateThreading` measures the values for the current machine.
+struct DIP_CLASS_EXPORT ThreadingCostModel {
+   dfloat operationCost = 1.0 / 3e9;   ///< Time for one operation, in seconds.
+   dfloat threadCost = 1e-6;           ///< Time added for each additional thread, in seconds.
+   dfloat startupCost = static_cast< dfloat >( threadingThreshold ) / 3e9 / 2.0 - 1e-6; ///< Time added for using multiple threads, in seconds.
+   /// Correction factors for `operationCost`, indexed by the line filter's type name (`typeid( lineFilter ).name()`).
+   /// These names are compiler-specific, they are only meaningful for the DIPlib binary that measured them.
+   std::map< String, dfloat > filterCostFactors;
+
+   /// \brief Returns the number of threads, at most `maxThreads`, that minimizes the time to do `operations`
+   /// operations with the line filter `filter`.
+   DIP_EXPORT dip::uint NumberOfThreads( dip::uint operations, dip::uint maxThreads, String const& filter = {} ) const;
+};
+
+/// \brief Measures the parameters of the multithreading cost model on the current machine.
+///
+/// Measures the overhead of starting work on two and on `dip::GetNumberOfThreads` threads (if more than one
+/// thread is available), and runs a set of typical filters in a single thread to measure the time per operation
+/// for each of their line filters. This takes a fraction of a second. The result is returned, not installed;
+/// use `dip::SetThreadingCostModel` to install it, or `dip::SaveThreadingCostModel` to store it. To calibrate
+/// when installing an application, for example:
+///
+/// ```cpp
+///     dip::SaveThreadingCostModel( dip::CalibrateThreading(), "/etc/myapp/threading.txt" );
+/// ```
+///
+/// The per-filter factors are only valid for the DIPlib binary that measured them, see `dip::LoadThreadingCostModel`.
+DIP_EXPORT ThreadingCostModel CalibrateThreading();
+
+/// \brief Writes a threading cost model to a text file.
+///
+/// The file records the DIPlib version and compiler used to build the library, which determine the
+/// line filter type names in `dip::ThreadingCostModel::filterCostFactors`.
+DIP_EXPORT void SaveThreadingCostModel( ThreadingCostModel const& model, String const& filename );
+
+/// \brief Reads a threading cost model from a text file written by `dip::SaveThreadingCostModel`.
+///
+/// If the file was written by a different build of DIPlib (a different version or compiler), the per-filter
+/// factors are discarded, since the line filter type names they refer to are not portable. The thread costs
+/// and the operation cost are always read.
+DIP_EXPORT ThreadingCostModel LoadThreadingCostModel( String const& filename );
+
+/// \brief Sets the threading cost model used by the frameworks.
+///
+/// Do not change the model while DIPlib functions are running in other threads.
+DIP_EXPORT void SetThreadingCostModel( ThreadingCostModel model );
+
+/// \brief Gets the threading cost model used by the frameworks.
+///
+/// Unless `dip::SetThreadingCostModel` was called earlier, the first call reads the model from the file given by
+/// the environment variable `DIP_THREADING_MODEL`. If that file doesn't exist, `dip::CalibrateThreading` is run
+/// and its result is written to the file, so that the calibration happens only the first time a program is run.
+/// If the environment variable is not set, the default model is used.
+DIP_EXPORT ThreadingCostModel const& GetThreadingCostModel();
+
 /// \}
 
 } // namespace dip
@@ -100,7 +100,9 @@ inline Image MedianFilter(
 ///
 /// `boundaryCondition` indicates how the boundary should be expanded in each dimension. See `dip::BoundaryCondition`.
 ///
-/// Uses `dip::FastVarianceAccumulator` for the computation.
+/// Uses `dip::FastVarianceAccumulator` for the computation. For rectangular kernels and real-valued input,
+/// summed-area tables (integral images) of the pixel values and their squares are used instead, making the
+/// computational cost independent of the kernel size.
 DIP_EXPORT void VarianceFilter(
       Image const& in,
       Image& out,
@@ -161,6 +163,10 @@ inline Image VarianceFilter(
 ///
 /// `control` must be a real-valued scalar image. `in` can be of any data type and tensor size. `out` will be of
 /// the same size, tensor size, and data type as `in`.
+///
+/// For rectangular kernels, the search for the optimal pixel is performed separably, such that the computational
+/// cost is proportional to the sum of the kernel sizes rather than their product. Ties can be resolved differently
+/// than for other kernel shapes.
 DIP_EXPORT void SelectionFilter(
       Image const& in,
       Image const& control,
@@ -210,6 +216,10 @@ inline Image SelectionFilter(
 ///
 /// `boundaryCondition` indicates how the boundary should be expanded in each dimension. See `dip::BoundaryCondition`.
 ///
+/// For rectangular kernels and real-valued input, the mean and variance within the filtering window are both
+/// computed from a single set of summed-area tables, and the selection is performed separably. This makes the
+/// computational cost nearly independent of the kernel size.
+///
 /// **Literature**
 /// - M. Kuwahara, K. Hachimura and M. Kinoshita, "%Image enhancement and left ventricular contour extraction techniques
 ///   applied to radioisotope angiocardiograms", Automedica 3:107-119, 1980.
@@ -0,0 +1,340 @@
+/*
+ * DIPlib 3.0
+ * This file contains declarations for bit-packed binary images
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef DIP_PACKED_BINARY_H
+#define DIP_PACKED_BINARY_H
+
+#include <vector>
+
+#include "diplib.h"
+
+
+/// \file
+/// \brief A bit-packed binary image and the binary image filters that work on it.
+/// \see binary
+
+
+namespace dip {
+
+
+/// \addtogroup binary
+/// \{
+
+
+/// \brief A binary image that stores 64 pixels in each 64-bit word.
+///
+/// A `dip::Image` of type `dip::DT_BIN` uses one byte per pixel. `%PackedBinaryImage` uses one bit per pixel,
+/// requiring 8 times less memory, and allows the binary morphology functions and logical operators defined
+/// for it to process 64 pixels with each machine instruction.
+///
+/// The image is stored as a set of rows, each row being a line along dimension 0. Each row starts at a word
+/// boundary, and is `WordsPerRow()` words long. Pixel `x` of a row is stored in bit `x % 64` of word `x / 64`,
+/// the unused bits at the end of the last word of each row are always 0. Rows are stored in linear index order,
+/// that is, the row with coordinates (\f$y\f$, \f$z\f$) in a 3D image has index \f$y + z N_y\f$.
+///
+/// This class is not a `dip::Image`, it can only be used with the functions in this file. Use the constructor
+/// to convert a binary `dip::Image` to the packed representation, and `Unpack` to convert it back. The image is
+/// always scalar, and does not carry any image properties such as the pixel size.
+class DIP_NO_EXPORT PackedBinaryImage {
+   public:
+      /// \brief The storage unit
+      using Word = std::uint64_t;
+
+      /// \brief The number of pixels stored in one `Word`
+      static constexpr dip::uint bitsPerWord = 64;
+
+      /// \brief The default-constructed image is empty, it has no pixels.
+      PackedBinaryImage() = default;
+
+      /// \brief Creates an image with the given sizes, with all pixels set to `value`.
+      explicit PackedBinaryImage( UnsignedArray const& sizes, bool value = false ) {
+         DIP_STACK_TRACE_THIS( ReForge( sizes, value ));
+      }
+
+      /// \brief Packs the binary image `image`. `image` must be forged, scalar and binary.
+      DIP_EXPORT explicit PackedBinaryImage( Image const& image );
+
+      /// \brief Unpacks the image into `out`, which will be a binary image of the same sizes.
+      ///
+      /// If `out` is protected and has the right sizes, it can be of any data type, and will be filled with
+      /// the values 0 and 1.
+      DIP_EXPORT void Unpack( Image& out ) const;
+
+      /// \brief Returns the image unpacked to a `dip::Image` of type `dip::DT_BIN`.
+      Image Unpack() const {
+         Image out;
+         Unpack( out );
+         return out;
+      }
+
+      /// \brief Changes the sizes of the image, and sets all pixels to `value`.
+      DIP_EXPORT void ReForge( UnsignedArray const& sizes, bool value = false );
+
+      /// \brief Returns `true` if the image has pixels.
+      bool IsForged() const { return !data_.empty(); }
+
+      /// \brief Returns the image sizes.
+      UnsignedArray const& Sizes() const { return sizes_; }
+
+      /// \brief Returns the image size along dimension `dim`.
+      dip::uint Size( dip::uint dim ) const { return sizes_[ dim ]; }
+
+      /// \brief Returns the image dimensionality.
+      dip::uint Dimensionality() const { return sizes_.size(); }
+
+      /// \brief Returns the number of pixels in the image.
+      dip::uint NumberOfPixels() const { return sizes_.product(); }
+
+      /// \brief Returns the number of words that make up one image row.
+      dip::uint WordsPerRow() const { return wordsPerRow_; }
+
+      /// \brief Returns the number of image rows, the number of pixels divided by the size along dimension 0.
+      dip::uint NumberOfRows() const { return wordsPerRow_ == 0 ? 0 : data_.size() / wordsPerRow_; }
+
+      /// \brief Returns a pointer to the first word of row `index`.
+      Word* Row( dip::uint index ) { return data_.data() + index * wordsPerRow_; }
+      Word const* Row( dip::uint index ) const { return data_.data() + index * wordsPerRow_; }
+
+      /// \brief Returns a mask with the bits of the last word of each row that belong to the image.
+      Word LastWordMask() const {
+         dip::uint bits = sizes_.empty() ? 0 : sizes_[ 0 ] % bitsPerWord;
+         return bits == 0 ? ~Word( 0 ) : ( Word( 1 ) << bits ) - 1;
+      }
+
+      /// \brief Returns the value of the pixel at `coords`.
+      bool At( UnsignedArray const& coords ) const {
+         dip::uint row = RowIndex( coords );
+         return ( Row( row )[ coords[ 0 ] / bitsPerWord ] >> ( coords[ 0 ] % bitsPerWord )) & 1u;
+      }
+
+      /// \brief Sets the pixel at `coords` to `value`.
+      void Set( UnsignedArray const& coords, bool value ) {
+         dip::uint row = RowIndex( coords );
+         Word& word = Row( row )[ coords[ 0 ] / bitsPerWord ];
+         Word bit = Word( 1 ) << ( coords[ 0 ] % bitsPerWord );
+         word = value ? ( word | bit ) : ( word & ~bit );
+      }
+
+      /// \brief Sets all pixels to `value`.
+      DIP_EXPORT void Fill( bool value );
+
+      /// \brief Returns the number of set pixels.
+      DIP_EXPORT dip::uint Count() const;
+
+      /// \brief Compares the sizes and the pixel values of two images.
+      bool operator==( PackedBinaryImage const& other ) const {
+         return ( sizes_ == other.sizes_ ) && ( data_ == other.data_ );
+      }
+      bool operator!=( PackedBinaryImage const& other ) const {
+         return !( *this == other );
+      }
+
+   private:
+      UnsignedArray sizes_;
+      dip::uint wordsPerRow_ = 0;
+      std::vector< Word > data_;
+
+      dip::uint RowIndex( UnsignedArray const& coords ) const {
+         DIP_ASSERT( coords.size() == sizes_.size() );
+         dip::uint row = 0;
+         for( dip::uint ii = sizes_.size() - 1; ii > 0; --ii ) {
+            DIP_ASSERT( coords[ ii ] < sizes_[ ii ] );
+            row = row * sizes_[ ii ] + coords[ ii ];
+         }
+         DIP_ASSERT( coords[ 0 ] < sizes_[ 0 ] );
+         return row;
+      }
+};
+
+
+/// \brief Binary morphological dilation operation on a packed binary image.
+///
+/// Produces the same result as `dip::BinaryDilation(Image const&, Image&, dip::sint, dip::uint, String const&)`,
+/// but processes 64 pixels at the time. Each iteration reads every input word once for each neighbor row, so the
+/// cost is independent of image content.
+DIP_EXPORT void BinaryDilation(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::BACKGROUND
+);
+inline PackedBinaryImage BinaryDilation(
+      PackedBinaryImage const& in,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::BACKGROUND
+) {
+   PackedBinaryImage out;
+   BinaryDilation( in, out, connectivity, iterations, edgeCondition );
+   return out;
+}
+
+/// \brief Binary morphological erosion operation on a packed binary image.
+///
+/// Produces the same result as `dip::BinaryErosion(Image const&, Image&, dip::sint, dip::uint, String const&)`,
+/// but processes 64 pixels at the time.
+DIP_EXPORT void BinaryErosion(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::OBJECT
+);
+inline PackedBinaryImage BinaryErosion(
+      PackedBinaryImage const& in,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::OBJECT
+) {
+   PackedBinaryImage out;
+   BinaryErosion( in, out, connectivity, iterations, edgeCondition );
+   return out;
+}
+
+/// \brief Binary morphological closing operation on a packed binary image.
+///
+/// Produces the same result as `dip::BinaryClosing(Image const&, Image&, dip::sint, dip::uint, String const&)`,
+/// including the `"special"` edge condition.
+DIP_EXPORT void BinaryClosing(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::SPECIAL
+);
+inline PackedBinaryImage BinaryClosing(
+      PackedBinaryImage const& in,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::SPECIAL
+) {
+   PackedBinaryImage out;
+   BinaryClosing( in, out, connectivity, iterations, edgeCondition );
+   return out;
+}
+
+/// \brief Binary morphological opening operation on a packed binary image.
+///
+/// Produces the same result as `dip::BinaryOpening(Image const&, Image&, dip::sint, dip::uint, String const&)`,
+/// including the `"special"` edge condition.
+DIP_EXPORT void BinaryOpening(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::SPECIAL
+);
+inline PackedBinaryImage BinaryOpening(
+      PackedBinaryImage const& in,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::SPECIAL
+) {
+   PackedBinaryImage out;
+   BinaryOpening( in, out, connectivity, iterations, edgeCondition );
+   return out;
+}
+
+/// \brief Counts the number of set neighbors for each pixel in the packed binary image `in`.
+///
+/// Produces the same `dip::DT_UINT8` image as
+/// `dip::CountNeighbors(Image const&, Image&, dip::uint, dip::String const&, dip::String const&)`.
+/// The counts are accumulated for 64 pixels at the time using bit-sliced addition.
+DIP_EXPORT void CountNeighbors(
+      PackedBinaryImage const& in,
+      Image& out,
+      dip::uint connectivity = 0,
+      dip::String const& mode = S::FOREGROUND,
+      dip::String const& edgeCondition = S::BACKGROUND
+);
+inline Image CountNeighbors(
+      PackedBinaryImage const& in,
+      dip::uint connectivity = 0,
+      dip::String const& mode = S::FOREGROUND,
+      dip::String const& edgeCondition = S::BACKGROUND
+) {
+   Image out;
+   CountNeighbors( in, out, connectivity, mode, edgeCondition );
+   return out;
+}
+
+/// \brief Logical AND of two packed binary images of the same sizes. `out` can be the same object as an input.
+DIP_EXPORT void And( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs, PackedBinaryImage& out );
+
+/// \brief Logical OR of two packed binary images of the same sizes. `out` can be the same object as an input.
+DIP_EXPORT void Or( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs, PackedBinaryImage& out );
+
+/// \brief Logical XOR of two packed binary images of the same sizes. `out` can be the same object as an input.
+DIP_EXPORT void Xor( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs, PackedBinaryImage& out );
+
+/// \brief Logical NOT of a packed binary image. `out` can be the same object as `in`.
+DIP_EXPORT void Not( PackedBinaryImage const& in, PackedBinaryImage& out );
+inline PackedBinaryImage Not( PackedBinaryImage const& in ) { PackedBinaryImage out; Not( in, out ); return out; }
+
+/// \brief Logical operator, calls `dip::And`.
+inline PackedBinaryImage operator&( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs ) {
+   PackedBinaryImage out;
+   And( lhs, rhs, out );
+   return out;
+}
+
+/// \brief Logical operator, calls `dip::Or`.
+inline PackedBinaryImage operator|( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs ) {
+   PackedBinaryImage out;
+   Or( lhs, rhs, out );
+   return out;
+}
+
+/// \brief Logical operator, calls `dip::Xor`.
+inline PackedBinaryImage operator^( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs ) {
+   PackedBinaryImage out;
+   Xor( lhs, rhs, out );
+   return out;
+}
+
+/// \brief Logical operator, calls `dip::Not`.
+inline PackedBinaryImage operator~( PackedBinaryImage const& in ) {
+   return Not( in );
+}
+
+/// \brief Compound assignment operator, calls `dip::And`.
+inline PackedBinaryImage& operator&=( PackedBinaryImage& lhs, PackedBinaryImage const& rhs ) {
+   And( lhs, rhs, lhs );
+   return lhs;
+}
+
+/// \brief Compound assignment operator, calls `dip::Or`.
+inline PackedBinaryImage& operator|=( PackedBinaryImage& lhs, PackedBinaryImage const& rhs ) {
+   Or( lhs, rhs, lhs );
+   return lhs;
+}
+
+/// \brief Compound assignment operator, calls `dip::Xor`.
+inline PackedBinaryImage& operator^=( PackedBinaryImage& lhs, PackedBinaryImage const& rhs ) {
+   Xor( lhs, rhs, lhs );
+   return lhs;
+}
+
+
+/// \}
+
+} // namespace dip
+
+#endif // DIP_PACKED_BINARY_H
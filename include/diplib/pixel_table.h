@@ -300,6 +300,14 @@ class DIP_NO_EXPORT PixelTable {
             }
          }
          origin_ = origin;
+         if( !weights_.empty() ) {
+            // The runs now go in the opposite direction, the weights along each run must be reversed too
+            auto it = weights_.begin();
+            for( auto const& run : runs_ ) {
+               std::reverse( it, it + static_cast< dip::sint >( run.length ));
+               it += static_cast< dip::sint >( run.length );
+            }
+         }
       }
 
       /// Returns the number of pixels in the neighborhood
@@ -86,6 +86,9 @@ DIP_EXPORT UnsignedArray GetObjectLabels(
 );
 
 /// \brief Re-assigns labels to objects in a labeled image, such that all labels are consecutive.
+///
+/// The new labels preserve the order of the old ones: the object with the smallest label becomes 1, the next
+/// one 2, etc. The background (label 0) is not changed.
 DIP_EXPORT void Relabel( Image const& label, Image& out );
 inline Image Relabel( Image const& label ) {
    Image out;
@@ -95,9 +98,9 @@ inline Image Relabel( Image const& label ) {
 
 /// \brief Removes small objects from a labeled or binary image.
 ///
-/// If `in` is an unsigned integer image, it is assumed to be a labeled image. The size of the objects
-/// are measured using `dip::MeasurementTool`, and the labels for the objects with fewer than `threshold`
-/// pixels are removed. The `connectivity` parameter is ignored.
+/// If `in` is an unsigned integer image, it is assumed to be a labeled image. The number of pixels of each
+/// object is counted, and the labels for the objects with fewer than `threshold` pixels are removed. The
+/// `connectivity` parameter is ignored.
 ///
 /// If `in` is a binary image, `dip::Label` is called with `minSize` set to `threshold`, and the result
 /// is binarized again. `connectivity` is passed to the labeling function.
@@ -480,11 +480,32 @@ inline Image MinimumAbs( Image const& in, Image const& mask = {}, BooleanArray c
 ///
 /// If `mask` is forged, only those pixels selected by the mask image are used.
 ///
+/// Sub-images that are large, or that have an 8 or 16-bit integer type, are not copied into a buffer for
+/// sorting. Instead, a radix selection algorithm determines the percentile with a few passes over the data,
+/// using a fixed amount of memory. If `mode` is `"approximate"`, the radix selection algorithm is always used,
+/// and it uses two passes over the data: one to determine the range of values, and one to compute a histogram
+/// with 2<sup>16</sup> bins over this range. The result is then accurate to within one bin width, that is, the
+/// error is smaller than (max-min)/65536. For integer images with a range smaller than 65536 the result is exact.
+/// If `mode` is `"exact"` (the default), the exact percentile is computed.
+///
 /// \see dip::PositionPercentile
-DIP_EXPORT void Percentile( Image const& in, Image const& mask, Image& out, dfloat percentile = 50, BooleanArray const& process = {} );
-inline Image Percentile( Image const& in, Image const& mask = {}, dfloat percentile = 50, BooleanArray const& process = {} ) {
+DIP_EXPORT void Percentile(
+      Image const& in,
+      Image const& mask,
+      Image& out,
+      dfloat percentile = 50,
+      BooleanArray const& process = {},
+      String const& mode = S::EXACT
+);
+inline Image Percentile(
+      Image const& in,
+      Image const& mask = {},
+      dfloat percentile = 50,
+      BooleanArray const& process = {},
+      String const& mode = S::EXACT
+) {
    Image out;
-   Percentile( in, mask, out, percentile, process );
+   Percentile( in, mask, out, percentile, process, mode );
    return out;
 }
 
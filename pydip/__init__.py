@@ -59,6 +59,21 @@ returns a copy of the data, but an assignment form is also available:
    img2 = img[mask]
    img2.Fill(0)     # does not affect img
    img[mask] = 0    # sets all pixels in mask to 0
+
+# NumPy arrays:
+
+NumPy arrays (and other objects that expose the buffer protocol) can be
+used wherever an Image is expected. The Image shares the data with the
+array, also if the array is not contiguous or has negative strides. The
+array is copied only if DIPlib cannot use its samples directly (64-bit
+integers, half floats, non-native byte order, or strides that are not a
+whole number of samples). To get an error instead of a copy:
+   dip.SetCopyOnConversion(False)
+This setting applies to the whole process, not only to the calling thread.
+
+Images created with the Image constructor store their pixels in a NumPy
+array. An Image converts to a NumPy array without copying:
+   arr = numpy.asarray(img)
 """
 
 # Here we import classes and functions from the binary and the python-code modules into
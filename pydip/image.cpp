@@ -16,11 +16,140 @@
  * limitations under the License.
  */
 
+#include <atomic>
+
 #include "pydip.h"
 #include "diplib/generic_iterators.h"
 
 namespace {
 
+// When false, converting a Python buffer that cannot be used directly throws instead of making a copy.
+// This is a process-wide setting, shared by all Python threads.
+std::atomic< bool > copyOnConversion( true );
+
+bool IsLittleEndian() {
+   dip::uint16 one = 1;
+   return *reinterpret_cast< dip::uint8* >( &one ) == 1;
+}
+
+py::dtype NumPyDType( dip::DataType datatype ) {
+   switch( datatype ) {
+      case dip::DT_BIN:      return py::dtype::of< bool >();
+      case dip::DT_UINT8:    return py::dtype::of< dip::uint8 >();
+      case dip::DT_UINT16:   return py::dtype::of< dip::uint16 >();
+      case dip::DT_UINT32:   return py::dtype::of< dip::uint32 >();
+      case dip::DT_SINT8:    return py::dtype::of< dip::sint8 >();
+      case dip::DT_SINT16:   return py::dtype::of< dip::sint16 >();
+      case dip::DT_SINT32:   return py::dtype::of< dip::sint32 >();
+      case dip::DT_SFLOAT:   return py::dtype::of< dip::sfloat >();
+      case dip::DT_DFLOAT:   return py::dtype::of< dip::dfloat >();
+      case dip::DT_SCOMPLEX: return py::dtype::of< dip::scomplex >();
+      case dip::DT_DCOMPLEX: return py::dtype::of< dip::dcomplex >();
+      default:
+         DIP_THROW( "Image of unknown type" ); // should never happen
+   }
+}
+
+// Finds the DIPlib data type for the samples in the buffer. `needsCopy` is set if the samples cannot be used as
+// they are, but can be converted to `datatype` by copying. Buffers are matched on the kind of sample and its size,
+// not on the format character, as the meaning of characters such as 'l' depends on the platform.
+dip::DataType BufferDataType( py::buffer_info const& info, bool& needsCopy ) {
+   needsCopy = false;
+   dip::String format = info.format;
+   if( !format.empty() ) {
+      switch( format[ 0 ] ) {
+         case '@':
+         case '=':
+            format.erase( 0, 1 );
+            break;
+         case '<':
+            needsCopy = !IsLittleEndian();
+            format.erase( 0, 1 );
+            break;
+         case '>':
+         case '!':
+            needsCopy = IsLittleEndian();
+            format.erase( 0, 1 );
+            break;
+         default:
+            break;
+      }
+   }
+   DIP_THROW_IF( format.empty(), "Buffer data type not compatible with class Image" );
+   dip::uint size = static_cast< dip::uint >( info.itemsize );
+   switch( format[ 0 ] ) {
+      case '?':
+         if( size == 1 ) {
+            return dip::DT_BIN;
+         }
+         break;
+      case 'b':
+      case 'h':
+      case 'i':
+      case 'l':
+      case 'q':
+      case 'n':
+         switch( size ) {
+            case 1: return dip::DT_SINT8;
+            case 2: return dip::DT_SINT16;
+            case 4: return dip::DT_SINT32;
+            case 8: needsCopy = true; return dip::DT_SINT32; // Range is tested when copying
+            default: break;
+         }
+         break;
+      case 'B':
+      case 'H':
+      case 'I':
+      case 'L':
+      case 'Q':
+      case 'N':
+         switch( size ) {
+            case 1: return dip::DT_UINT8;
+            case 2: return dip::DT_UINT16;
+            case 4: return dip::DT_UINT32;
+            case 8: needsCopy = true; return dip::DT_UINT32; // Range is tested when copying
+            default: break;
+         }
+         break;
+      case 'e':
+      case 'f':
+      case 'd':
+      case 'g':
+         switch( size ) {
+            case 2: needsCopy = true; return dip::DT_SFLOAT;
+            case 4: return dip::DT_SFLOAT;
+            case 8: return dip::DT_DFLOAT;
+            default: needsCopy = true; return dip::DT_DFLOAT;
+         }
+      case 'Z':
+         switch( size ) {
+            case 8: return dip::DT_SCOMPLEX;
+            case 16: return dip::DT_DCOMPLEX;
+            default: needsCopy = true; return dip::DT_DCOMPLEX;
+         }
+      default:
+         break;
+   }
+   DIP_THROW( "Buffer data type not compatible with class Image" );
+}
+
+// Copies the buffer into a NumPy array of the given data type, keeping the memory layout where possible.
+// 64-bit integers are converted to 32-bit integers only if all values fit.
+py::buffer CopyBuffer( py::buffer& buf, dip::DataType datatype ) {
+   DIP_THROW_IF( !copyOnConversion, "Buffer cannot be used without copying, and copying is disabled (see SetCopyOnConversion)" );
+   auto numpy = py::module::import( "numpy" );
+   py::object array = numpy.attr( "asarray" )( buf );
+   if( datatype.IsInteger() && ( array.attr( "dtype" ).attr( "itemsize" ).cast< dip::uint >() > datatype.SizeOf() )
+       && ( array.attr( "size" ).cast< dip::uint >() > 0 )) {
+      DIP_THROW_IF( datatype.IsSigned()
+                    ? (( array.attr( "min" )().cast< dip::sint >() < std::numeric_limits< dip::sint32 >::lowest() ) ||
+                       ( array.attr( "max" )().cast< dip::sint >() > std::numeric_limits< dip::sint32 >::max() ))
+                    : ( array.attr( "max" )().cast< dip::uint >() > std::numeric_limits< dip::uint32 >::max() ),
+                    "Buffer contains 64-bit integers that do not fit in a 32-bit integer image" );
+   }
+   return numpy.attr( "array" )( array, "dtype"_a = NumPyDType( datatype ), "order"_a = "K" );
+}
+
 dip::Image BufferToImage( py::buffer& buf ) {
    py::buffer_info info = buf.request();
    //std::cout << "--Constructing dip::Image from Python buffer.\n";
@@ -34,52 +163,8 @@ dip::Image BufferToImage( py::buffer& buf ) {
    //std::cout << "   info.strides[0] = " << info.strides[0] << std::endl;
    //std::cout << "   info.strides[1] = " << info.strides[1] << std::endl;
    // Data type
-   dip::DataType datatype;
-   switch( info.format[ 0 ] ) {
-      case py::format_descriptor< bool >::c:
-         datatype = dip::DT_BIN;
-         break;
-      case py::format_descriptor< dip::uint8 >::c:
-         datatype = dip::DT_UINT8;
-         break;
-      case py::format_descriptor< dip::uint16 >::c:
-         datatype = dip::DT_UINT16;
-         break;
-      case py::format_descriptor< dip::uint32 >::c:
-         datatype = dip::DT_UINT32;
-         break;
-      case py::format_descriptor< dip::sint8 >::c:
-         datatype = dip::DT_SINT8;
-         break;
-      case py::format_descriptor< dip::sint16 >::c:
-         datatype = dip::DT_SINT16;
-         break;
-      case py::format_descriptor< dip::sint32 >::c:
-         datatype = dip::DT_SINT32;
-         break;
-      case py::format_descriptor< dip::sfloat >::c:
-         datatype = dip::DT_SFLOAT;
-         break;
-      case py::format_descriptor< dip::dfloat >::c:
-         datatype = dip::DT_DFLOAT;
-         break;
-      case 'Z':
-         switch( info.format[ 1 ] ) {
-            case py::format_descriptor< dip::scomplex >::c:
-               datatype = dip::DT_SCOMPLEX;
-               break;
-            case py::format_descriptor< dip::dcomplex >::c:
-               datatype = dip::DT_DCOMPLEX;
-               break;
-            default:
-               std::cout << "Attempted to convert buffer to dip.Image object: data type not compatible." << std::endl;
-               DIP_THROW( "Buffer data type not compatible with class Image" );
-         }
-         break;
-      default:
-         std::cout << "Attempted to convert buffer to dip.Image object: data type not compatible." << std::endl;
-         DIP_THROW( "Buffer data type not compatible with class Image" );
-   }
+   bool needsCopy;
+   dip::DataType datatype = BufferDataType( info, needsCopy );
    // Sizes, reversed
    dip::uint ndim = static_cast< dip::uint >( info.ndim );
    DIP_ASSERT( ndim == info.shape.size() );
@@ -87,14 +172,19 @@ dip::Image BufferToImage( py::buffer& buf ) {
    for( dip::uint ii = 0; ii < ndim; ++ii ) {
       sizes[ ii ] = static_cast< dip::uint >( info.shape[ ndim - ii - 1 ] );
    }
-   // Strides, also reversed
+   // Strides, also reversed. Negative and non-contiguous strides are fine, but they must be in whole pixels.
    dip::IntegerArray strides( ndim, 1 );
    for( dip::uint ii = 0; ii < ndim; ++ii ) {
       dip::sint s = info.strides[ ndim - ii - 1 ] / static_cast< dip::sint >( info.itemsize );
-      DIP_THROW_IF( s * static_cast< dip::sint >( info.itemsize ) != info.strides[ ndim - ii - 1 ],
-                    "Cannot create image out of an array where strides are not in whole pixels" );
+      if( s * static_cast< dip::sint >( info.itemsize ) != info.strides[ ndim - ii - 1 ] ) {
+         needsCopy = true;
+      }
       strides[ ii ] = s;
    }
+   if( needsCopy ) {
+      py::buffer copy = CopyBuffer( buf, datatype );
+      return BufferToImage( copy );
+   }
    // The containing Python object. We increase its reference count, and create a unique_ptr that decreases
    // its reference count again.
    PyObject* pyObject = buf.ptr();
@@ -102,6 +192,7 @@ dip::Image BufferToImage( py::buffer& buf ) {
    Py_XINCREF( pyObject );
    dip::DataSegment dataSegment{ pyObject, []( void* obj ) {
       //std::cout << "   *** Decrementing ref count for pyObject " << obj << std::endl;
+      py::gil_scoped_acquire acquire; // The image might be destroyed while the GIL is released (see `ReleaseGIL`)
       Py_XDECREF( static_cast< PyObject* >( obj ));
    }};
    // Create an image with all of this.
@@ -166,7 +257,7 @@ py::buffer_info ImageToBuffer( dip::Image const& image ) {
    }
    if( !image.IsScalar() ) {
       sizes.push_back( image.TensorElements() );
-      strides.push_back( image.TensorStride() );
+      strides.push_back( image.TensorStride() * itemsize );
    }
    py::buffer_info info{ image.Origin(), itemsize, format, static_cast< py::ssize_t >( sizes.size() ), sizes, strides };
    //std::cout << "--Constructed Python buffer for dip::Image object.\n";
@@ -206,12 +297,48 @@ dip::String ImageRepr( dip::Image const& image ) {
 
 } // namespace
 
+dip::DataSegment NumPyInterface::AllocateData(
+      void*& origin,
+      dip::DataType datatype,
+      dip::UnsignedArray const& sizes,
+      dip::IntegerArray& strides,
+      dip::Tensor const& tensor,
+      dip::sint& tstride
+) {
+   py::gil_scoped_acquire acquire; // Images are typically forged while the GIL is released
+   dip::uint nDims = sizes.size();
+   std::vector< py::ssize_t > shape( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      shape[ ii ] = static_cast< py::ssize_t >( sizes[ nDims - ii - 1 ] );
+   }
+   if( !tensor.IsScalar() ) {
+      shape.push_back( static_cast< py::ssize_t >( tensor.Elements() ));
+   }
+   py::array array( NumPyDType( datatype ), shape ); // C order: these are DIPlib's normal strides
+   strides.resize( nDims );
+   dip::sint stride = static_cast< dip::sint >( tensor.Elements() );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      strides[ ii ] = stride;
+      stride *= static_cast< dip::sint >( sizes[ ii ] );
+   }
+   tstride = 1;
+   origin = array.mutable_data();
+   return dip::DataSegment{ array.release().ptr(), []( void* obj ) {
+      py::gil_scoped_acquire acquire;
+      Py_XDECREF( static_cast< PyObject* >( obj ));
+   }};
+}
+
 void init_image( py::module& m ) {
    auto img = py::class_< dip::Image >( m, "Image", py::buffer_protocol(), "The class that encapsulates DIPlib images of all types." );
    // Constructor for raw (unforged) image, to be used e.g. when no mask input argument is needed
    img.def( py::init<>() );
    // Constructor, generic
-   img.def( py::init< dip::UnsignedArray const&, dip::uint, dip::DataType >(), "sizes"_a, "tensorElems"_a = 1, "dt"_a = dip::DT_SFLOAT );
+   img.def( py::init([]( dip::UnsignedArray const& sizes, dip::uint tensorElems, dip::DataType dt ) {
+               dip::Image out = NumPyInterface::NewImage(); // Pixels are stored in a NumPy array
+               out.ReForge( sizes, tensorElems, dt );
+               return out;
+            } ), "sizes"_a, "tensorElems"_a = 1, "dt"_a = dip::DT_SFLOAT );
    // Constructor that takes a Sample
    img.def( py::init< dip::Image::Sample const& >(), "sample"_a );
    img.def( py::init< dip::Image::Sample const&, dip::DataType >(), "sample"_a, "dt"_a );
@@ -445,6 +572,9 @@ void init_image( py::module& m ) {
       return out;
    } );
 
+   m.def( "SetCopyOnConversion", []( bool copy ) { copyOnConversion = copy; }, "copy"_a = true );
+   m.def( "GetCopyOnConversion", []() { return copyOnConversion.load(); } );
+
    m.def( "Copy", py::overload_cast< dip::Image const& >( &dip::Copy ), "src"_a );
    m.def( "ExpandTensor", py::overload_cast< dip::Image const& >( &dip::ExpandTensor ), "src"_a );
    m.def( "Convert", py::overload_cast< dip::Image, dip::DataType >( &dip::Convert ), "src"_a, "dt"_a );
@@ -20,134 +20,140 @@
 #include "diplib/math.h"
 
 void init_math( py::module& m ) {
-   m.def( "Add", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Add( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a );
-   m.def( "Add", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Add( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "Subtract", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Subtract( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a );
-   m.def( "Subtract", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Subtract( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "Multiply", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Multiply( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a );
-   m.def( "Multiply", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Multiply( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "MultiplySampleWise", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::MultiplySampleWise( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a );
-   m.def( "MultiplySampleWise", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::MultiplySampleWise( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "MultiplyConjugate", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::MultiplyConjugate( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a );
-   m.def( "MultiplyConjugate", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::MultiplyConjugate( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "Divide", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Divide( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a );
-   m.def( "Divide", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Divide( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "SafeDivide", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::SafeDivide( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a );
-   m.def( "SafeDivide", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::SafeDivide( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "Modulo", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Modulo( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a );
-   m.def( "Modulo", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Modulo( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "Power", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Power( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a );
-   m.def( "Power", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Power( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "Invert", py::overload_cast< dip::Image const& >( &dip::Invert ), "in"_a );
-   m.def( "And", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::And( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "Or", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Or( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "Xor", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Xor( lhs, rhs ); }, "lhs"_a, "rhs"_a );
-   m.def( "Not", py::overload_cast< dip::Image const& >( &dip::Not ), "in"_a );
-   m.def( "InRange", []( dip::Image const& in, dip::Image const& lhs, dip::Image const& rhs ) { return dip::InRange( in, lhs, rhs ); }, "in"_a, "lhs"_a, "rhs"_a );
-   m.def( "OutOfRange", []( dip::Image const& in, dip::Image const& lhs, dip::Image const& rhs ) { return dip::OutOfRange( in, lhs, rhs ); }, "in"_a, "lhs"_a, "rhs"_a );
+   m.def( "Add", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Add( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a, ReleaseGIL() );
+   m.def( "Add", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Add( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "Subtract", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Subtract( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a, ReleaseGIL() );
+   m.def( "Subtract", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Subtract( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "Multiply", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Multiply( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a, ReleaseGIL() );
+   m.def( "Multiply", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Multiply( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "MultiplySampleWise", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::MultiplySampleWise( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a, ReleaseGIL() );
+   m.def( "MultiplySampleWise", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::MultiplySampleWise( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "MultiplyConjugate", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::MultiplyConjugate( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a, ReleaseGIL() );
+   m.def( "MultiplyConjugate", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::MultiplyConjugate( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "Divide", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Divide( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a, ReleaseGIL() );
+   m.def( "Divide", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Divide( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "SafeDivide", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::SafeDivide( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a, ReleaseGIL() );
+   m.def( "SafeDivide", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::SafeDivide( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "Modulo", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Modulo( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a, ReleaseGIL() );
+   m.def( "Modulo", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Modulo( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "Power", []( dip::Image const& lhs, dip::Image const& rhs, dip::DataType dt ) { return dip::Power( lhs, rhs, dt ); }, "lhs"_a, "rhs"_a, "datatype"_a, ReleaseGIL() );
+   m.def( "Power", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Power( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "Invert", py::overload_cast< dip::Image const& >( &dip::Invert ), "in"_a, ReleaseGIL() );
+   m.def( "And", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::And( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "Or", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Or( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "Xor", []( dip::Image const& lhs, dip::Image const& rhs ) { return dip::Xor( lhs, rhs ); }, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "Not", py::overload_cast< dip::Image const& >( &dip::Not ), "in"_a, ReleaseGIL() );
+   m.def( "InRange", []( dip::Image const& in, dip::Image const& lhs, dip::Image const& rhs ) { return dip::InRange( in, lhs, rhs ); }, "in"_a, "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "OutOfRange", []( dip::Image const& in, dip::Image const& lhs, dip::Image const& rhs ) { return dip::OutOfRange( in, lhs, rhs ); }, "in"_a, "lhs"_a, "rhs"_a, ReleaseGIL() );
 
-   m.def( "SquareModulus", py::overload_cast< dip::Image const& >( &dip::SquareModulus ), "in"_a );
-   m.def( "Phase", py::overload_cast< dip::Image const& >( &dip::Phase ), "in"_a );
-   m.def( "Round", py::overload_cast< dip::Image const& >( &dip::Round ), "in"_a );
-   m.def( "Ceil", py::overload_cast< dip::Image const& >( &dip::Ceil ), "in"_a );
-   m.def( "Floor", py::overload_cast< dip::Image const& >( &dip::Floor ), "in"_a );
-   m.def( "Truncate", py::overload_cast< dip::Image const& >( &dip::Truncate ), "in"_a );
-   m.def( "Fraction", py::overload_cast< dip::Image const& >( &dip::Fraction ), "in"_a );
-   m.def( "Reciprocal", py::overload_cast< dip::Image const& >( &dip::Reciprocal ), "in"_a );
-   m.def( "Square", py::overload_cast< dip::Image const& >( &dip::Square ), "in"_a );
-   m.def( "Sqrt", py::overload_cast< dip::Image const& >( &dip::Sqrt ), "in"_a );
-   m.def( "Exp", py::overload_cast< dip::Image const& >( &dip::Exp ), "in"_a );
-   m.def( "Exp2", py::overload_cast< dip::Image const& >( &dip::Exp2 ), "in"_a );
-   m.def( "Exp10", py::overload_cast< dip::Image const& >( &dip::Exp10 ), "in"_a );
-   m.def( "Ln", py::overload_cast< dip::Image const& >( &dip::Ln ), "in"_a );
-   m.def( "Log2", py::overload_cast< dip::Image const& >( &dip::Log2 ), "in"_a );
-   m.def( "Log10", py::overload_cast< dip::Image const& >( &dip::Log10 ), "in"_a );
-   m.def( "Sin", py::overload_cast< dip::Image const& >( &dip::Sin ), "in"_a );
-   m.def( "Cos", py::overload_cast< dip::Image const& >( &dip::Cos ), "in"_a );
-   m.def( "Tan", py::overload_cast< dip::Image const& >( &dip::Tan ), "in"_a );
-   m.def( "Asin", py::overload_cast< dip::Image const& >( &dip::Asin ), "in"_a );
-   m.def( "Acos", py::overload_cast< dip::Image const& >( &dip::Acos ), "in"_a );
-   m.def( "Atan", py::overload_cast< dip::Image const& >( &dip::Atan ), "in"_a );
-   m.def( "Sinh", py::overload_cast< dip::Image const& >( &dip::Sinh ), "in"_a );
-   m.def( "Cosh", py::overload_cast< dip::Image const& >( &dip::Cosh ), "in"_a );
-   m.def( "Tanh", py::overload_cast< dip::Image const& >( &dip::Tanh ), "in"_a );
-   m.def( "BesselJ0", py::overload_cast< dip::Image const& >( &dip::BesselJ0 ), "in"_a );
-   m.def( "BesselJ1", py::overload_cast< dip::Image const& >( &dip::BesselJ1 ), "in"_a );
-   m.def( "BesselJN", py::overload_cast< dip::Image const&, dip::uint >( &dip::BesselJN ), "in"_a, "alpha"_a  );
-   m.def( "BesselY0", py::overload_cast< dip::Image const& >( &dip::BesselY0 ), "in"_a );
-   m.def( "BesselY1", py::overload_cast< dip::Image const& >( &dip::BesselY1 ), "in"_a );
-   m.def( "BesselYN", py::overload_cast< dip::Image const&, dip::uint >( &dip::BesselYN ), "in"_a, "alpha"_a  );
-   m.def( "LnGamma", py::overload_cast< dip::Image const& >( &dip::LnGamma ), "in"_a );
-   m.def( "Erf", py::overload_cast< dip::Image const& >( &dip::Erf ), "in"_a );
-   m.def( "Erfc", py::overload_cast< dip::Image const& >( &dip::Erfc ), "in"_a );
-   m.def( "Sinc", py::overload_cast< dip::Image const& >( &dip::Sinc ), "in"_a );
-   m.def( "IsNotANumber", py::overload_cast< dip::Image const& >( &dip::IsNotANumber ), "in"_a );
-   m.def( "IsInfinite", py::overload_cast< dip::Image const& >( &dip::IsInfinite ), "in"_a );
-   m.def( "IsFinite", py::overload_cast< dip::Image const& >( &dip::IsFinite ), "in"_a );
+   m.def( "SquareModulus", py::overload_cast< dip::Image const& >( &dip::SquareModulus ), "in"_a, ReleaseGIL() );
+   m.def( "Phase", py::overload_cast< dip::Image const& >( &dip::Phase ), "in"_a, ReleaseGIL() );
+   m.def( "Round", py::overload_cast< dip::Image const& >( &dip::Round ), "in"_a, ReleaseGIL() );
+   m.def( "Ceil", py::overload_cast< dip::Image const& >( &dip::Ceil ), "in"_a, ReleaseGIL() );
+   m.def( "Floor", py::overload_cast< dip::Image const& >( &dip::Floor ), "in"_a, ReleaseGIL() );
+   m.def( "Truncate", py::overload_cast< dip::Image const& >( &dip::Truncate ), "in"_a, ReleaseGIL() );
+   m.def( "Fraction", py::overload_cast< dip::Image const& >( &dip::Fraction ), "in"_a, ReleaseGIL() );
+   m.def( "Reciprocal", py::overload_cast< dip::Image const& >( &dip::Reciprocal ), "in"_a, ReleaseGIL() );
+   m.def( "Square", py::overload_cast< dip::Image const& >( &dip::Square ), "in"_a, ReleaseGIL() );
+   m.def( "Sqrt", py::overload_cast< dip::Image const& >( &dip::Sqrt ), "in"_a, ReleaseGIL() );
+   m.def( "Exp", py::overload_cast< dip::Image const& >( &dip::Exp ), "in"_a, ReleaseGIL() );
+   m.def( "Exp2", py::overload_cast< dip::Image const& >( &dip::Exp2 ), "in"_a, ReleaseGIL() );
+   m.def( "Exp10", py::overload_cast< dip::Image const& >( &dip::Exp10 ), "in"_a, ReleaseGIL() );
+   m.def( "Ln", py::overload_cast< dip::Image const& >( &dip::Ln ), "in"_a, ReleaseGIL() );
+   m.def( "Log2", py::overload_cast< dip::Image const& >( &dip::Log2 ), "in"_a, ReleaseGIL() );
+   m.def( "Log10", py::overload_cast< dip::Image const& >( &dip::Log10 ), "in"_a, ReleaseGIL() );
+   m.def( "Sin", py::overload_cast< dip::Image const& >( &dip::Sin ), "in"_a, ReleaseGIL() );
+   m.def( "Cos", py::overload_cast< dip::Image const& >( &dip::Cos ), "in"_a, ReleaseGIL() );
+   m.def( "Tan", py::overload_cast< dip::Image const& >( &dip::Tan ), "in"_a, ReleaseGIL() );
+   m.def( "Asin", py::overload_cast< dip::Image const& >( &dip::Asin ), "in"_a, ReleaseGIL() );
+   m.def( "Acos", py::overload_cast< dip::Image const& >( &dip::Acos ), "in"_a, ReleaseGIL() );
+   m.def( "Atan", py::overload_cast< dip::Image const& >( &dip::Atan ), "in"_a, ReleaseGIL() );
+   m.def( "Sinh", py::overload_cast< dip::Image const& >( &dip::Sinh ), "in"_a, ReleaseGIL() );
+   m.def( "Cosh", py::overload_cast< dip::Image const& >( &dip::Cosh ), "in"_a, ReleaseGIL() );
+   m.def( "Tanh", py::overload_cast< dip::Image const& >( &dip::Tanh ), "in"_a, ReleaseGIL() );
+   m.def( "BesselJ0", py::overload_cast< dip::Image const& >( &dip::BesselJ0 ), "in"_a, ReleaseGIL() );
+   m.def( "BesselJ1", py::overload_cast< dip::Image const& >( &dip::BesselJ1 ), "in"_a, ReleaseGIL() );
+   m.def( "BesselJN", py::overload_cast< dip::Image const&, dip::uint >( &dip::BesselJN ), "in"_a, "alpha"_a, ReleaseGIL()  );
+   m.def( "BesselY0", py::overload_cast< dip::Image const& >( &dip::BesselY0 ), "in"_a, ReleaseGIL() );
+   m.def( "BesselY1", py::overload_cast< dip::Image const& >( &dip::BesselY1 ), "in"_a, ReleaseGIL() );
+   m.def( "BesselYN", py::overload_cast< dip::Image const&, dip::uint >( &dip::BesselYN ), "in"_a, "alpha"_a, ReleaseGIL()  );
+   m.def( "LnGamma", py::overload_cast< dip::Image const& >( &dip::LnGamma ), "in"_a, ReleaseGIL() );
+   m.def( "Erf", py::overload_cast< dip::Image const& >( &dip::Erf ), "in"_a, ReleaseGIL() );
+   m.def( "Erfc", py::overload_cast< dip::Image const& >( &dip::Erfc ), "in"_a, ReleaseGIL() );
+   m.def( "Sinc", py::overload_cast< dip::Image const& >( &dip::Sinc ), "in"_a, ReleaseGIL() );
+   m.def( "IsNotANumber", py::overload_cast< dip::Image const& >( &dip::IsNotANumber ), "in"_a, ReleaseGIL() );
+   m.def( "IsInfinite", py::overload_cast< dip::Image const& >( &dip::IsInfinite ), "in"_a, ReleaseGIL() );
+   m.def( "IsFinite", py::overload_cast< dip::Image const& >( &dip::IsFinite ), "in"_a, ReleaseGIL() );
 
-   m.def( "Abs", py::overload_cast< dip::Image const& >( &dip::Abs ), "in"_a );
-   m.def( "Modulus", py::overload_cast< dip::Image const& >( &dip::Modulus ), "in"_a );
-   m.def( "Real", py::overload_cast< dip::Image const& >( &dip::Real ), "in"_a );
-   m.def( "Imaginary", py::overload_cast< dip::Image const& >( &dip::Imaginary ), "in"_a );
-   m.def( "Conjugate", py::overload_cast< dip::Image const& >( &dip::Conjugate ), "in"_a );
-   m.def( "Sign", py::overload_cast< dip::Image const& >( &dip::Sign ), "in"_a );
-   m.def( "NearestInt", py::overload_cast< dip::Image const& >( &dip::NearestInt ), "in"_a );
-   m.def( "Supremum", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Supremum ), "in1"_a, "in2"_a );
-   m.def( "Supremum", py::overload_cast< dip::ImageConstRefArray const& >( &dip::Supremum ), "image_array"_a );
-   m.def( "Infimum", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Infimum ), "in1"_a, "in2"_a );
-   m.def( "Infimum", py::overload_cast< dip::ImageConstRefArray const& >( &dip::Infimum ), "image_array"_a );
-   m.def( "SignedInfimum", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::SignedInfimum ), "in1"_a, "in2"_a );
+   m.def( "Abs", py::overload_cast< dip::Image const& >( &dip::Abs ), "in"_a, ReleaseGIL() );
+   m.def( "Modulus", py::overload_cast< dip::Image const& >( &dip::Modulus ), "in"_a, ReleaseGIL() );
+   m.def( "Real", py::overload_cast< dip::Image const& >( &dip::Real ), "in"_a, ReleaseGIL() );
+   m.def( "Imaginary", py::overload_cast< dip::Image const& >( &dip::Imaginary ), "in"_a, ReleaseGIL() );
+   m.def( "Conjugate", py::overload_cast< dip::Image const& >( &dip::Conjugate ), "in"_a, ReleaseGIL() );
+   m.def( "Sign", py::overload_cast< dip::Image const& >( &dip::Sign ), "in"_a, ReleaseGIL() );
+   m.def( "NearestInt", py::overload_cast< dip::Image const& >( &dip::NearestInt ), "in"_a, ReleaseGIL() );
+   m.def( "Supremum", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Supremum ), "in1"_a, "in2"_a, ReleaseGIL() );
+   m.def( "Supremum", py::overload_cast< dip::ImageConstRefArray const& >( &dip::Supremum ), "image_array"_a, ReleaseGIL() );
+   m.def( "Infimum", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Infimum ), "in1"_a, "in2"_a, ReleaseGIL() );
+   m.def( "Infimum", py::overload_cast< dip::ImageConstRefArray const& >( &dip::Infimum ), "image_array"_a, ReleaseGIL() );
+   m.def( "SignedInfimum", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::SignedInfimum ), "in1"_a, "in2"_a, ReleaseGIL() );
    m.def( "LinearCombination", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat, dip::dfloat >( &dip::LinearCombination ),
-          "a"_a, "b"_a, "aWeight"_a = 0.5, "bWeight"_a = 0.5 );
+          "a"_a, "b"_a, "aWeight"_a = 0.5, "bWeight"_a = 0.5, ReleaseGIL() );
    m.def( "LinearCombination", py::overload_cast< dip::Image const&, dip::Image const&, dip::dcomplex, dip::dcomplex >( &dip::LinearCombination ),
-          "a"_a, "b"_a, "aWeight"_a, "bWeight"_a );
+          "a"_a, "b"_a, "aWeight"_a, "bWeight"_a, ReleaseGIL() );
 
-   m.def( "Atan2", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Atan2 ), "y"_a, "x"_a );
-   m.def( "Hypot", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Hypot ), "a"_a, "b"_a );
-   m.def( "Transpose", py::overload_cast< dip::Image const& >( &dip::Transpose ), "in"_a );
-   m.def( "ConjugateTranspose", py::overload_cast< dip::Image const& >( &dip::ConjugateTranspose ), "in"_a );
-   m.def( "DotProduct", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::DotProduct ), "lhs"_a, "rhs"_a );
-   m.def( "CrossProduct", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::CrossProduct ), "lhs"_a, "rhs"_a );
+   m.def( "Atan2", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Atan2 ), "y"_a, "x"_a, ReleaseGIL() );
+   m.def( "Hypot", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Hypot ), "a"_a, "b"_a, ReleaseGIL() );
+   m.def( "Transpose", py::overload_cast< dip::Image const& >( &dip::Transpose ), "in"_a, ReleaseGIL() );
+   m.def( "ConjugateTranspose", py::overload_cast< dip::Image const& >( &dip::ConjugateTranspose ), "in"_a, ReleaseGIL() );
+   m.def( "DotProduct", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::DotProduct ), "lhs"_a, "rhs"_a, ReleaseGIL() );
+   m.def( "CrossProduct", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::CrossProduct ), "lhs"_a, "rhs"_a, ReleaseGIL() );
    m.def( "Norm", //py::overload_cast< dip::Image const& >( &dip::Norm ), // Fails to resolve!
-          static_cast< dip::Image ( * )( dip::Image const& ) >( &dip::Norm ), "in"_a );
-   m.def( "Angle", py::overload_cast< dip::Image const& >( &dip::Angle ), "in"_a );
-   m.def( "Orientation", py::overload_cast< dip::Image const& >( &dip::Orientation ), "in"_a );
-   m.def( "CartesianToPolar", py::overload_cast< dip::Image const& >( &dip::CartesianToPolar ), "in"_a );
-   m.def( "PolarToCartesian", py::overload_cast< dip::Image const& >( &dip::PolarToCartesian ), "in"_a );
-   m.def( "Determinant", py::overload_cast< dip::Image const& >( &dip::Determinant ), "in"_a );
+          static_cast< dip::Image ( * )( dip::Image const& ) >( &dip::Norm ), "in"_a, ReleaseGIL() );
+   m.def( "Angle", py::overload_cast< dip::Image const& >( &dip::Angle ), "in"_a, ReleaseGIL() );
+   m.def( "Orientation", py::overload_cast< dip::Image const& >( &dip::Orientation ), "in"_a, ReleaseGIL() );
+   m.def( "CartesianToPolar", py::overload_cast< dip::Image const& >( &dip::CartesianToPolar ), "in"_a, ReleaseGIL() );
+   m.def( "PolarToCartesian", py::overload_cast< dip::Image const& >( &dip::PolarToCartesian ), "in"_a, ReleaseGIL() );
+   m.def( "Determinant", py::overload_cast< dip::Image const& >( &dip::Determinant ), "in"_a, ReleaseGIL() );
    m.def( "Trace", //py::overload_cast< dip::Image const& >( &dip::Trace ), // Fails to resolve!
-          static_cast< dip::Image ( * )( dip::Image const& ) >( &dip::Trace ), "in"_a );
-   m.def( "Rank", py::overload_cast< dip::Image const& >( &dip::Rank ), "in"_a );
-   m.def( "Eigenvalues", py::overload_cast< dip::Image const& >( &dip::Eigenvalues ), "in"_a );
-   m.def( "LargestEigenvalue", py::overload_cast< dip::Image const& >( &dip::LargestEigenvalue ), "in"_a );
-   m.def( "SmallestEigenvalue", py::overload_cast< dip::Image const& >( &dip::SmallestEigenvalue ), "in"_a );
+          static_cast< dip::Image ( * )( dip::Image const& ) >( &dip::Trace ), "in"_a, ReleaseGIL() );
+   m.def( "Rank", py::overload_cast< dip::Image const& >( &dip::Rank ), "in"_a, ReleaseGIL() );
+   m.def( "Eigenvalues", py::overload_cast< dip::Image const& >( &dip::Eigenvalues ), "in"_a, ReleaseGIL() );
+   m.def( "LargestEigenvalue", py::overload_cast< dip::Image const& >( &dip::LargestEigenvalue ), "in"_a, ReleaseGIL() );
+   m.def( "SmallestEigenvalue", py::overload_cast< dip::Image const& >( &dip::SmallestEigenvalue ), "in"_a, ReleaseGIL() );
    m.def( "EigenDecomposition", []( dip::Image const& in ){
              dip::Image out, eigenvectors;
-             dip::EigenDecomposition( in, out, eigenvectors );
+             {
+                py::gil_scoped_release release;
+                dip::EigenDecomposition( in, out, eigenvectors );
+             }
              return py::make_tuple( out, eigenvectors ).release();
           }, "in"_a );
-   m.def( "LargestEigenVector", py::overload_cast< dip::Image const& >( &dip::LargestEigenVector ), "in"_a );
-   m.def( "SmallestEigenVector", py::overload_cast< dip::Image const& >( &dip::SmallestEigenVector ), "in"_a );
-   m.def( "Inverse", py::overload_cast< dip::Image const& >( &dip::Inverse ), "in"_a );
-   m.def( "PseudoInverse", py::overload_cast< dip::Image const&, dip::dfloat >( &dip::PseudoInverse ), "in"_a, "tolerance"_a = 1e-7 );
-   m.def( "SingularValues", py::overload_cast< dip::Image const& >( &dip::SingularValues ), "in"_a );
+   m.def( "LargestEigenVector", py::overload_cast< dip::Image const& >( &dip::LargestEigenVector ), "in"_a, ReleaseGIL() );
+   m.def( "SmallestEigenVector", py::overload_cast< dip::Image const& >( &dip::SmallestEigenVector ), "in"_a, ReleaseGIL() );
+   m.def( "Inverse", py::overload_cast< dip::Image const& >( &dip::Inverse ), "in"_a, ReleaseGIL() );
+   m.def( "PseudoInverse", py::overload_cast< dip::Image const&, dip::dfloat >( &dip::PseudoInverse ), "in"_a, "tolerance"_a = 1e-7, ReleaseGIL() );
+   m.def( "SingularValues", py::overload_cast< dip::Image const& >( &dip::SingularValues ), "in"_a, ReleaseGIL() );
    m.def( "SingularValueDecomposition", []( dip::Image const& in ){
              dip::Image U, S, V;
-             dip::SingularValueDecomposition( in, U, S, V );
+             {
+                py::gil_scoped_release release;
+                dip::SingularValueDecomposition( in, U, S, V );
+             }
              return py::make_tuple( U, S, V ).release();
           }, "in"_a );
-   m.def( "Identity", py::overload_cast< dip::Image const& >( &dip::Identity ), "in"_a );
+   m.def( "Identity", py::overload_cast< dip::Image const& >( &dip::Identity ), "in"_a, ReleaseGIL() );
 
-   m.def( "SumTensorElements", py::overload_cast< dip::Image const& >( &dip::SumTensorElements ), "in"_a );
-   m.def( "ProductTensorElements", py::overload_cast< dip::Image const& >( &dip::ProductTensorElements ), "in"_a );
-   m.def( "AllTensorElements", py::overload_cast< dip::Image const& >( &dip::AllTensorElements ), "in"_a );
-   m.def( "AnyTensorElement", py::overload_cast< dip::Image const& >( &dip::AnyTensorElement ), "in"_a );
-   m.def( "MaximumTensorElement", py::overload_cast< dip::Image const& >( &dip::MaximumTensorElement ), "in"_a );
-   m.def( "MinimumTensorElement", py::overload_cast< dip::Image const& >( &dip::MinimumTensorElement ), "in"_a );
-   m.def( "MeanTensorElement", py::overload_cast< dip::Image const& >( &dip::MeanTensorElement ), "in"_a );
+   m.def( "SumTensorElements", py::overload_cast< dip::Image const& >( &dip::SumTensorElements ), "in"_a, ReleaseGIL() );
+   m.def( "ProductTensorElements", py::overload_cast< dip::Image const& >( &dip::ProductTensorElements ), "in"_a, ReleaseGIL() );
+   m.def( "AllTensorElements", py::overload_cast< dip::Image const& >( &dip::AllTensorElements ), "in"_a, ReleaseGIL() );
+   m.def( "AnyTensorElement", py::overload_cast< dip::Image const& >( &dip::AnyTensorElement ), "in"_a, ReleaseGIL() );
+   m.def( "MaximumTensorElement", py::overload_cast< dip::Image const& >( &dip::MaximumTensorElement ), "in"_a, ReleaseGIL() );
+   m.def( "MinimumTensorElement", py::overload_cast< dip::Image const& >( &dip::MinimumTensorElement ), "in"_a, ReleaseGIL() );
+   m.def( "MeanTensorElement", py::overload_cast< dip::Image const& >( &dip::MeanTensorElement ), "in"_a, ReleaseGIL() );
 
    m.def( "Select", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const&, dip::Image const&, dip::String const& >( &dip::Select ),
-          "in1"_a , "in2"_a , "in3"_a, "in4"_a, "selector"_a );
+          "in1"_a , "in2"_a , "in3"_a, "in4"_a, "selector"_a, ReleaseGIL() );
    m.def( "Select", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const& >( &dip::Select ),
-          "in1"_a , "in2"_a , "mask"_a );
+          "in1"_a , "in2"_a , "mask"_a, ReleaseGIL() );
 }
@@ -168,7 +168,7 @@ void init_measurement( py::module& m ) {
    // dip::MeasurementTool
    mm.def( "Measure", []( dip::Image const& label, dip::Image const& grey, dip::StringArray const& features, dip::UnsignedArray const& objectIDs, dip::uint connectivity ) {
               return measurementTool.Measure( label, grey, features, objectIDs, connectivity );
-           }, "label"_a, "grey"_a = dip::Image{}, "features"_a = dip::StringArray{ "Size" }, "objectIDs"_a = dip::StringArray{}, "connectivity"_a = 0 );
+           }, "label"_a, "grey"_a = dip::Image{}, "features"_a = dip::StringArray{ "Size" }, "objectIDs"_a = dip::StringArray{}, "connectivity"_a = 0, ReleaseGIL() );
    mm.def( "Features", []() {
               auto features = measurementTool.Features();
               std::vector< std::tuple< dip::String, dip::String >> out;
@@ -180,21 +180,21 @@ void init_measurement( py::module& m ) {
                  out.emplace_back( f.name, description );
               }
               return out;
-           } );
+           }, ReleaseGIL() );
 
    // Other functions
-   m.def( "ObjectToMeasurement", py::overload_cast< dip::Image const&, dip::Measurement::IteratorFeature const& >( &dip::ObjectToMeasurement ), "label"_a, "featureValues"_a );
-   m.def( "MeasurementWriteCSV", &dip::MeasurementWriteCSV, "measurement"_a, "filename"_a, "options"_a = dip::StringSet{} );
-   m.def( "Minimum", py::overload_cast< dip::Measurement::IteratorFeature const& >( &dip::Minimum ), "featureValues"_a  );
-   m.def( "Maximum", py::overload_cast< dip::Measurement::IteratorFeature const& >( &dip::Maximum ), "featureValues"_a  );
-   m.def( "Percentile", py::overload_cast< dip::Measurement::IteratorFeature const&, dip::dfloat >( &dip::Percentile ), "featureValues"_a, "percentile"_a  );
-   m.def( "Median", py::overload_cast< dip::Measurement::IteratorFeature const& >( &dip::Median ), "featureValues"_a  );
-   m.def( "Mean", py::overload_cast< dip::Measurement::IteratorFeature const& >( &dip::Mean ), "featureValues"_a  );
+   m.def( "ObjectToMeasurement", py::overload_cast< dip::Image const&, dip::Measurement::IteratorFeature const& >( &dip::ObjectToMeasurement ), "label"_a, "featureValues"_a, ReleaseGIL() );
+   m.def( "MeasurementWriteCSV", &dip::MeasurementWriteCSV, "measurement"_a, "filename"_a, "options"_a = dip::StringSet{}, ReleaseGIL() );
+   m.def( "Minimum", py::overload_cast< dip::Measurement::IteratorFeature const& >( &dip::Minimum ), "featureValues"_a, ReleaseGIL()  );
+   m.def( "Maximum", py::overload_cast< dip::Measurement::IteratorFeature const& >( &dip::Maximum ), "featureValues"_a, ReleaseGIL()  );
+   m.def( "Percentile", py::overload_cast< dip::Measurement::IteratorFeature const&, dip::dfloat >( &dip::Percentile ), "featureValues"_a, "percentile"_a, ReleaseGIL()  );
+   m.def( "Median", py::overload_cast< dip::Measurement::IteratorFeature const& >( &dip::Median ), "featureValues"_a, ReleaseGIL()  );
+   m.def( "Mean", py::overload_cast< dip::Measurement::IteratorFeature const& >( &dip::Mean ), "featureValues"_a, ReleaseGIL()  );
    m.def( "MaximumAndMinimum", []( dip::Measurement::IteratorFeature const& featureValues ) {
              dip::MinMaxAccumulator acc = dip::MaximumAndMinimum( featureValues );
              return py::make_tuple( acc.Minimum(), acc.Maximum() ).release();
           }, "featureValues"_a );
-   m.def( "SampleStatistics", &dip::SampleStatistics, "featureValues"_a );
+   m.def( "SampleStatistics", &dip::SampleStatistics, "featureValues"_a, ReleaseGIL() );
 
    // dip::Polygon
    auto poly = py::class_< dip::Polygon >( m, "Polygon", py::buffer_protocol(), "A polygon representing a 2D object." );
@@ -254,8 +254,8 @@ void init_measurement( py::module& m ) {
    chain.def( "Offset", &dip::ChainCode::Offset );
 
    // Chain code functions
-   m.def( "GetImageChainCodes", &dip::GetImageChainCodes, "labels"_a, "objectIDs"_a = dip::UnsignedArray{}, "connectivity"_a = 2 );
-   m.def( "GetSingleChainCode", &dip::GetSingleChainCode, "labels"_a, "startCoord"_a, "connectivity"_a = 2 );
+   m.def( "GetImageChainCodes", &dip::GetImageChainCodes, "labels"_a, "objectIDs"_a = dip::UnsignedArray{}, "connectivity"_a = 2, ReleaseGIL() );
+   m.def( "GetSingleChainCode", &dip::GetSingleChainCode, "labels"_a, "startCoord"_a, "connectivity"_a = 2, ReleaseGIL() );
 
    // dip::CovarianceMatrix::EllipseParameters
    auto ellipseParams = py::class_< dip::CovarianceMatrix::EllipseParameters >( m, "EllipseParameters", "Parameters of the best fit ellipse." );
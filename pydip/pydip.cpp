@@ -172,6 +172,7 @@ PYBIND11_MODULE( PyDIP_bin, m ) {
 
    m.def( "SetNumberOfThreads", &dip::SetNumberOfThreads, "nThreads"_a );
    m.def( "GetNumberOfThreads", &dip::GetNumberOfThreads );
+   m.def_submodule( "batch", "Functions that apply the same operation to each image in a list, processing the images in parallel." );
 
    // Include definitions from all other source files
 
@@ -20,6 +20,7 @@
 #define DIP_PYDIP_H
 
 #include "diplib.h"
+#include "diplib/multithreading.h"
 
 #include <pybind11/pybind11.h>
 #include <pybind11/complex.h>
@@ -56,6 +57,58 @@ void init_analysis( py::module& m );
 void init_measurement( py::module& m );
 void init_assorted( py::module& m );
 
+// Add `ReleaseGIL()` to the arguments of `py::module::def` to release the GIL while the function runs, allowing
+// other Python threads to run in the mean time. The function must not touch any Python objects. DIPlib functions
+// don't; the only exception is the deleter of an image that wraps a Python buffer, which acquires the GIL itself.
+using ReleaseGIL = py::call_guard< py::gil_scoped_release >;
+
+// Turns a function `dip::Image f( dip::Image const&, Args... )` into one that applies it, with the same arguments,
+// to each image in a list. The images are processed in parallel, without holding the GIL. These functions are
+// bound in the `batch` submodule.
+template< typename... Args >
+auto BatchFunction( dip::Image( *function )( dip::Image const&, Args... )) {
+   return [ function ]( dip::ImageArray const& in, Args... args ) {
+      dip::ImageArray out( in.size() );
+      {
+         py::gil_scoped_release release;
+         dip::ParallelFor( in.size(), [ & ]( dip::uint ii ) {
+            out[ ii ] = function( in[ ii ], args... );
+         } );
+      }
+      return out;
+   };
+}
+
+// The `dip::ExternalInterface` for PyDIP: images forged through it store their pixels in a NumPy array that they
+// own a reference to. The array is C-ordered, which matches the normal strides of the image (NumPy's dimension order
+// is the reverse of DIPlib's, with the tensor dimension last). Allocation acquires the GIL.
+class NumPyInterface : public dip::ExternalInterface {
+   public:
+      virtual dip::DataSegment AllocateData(
+            void*& origin,
+            dip::DataType datatype,
+            dip::UnsignedArray const& sizes,
+            dip::IntegerArray& strides,
+            dip::Tensor const& tensor,
+            dip::sint& tstride
+      ) override;
+
+      // Returns an unforged image that will be forged through this interface.
+      static dip::Image NewImage() {
+         dip::Image out;
+         out.SetExternalInterface( GetInstance() );
+         return out;
+      }
+
+      static NumPyInterface* GetInstance() {
+         static NumPyInterface ei;
+         return &ei;
+      }
+
+   private:
+      NumPyInterface() = default;
+};
+
 namespace pybind11 {
 namespace detail {
 
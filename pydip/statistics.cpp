@@ -20,120 +20,124 @@
 #include "diplib/statistics.h"
 
 void init_statistics( py::module& m ) {
-   m.def( "Count", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Count ), "in"_a, "mask"_a = dip::Image{} );
-   m.def( "MaximumPixel", &dip::MaximumPixel, "in"_a, "mask"_a = dip::Image{}, "positionFlag"_a = dip::S::FIRST );
-   m.def( "MinimumPixel", &dip::MinimumPixel, "in"_a, "mask"_a = dip::Image{}, "positionFlag"_a = dip::S::FIRST );
+   m.def( "Count", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::Count ), "in"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
+   m.def( "MaximumPixel", &dip::MaximumPixel, "in"_a, "mask"_a = dip::Image{}, "positionFlag"_a = dip::S::FIRST, ReleaseGIL() );
+   m.def( "MinimumPixel", &dip::MinimumPixel, "in"_a, "mask"_a = dip::Image{}, "positionFlag"_a = dip::S::FIRST, ReleaseGIL() );
    m.def( "CumulativeSum", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::CumulativeSum ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "MaximumAndMinimum", []( dip::Image const& in, dip::Image const& mask ) {
-                dip::MinMaxAccumulator acc = dip::MaximumAndMinimum( in, mask );
+                dip::MinMaxAccumulator acc;
+                {
+                   py::gil_scoped_release release;
+                   acc = dip::MaximumAndMinimum( in, mask );
+                }
                 return py::make_tuple( acc.Minimum(), acc.Maximum() ).release();
           }, "in"_a, "mask"_a = dip::Image{} );
    m.def( "SampleStatistics", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::SampleStatistics ),
-          "in"_a, "mask"_a = dip::Image{} );
-   m.def( "Covariance", &dip::Covariance, "in1"_a, "in2"_a, "mask"_a = dip::Image{} );
-   m.def( "CenterOfMass", &dip::CenterOfMass, "in"_a, "mask"_a = dip::Image{} );
-   m.def( "Moments", &dip::Moments, "in"_a, "mask"_a = dip::Image{} );
+          "in"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
+   m.def( "Covariance", &dip::Covariance, "in1"_a, "in2"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
+   m.def( "CenterOfMass", &dip::CenterOfMass, "in"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
+   m.def( "Moments", &dip::Moments, "in"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
 
    m.def( "Mean", py::overload_cast< dip::Image const&, dip::Image const&, dip::String const&, dip::BooleanArray const& >( &dip::Mean ),
-          "in"_a, "mask"_a = dip::Image{}, "mode"_a = "", "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "mode"_a = "", "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "Sum", //py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::Sum ), // Fails to resolve!
           static_cast< dip::Image( * )( dip::Image const&, dip::Image const&, dip::BooleanArray const& ) >( &dip::Sum ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "Product", //py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::Product ), // Fails to resolve!
           static_cast< dip::Image( * )( dip::Image const&, dip::Image const&, dip::BooleanArray const& ) >( &dip::Product ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "MeanAbs", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::MeanAbs ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "SumAbs", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::SumAbs ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "MeanSquare", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::MeanSquare ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "SumSquare", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::SumSquare ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "MeanModulus", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::MeanModulus ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "SumModulus", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::SumModulus ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "MeanSquareModulus", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::MeanSquareModulus ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "SumSquareModulus", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::SumSquareModulus ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "Variance", py::overload_cast< dip::Image const&, dip::Image const&, dip::String const&, dip::BooleanArray const& >( &dip::Variance ),
-          "in"_a, "mask"_a = dip::Image{}, "mode"_a = dip::S::FAST, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "mode"_a = dip::S::FAST, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "StandardDeviation", py::overload_cast< dip::Image const&, dip::Image const&, dip::String const&, dip::BooleanArray const& >( &dip::StandardDeviation ),
-          "in"_a, "mask"_a = dip::Image{}, "mode"_a = dip::S::FAST, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "mode"_a = dip::S::FAST, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "Maximum", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::Maximum ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "Minimum", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::Minimum ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "MaximumAbs", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::MaximumAbs ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "MinimumAbs", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::MinimumAbs ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
-   m.def( "Percentile", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat, dip::BooleanArray const& >( &dip::Percentile ),
-          "in"_a, "mask"_a = dip::Image{}, "percentile"_a = 50.0, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
+   m.def( "Percentile", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat, dip::BooleanArray const&, dip::String const& >( &dip::Percentile ),
+          "in"_a, "mask"_a = dip::Image{}, "percentile"_a = 50.0, "process"_a = dip::BooleanArray{}, "mode"_a = dip::S::EXACT, ReleaseGIL() );
    m.def( "Median", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::Median ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "All", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::All ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
    m.def( "Any", py::overload_cast< dip::Image const&, dip::Image const&, dip::BooleanArray const& >( &dip::Any ),
-          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "process"_a = dip::BooleanArray{}, ReleaseGIL() );
 
    m.def( "PositionMaximum", py::overload_cast< dip::Image const&, dip::Image const&, dip::uint, dip::String const& >( &dip::PositionMaximum ),
-          "in"_a, "mask"_a = dip::Image{}, "dim"_a = 0, "mode"_a = dip::S::FIRST );
+          "in"_a, "mask"_a = dip::Image{}, "dim"_a = 0, "mode"_a = dip::S::FIRST, ReleaseGIL() );
    m.def( "PositionMinimum", py::overload_cast< dip::Image const&, dip::Image const&, dip::uint, dip::String const& >( &dip::PositionMinimum ),
-          "in"_a, "mask"_a = dip::Image{}, "dim"_a = 0, "mode"_a = dip::S::FIRST );
+          "in"_a, "mask"_a = dip::Image{}, "dim"_a = 0, "mode"_a = dip::S::FIRST, ReleaseGIL() );
    m.def( "PositionPercentile", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat, dip::uint, dip::String const& >( &dip::PositionPercentile ),
-          "in"_a, "mask"_a = dip::Image{}, "percentile"_a = 50, "dim"_a = 0, "mode"_a = dip::S::FIRST );
+          "in"_a, "mask"_a = dip::Image{}, "percentile"_a = 50, "dim"_a = 0, "mode"_a = dip::S::FIRST, ReleaseGIL() );
    m.def( "PositionMedian", py::overload_cast< dip::Image const&, dip::Image const&, dip::uint, dip::String const& >( &dip::PositionMedian ),
-          "in"_a, "mask"_a = dip::Image{}, "dim"_a = 0, "mode"_a = dip::S::FIRST );
+          "in"_a, "mask"_a = dip::Image{}, "dim"_a = 0, "mode"_a = dip::S::FIRST, ReleaseGIL() );
 
    m.def( "RadialSum", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat, dip::String const&, dip::FloatArray const& >( &dip::RadialSum ),
-          "in"_a, "mask"_a = dip::Image{}, "binSize"_a = 1, "maxRadius"_a = dip::S::OUTERRADIUS, "center"_a = dip::FloatArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "binSize"_a = 1, "maxRadius"_a = dip::S::OUTERRADIUS, "center"_a = dip::FloatArray{}, ReleaseGIL() );
    m.def( "RadialMean", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat, dip::String const&, dip::FloatArray const& >( &dip::RadialMean ),
-          "in"_a, "mask"_a = dip::Image{}, "binSize"_a = 1, "maxRadius"_a = dip::S::OUTERRADIUS, "center"_a = dip::FloatArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "binSize"_a = 1, "maxRadius"_a = dip::S::OUTERRADIUS, "center"_a = dip::FloatArray{}, ReleaseGIL() );
    m.def( "RadialMinimum", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat, dip::String const&, dip::FloatArray const& >( &dip::RadialMinimum ),
-          "in"_a, "mask"_a = dip::Image{}, "binSize"_a = 1, "maxRadius"_a = dip::S::OUTERRADIUS, "center"_a = dip::FloatArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "binSize"_a = 1, "maxRadius"_a = dip::S::OUTERRADIUS, "center"_a = dip::FloatArray{}, ReleaseGIL() );
    m.def( "RadialMaximum", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat, dip::String const&, dip::FloatArray const& >( &dip::RadialMaximum ),
-          "in"_a, "mask"_a = dip::Image{}, "binSize"_a = 1, "maxRadius"_a = dip::S::OUTERRADIUS, "center"_a = dip::FloatArray{} );
+          "in"_a, "mask"_a = dip::Image{}, "binSize"_a = 1, "maxRadius"_a = dip::S::OUTERRADIUS, "center"_a = dip::FloatArray{}, ReleaseGIL() );
 
    m.def( "MeanError", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const& >( &dip::MeanError ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{} );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "MeanSquareError", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const& >( &dip::MeanSquareError ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{} );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "RootMeanSquareError", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const& >( &dip::RootMeanSquareError ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{} );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "MeanAbsoluteError", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const& >( &dip::MeanAbsoluteError ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{} );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "MaximumAbsoluteError", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const& >( &dip::MaximumAbsoluteError ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{} );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "IDivergence", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const& >( &dip::IDivergence ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{} );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "InProduct", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const& >( &dip::InProduct ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{} );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "LnNormError", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const&, dip::dfloat >( &dip::LnNormError ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, "order"_a = 2.0 );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, "order"_a = 2.0, ReleaseGIL() );
    m.def( "PSNR", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const&, dip::dfloat >( &dip::PSNR ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, "peakSignal"_a = 0.0 );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, "peakSignal"_a = 0.0, ReleaseGIL() );
    m.def( "SSIM", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const&, dip::dfloat, dip::dfloat, dip::dfloat >( &dip::SSIM ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, "sigma"_a = 1.5, "K1"_a = 0.01, "K2"_a = 0.03 );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, "sigma"_a = 1.5, "K1"_a = 0.01, "K2"_a = 0.03, ReleaseGIL() );
    m.def( "MutualInformation", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const&, dip::uint >( &dip::MutualInformation ),
-          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, "nBins"_a = 256 );
+          "in1"_a, "in2"_a, "mask"_a = dip::Image{}, "nBins"_a = 256, ReleaseGIL() );
 
-   m.def( "SpatialOverlap", &dip::SpatialOverlap, "in"_a, "reference"_a ); // TODO: return type?
-   m.def( "DiceCoefficient", &dip::DiceCoefficient, "in"_a, "reference"_a );
-   m.def( "JaccardIndex", &dip::JaccardIndex, "in"_a, "reference"_a );
-   m.def( "Specificity", &dip::Specificity, "in"_a, "reference"_a );
-   m.def( "Sensitivity", &dip::Sensitivity, "in"_a, "reference"_a );
-   m.def( "Accuracy", &dip::Accuracy, "in"_a, "reference"_a );
-   m.def( "Precision", &dip::Precision, "in"_a, "reference"_a );
-   m.def( "HausdorffDistance", &dip::HausdorffDistance, "in"_a, "reference"_a );
+   m.def( "SpatialOverlap", &dip::SpatialOverlap, "in"_a, "reference"_a, ReleaseGIL() );
+   m.def( "DiceCoefficient", &dip::DiceCoefficient, "in"_a, "reference"_a, ReleaseGIL() );
+   m.def( "JaccardIndex", &dip::JaccardIndex, "in"_a, "reference"_a, ReleaseGIL() );
+   m.def( "Specificity", &dip::Specificity, "in"_a, "reference"_a, ReleaseGIL() );
+   m.def( "Sensitivity", &dip::Sensitivity, "in"_a, "reference"_a, ReleaseGIL() );
+   m.def( "Accuracy", &dip::Accuracy, "in"_a, "reference"_a, ReleaseGIL() );
+   m.def( "Precision", &dip::Precision, "in"_a, "reference"_a, ReleaseGIL() );
+   m.def( "HausdorffDistance", &dip::HausdorffDistance, "in"_a, "reference"_a, ReleaseGIL() );
 
    m.def( "Entropy", py::overload_cast< dip::Image const&, dip::Image const&, dip::uint >( &dip::Entropy ),
-          "in"_a, "mask"_a = dip::Image{}, "nBins"_a = 256 );
+          "in"_a, "mask"_a = dip::Image{}, "nBins"_a = 256, ReleaseGIL() );
    m.def( "EstimateNoiseVariance", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::EstimateNoiseVariance ),
-          "in"_a, "mask"_a = dip::Image{} );
+          "in"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
 
    // dip::StatisticsAccumulator
    auto statsAcc = py::class_< dip::StatisticsAccumulator >( m, "StatisticsValues", "Statistics values." );
@@ -0,0 +1,159 @@
+# PyDIP 3.0, Python bindings for DIPlib 3.0
+#
+# (c)2018, Flagship Biosciences, Inc., written by Cris Luengo.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for the conversion between NumPy arrays and images: which buffers are used without copying, which are
+copied and to what data type, and the images created through the NumPy external interface."""
+
+import sys
+import threading
+import unittest
+
+import numpy as np
+import PyDIP as dip
+
+
+class TestBufferToImage(unittest.TestCase):
+
+    def assertConverted(self, arr, dataType, shared):
+        img = dip.Image(arr)
+        self.assertEqual(img.DataType(), dataType)
+        self.assertEqual(img.Sizes(), list(reversed(arr.shape)))
+        out = np.asarray(img)
+        self.assertEqual(np.shares_memory(out, arr), shared)
+        np.testing.assert_array_equal(out, arr)
+        return img
+
+    def test_native_types_are_shared(self):
+        for dtype, dataType in [(np.bool_, 'BIN'), (np.uint8, 'UINT8'), (np.uint16, 'UINT16'),
+                                (np.uint32, 'UINT32'), (np.int8, 'SINT8'), (np.int16, 'SINT16'),
+                                (np.int32, 'SINT32'), (np.float32, 'SFLOAT'), (np.float64, 'DFLOAT'),
+                                (np.complex64, 'SCOMPLEX'), (np.complex128, 'DCOMPLEX')]:
+            with self.subTest(dtype=dtype):
+                self.assertConverted(np.arange(12).reshape(3, 4).astype(dtype), dataType, True)
+
+    def test_int64_in_range(self):
+        arr = np.array([[0, 1, -5], [2 ** 31 - 1, -2 ** 31, 7]], dtype=np.int64)
+        self.assertConverted(arr, 'SINT32', False)
+        arr = np.array([[0, 1, 5], [2 ** 32 - 1, 2 ** 31, 7]], dtype=np.uint64)
+        self.assertConverted(arr, 'UINT32', False)
+
+    def test_int64_out_of_range(self):
+        for arr in [np.array([[0, 2 ** 31]], dtype=np.int64),
+                    np.array([[-2 ** 31 - 1, 0]], dtype=np.int64),
+                    np.array([[0, 2 ** 32]], dtype=np.uint64)]:
+            with self.subTest(arr=arr):
+                with self.assertRaisesRegex(RuntimeError, "64-bit integers that do not fit"):
+                    dip.Image(arr)
+
+    def test_big_endian(self):
+        native = np.arange(-6, 6).reshape(3, 4)
+        self.assertConverted(native.astype('>i2'), 'SINT16', sys.byteorder == 'big')
+        self.assertConverted(native.astype('>f4'), 'SFLOAT', sys.byteorder == 'big')
+        self.assertConverted(native.astype('>f8'), 'DFLOAT', sys.byteorder == 'big')
+        self.assertConverted(native.astype('<f4'), 'SFLOAT', sys.byteorder == 'little')
+
+    def test_half_float(self):
+        arr = (np.arange(12).reshape(3, 4) / 4).astype(np.float16)
+        self.assertConverted(arr, 'SFLOAT', False)
+
+    def test_negative_strides(self):
+        base = np.arange(48, dtype=np.float32).reshape(6, 8)
+        arr = base[::-1, ::-2]
+        img = self.assertConverted(arr, 'SFLOAT', True)
+        self.assertEqual(img.Strides(), [-2, -8])
+        base[5, 7] = -1  # the first pixel of the image
+        self.assertEqual(img.At(0, 0)[0], -1)
+
+    def test_strides_not_whole_samples(self):
+        raw = np.zeros(64, dtype=np.uint8)
+        arr = np.ndarray((3, 4), dtype=np.float32, buffer=raw, strides=(17, 4))
+        arr[...] = np.arange(12).reshape(3, 4)
+        img = self.assertConverted(arr, 'SFLOAT', False)
+        self.assertEqual(img.Strides(), [1, 4])
+
+    def test_tensor_dimension(self):
+        arr = np.zeros((10, 12, 3), dtype=np.uint8)
+        img = dip.Image(arr)
+        self.assertEqual(img.Sizes(), [12, 10])
+        self.assertEqual(img.TensorElements(), 3)
+        self.assertTrue(np.shares_memory(np.asarray(img), arr))
+
+
+class TestCopyOnConversion(unittest.TestCase):
+
+    def setUp(self):
+        self.assertTrue(dip.GetCopyOnConversion())
+        dip.SetCopyOnConversion(False)
+
+    def tearDown(self):
+        dip.SetCopyOnConversion(True)
+
+    def test_copy_disabled(self):
+        self.assertFalse(dip.GetCopyOnConversion())
+        raw = np.zeros(64, dtype=np.uint8)
+        for arr in [np.zeros((3, 4), dtype=np.int64),
+                    np.zeros((3, 4), dtype=np.float16),
+                    np.zeros((3, 4), dtype='>f4' if sys.byteorder == 'little' else '<f4'),
+                    np.ndarray((3, 4), dtype=np.float32, buffer=raw, strides=(17, 4))]:
+            with self.subTest(dtype=arr.dtype, strides=arr.strides):
+                with self.assertRaisesRegex(RuntimeError, "copying is disabled"):
+                    dip.Image(arr)
+                # A failed implicit conversion makes the function not match its arguments
+                with self.assertRaises(TypeError):
+                    dip.Gauss(arr, [1.0])
+
+    def test_no_copy_needed(self):
+        arr = np.arange(48, dtype=np.float32).reshape(6, 8)[::-1, ::2]
+        img = dip.Image(arr)
+        self.assertTrue(np.shares_memory(np.asarray(img), arr))
+        self.assertEqual(dip.Gauss(arr, [1.0]).DataType(), 'SFLOAT')
+
+    def test_process_wide(self):
+        values = []
+        thread = threading.Thread(target=lambda: values.append(dip.GetCopyOnConversion()))
+        thread.start()
+        thread.join()
+        self.assertEqual(values, [False])
+
+
+class TestNumPyInterface(unittest.TestCase):
+
+    def test_new_image(self):
+        for dataType, dtype in [('BIN', np.bool_), ('UINT8', np.uint8), ('SINT32', np.int32),
+                                ('SFLOAT', np.float32), ('DCOMPLEX', np.complex128)]:
+            with self.subTest(dataType=dataType):
+                img = dip.Image([5, 3], 2, dataType)
+                arr = np.asarray(img)
+                self.assertEqual(arr.dtype, dtype)
+                self.assertEqual(arr.shape, (3, 5, 2))
+                self.assertTrue(arr.flags['C_CONTIGUOUS'])
+                self.assertIsNotNone(arr.base)
+
+    def test_array_outlives_image(self):
+        img = dip.Image([4, 4], 1, 'SFLOAT')
+        img.Fill(3)
+        arr = np.asarray(img)
+        del img
+        np.testing.assert_array_equal(arr, np.full((4, 4), 3, dtype=np.float32))
+
+    def test_output_of_filter(self):
+        arr = np.asarray(dip.Gauss(np.ones((20, 30), dtype=np.float32), [1.0]))
+        self.assertEqual(arr.shape, (20, 30))
+        np.testing.assert_allclose(arr, 1, rtol=1e-6)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,130 @@
+# PyDIP 3.0, Python bindings for DIPlib 3.0
+#
+# (c)2018, Flagship Biosciences, Inc., written by Cris Luengo.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for calling PyDIP from multiple Python threads: functions that release the GIL, the deleters of images
+that reference Python objects, and the `batch` submodule."""
+
+import concurrent.futures
+import sys
+import threading
+import time
+import unittest
+
+import numpy as np
+import PyDIP as dip
+
+
+def RandomImages(count, shape, dtype=np.float32):
+    rng = np.random.default_rng(0)
+    return [(rng.random(shape) * 255).astype(dtype) for _ in range(count)]
+
+
+class TestReleaseGIL(unittest.TestCase):
+
+    def setUp(self):
+        self.switchInterval = sys.getswitchinterval()
+
+    def tearDown(self):
+        sys.setswitchinterval(self.switchInterval)
+
+    def test_other_threads_run_during_call(self):
+        # With a long switch interval, the interpreter doesn't preempt the worker thread: the main thread can only
+        # run while the worker is inside a call if that call released the GIL.
+        sys.setswitchinterval(10)
+        image = RandomImages(1, (512, 512))[0]
+        inCall = [False]
+
+        def Worker():
+            for _ in range(20):
+                inCall[0] = True
+                dip.Gauss(image, [4.0])
+                inCall[0] = False
+
+        worker = threading.Thread(target=Worker)
+        worker.start()
+        observed = False
+        while worker.is_alive():
+            if inCall[0]:
+                observed = True
+            time.sleep(0.001)
+        worker.join()
+        self.assertTrue(observed)
+
+    def test_concurrent_calls(self):
+        images = RandomImages(8, (200, 300))
+        expected = [np.asarray(dip.Gauss(img, [2.0])) for img in images]
+        with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+            results = list(executor.map(lambda img: np.asarray(dip.Gauss(img, [2.0])), images))
+        for res, exp in zip(results, expected):
+            np.testing.assert_array_equal(res, exp)
+
+    def test_buffer_references_released(self):
+        # Each call wraps the NumPy arrays in images that hold a reference to them; these references must be
+        # released again, also for arrays that are copied on conversion (float16, big-endian)
+        images = RandomImages(4, (100, 100)) + RandomImages(2, (100, 100), np.float16) + \
+                 [img.astype('>f4') for img in RandomImages(2, (100, 100))]
+        counts = [sys.getrefcount(img) for img in images]
+        with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+            results = list(executor.map(lambda img: dip.Gauss(img, [1.0]), images * 4))
+        del results
+        self.assertEqual([sys.getrefcount(img) for img in images], counts)
+
+    def test_output_reforged_without_gil(self):
+        # `IncoherentPSF` reforges its output image while the GIL is released: the image releases its reference
+        # to the NumPy array it wrapped, and allocates a new NumPy array through the external interface; both
+        # acquire the GIL
+        arrays = [np.zeros((5, 5), dtype=np.uint8) for _ in range(8)]
+        counts = [sys.getrefcount(arr) for arr in arrays]
+        images = [dip.Image(arr) for arr in arrays]
+        images += [dip.Image([7, 7], 1, 'UINT8') for _ in range(8)]
+        with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+            list(executor.map(dip.IncoherentPSF, images))
+        self.assertEqual([sys.getrefcount(arr) for arr in arrays], counts)
+        for img in images:
+            expected = dip.Image(img.Sizes(), 1, 'SFLOAT')
+            dip.IncoherentPSF(expected)
+            self.assertEqual(img.DataType(), 'SFLOAT')
+            np.testing.assert_array_equal(np.asarray(img), np.asarray(expected))
+
+
+class TestBatch(unittest.TestCase):
+
+    def test_gauss(self):
+        images = RandomImages(6, (120, 80))
+        out = dip.batch.Gauss(images, [1.5])
+        self.assertIsInstance(out, list)
+        self.assertEqual(len(out), len(images))
+        for res, img in zip(out, images):
+            np.testing.assert_array_equal(np.asarray(res), np.asarray(dip.Gauss(img, [1.5])))
+
+    def test_gauss_from_threads(self):
+        images = RandomImages(5, (64, 64)) + RandomImages(3, (64, 64), np.float16)
+        counts = [sys.getrefcount(img) for img in images]
+        expected = [np.asarray(res) for res in dip.batch.Gauss(images, [2.0])]
+        with concurrent.futures.ThreadPoolExecutor(max_workers=3) as executor:
+            results = list(executor.map(lambda _: dip.batch.Gauss(images, [2.0]), range(6)))
+        for out in results:
+            for res, exp in zip(out, expected):
+                np.testing.assert_array_equal(np.asarray(res), exp)
+        del results
+        self.assertEqual([sys.getrefcount(img) for img in images], counts)
+
+    def test_empty_list(self):
+        self.assertEqual(dip.batch.Gauss([], [1.0]), [])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -25,6 +25,7 @@ set(DIPlib_sources_bogus
 ../include/diplib/kernel.h
 ../include/diplib/library/clamp_cast.h
 ../include/diplib/library/copy_buffer.h
+../include/diplib/library/cpu_dispatch.h
 ../include/diplib/library/datatype.h
 ../include/diplib/library/dimension_array.h
 ../include/diplib/library/error.h
@@ -49,6 +50,7 @@ set(DIPlib_sources_bogus
 ../include/diplib/neighborlist.h
 ../include/diplib/nonlinear.h
 ../include/diplib/overload.h
+../include/diplib/packed_binary.h
 ../include/diplib/pixel_table.h
 ../include/diplib/private/constfor.h
 ../include/diplib/private/monadic_operators.h
@@ -78,6 +80,7 @@ binary/binary_support.cpp
 binary/binary_support.h
 binary/bucket.h
 binary/count_neighbors.cpp
+binary/packed_binary.cpp
 binary/skeleton.cpp
 binary/sup_inf_generator.cpp
 binary/thick_thin_2D.cpp
@@ -110,6 +113,7 @@ generation/noise.cpp
 generation/windowing.cpp
 geometry/interpolation.cpp
 geometry/interpolation.h
+geometry/pyramid.cpp
 geometry/resampleat.cpp
 geometry/tile.cpp
 geometry/wrap.cpp
@@ -121,11 +125,13 @@ histogram/statistics.cpp
 histogram/threshold_algorithms.cpp
 library/boundary.cpp
 library/copy_buffer.cpp
+library/cpu_dispatch.cpp
 library/datatype.cpp
 library/framework.cpp
 library/framework_full.cpp
 library/framework_scan.cpp
 library/framework_separable.cpp
+library/framework_support.h
 library/image.cpp
 library/image_copy.cpp
 library/image_data.cpp
@@ -138,11 +144,13 @@ library/multithreading.cpp
 library/neighborhood.cpp
 library/physical_dimensions.cpp
 library/pixel_table.cpp
+library/threading_calibration.cpp
 library/types.cpp
 library/unit_tests.cpp
 linear/convolution.cpp
 linear/derivative.cpp
 linear/finitediff.cpp
+linear/fourier_filter_bank.cpp
 linear/gabor.cpp
 linear/gaboriir.cpp
 linear/gauss.cpp
@@ -156,6 +164,7 @@ mapping/mapping.cpp
 math/arithmetic.cpp
 math/bitwise.cpp
 math/comparison.cpp
+math/dispatched_line_filter.h
 math/dyadic_operators.cpp
 math/error.cpp
 math/monadic_operators.cpp
@@ -235,10 +244,13 @@ nonlinear/bilateral.cpp
 nonlinear/kuwahara.cpp
 nonlinear/nonmaximumsuppression.cpp
 nonlinear/percentile.cpp
+nonlinear/summed_area_table.cpp
+nonlinear/summed_area_table.h
 nonlinear/variancefilter.cpp
 regions/grow_regions.cpp
 regions/label.cpp
 regions/label_manipulation.cpp
+regions/label_map.h
 regions/labelingGrana2016.h
 segmentation/canny.cpp
 segmentation/kmeans_clustering.cpp
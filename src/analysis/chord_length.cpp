@@ -24,20 +24,15 @@
 #include "diplib/analysis.h"
 #include "diplib/regions.h"
 #include "diplib/generic_iterators.h"
+#include "diplib/multithreading.h"
 #include "diplib/overload.h"
 #include "diplib/random.h"
+#include "sampling_support.h"
 
 namespace dip {
 
 namespace {
 
-using UIntPixelValueReaderFunction = dip::uint ( * )( void const* );
-
-template< typename TPI >
-static dip::uint UIntPixelValueReader( void const* data ) {
-   return static_cast< dip::uint >( *static_cast< TPI const* >( data ));
-}
-
 using PhaseLookupTable = std::unordered_map< dip::uint, dip::uint >;
 
 void UpdateDistribution(
@@ -50,12 +45,17 @@ void UpdateDistribution(
 ) {
    if(( length > 0 ) && ( length - 1 < distribution.Size() )) {
       // We are interested in the phase of the points
-      dip::uint index = phaseLookupTable.at( phase );
-      distribution[ length - 1 ].Y( index ) += 1.0;
-      ++( counts[ index ] );
+      auto it = phaseLookupTable.find( phase );
+      if( it != phaseLookupTable.end() ) { // Chords outside the mask can have a phase not in the table
+         dip::uint index = it->second;
+         distribution[ length - 1 ].Y( index ) += 1.0;
+         ++( counts[ index ] );
+      }
    }
 }
 
+// The probes are divided into chunks, each chunk using its own random stream (see `NumberOfRandomSamplingChunks`).
+template< typename TPI >
 void RandomPixelPairSampler(
       Image const& object,
       Image const& mask,
@@ -64,120 +64,134 @@ void RandomPixelPairSampler(
       PhaseLookupTable const& phaseLookupTable,
       dip::uint nProbes
 ) {
-   UIntPixelValueReaderFunction GetUIntPixelValue;
-   DIP_OVL_ASSIGN_UINT( GetUIntPixelValue, UIntPixelValueReader, object.DataType() );
    bool hasMask = mask.IsForged();
-   Random random( 0 );
-   UniformRandomGenerator uniformRandomGenerator( random );
-   GaussianRandomGenerator normalRandomGenerator( random );
    dip::uint nDims = object.Dimensionality();
    UnsignedArray const& sizes = object.Sizes();
+   TPI const* data = static_cast< TPI const* >( object.Origin() );
+   IntegerArray const& strides = object.Strides();
+   bin const* maskData = hasMask ? static_cast< bin const* >( mask.Origin() ) : nullptr;
+   IntegerArray maskStrides = hasMask ? mask.Strides() : IntegerArray{};
    FloatArray maxpos{ sizes };   // upper limit for coordinates
    maxpos -= 1;
-   FloatArray origin( nDims );
-   FloatArray direction( nDims, 1 );
-   UnsignedArray pointInt( nDims );
-   FloatArray pointFloat( nDims );
-   for( dip::uint probe = 0; probe < nProbes; ++probe ) { // TODO: trivially parallelizable.
-      // A point
-      for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         origin[ ii ] = uniformRandomGenerator( 0, maxpos[ ii ] );
-      }
-      // A direction
-      if( nDims == 2 ) {
-         // This is the easy case
-         dfloat phi = uniformRandomGenerator( 0, 2 * pi );
-         direction[ 0 ] = cos( phi );
-         direction[ 1 ] = sin( phi );
-      } else if( nDims == 3 ) {
-         // https://math.stackexchange.com/a/44691/414894
-         // http://mathworld.wolfram.com/SpherePointPicking.html
-         dfloat phi = uniformRandomGenerator( 0, 2 * pi );
-         dfloat z = uniformRandomGenerator( -1, 1 );
-         dfloat u = std::sqrt( 1 - z * z );
-         direction[ 0 ] = u * cos( phi );
-         direction[ 1 ] = u * sin( phi );
-         direction[ 2 ] = z;
-      } else if( nDims > 3 ) {
-         // Pick a normally distributed point and normalize
-         dfloat norm = 0;
-         do {
+   dip::uint nChunks = NumberOfRandomSamplingChunks( nProbes, sizes.maximum_value() );
+   std::vector< Random > randomStreams = RandomSamplingStreams( nChunks );
+   std::vector< Distribution > distributions( nChunks, distribution ); // one for each chunk
+   std::vector< std::vector< dip::uint >> countsArray( nChunks, counts );
+   ParallelFor( nChunks, [ & ]( dip::uint chunk ) {
+      UniformRandomGenerator uniformRandomGenerator( randomStreams[ chunk ] );
+      GaussianRandomGenerator normalRandomGenerator( randomStreams[ chunk ] );
+      Distribution& chunkDistribution = distributions[ chunk ];
+      std::vector< dip::uint >& chunkCounts = countsArray[ chunk ];
+      FloatArray origin( nDims );
+      FloatArray direction( nDims, 1 );
+      UnsignedArray pointInt( nDims );
+      FloatArray pointFloat( nDims );
+      dip::uint firstProbe = nProbes * chunk / nChunks;
+      dip::uint lastProbe = nProbes * ( chunk + 1 ) / nChunks;
+      for( dip::uint probe = firstProbe; probe < lastProbe; ++probe ) {
+         // A point
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            origin[ ii ] = uniformRandomGenerator( 0, maxpos[ ii ] );
+         }
+         // A direction
+         if( nDims == 2 ) {
+            // This is the easy case
+            dfloat phi = uniformRandomGenerator( 0, 2 * pi );
+            direction[ 0 ] = cos( phi );
+            direction[ 1 ] = sin( phi );
+         } else if( nDims == 3 ) {
+            // https://math.stackexchange.com/a/44691/414894
+            // http://mathworld.wolfram.com/SpherePointPicking.html
+            dfloat phi = uniformRandomGenerator( 0, 2 * pi );
+            dfloat z = uniformRandomGenerator( -1, 1 );
+            dfloat u = std::sqrt( 1 - z * z );
+            direction[ 0 ] = u * cos( phi );
+            direction[ 1 ] = u * sin( phi );
+            direction[ 2 ] = z;
+         } else if( nDims > 3 ) {
+            // Pick a normally distributed point and normalize
+            dfloat norm = 0;
+            do {
+               for( dip::uint ii = 0; ii < nDims; ++ii ) {
+                  direction[ ii ] = normalRandomGenerator( 0, 1 );
+                  norm += direction[ ii ] * direction[ ii ];
+               }
+            } while( norm == 0 ); // highly unlikely, but we need to do this anway
+            norm = std::sqrt( norm );
             for( dip::uint ii = 0; ii < nDims; ++ii ) {
-               direction[ ii ] = normalRandomGenerator( 0, 1 );
-               norm += direction[ ii ] * direction[ ii ];
+               direction[ ii ] /= norm;
             }
-         } while( norm == 0 ); // highly unlikely, but we need to do this anway
-         norm = std::sqrt( norm );
+         } // else : ( nDims == 1 ) : direction is always 1
+         // Given a point and a direction, find the two points where this line crosses the image boundary
+         bool first = true;
+         dfloat distanceBegin = 0;
+         dfloat distanceEnd = 0;
          for( dip::uint ii = 0; ii < nDims; ++ii ) {
-            direction[ ii ] /= norm;
-         }
-      } // else : ( nDims == 1 ) : direction is always 1
-      // Given a point and a direction, find the two points where this line crosses the image boundary
-      bool first = true;
-      dfloat distanceBegin = 0;
-      dfloat distanceEnd = 0;
-      for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         // We're sure at least one direction[ii] is not zero
-         if( direction[ ii ] != 0 ) {
-            dfloat distB, distE;
-            if( direction[ ii ] > 0 ) {
-               distB = ( origin[ ii ] ) / direction[ ii ];
-               distE = ( maxpos[ ii ] - origin[ ii ] ) / direction[ ii ];
-            } else {
-               distB = ( maxpos[ ii ] - origin[ ii ] ) / -direction[ ii ];
-               distE = ( -origin[ ii ] ) / direction[ ii ];
+            // We're sure at least one direction[ii] is not zero
+            if( direction[ ii ] != 0 ) {
+               dfloat distB, distE;
+               if( direction[ ii ] > 0 ) {
+                  distB = ( origin[ ii ] ) / direction[ ii ];
+                  distE = ( maxpos[ ii ] - origin[ ii ] ) / direction[ ii ];
+               } else {
+                  distB = ( maxpos[ ii ] - origin[ ii ] ) / -direction[ ii ];
+                  distE = ( -origin[ ii ] ) / direction[ ii ];
+               }
+               distanceBegin = first ? distB : std::min( distB, distanceBegin );
+               distanceEnd = first ? distE : std::min( distE, distanceEnd );
+               first = false;
             }
-            distanceBegin = first ? distB : std::min( distB, distanceBegin );
-            distanceEnd = first ? distE : std::min( distE, distanceEnd );
-            first = false;
          }
-      }
-      dfloat totalLength = 0.0;
-      for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         double end = origin[ ii ] + direction[ ii ] * distanceEnd;
-         double begin = origin[ ii ] - direction[ ii ] * distanceBegin;
-         DIP_ASSERT( end >= -0.499 );
-         DIP_ASSERT( end <= maxpos[ ii ] + 0.499 );
-         DIP_ASSERT( begin >= -0.499 );
-         DIP_ASSERT( begin <= maxpos[ ii ] + 0.499 );
-         pointFloat[ ii ] = begin;
-         pointInt[ ii ] = static_cast< dip::uint >( std::round( begin ));
-         dfloat dist = end - begin;
-         totalLength += dist * dist;
-      }
-      totalLength = sqrt( totalLength );
-      dip::uint totalLengthInt = static_cast< dip::uint >( totalLength );
-      // Walk along this line and find phase changes
-      dip::uint d1 = GetUIntPixelValue( object.Pointer( pointInt ));
-      bin m1 = hasMask ? *static_cast< bin const* >( mask.Pointer( pointInt )) : bin( true );
-      dip::uint d2 = d1;
-      bin m2 = m1;
-      dip::uint length = 0;
-      for( dip::uint rr = 0; rr < totalLengthInt; ++rr ) {
-         // We want to measure the len of the line in the same phase, in the same object
-         if( d2 == d1 && m2 == m1 ) {
-            ++length;
-         } else {
-            UpdateDistribution( distribution, counts, phaseLookupTable, d2, length );
-            // Only count chord length inside a masked area
-            length = ( m1 ? 1 : 0 );
-         }
-         // Update to the next point on the line by adding direction to pointFloat and rounding it to nearest integer point
-         d2 = d1;
-         m2 = m1;
+         dfloat totalLength = 0.0;
          for( dip::uint ii = 0; ii < nDims; ++ii ) {
-            pointFloat[ ii ] += direction[ ii ];
-            DIP_ASSERT( pointFloat[ ii ] >= -0.499 );
-            DIP_ASSERT( pointFloat[ ii ] <= maxpos[ ii ] + 0.499 );
-            pointInt[ ii ] = static_cast< dip::uint >( std::round( pointFloat[ ii ] ));
+            double end = origin[ ii ] + direction[ ii ] * distanceEnd;
+            double begin = origin[ ii ] - direction[ ii ] * distanceBegin;
+            DIP_ASSERT( end >= -0.499 );
+            DIP_ASSERT( end <= maxpos[ ii ] + 0.499 );
+            DIP_ASSERT( begin >= -0.499 );
+            DIP_ASSERT( begin <= maxpos[ ii ] + 0.499 );
+            pointFloat[ ii ] = begin;
+            pointInt[ ii ] = static_cast< dip::uint >( std::round( begin ));
+            dfloat dist = end - begin;
+            totalLength += dist * dist;
          }
-         d1 = GetUIntPixelValue( object.Pointer( pointInt ));
-         m1 = hasMask ? *static_cast< bin const* >( mask.Pointer( pointInt )) : bin( true );
+         totalLength = sqrt( totalLength );
+         dip::uint totalLengthInt = static_cast< dip::uint >( totalLength );
+         // Walk along this line and find phase changes
+         dip::uint d1 = static_cast< dip::uint >( data[ Offset( pointInt, strides ) ] );
+         bin m1 = hasMask ? maskData[ Offset( pointInt, maskStrides ) ] : bin( true );
+         dip::uint d2 = d1;
+         bin m2 = m1;
+         dip::uint length = 0;
+         for( dip::uint rr = 0; rr < totalLengthInt; ++rr ) {
+            // We want to measure the len of the line in the same phase, in the same object
+            if( d2 == d1 && m2 == m1 ) {
+               ++length;
+            } else {
+               UpdateDistribution( chunkDistribution, chunkCounts, phaseLookupTable, d2, length );
+               // Only count chord length inside a masked area
+               length = ( m1 ? 1 : 0 );
+            }
+            // Update to the next point on the line by adding direction to pointFloat and rounding it to nearest integer point
+            d2 = d1;
+            m2 = m1;
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               pointFloat[ ii ] += direction[ ii ];
+               DIP_ASSERT( pointFloat[ ii ] >= -0.499 );
+               DIP_ASSERT( pointFloat[ ii ] <= maxpos[ ii ] + 0.499 );
+               pointInt[ ii ] = static_cast< dip::uint >( std::round( pointFloat[ ii ] ));
+            }
+            d1 = static_cast< dip::uint >( data[ Offset( pointInt, strides ) ] );
+            m1 = hasMask ? maskData[ Offset( pointInt, maskStrides ) ] : bin( true );
+         }
+         UpdateDistribution( chunkDistribution, chunkCounts, phaseLookupTable, d2, length );
       }
-      UpdateDistribution( distribution, counts, phaseLookupTable, d2, length );
-   }
+   } );
+   MergePartialResults( distribution, counts, distributions, countsArray );
 }
 
+// The grid lines along each dimension are divided over the threads.
+template< typename TPI >
 void GridPixelPairSampler(
       Image const& object,
       Image const& mask,
@@ -186,8 +200,6 @@ void GridPixelPairSampler(
       PhaseLookupTable const& phaseLookupTable,
       dip::uint nProbes
 ) {
-   UIntPixelValueReaderFunction GetUIntPixelValue;
-   DIP_OVL_ASSIGN_UINT( GetUIntPixelValue, UIntPixelValueReader, object.DataType() );
    bool hasMask = mask.IsForged();
    dip::uint nDims = object.Dimensionality();
    UnsignedArray coords( nDims );
@@ -202,44 +214,83 @@ void GridPixelPairSampler(
       step = div_floor( nLines, nProbes );
       step = std::max< dip::uint >( step, 1 ); // step must be at least 1.
    }
+   dip::uint nThreads = 1;
+   if( object.Sizes().product() * nDims / step >= threadingThreshold ) {
+      nThreads = GetNumberOfThreads();
+   }
+   std::vector< Distribution > distributions( nThreads, distribution ); // one for each thread
+   std::vector< std::vector< dip::uint >> countsArray( nThreads, counts );
    // Iterate over image dimensions
    for( dip::uint dim = 0; dim < nDims; ++dim ) {
       GenericJointImageIterator< 2 > it( { object, mask }, dim );
       dip::uint size = it.ProcessingDimensionSize();
-      dip::sint dataStride = it.ProcessingDimensionStride< 0 >() * static_cast< dip::sint >( object.DataType().SizeOf() );
+      dip::sint dataStride = it.ProcessingDimensionStride< 0 >();
       dip::sint maskStride = hasMask ? it.ProcessingDimensionStride< 1 >() : 0;
-      // Iterate over `fraction` image lines
+      // Collect `fraction` image lines
+      std::vector< TPI const* > dataLines;
+      std::vector< bin const* > maskLines;
       do {
-         void const* dataPtr = it.Pointer< 0 >();
-         bin const* maskPtr = hasMask ? static_cast< bin const* >( it.Pointer< 1 >() ) : nullptr;
-         // Walk along this line and find phase changes
-         dip::uint d1 = GetUIntPixelValue( dataPtr );
-         bin m1 = hasMask ? *maskPtr : bin( true );
-         dip::uint d2 = d1;
-         bin m2 = m1;
-         dip::uint length = 0;
-         for( dip::uint rr = 0; rr < size; ++rr ) {
-            // We want to measure the len of the line in the same phase, in the same object
-            if( d2 == d1 && m2 == m1 ) {
-               ++length;
-            } else {
-               UpdateDistribution( distribution, counts, phaseLookupTable, d2, length );
-               // Only count chord length inside a masked area
-               length = ( m1 ? 1 : 0 );
-            }
-            // Update to the next point on the line
-            d2 = d1;
-            m2 = m1;
-            dataPtr = static_cast< uint8 const* >( dataPtr ) + dataStride;
-            maskPtr += maskStride;
-            d1 = GetUIntPixelValue( dataPtr );
-            m1 = hasMask ? *maskPtr : bin( true );
-         }
-         UpdateDistribution( distribution, counts, phaseLookupTable, d2, length );
+         dataLines.push_back( static_cast< TPI const* >( it.Pointer< 0 >() ));
+         maskLines.push_back( hasMask ? static_cast< bin const* >( it.Pointer< 1 >() ) : nullptr );
          for( dip::uint ii = 0; ( ii < step ) && it; ++ii ) {
             ++it; // TODO: this does not skip appropriately in 3D and higher dims.
          }
       } while( it );
+      dip::uint nLines = dataLines.size();
+      // Iterate over these lines, each thread processes a contiguous range of lines
+      dip::uint nTasks = std::min( nThreads, nLines );
+      ParallelFor( nTasks, [ & ]( dip::uint thread ) {
+         Distribution& threadDistribution = distributions[ thread ];
+         std::vector< dip::uint >& threadCounts = countsArray[ thread ];
+         for( dip::uint line = nLines * thread / nTasks; line < nLines * ( thread + 1 ) / nTasks; ++line ) {
+            TPI const* dataPtr = dataLines[ line ];
+            bin const* maskPtr = maskLines[ line ];
+            // Walk along this line and find phase changes
+            dip::uint d1 = static_cast< dip::uint >( *dataPtr );
+            bin m1 = hasMask ? *maskPtr : bin( true );
+            dip::uint d2 = d1;
+            bin m2 = m1;
+            dip::uint length = 0;
+            for( dip::uint rr = 0; rr < size; ++rr ) {
+               // We want to measure the len of the line in the same phase, in the same object
+               if( d2 == d1 && m2 == m1 ) {
+                  ++length;
+               } else {
+                  UpdateDistribution( threadDistribution, threadCounts, phaseLookupTable, d2, length );
+                  // Only count chord length inside a masked area
+                  length = ( m1 ? 1 : 0 );
+               }
+               // Update to the next point on the line
+               d2 = d1;
+               m2 = m1;
+               if( rr + 1 < size ) { // Don't read past the end of the line
+                  dataPtr += dataStride;
+                  maskPtr += maskStride;
+                  d1 = static_cast< dip::uint >( *dataPtr );
+                  m1 = hasMask ? *maskPtr : bin( true );
+               }
+            }
+            UpdateDistribution( threadDistribution, threadCounts, phaseLookupTable, d2, length );
+         }
+      } );
+   }
+   MergePartialResults( distribution, counts, distributions, countsArray );
+}
+
+template< typename TPI >
+void ChordLengthSampler(
+      Image const& object,
+      Image const& mask,
+      Distribution& distribution,
+      std::vector< dip::uint >& counts,
+      PhaseLookupTable const& phaseLookupTable,
+      dip::uint probes,
+      bool random
+) {
+   if( random ) {
+      RandomPixelPairSampler< TPI >( object, mask, distribution, counts, phaseLookupTable, probes );
+   } else {
+      GridPixelPairSampler< TPI >( object, mask, distribution, counts, phaseLookupTable, probes );
    }
 }
 
@@ -278,11 +329,8 @@ Distribution ChordLength(
    std::vector< dip::uint >counts( nPhases, 0 );
 
    // Fill output
-   if( random ) {
-      RandomPixelPairSampler( object, mask, distribution, counts, phaseLookupTable, probes );
-   } else {
-      GridPixelPairSampler( object, mask, distribution, counts, phaseLookupTable, probes );
-   }
+   DIP_OVL_CALL_UINT( ChordLengthSampler, ( object, mask, distribution, counts, phaseLookupTable, probes, random ),
+                      object.DataType() );
 
    // Process the intermediate output results
    for( dip::uint ii = 0; ii < nPhases; ++ii ) {
@@ -296,3 +344,32 @@ Distribution ChordLength(
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::ChordLength with multiple threads") {
+   dip::Image img{ dip::UnsignedArray{ 300, 200 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random );
+   dip::Image object = img > 0.5;
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Distribution random1 = dip::ChordLength( object, {}, 100000, 10, dip::S::RANDOM );
+   dip::Distribution grid1 = dip::ChordLength( object, {}, 0, 10, dip::S::GRID );
+   dip::SetNumberOfThreads( 4 );
+   dip::Distribution random4 = dip::ChordLength( object, {}, 100000, 10, dip::S::RANDOM );
+   dip::Distribution grid4 = dip::ChordLength( object, {}, 0, 10, dip::S::GRID );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_REQUIRE( random1.Size() == random4.Size() );
+   for( dip::uint ii = 0; ii < random1.Size(); ++ii ) {
+      DOCTEST_CHECK( random1[ ii ].Y( 0 ) == random4[ ii ].Y( 0 ));
+      DOCTEST_CHECK( random1[ ii ].Y( 1 ) == random4[ ii ].Y( 1 ));
+      DOCTEST_CHECK( grid1[ ii ].Y( 0 ) == grid4[ ii ].Y( 0 ));
+      DOCTEST_CHECK( grid1[ ii ].Y( 1 ) == grid4[ ii ].Y( 1 ));
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
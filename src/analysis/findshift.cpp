@@ -18,6 +18,7 @@
  * limitations under the License.
  */
 
+
 #include "diplib.h"
 #include "diplib/analysis.h"
 #include "diplib/transform.h"
@@ -25,6 +26,8 @@
 #include "diplib/statistics.h"
 #include "diplib/linear.h"
 #include "diplib/geometry.h"
+#include "diplib/generation.h"
+#include "diplib/multithreading.h"
 
 namespace dip {
 
@@ -81,17 +84,15 @@ void CrossCorrelationFT(
 
 namespace {
 
-FloatArray FindShift_CPF( Image const& in1, Image const& in2, dfloat maxFrequency ) {
-   DIP_THROW_IF( in1.Dimensionality() != 2, E::DIMENSIONALITY_NOT_SUPPORTED );
+// Estimates the shift from the phase of the normalized cross-correlation `cross`, given in the frequency domain.
+// TPI is either scomplex or dcomplex.
+template< typename TPI >
+FloatArray FindShift_CPF( Image const& cross, dfloat maxFrequency ) {
+   DIP_ASSERT( cross.DataType() == DataType( TPI{} ));
+   DIP_ASSERT( cross.Stride( 0 ) == 1 );
    if( maxFrequency <= 0.0 ) {
       maxFrequency = 0.2;
    }
-   // Do cross-correlation for sub-pixel shift, forcing dcomplex output
-   Image cross{ in1.Sizes(), 1, DT_DCOMPLEX };
-   cross.Protect();
-   CrossCorrelationFT( in1, in2, cross, S::SPATIAL, S::SPATIAL, S::FREQUENCY, S::NORMALIZE );
-   DIP_ASSERT( cross.DataType() == DT_DCOMPLEX );
-   DIP_ASSERT( cross.Stride( 0 ) == 1 );
    // Do the least squares fit
    dip::sint center_x = static_cast< dip::sint >( cross.Size( 0 ) / 2 );
    dip::sint center_y = static_cast< dip::sint >( cross.Size( 1 ) / 2 );
@@ -108,17 +109,17 @@ FloatArray FindShift_CPF( Image const& in1, Image const& in2, dfloat maxFrequenc
    dfloat v = static_cast< dfloat >( 0 - center_y ) * dv;
    // For the sake of simplicity, we forgo the Framework
    for( dip::sint jj = 0; jj < static_cast< dip::sint >( cross.Size( 1 )); ++jj ) {
-      dcomplex* ptr = static_cast< dcomplex* >( cross.Origin() ) + cross.Stride( 1 ) * jj; // just in case stride != width, which should not happen.
+      TPI const* ptr = static_cast< TPI const* >( cross.Origin() ) + cross.Stride( 1 ) * jj; // just in case stride != width, which should not happen.
       dfloat vv = v * v;
       if( vv < radius ) {
          dfloat u = uStart;
          for( dip::sint ii = 0; ii < static_cast< dip::sint >( cross.Size( 0 )); ii++ ) {
             dfloat uu = u * u;
             if( uu + vv < radius ) {
-               dfloat amplitude = std::abs( *ptr );
+               dfloat amplitude = static_cast< dfloat >( std::abs( *ptr ));
                if( std::abs( amplitude - 1 ) < 0.1 ) {
                   // Use this point
-                  dfloat angle = std::arg( *ptr );
+                  dfloat angle = static_cast< dfloat >( std::arg( *ptr ));
                   sumuv += u * v;
                   sumuu += uu;
                   sumvv += vv;
@@ -144,6 +145,15 @@ FloatArray FindShift_CPF( Image const& in1, Image const& in2, dfloat maxFrequenc
    // TODO: CPF can probably be computed independently for each dimension by averaging fits along each line.
 }
 
+FloatArray FindShift_CPF( Image const& in1, Image const& in2, dfloat maxFrequency ) {
+   DIP_THROW_IF( in1.Dimensionality() != 2, E::DIMENSIONALITY_NOT_SUPPORTED );
+   // Do cross-correlation for sub-pixel shift, forcing dcomplex output
+   Image cross{ in1.Sizes(), 1, DT_DCOMPLEX };
+   cross.Protect();
+   CrossCorrelationFT( in1, in2, cross, S::SPATIAL, S::SPATIAL, S::FREQUENCY, S::NORMALIZE );
+   return FindShift_CPF< dcomplex >( cross, maxFrequency );
+}
+
 FloatArray FindShift_MTS( Image const& in1, Image const& in2, dip::uint iterations, dfloat accuracy, dfloat sigma ) {
    dip::uint nDims = in1.Dimensionality();
    FloatArray out( nDims, 0.0 );
@@ -249,17 +259,14 @@ FloatArray FindShift_PROJ( Image const& in1, Image const& in2, dip::uint iterati
    return shift;
 }
 
-FloatArray FindShift_CC(
-      Image const& in1,
-      Image const& in2,
+// Finds the shift from the location of the peak in the cross-correlation `cross`, given in the spatial domain.
+FloatArray FindCrossCorrelationPeak(
+      Image& cross,
       UnsignedArray const& maxShift,
-      String const& normalize = S::DONT_NORMALIZE,
-      bool subpixelPrecision = false
+      bool subpixelPrecision
 ) {
-   dip::uint nDims = in1.Dimensionality();
-   Image cross;
-   DIP_STACK_TRACE_THIS( CrossCorrelationFT( in1, in2, cross, S::SPATIAL, S::SPATIAL, S::SPATIAL, normalize ));
    DIP_ASSERT( cross.DataType().IsReal() );
+   dip::uint nDims = cross.Dimensionality();
    UnsignedArray sizes = cross.Sizes();
    bool crop = false;
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
@@ -290,17 +297,28 @@ FloatArray FindShift_CC(
    return shift;
 }
 
-FloatArray CorrectIntegerShift(
+FloatArray FindShift_CC(
+      Image const& in1,
+      Image const& in2,
+      UnsignedArray const& maxShift,
+      String const& normalize = S::DONT_NORMALIZE,
+      bool subpixelPrecision = false
+) {
+   Image cross;
+   DIP_STACK_TRACE_THIS( CrossCorrelationFT( in1, in2, cross, S::SPATIAL, S::SPATIAL, S::SPATIAL, normalize ));
+   return FindCrossCorrelationPeak( cross, maxShift, subpixelPrecision );
+}
+
+// Crops `in1` and `in2` to their common part, given an integer `shift` of `in2` with respect to `in1`.
+void CropToCommonPart(
       Image& in1,
       Image& in2,
-      UnsignedArray const& maxShift
+      FloatArray const& shift
 ) {
-   dip::uint nDims = in1.Dimensionality();
-   FloatArray shift;
-   DIP_STACK_TRACE_THIS( shift = FindShift_CC( in1, in2, maxShift ));
    if( shift.any() ) {
       // Shift is non-zero along at least one dimension
       // Correct for this integer shift by cropping both images
+      dip::uint nDims = in1.Dimensionality();
       UnsignedArray sizes = in1.Sizes();
       UnsignedArray origin( nDims, 0 );
       for( dip::uint ii = 0; ii < nDims; ++ii ) {
@@ -315,9 +333,68 @@ FloatArray CorrectIntegerShift(
       in1.dip__SetSizes( sizes );
       in1.dip__SetOrigin( in1.Pointer( origin ));
    }
+}
+
+FloatArray CorrectIntegerShift(
+      Image& in1,
+      Image& in2,
+      UnsignedArray const& maxShift
+) {
+   FloatArray shift;
+   DIP_STACK_TRACE_THIS( shift = FindShift_CC( in1, in2, maxShift ));
+   CropToCommonPart( in1, in2, shift );
    return shift;
 }
 
+// The sub-pixel refinement for the "MTS", "ITER" and "PROJ" methods, applied after correcting for the integer shift.
+FloatArray FindSubpixelShift(
+      Image const& in1,
+      Image const& in2,
+      String const& method,
+      dfloat parameter
+) {
+   if( method == "MTS" ) {
+      if( parameter <= 0.0 ) {
+         parameter = 1.0;
+      }
+      return FindShift_MTS( in1, in2, 1, 0.0, parameter );
+   }
+   dip::uint maxIter = 5;  // default number of iteration => accuracy ~ 1e-4
+   dfloat accuracy = 0.0;  // signals early break if bias correction is possible
+   if( parameter < 0.0 ) {
+      maxIter = std::max( dip::uint{ 1 }, static_cast< dip::uint >( round_cast( -parameter )));
+      accuracy = 1e-10;    // so small that maxIter would play its role
+   } else if(( parameter > 0.0 ) && ( parameter <= 0.1 )) {
+      maxIter = 20;        // NOTE: more iteration solution may end up very far from truth
+      accuracy = parameter;
+   }
+   if( method == "ITER" ) {
+      return FindShift_MTS( in1, in2, maxIter, accuracy, 1.0 );
+   } else if( method == "PROJ" ) {
+      return FindShift_PROJ( in1, in2, maxIter, accuracy, 1.0 ); // calls FindShift_MTS
+   } else {
+      DIP_THROW_INVALID_FLAG( method );
+   }
+}
+
+// Computes the single-precision Fourier transform of `in`, after applying the window if one is given.
+Image SinglePrecisionSpectrum( Image const& in, String const& window, dfloat windowParameter ) {
+   Image tmp = in.QuickCopy();
+   if( !window.empty() ) {
+      tmp = ApplyWindow( in, window, windowParameter );
+   }
+   if( tmp.DataType() != DT_SFLOAT ) {
+      tmp = Convert( tmp, DT_SFLOAT );
+   }
+   Image out = FourierTransform( tmp );
+   DIP_ASSERT( out.DataType() == DT_SCOMPLEX );
+   return out;
+}
+
+bool UsesSubpixelRefinement( String const& method ) {
+   return ( method == "CPF" ) || ( method == "MTS" ) || ( method == "ITER" ) || ( method == "PROJ" );
+}
+
 } // namespace
 
 FloatArray FindShift(
@@ -348,38 +425,106 @@ FloatArray FindShift(
       DIP_STACK_TRACE_THIS( shift = CorrectIntegerShift( in1, in2, maxShift )); // modifies in1 and in2
       if( method == "CPF" ) {
          DIP_STACK_TRACE_THIS( shift += FindShift_CPF( in1, in2, parameter ));
-      } else if( method == "MTS" ) {
-         if( parameter <= 0.0 ) {
-            parameter = 1.0;
-         }
-         DIP_STACK_TRACE_THIS( shift += FindShift_MTS( in1, in2, 1, 0.0, parameter ));
       } else {
-         dip::uint maxIter = 5;  // default number of iteration => accuracy ~ 1e-4
-         dfloat accuracy = 0.0;  // signals early break if bias correction is possible
-         if( parameter < 0.0 ) {
-            maxIter = std::max( dip::uint{ 1 }, static_cast< dip::uint >( round_cast( -parameter )));
-            accuracy = 1e-10;    // so small that maxIter would play its role
-         } else if(( parameter > 0.0 ) && ( parameter <= 0.1 )) {
-            maxIter = 20;        // NOTE: more iteration solution may end up very far from truth
-            accuracy = parameter;
-         }
-         if( method == "ITER" ) {
-            DIP_STACK_TRACE_THIS( shift += FindShift_MTS( in1, in2, maxIter, accuracy, 1.0 ));
-         } else if( method == "PROJ" ) {
-            DIP_STACK_TRACE_THIS( shift += FindShift_PROJ( in1, in2, maxIter, accuracy, 1.0 )); // calls FindShift_MTS
-         } else {
-            DIP_THROW_INVALID_FLAG( method );
-         }
+         DIP_STACK_TRACE_THIS( shift += FindSubpixelShift( in1, in2, method, parameter ));
       }
    }
    return shift;
 }
 
+ShiftEstimator::ShiftEstimator(
+      Image const& reference,
+      String const& method,
+      dfloat parameter,
+      UnsignedArray maxShift,
+      String const& window,
+      dfloat windowParameter
+) : method_( method ), parameter_( parameter ), window_( window ), windowParameter_( windowParameter ) {
+   DIP_THROW_IF( !reference.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !reference.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !reference.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   dip::uint nDims = reference.Dimensionality();
+   DIP_THROW_IF(( method_ == "CPF" ) && ( nDims != 2 ), E::DIMENSIONALITY_NOT_SUPPORTED );
+   if( !UsesSubpixelRefinement( method_ ) && ( method_ != "integer only" ) && ( method_ != "CC" ) &&
+       ( method_ != "NCC" ) && ( method_ != "PC" )) {
+      DIP_THROW_INVALID_FLAG( method_ );
+   }
+   DIP_START_STACK_TRACE
+      ArrayUseParameter( maxShift, nDims, std::numeric_limits< dip::uint >::max() );
+      maxShift_ = maxShift;
+      reference_ = reference.QuickCopy();
+      referenceFT_ = SinglePrecisionSpectrum( reference, window_, windowParameter_ );
+      if( method_ == "PC" ) {
+         Modulus( referenceFT_, referenceNorm_ );
+      } else if(( method_ == "NCC" ) || ( method_ == "CPF" )) {
+         SquareModulus( referenceFT_, referenceNorm_ );
+      }
+   DIP_END_STACK_TRACE
+}
+
+FloatArray ShiftEstimator::FindShift( Image const& in ) const {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( in.Sizes() != reference_.Sizes(), E::SIZES_DONT_MATCH );
+   FloatArray shift;
+   DIP_START_STACK_TRACE
+      // The cross-correlation, computed as in `dip::CrossCorrelationFT`, but re-using the reference spectrum
+      Image inFT = SinglePrecisionSpectrum( in, window_, windowParameter_ );
+      Image cross;
+      MultiplyConjugate( referenceFT_, inFT, cross, DT_SCOMPLEX );
+      if( method_ == "NCC" ) {
+         SafeDivide( cross, referenceNorm_, cross, DT_SCOMPLEX );
+      } else if( method_ == "PC" ) {
+         SafeDivide( cross, referenceNorm_, cross, DT_SCOMPLEX );
+         Modulus( inFT, inFT );
+         SafeDivide( cross, inFT, cross, DT_SCOMPLEX );
+      }
+      if( !UsesSubpixelRefinement( method_ )) {
+         FourierTransform( cross, cross, { S::INVERSE, S::REAL } );
+         return FindCrossCorrelationPeak( cross, maxShift_, method_ != "integer only" );
+      }
+      // Find the integer shift, then refine
+      Image normalized;
+      if( method_ == "CPF" ) {
+         SafeDivide( cross, referenceNorm_, normalized, DT_SCOMPLEX );
+      }
+      FourierTransform( cross, cross, { S::INVERSE, S::REAL } );
+      shift = FindCrossCorrelationPeak( cross, maxShift_, false );
+      if( method_ == "CPF" ) {
+         if( shift.any() ) {
+            Image in1 = reference_.QuickCopy();
+            Image in2 = in.QuickCopy();
+            CropToCommonPart( in1, in2, shift );
+            Image in1FT = SinglePrecisionSpectrum( in1, window_, windowParameter_ );
+            MultiplyConjugate( in1FT, SinglePrecisionSpectrum( in2, window_, windowParameter_ ), normalized, DT_SCOMPLEX );
+            SquareModulus( in1FT, in1FT );
+            SafeDivide( normalized, in1FT, normalized, DT_SCOMPLEX );
+         }
+         shift += FindShift_CPF< scomplex >( normalized, parameter_ );
+      } else {
+         Image in1 = reference_.QuickCopy();
+         Image in2 = in.QuickCopy();
+         CropToCommonPart( in1, in2, shift );
+         shift += FindSubpixelShift( in1, in2, method_, parameter_ );
+      }
+   DIP_END_STACK_TRACE
+   return shift;
+}
+
+std::vector< FloatArray > ShiftEstimator::FindShift( ImageConstRefArray const& in ) const {
+   dip::uint nImages = in.size();
+   std::vector< FloatArray > shifts( nImages );
+   ParallelFor( nImages, [ & ]( dip::uint ii ) {
+      shifts[ ii ] = FindShift( in[ ii ].get() );
+   } );
+   return shifts;
+}
+
 } // namespace dip
 
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
-#include "diplib/generation.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the FindShift fuction") {
    // Something to shift
@@ -446,4 +591,39 @@ DOCTEST_TEST_CASE("[DIPlib] testing the FindShift fuction") {
    DOCTEST_CHECK( std::abs( result[ 1 ] - shift[ 1 ] ) < 0.03 );
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the ShiftEstimator class") {
+   dip::Image reference( { 250, 261 }, 1, dip::DT_SFLOAT );
+   dip::FillRadiusCoordinate( reference );
+   reference -= 100;
+   dip::Erf( reference, reference );
+   dip::ImageArray frames;
+   std::vector< dip::FloatArray > trueShifts{ { 10.27, 6.08 }, { -0.31, 0.42 }, { 3.5, -7.2 }, { 0.0, 0.0 } };
+   for( auto const& shift : trueShifts ) {
+      frames.push_back( dip::Shift( reference, shift, "3-cubic" ));
+   }
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 4 );
+   for( auto const& test : std::vector< std::pair< dip::String, dip::dfloat >>{
+         { "integer only", 0.5 }, { "CC", 0.03 }, { "NCC", 0.2 }, { "CPF", 0.05 }, { "MTS", 0.01 }, { "ITER", 0.002 } } ) {
+      dip::ShiftEstimator estimator( reference, test.first );
+      std::vector< dip::FloatArray > result = estimator.FindShift( frames );
+      DOCTEST_REQUIRE( result.size() == frames.size() );
+      for( dip::uint ii = 0; ii < frames.size(); ++ii ) {
+         DOCTEST_REQUIRE( result[ ii ].size() == 2 );
+         DOCTEST_CHECK( std::abs( result[ ii ][ 0 ] - trueShifts[ ii ][ 0 ] ) <= test.second );
+         DOCTEST_CHECK( std::abs( result[ ii ][ 1 ] - trueShifts[ ii ][ 1 ] ) <= test.second );
+         // Registering a single image gives the same result, and matches `dip::FindShift`
+         DOCTEST_CHECK( estimator.FindShift( frames[ ii ] ) == result[ ii ] );
+         dip::FloatArray expected = dip::FindShift( reference, frames[ ii ], test.first );
+         DOCTEST_CHECK( result[ ii ][ 0 ] == doctest::Approx( expected[ 0 ] ).epsilon( 1e-3 ));
+         DOCTEST_CHECK( result[ ii ][ 1 ] == doctest::Approx( expected[ 1 ] ).epsilon( 1e-3 ));
+      }
+   }
+   dip::ShiftEstimator windowed( reference, "NCC", 0, {}, "Hamming" );
+   dip::FloatArray result = windowed.FindShift( frames[ 1 ] );
+   DOCTEST_CHECK( std::abs( result[ 0 ] - trueShifts[ 1 ][ 0 ] ) < 0.2 );
+   DOCTEST_CHECK( std::abs( result[ 1 ] - trueShifts[ 1 ][ 1 ] ) < 0.2 );
+   dip::SetNumberOfThreads( nThreads );
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -27,78 +27,56 @@
 
 namespace dip {
 
-void MonogenicSignal(
-      Image const& c_in,
-      Image& out,
+FourierFilterBank CreateMonogenicFilterBank(
+      UnsignedArray const& sizes,
       FloatArray const& wavelengths,
-      dfloat bandwidth,
-      String const& inRepresentation,
-      String const& outRepresentation
+      dfloat bandwidth
 ) {
-   DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
-   DIP_THROW_IF( !c_in.IsScalar(), E::IMAGE_NOT_SCALAR );
-   DIP_THROW_IF( c_in.DataType().IsComplex(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( sizes.empty() || !sizes.all(), "Raw image sizes not valid" );
    dip::uint nFrequencyScales = wavelengths.size();
    DIP_THROW_IF( nFrequencyScales < 1, E::ARRAY_PARAMETER_EMPTY );
    DIP_THROW_IF( bandwidth <= 0, E::INVALID_PARAMETER );
-   dip::uint nDims = c_in.Dimensionality();
-   bool spatialDomainInput;
-   DIP_STACK_TRACE_THIS( spatialDomainInput = BooleanFromString( inRepresentation, S::SPATIAL, S::FREQUENCY ));
-   bool spatialDomainOutput;
-   DIP_STACK_TRACE_THIS( spatialDomainOutput = BooleanFromString( outRepresentation, S::SPATIAL, S::FREQUENCY ));
-   bool inputIsReal = spatialDomainInput && !c_in.DataType().IsComplex();
-   bool ouputIsReal = inputIsReal && spatialDomainOutput;
-   DataType dt = ouputIsReal ? DT_SFLOAT : DT_SCOMPLEX;
-   Image in = c_in;
-   if( out.Aliases( in )) {
-      out.Strip(); // we can't work in-place
-   }
-   DIP_STACK_TRACE_THIS( out.ReForge( in.Sizes(), ( nDims + 1 ) * nFrequencyScales, dt ));
-   out.ReshapeTensor( nDims + 1, nFrequencyScales );
-   Image ftIn;
-   if( spatialDomainInput ) {
-      ftIn = FourierTransform( in );
-   } else {
-      ftIn = in.QuickCopy();
-   }
-   UnsignedArray center = in.Sizes();
-   center /= 2;
-   // Compute Riesz transform
-   Image mono;
-   DIP_STACK_TRACE_THIS( RieszTransform( ftIn, mono, S::FREQUENCY, S::FREQUENCY ));
-   // Compute scale selection filters
-   Image radialFilter;
-   radialFilter.SetSizes( in.Sizes() ); // We'll use this non-forged image as input to get a filter bank not applied to an image
-   DIP_STACK_TRACE_THIS( LogGaborFilterBank( radialFilter, radialFilter, wavelengths, bandwidth, 1, S::FREQUENCY, S::FREQUENCY ));
-   // Options for inverse transform
-   StringSet options = { S::INVERSE };
-   if( spatialDomainOutput && ouputIsReal ) {
-      options.insert( S::REAL );
-   }
-   // Get all combinations by multiplication
-   for( dip::uint scale = 0; scale < nFrequencyScales; ++scale ) {
-      {
-         Image destination = out[ UnsignedArray{ 0, scale } ];
-         destination.Protect();          // ensure it will not be reforged
-         Image tempStorage;
-         Image& ftDestination = ( spatialDomainOutput && ouputIsReal ) ? tempStorage : destination;
-         DIP_STACK_TRACE_THIS( Multiply( radialFilter[ scale ], ftIn, ftDestination ));
-         ftDestination.At( center ) = 0;
-         if( spatialDomainOutput ) {
-            DIP_STACK_TRACE_THIS( FourierTransform( ftDestination, destination, options ));
+   dip::uint nDims = sizes.size();
+   DIP_START_STACK_TRACE
+      // Compute scale selection filters
+      Image radialFilter;
+      radialFilter.SetSizes( sizes ); // We'll use this non-forged image as input to get a filter bank not applied to an image
+      LogGaborFilterBank( radialFilter, radialFilter, wavelengths, bandwidth, 1, S::FREQUENCY, S::FREQUENCY );
+      // Compute Riesz transform filters, by applying the transform to a constant image in the frequency domain
+      Image riesz( sizes, 1, DT_SFLOAT );
+      riesz.Fill( 1 );
+      RieszTransform( riesz, riesz, S::FREQUENCY, S::FREQUENCY );
+      // Get all combinations by multiplication
+      Image filters( sizes, ( nDims + 1 ) * nFrequencyScales, DT_SCOMPLEX );
+      filters.ReshapeTensor( nDims + 1, nFrequencyScales );
+      for( dip::uint scale = 0; scale < nFrequencyScales; ++scale ) {
+         Image even = filters[ UnsignedArray{ 0, scale } ];
+         even.Protect();                 // ensure it will not be reforged
+         even.Copy( radialFilter[ scale ] );
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            Image odd = filters[ UnsignedArray{ ii + 1, scale } ];
+            odd.Protect();
+            Multiply( radialFilter[ scale ], riesz[ ii ], odd );
          }
       }
-      for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         Image destination = out[ UnsignedArray{ ii + 1, scale } ];
-         destination.Protect();          // ensure it will not be reforged
-         Image tempStorage;
-         Image& ftDestination = ( spatialDomainOutput && ouputIsReal ) ? tempStorage : destination;
-         DIP_STACK_TRACE_THIS( Multiply( radialFilter[ scale ], mono[ ii ], ftDestination ));
-         if( spatialDomainOutput ) {
-            DIP_STACK_TRACE_THIS( FourierTransform( ftDestination, destination, options ));
-         }
-      }
-   }
+      // All filters are Fourier transforms of real-valued kernels
+      return FourierFilterBank( filters, true );
+   DIP_END_STACK_TRACE
+}
+
+void MonogenicSignal(
+      Image const& in,
+      Image& out,
+      FloatArray const& wavelengths,
+      dfloat bandwidth,
+      String const& inRepresentation,
+      String const& outRepresentation
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( in.DataType().IsComplex(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_STACK_TRACE_THIS( CreateMonogenicFilterBank( in.Sizes(), wavelengths, bandwidth )
+                               .Apply( in, out, inRepresentation, outRepresentation ));
 }
 
 void MonogenicSignalAnalysis(
@@ -24,9 +24,11 @@
 #include "diplib/analysis.h"
 #include "diplib/regions.h"
 #include "diplib/generic_iterators.h"
+#include "diplib/multithreading.h"
 #include "diplib/overload.h"
 #include "diplib/random.h"
 #include "diplib/saturated_arithmetic.h"
+#include "sampling_support.h"
 
 namespace dip {
 
@@ -36,107 +38,94 @@ namespace {
 // --- Infrastructure ---
 //
 
-// Reading UInt value
-
-using UIntPixelValueReaderFunction = dip::uint ( * )( void const* );
-
-template< typename TPI >
-static dip::uint UIntPixelValueReader( void const* data ) {
-   return static_cast< dip::uint >( *static_cast< TPI const* >( data ));
-}
-
-// Reading Float value
-
-using FloatPixelValueReaderWithOffsetFunction = dfloat ( * )( void const*, dip::sint );
-
-template< typename TPI >
-dfloat FloatPixelValueReaderWithOffset( void const* data, dip::sint offset ) {
-   return static_cast< dfloat >( *( static_cast< TPI const* >( data ) + offset ));
-}
-
-using FloatPixelValueReaderFunction = dfloat ( * )( void const* );
-
-template< typename TPI >
-dfloat FloatPixelValueReader( void const* data ) {
-   return static_cast< dfloat >( *static_cast< TPI const* >( data ));
-}
-
-
-class PixelPairFunction {
-   public:
-      virtual void UpdateRandom(
-            UnsignedArray const& coords1,
-            UnsignedArray const& coords2,
-            dip::uint distance
-      ) = 0;
-      virtual void UpdateGrid(
-            void const* dataPtr1,
-            void const* dataPtr2,
-            dip::uint distance
-      ) = 0;
-      // virtual void SetNumberOfThreads( dip::uint  threads ) { ( void )threads; }
-};
+// The pixel pair functions below are templated on the pixel type, and have a member function
+//    void Update( Distribution& distribution, TPI const* dataPtr1, TPI const* dataPtr2, dip::uint distance ) const;
+// which adds the contribution of a pixel pair to `distribution`. The samplers below count the pairs.
+// The samplers give each chunk of work its own copy of `distribution` and `counts`, these are added together at
+// the end (see `MergePartialResults`).
 
+// The probes are divided into chunks, each chunk using its own random stream (see `NumberOfRandomSamplingChunks`).
+template< typename TPI, typename F >
 void RandomPixelPairSampler(
       Image const& object, // unsigned integer type
       Image const& mask,   // might or might not be forged
-      PixelPairFunction* pixelPairFunction,
+      F const& pixelPairFunction,
+      Distribution& distribution,
+      std::vector< dip::uint >& counts,
       dip::uint nProbes,
       dip::uint maxLength
 ) {
    bool hasMask = mask.IsForged();
-   Random random( 0 );
-   UniformRandomGenerator uniformRandomGenerator( random );
    dip::uint nDims = object.Dimensionality();
    UnsignedArray const& sizes = object.Sizes();
-   UnsignedArray coords1( nDims );
-   UnsignedArray coords2( nDims );
-   for( dip::uint probe = 0; probe < nProbes; ++probe ) { // TODO: trivially parallelizable.
-      bool isInMask = true;
-      // First point
-      do {
-         for( dip::uint ii = 0; ii < nDims; ++ii ) {
-            coords1[ ii ] = static_cast< dip::uint >( uniformRandomGenerator( 0, static_cast< dfloat >( sizes[ ii ] ))); // computes floor
-         }
-         isInMask = hasMask ? static_cast< bool >( *static_cast< bin* >( mask.Pointer( coords1 ))) : true;
-      } while( !isInMask );
-      // Second point, probe within a region of side maxLength around first point
+   TPI const* data = static_cast< TPI const* >( object.Origin() );
+   IntegerArray const& strides = object.Strides();
+   bin const* maskData = hasMask ? static_cast< bin const* >( mask.Origin() ) : nullptr;
+   IntegerArray maskStrides = hasMask ? mask.Strides() : IntegerArray{};
+   dip::uint nChunks = NumberOfRandomSamplingChunks( nProbes, nDims * 10 );
+   std::vector< Random > randomStreams = RandomSamplingStreams( nChunks );
+   std::vector< Distribution > distributions( nChunks, distribution ); // one for each chunk
+   std::vector< std::vector< dip::uint >> countsArray( nChunks, counts );
+   ParallelFor( nChunks, [ & ]( dip::uint chunk ) {
+      UniformRandomGenerator uniformRandomGenerator( randomStreams[ chunk ] );
+      Distribution& chunkDistribution = distributions[ chunk ];
+      std::vector< dip::uint >& chunkCounts = countsArray[ chunk ];
+      UnsignedArray coords1( nDims );
+      UnsignedArray coords2( nDims );
       UnsignedArray topLeft( nDims );
       UnsignedArray botRight( nDims );
-      for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         topLeft[ ii ] = coords1[ ii ] > maxLength ? coords1[ ii ] - maxLength : 0u;
-         botRight[ ii ] = std::min( coords1[ ii ] + maxLength + 1, sizes[ ii ] );
-      }
-      dip::uint distance;
-      do {
-         distance = 0;
+      dip::uint firstProbe = nProbes * chunk / nChunks;
+      dip::uint lastProbe = nProbes * ( chunk + 1 ) / nChunks;
+      for( dip::uint probe = firstProbe; probe < lastProbe; ++probe ) {
+         bool isInMask = true;
+         // First point
+         do {
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               coords1[ ii ] = static_cast< dip::uint >( uniformRandomGenerator( 0, static_cast< dfloat >( sizes[ ii ] ))); // computes floor
+            }
+            isInMask = hasMask ? static_cast< bool >( maskData[ Offset( coords1, maskStrides ) ] ) : true;
+         } while( !isInMask );
+         // Second point, probe within a region of side maxLength around first point
          for( dip::uint ii = 0; ii < nDims; ++ii ) {
-            coords2[ ii ] = static_cast< dip::uint >( uniformRandomGenerator(
-                  static_cast< dfloat >( topLeft[ ii ] ), static_cast< dfloat >( botRight[ ii ] ))); // computes floor
-            dip::uint d = coords2[ ii ] >= coords1[ ii ] ? coords2[ ii ] - coords1[ ii ] : coords1[ ii ] - coords2[ ii ];
-            distance += d * d;
+            topLeft[ ii ] = coords1[ ii ] > maxLength ? coords1[ ii ] - maxLength : 0u;
+            botRight[ ii ] = std::min( coords1[ ii ] + maxLength + 1, sizes[ ii ] );
          }
-         if( distance > maxLength * maxLength ) {
-            isInMask = false;
-         } else {
-            isInMask = hasMask ? static_cast< bool >( *static_cast< bin* >( mask.Pointer( coords2 ))) : true;
-         }
-      } while( !isInMask );
-      distance = static_cast< dip::uint >( std::round( std::sqrt( distance )));
-      pixelPairFunction->UpdateRandom( coords1, coords2, distance );
-   }
+         dip::uint distance;
+         do {
+            distance = 0;
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               coords2[ ii ] = static_cast< dip::uint >( uniformRandomGenerator(
+                     static_cast< dfloat >( topLeft[ ii ] ), static_cast< dfloat >( botRight[ ii ] ))); // computes floor
+               dip::uint d = coords2[ ii ] >= coords1[ ii ] ? coords2[ ii ] - coords1[ ii ] : coords1[ ii ] - coords2[ ii ];
+               distance += d * d;
+            }
+            if( distance > maxLength * maxLength ) {
+               isInMask = false;
+            } else {
+               isInMask = hasMask ? static_cast< bool >( maskData[ Offset( coords2, maskStrides ) ] ) : true;
+            }
+         } while( !isInMask );
+         distance = static_cast< dip::uint >( std::round( std::sqrt( distance )));
+         ++( chunkCounts[ distance ] );
+         pixelPairFunction.Update( chunkDistribution, data + Offset( coords1, strides ), data + Offset( coords2, strides ), distance );
+      }
+   } );
+   MergePartialResults( distribution, counts, distributions, countsArray );
 }
 
+// The grid lines along each dimension are divided over the threads.
+template< typename TPI, typename F >
 void GridPixelPairSampler(
       Image const& object, // unsigned integer type
       Image const& mask,   // might or might not be forged
-      PixelPairFunction* pixelPairFunction,
+      F const& pixelPairFunction,
+      Distribution& distribution,
+      std::vector< dip::uint >& counts,
       dip::uint nProbes,
       dip::uint maxLength
 ) {
    bool hasMask = mask.IsForged();
    dip::uint nDims = object.Dimensionality();
-   UnsignedArray coords( nDims );
    dip::uint nPixels = object.Sizes().product();
    dip::uint nGridPoints = nPixels;
    dip::uint step = 1; // how many lines to skip
@@ -146,43 +135,82 @@ void GridPixelPairSampler(
       step = static_cast< dip::uint >( floor_cast( 1.0 / fraction ));
       step = std::max< dip::uint >( step, 1 ); // step must be at least 1, this test should never trigger.
    }
+   dip::uint nThreads = 1;
+   if( nGridPoints * nDims * ( maxLength + 1 ) >= threadingThreshold ) {
+      nThreads = GetNumberOfThreads();
+   }
+   std::vector< Distribution > distributions( nThreads, distribution ); // one for each thread
+   std::vector< std::vector< dip::uint >> countsArray( nThreads, counts );
    // Iterate over image dimensions
    for( dip::uint dim = 0; dim < nDims; ++dim ) {
       GenericJointImageIterator< 2 > it( { object, mask }, dim );
       dip::uint size = it.ProcessingDimensionSize();
-      dip::sint dataStride = it.ProcessingDimensionStride< 0 >() * static_cast< dip::sint >( object.DataType().SizeOf() );
+      dip::sint dataStride = it.ProcessingDimensionStride< 0 >();
       dip::sint maskStride = hasMask ? it.ProcessingDimensionStride< 1 >() : 0;
       dip::uint nLinesInGrid = div_floor( nPixels / size, step );
       dip::uint nPointsPerLine = div_ceil( nGridPoints, nLinesInGrid );
       nPointsPerLine = std::min( nPointsPerLine, size ); // don't do more points than we have in the line, this should not trigger.
       dip::uint lineStep = div_floor( size, nPointsPerLine );
       dip::uint lastPoint = lineStep * nPointsPerLine;
-      // Iterate over `fraction` image lines
+      // Collect `fraction` image lines
+      std::vector< TPI const* > dataLines;
+      std::vector< bin const* > maskLines;
       do {
-         // Iterate over `fraction` pixels in this image line
-         void const* dataPtr = it.Pointer< 0 >();
-         bin const* maskPtr = hasMask ? static_cast< bin const* >( it.Pointer< 1 >() ) : nullptr;
-         for( dip::uint ii = 0; ii < lastPoint; ii += lineStep ) {
-            if( !hasMask || *maskPtr ) {
-               // Iterate over pixels at all distances from this pixel
-               dip::uint max = std::min( maxLength, size - ii - 1 );
-               void const* dataPtr2 = dataPtr;
-               bin const* maskPtr2 = maskPtr;
-               for( dip::uint distance = 0; distance <= max; ++distance ) {
-                  if( !hasMask || *maskPtr2 ) {
-                     pixelPairFunction->UpdateGrid( dataPtr, dataPtr2, distance );
-                  }
-                  dataPtr2 = static_cast< uint8 const* >( dataPtr2 ) + dataStride;
-                  maskPtr2 += maskStride;
-               }
-            }
-            dataPtr = static_cast< uint8 const* >( dataPtr ) + dataStride;
-            maskPtr += maskStride;
-         }
+         dataLines.push_back( static_cast< TPI const* >( it.Pointer< 0 >() ));
+         maskLines.push_back( hasMask ? static_cast< bin const* >( it.Pointer< 1 >() ) : nullptr );
          for( dip::uint ii = 0; ( ii < step ) && it; ++ii ) {
             ++it; // TODO: this does not skip appropriately in 3D and higher dims.
          }
       } while( it );
+      dip::uint nLines = dataLines.size();
+      // Iterate over these lines, each thread processes a contiguous range of lines
+      dip::uint nTasks = std::min( nThreads, nLines );
+      ParallelFor( nTasks, [ & ]( dip::uint thread ) {
+         Distribution& threadDistribution = distributions[ thread ];
+         std::vector< dip::uint >& threadCounts = countsArray[ thread ];
+         for( dip::uint line = nLines * thread / nTasks; line < nLines * ( thread + 1 ) / nTasks; ++line ) {
+            // Iterate over `fraction` pixels in this image line
+            TPI const* dataPtr = dataLines[ line ];
+            bin const* maskPtr = maskLines[ line ];
+            for( dip::uint ii = 0; ii < lastPoint; ii += lineStep ) {
+               if( !hasMask || *maskPtr ) {
+                  // Iterate over pixels at all distances from this pixel
+                  dip::uint max = std::min( maxLength, size - ii - 1 );
+                  TPI const* dataPtr2 = dataPtr;
+                  bin const* maskPtr2 = maskPtr;
+                  for( dip::uint distance = 0; distance <= max; ++distance ) {
+                     if( !hasMask || *maskPtr2 ) {
+                        ++( threadCounts[ distance ] );
+                        pixelPairFunction.Update( threadDistribution, dataPtr, dataPtr2, distance );
+                     }
+                     dataPtr2 += dataStride;
+                     maskPtr2 += maskStride;
+                  }
+               }
+               dataPtr += dataStride;
+               maskPtr += maskStride;
+            }
+         }
+      } );
+   }
+   MergePartialResults( distribution, counts, distributions, countsArray );
+}
+
+template< typename TPI, typename F >
+void PixelPairSampler(
+      Image const& object,
+      Image const& mask,
+      F const& pixelPairFunction,
+      Distribution& distribution,
+      std::vector< dip::uint >& counts,
+      dip::uint nProbes,
+      dip::uint maxLength,
+      bool random
+) {
+   if( random ) {
+      RandomPixelPairSampler< TPI >( object, mask, pixelPairFunction, distribution, counts, nProbes, maxLength );
+   } else {
+      GridPixelPairSampler< TPI >( object, mask, pixelPairFunction, distribution, counts, nProbes, maxLength );
    }
 }
 
@@ -213,61 +241,60 @@ namespace {
 
 using PhaseLookupTable = std::unordered_map< dip::uint, dip::uint >;
 
-class PairCorrelationFunction : public PixelPairFunction {
+template< typename TPI >
+class PairCorrelationFunction {
    public:
-      virtual void UpdateRandom(
-            UnsignedArray const& coords1,
-            UnsignedArray const& coords2,
-            dip::uint distance
-      ) override {
-         UpdateGrid( object_.Pointer( coords1 ), object_.Pointer( coords2 ), distance );
-      }
-
-      virtual void UpdateGrid(
-            void const* dataPtr1,
-            void const* dataPtr2,
+      void Update(
+            Distribution& distribution,         // distribution.Rows()==nPhases
+            TPI const* dataPtr1,
+            TPI const* dataPtr2,
             dip::uint distance
-      ) override {
-         dip::uint phase1 = GetUIntPixelValue_( dataPtr1 );
-         dip::uint phase2 = GetUIntPixelValue_( dataPtr2 );
-         ++( counts_[ distance ] );
+      ) const {
+         dip::uint phase1 = static_cast< dip::uint >( *dataPtr1 );
+         dip::uint phase2 = static_cast< dip::uint >( *dataPtr2 );
          dip::uint index1 = phaseLookupTable_.at( phase1 );
          if( covariance_ ) {
             if( phase1 == phase2 ) {
-               distribution_[ distance ].Y( index1, index1 ) += 1.0;
+               distribution[ distance ].Y( index1, index1 ) += 1.0;
             } else {
                dip::uint index2 = phaseLookupTable_.at( phase2 );
                // To make sure the matrix remains symmetric, we assign half the hit to each phase.
-               distribution_[ distance ].Y( index1, index2 ) += 0.5;
-               distribution_[ distance ].Y( index2, index1 ) += 0.5;
+               distribution[ distance ].Y( index1, index2 ) += 0.5;
+               distribution[ distance ].Y( index2, index1 ) += 0.5;
             }
          } else {
             if( phase1 == phase2 ) {
-               distribution_[ distance ].Y( index1 ) += 1.0;
+               distribution[ distance ].Y( index1 ) += 1.0;
             }
          }
       }
 
       PairCorrelationFunction(
-            Image const& object,
-            Distribution& distribution,         // distribution.Rows()==nPhases
-            std::vector< dip::uint >& counts,
             PhaseLookupTable const& phaseLookupTable,
             bool covariance                     // if true, distribution.Columns()==nPhases, otherwise distribution.Columns()==1
-      ) : object_( object ), distribution_( distribution ), counts_( counts ), phaseLookupTable_( phaseLookupTable ),
-          covariance_( covariance ) {
-         DIP_OVL_ASSIGN_UINT( GetUIntPixelValue_, UIntPixelValueReader, object.DataType() );
-      }
+      ) : phaseLookupTable_( phaseLookupTable ), covariance_( covariance ) {}
 
    private:
-      Image const& object_;
-      Distribution& distribution_;
-      std::vector< dip::uint >& counts_;
       PhaseLookupTable const& phaseLookupTable_;
       bool covariance_;
-      UIntPixelValueReaderFunction GetUIntPixelValue_;
 };
 
+template< typename TPI >
+void PairCorrelationSampler(
+      Image const& object,
+      Image const& mask,
+      PhaseLookupTable const& phaseLookupTable,
+      bool covariance,
+      Distribution& distribution,
+      std::vector< dip::uint >& counts,
+      dip::uint probes,
+      dip::uint length,
+      bool random
+) {
+   PairCorrelationFunction< TPI > pixelPairFunction( phaseLookupTable, covariance );
+   PixelPairSampler< TPI >( object, mask, pixelPairFunction, distribution, counts, probes, length, random );
+}
+
 enum class PairCorrelationNormalization{ None, Volume, VolumeSquare };
 
 std::pair< bool, PairCorrelationNormalization > ParsePairCorrelationOptions( StringSet const& options ) {
@@ -373,12 +400,9 @@ Distribution PairCorrelation(
    std::vector< dip::uint >counts( length + 1, 0 );
 
    // Fill output
-   PairCorrelationFunction pixelPairFunction( object, distribution, counts, phaseLookupTable, covariance );
-   if( random ) {
-      RandomPixelPairSampler( object, mask, &pixelPairFunction, probes, length );
-   } else {
-      GridPixelPairSampler( object, mask, &pixelPairFunction, probes, length );
-   }
+   DIP_OVL_CALL_UINT( PairCorrelationSampler,
+                      ( object, mask, phaseLookupTable, covariance, distribution, counts, probes, length, random ),
+                      object.DataType() );
 
    // Process the intermediate output results
    NormalizeDistribution( distribution, counts );
@@ -393,61 +417,61 @@ Distribution PairCorrelation(
 
 namespace {
 
-class ProbabilisticPairCorrelationFunction : public PixelPairFunction {
+template< typename TPI >
+class ProbabilisticPairCorrelationFunction {
    public:
-      virtual void UpdateRandom(
-            UnsignedArray const& coords1,
-            UnsignedArray const& coords2,
-            dip::uint distance
-      ) override {
-         UpdateGrid( phases_.Pointer( coords1 ), phases_.Pointer( coords2 ), distance );
-      }
-
-      virtual void UpdateGrid(
-            void const* dataPtr1,
-            void const* dataPtr2,
+      void Update(
+            Distribution& distribution,         // distribution.Rows()==nPhases
+            TPI const* dataPtr1,
+            TPI const* dataPtr2,
             dip::uint distance
-      ) override {
-         ++( counts_[ distance ] );
+      ) const {
          if( covariance_ ) {
             for( dip::uint phase1 = 0; phase1 < nPhases_; ++phase1 ) {
-               dfloat prob1 = GetFloatPixelValue_( dataPtr1, phases_.TensorStride() * static_cast< dip::sint >( phase1 ));
+               dfloat prob1 = static_cast< dfloat >( dataPtr1[ tensorStride_ * static_cast< dip::sint >( phase1 ) ] );
                for( dip::uint phase2 = phase1; phase2 < nPhases_; ++phase2 ) {
-                  dfloat prob2 = GetFloatPixelValue_( dataPtr2, phases_.TensorStride() * static_cast< dip::sint >( phase2 ));
-                  distribution_[ distance ].Y( phase1, phase2 ) += prob1 * prob2;
+                  dfloat prob2 = static_cast< dfloat >( dataPtr2[ tensorStride_ * static_cast< dip::sint >( phase2 ) ] );
+                  distribution[ distance ].Y( phase1, phase2 ) += prob1 * prob2;
                   if( phase1 != phase2 ) {
-                     distribution_[ distance ].Y( phase2, phase1 ) += prob1 * prob2;
+                     distribution[ distance ].Y( phase2, phase1 ) += prob1 * prob2;
                   }
                }
             }
          } else {
             for( dip::uint ii = 0; ii < nPhases_; ++ii ) {
-               dfloat prob1 = GetFloatPixelValue_( dataPtr1, phases_.TensorStride() * static_cast< dip::sint >( ii ));
-               dfloat prob2 = GetFloatPixelValue_( dataPtr2, phases_.TensorStride() * static_cast< dip::sint >( ii ));
-               distribution_[ distance ].Y( ii ) += prob1 * prob2;
+               dfloat prob1 = static_cast< dfloat >( dataPtr1[ tensorStride_ * static_cast< dip::sint >( ii ) ] );
+               dfloat prob2 = static_cast< dfloat >( dataPtr2[ tensorStride_ * static_cast< dip::sint >( ii ) ] );
+               distribution[ distance ].Y( ii ) += prob1 * prob2;
             }
          }
       }
 
       ProbabilisticPairCorrelationFunction(
             Image const& phases,
-            Distribution& distribution,         // distribution_.Rows()==nPhases
-            std::vector< dip::uint >& counts,
             bool covariance                     // if true, distribution.Columns()==nPhases, otherwise distribution.Columns()==1
-      ) : phases_( phases ), distribution_( distribution ), counts_( counts ), covariance_( covariance ) {
-         DIP_OVL_ASSIGN_FLOAT( GetFloatPixelValue_, FloatPixelValueReaderWithOffset, phases.DataType() );
-         nPhases_ = phases.TensorElements();
-      }
+      ) : nPhases_( phases.TensorElements() ), tensorStride_( phases.TensorStride() ), covariance_( covariance ) {}
 
    private:
-      Image const& phases_;
-      Distribution& distribution_;
-      std::vector< dip::uint >& counts_;
       dip::uint nPhases_;
+      dip::sint tensorStride_;
       bool covariance_;
-      FloatPixelValueReaderWithOffsetFunction GetFloatPixelValue_;
 };
 
+template< typename TPI >
+void ProbabilisticPairCorrelationSampler(
+      Image const& phases,
+      Image const& mask,
+      bool covariance,
+      Distribution& distribution,
+      std::vector< dip::uint >& counts,
+      dip::uint probes,
+      dip::uint length,
+      bool random
+) {
+   ProbabilisticPairCorrelationFunction< TPI > pixelPairFunction( phases, covariance );
+   PixelPairSampler< TPI >( phases, mask, pixelPairFunction, distribution, counts, probes, length, random );
+}
+
 } // namespace
 
 Distribution ProbabilisticPairCorrelation(
@@ -476,12 +500,9 @@ Distribution ProbabilisticPairCorrelation(
    std::vector< dip::uint >counts( length + 1, 0 );
 
    // Fill output
-   ProbabilisticPairCorrelationFunction pixelPairFunction( phases, distribution, counts, covariance );
-   if( random ) {
-      RandomPixelPairSampler( phases, mask, &pixelPairFunction, probes, length );
-   } else {
-      GridPixelPairSampler( phases, mask, &pixelPairFunction, probes, length );
-   }
+   DIP_OVL_CALL_FLOAT( ProbabilisticPairCorrelationSampler,
+                       ( phases, mask, covariance, distribution, counts, probes, length, random ),
+                       phases.DataType() );
 
    // Process the intermediate output results
    NormalizeDistribution( distribution, counts );
@@ -498,41 +519,33 @@ Distribution ProbabilisticPairCorrelation(
 
 namespace {
 
-class SemivariogramFunction : public PixelPairFunction {
+template< typename TPI >
+class SemivariogramFunction {
    public:
-      virtual void UpdateRandom(
-            UnsignedArray const& coords1,
-            UnsignedArray const& coords2,
-            dip::uint distance
-      ) override {
-         UpdateGrid( image_.Pointer( coords1 ), image_.Pointer( coords2 ), distance );
-      }
-
-      virtual void UpdateGrid(
-            void const* dataPtr1,
-            void const* dataPtr2,
+      void Update(
+            Distribution& distribution,
+            TPI const* dataPtr1,
+            TPI const* dataPtr2,
             dip::uint distance
-      ) override {
-         ++( counts_[ distance ] );
-         dfloat diff = GetFloatPixelValue_( dataPtr1 ) - GetFloatPixelValue_( dataPtr2 );
-         distribution_[ distance ].Y() += 0.5 * diff * diff;
+      ) const {
+         dfloat diff = static_cast< dfloat >( *dataPtr1 ) - static_cast< dfloat >( *dataPtr2 );
+         distribution[ distance ].Y() += 0.5 * diff * diff;
       }
-
-      SemivariogramFunction(
-            Image const& in,
-            Distribution& distribution,         // distribution_.Rows()==nPhases
-            std::vector< dip::uint >& counts
-      ) : image_( in ), distribution_( distribution ), counts_( counts ) {
-         DIP_OVL_ASSIGN_REAL( GetFloatPixelValue_, FloatPixelValueReader, in.DataType() );
-      }
-
-   private:
-      Image const& image_;
-      Distribution& distribution_;
-      std::vector< dip::uint >& counts_;
-      FloatPixelValueReaderFunction GetFloatPixelValue_;
 };
 
+template< typename TPI >
+void SemivariogramSampler(
+      Image const& in,
+      Image const& mask,
+      Distribution& distribution,
+      std::vector< dip::uint >& counts,
+      dip::uint probes,
+      dip::uint length,
+      bool random
+) {
+   PixelPairSampler< TPI >( in, mask, SemivariogramFunction< TPI >{}, distribution, counts, probes, length, random );
+}
+
 } // namespace
 
 Distribution Semivariogram(
@@ -557,12 +570,7 @@ Distribution Semivariogram(
    std::vector< dip::uint >counts( length + 1, 0 );
 
    // Fill output
-   SemivariogramFunction pixelPairFunction( in, distribution, counts );
-   if( random ) {
-      RandomPixelPairSampler( in, mask, &pixelPairFunction, probes, length );
-   } else {
-      GridPixelPairSampler( in, mask, &pixelPairFunction, probes, length );
-   }
+   DIP_OVL_CALL_REAL( SemivariogramSampler, ( in, mask, distribution, counts, probes, length, random ), in.DataType() );
 
    // Process the intermediate output results
    NormalizeDistribution( distribution, counts );
@@ -571,3 +579,45 @@ Distribution Semivariogram(
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the parallel pixel pair samplers") {
+   dip::Image img{ dip::UnsignedArray{ 300, 200 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random );
+   dip::Image object = img > 0.5;
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Distribution grid1 = dip::PairCorrelation( object, {}, 0, 10, dip::S::GRID, {} );
+   dip::Distribution semi1 = dip::Semivariogram( img, {}, 0, 10, dip::S::GRID );
+   dip::Distribution random1 = dip::PairCorrelation( object, {}, 200000, 10, dip::S::RANDOM, {} );
+   dip::Distribution randomSemi1 = dip::Semivariogram( img, {}, 200000, 10, dip::S::RANDOM );
+   dip::SetNumberOfThreads( 4 );
+   dip::Distribution grid4 = dip::PairCorrelation( object, {}, 0, 10, dip::S::GRID, {} );
+   dip::Distribution semi4 = dip::Semivariogram( img, {}, 0, 10, dip::S::GRID );
+   dip::Distribution random4 = dip::PairCorrelation( object, {}, 200000, 10, dip::S::RANDOM, {} );
+   dip::Distribution randomSemi4 = dip::Semivariogram( img, {}, 200000, 10, dip::S::RANDOM );
+   dip::SetNumberOfThreads( nThreads );
+   for( dip::uint ii = 0; ii < grid1.Size(); ++ii ) {
+      // Grid sampling visits the same pixel pairs independently of the number of threads
+      DOCTEST_CHECK( grid1[ ii ].Y( 0 ) == grid4[ ii ].Y( 0 ));
+      DOCTEST_CHECK( grid1[ ii ].Y( 1 ) == grid4[ ii ].Y( 1 ));
+      DOCTEST_CHECK( semi1[ ii ].Y() == doctest::Approx( semi4[ ii ].Y() ));
+      // Random sampling draws the same probes, and adds them up in the same order, independently of the number of threads
+      DOCTEST_CHECK( random1[ ii ].Y( 0 ) == random4[ ii ].Y( 0 ));
+      DOCTEST_CHECK( random1[ ii ].Y( 1 ) == random4[ ii ].Y( 1 ));
+      DOCTEST_CHECK( randomSemi1[ ii ].Y() == randomSemi4[ ii ].Y() );
+   }
+   // Each phase has a volume fraction of 0.5, and there is no correlation between pixels. Few probes have
+   // distance 0, so that bin is less precise than the others.
+   DOCTEST_CHECK( random4[ 0 ].Y( 1 ) == doctest::Approx( 0.5 ).epsilon( 0.1 ));
+   for( dip::uint ii = 1; ii < random4.Size(); ++ii ) {
+      DOCTEST_CHECK( random4[ ii ].Y( 1 ) == doctest::Approx( 0.25 ).epsilon( 0.1 ));
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
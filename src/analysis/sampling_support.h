@@ -0,0 +1,82 @@
+/*
+ * DIPlib 3.0
+ * This file contains support functions for pixel_pair_sampling.cpp and chord_length.cpp.
+ *
+ * (c)2018, Cris Luengo.
+ * Based on original DIPlib code: (c)1995-2014, Delft University of Technology.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_SAMPLING_SUPPORT_H
+#define DIP_SAMPLING_SUPPORT_H
+
+#include "diplib.h"
+#include "diplib/distribution.h"
+#include "diplib/multithreading.h"
+#include "diplib/random.h"
+
+namespace dip {
+
+// The random samplers divide the probes into this many chunks, each chunk drawing from its own random stream.
+// The chunks do not depend on the number of threads, so that a given seed always yields the same result.
+constexpr dip::uint randomSamplingChunks = 64;
+
+// The number of chunks to divide `nProbes` random probes into, each probe costing about `operationsPerProbe`.
+// Small problems use a single chunk, and thus the same random stream as the single-threaded implementation.
+inline dip::uint NumberOfRandomSamplingChunks( dip::uint nProbes, dip::uint operationsPerProbe ) {
+   if( nProbes * operationsPerProbe < threadingThreshold ) {
+      return 1;
+   }
+   return std::min( randomSamplingChunks, nProbes );
+}
+
+// One random stream for each of `nChunks` chunks, all derived from the same seed.
+inline std::vector< Random > RandomSamplingStreams( dip::uint nChunks ) {
+   std::vector< Random > streams( nChunks, Random( 0 ));
+   for( dip::uint ii = 1; ii < nChunks; ++ii ) {
+      streams[ ii ] = streams[ 0 ].Split();
+   }
+   return streams;
+}
+
+// Each chunk (or thread) accumulates into its own copy of `distribution` and `counts`, these are added together
+// here, in chunk order.
+inline void MergePartialResults(
+      Distribution& distribution,
+      std::vector< dip::uint >& counts,
+      std::vector< Distribution >& distributions,
+      std::vector< std::vector< dip::uint >>& countsArray
+) {
+   distribution = std::move( distributions[ 0 ] );
+   counts = std::move( countsArray[ 0 ] );
+   for( dip::uint ii = 1; ii < distributions.size(); ++ii ) {
+      distribution += distributions[ ii ];
+      for( dip::uint jj = 0; jj < counts.size(); ++jj ) {
+         counts[ jj ] += countsArray[ ii ][ jj ];
+      }
+   }
+}
+
+// The offset of the pixel at `coords` in an image with the given `strides`.
+inline dip::sint Offset( UnsignedArray const& coords, IntegerArray const& strides ) {
+   dip::sint offset = 0;
+   for( dip::uint ii = 0; ii < coords.size(); ++ii ) {
+      offset += static_cast< dip::sint >( coords[ ii ] ) * strides[ ii ];
+   }
+   return offset;
+}
+
+} // namespace dip
+
+#endif // DIP_SAMPLING_SUPPORT_H
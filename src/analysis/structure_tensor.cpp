@@ -24,6 +24,7 @@
 #include "diplib/statistics.h"
 #include "diplib/linear.h"
 #include "diplib/generic_iterators.h"
+#include "../linear/gauss_support.h"
 
 namespace dip {
 
@@ -198,7 +199,7 @@ void StructureTensorAnalysis3D(
       *l2 = ll[ 1 ];
    }
    if( l3 ) {
-      *l3 = ll[ 3 ];
+      *l3 = ll[ 2 ];
    }
    if( energy ) {
       Add( ll[ 0 ], ll[ 1 ], *energy );
@@ -307,6 +308,123 @@ void StructureTensorAnalysis(
    }
 }
 
+namespace {
+
+// Returns true if `StructureTensor` with these parameters uses only FIR filters, such that each output pixel
+// depends only on a finite neighborhood. See `GaussDispatch` in derivative.cpp.
+bool UsesFIRFilters( FloatArray const& gradientSigmas, FloatArray const& tensorSigmas, String const& method ) {
+   if(( method == "gaussFIR" ) || ( method == "gaussfir" )) {
+      return true;
+   }
+   if( method != S::BEST ) {
+      return false;
+   }
+   for( auto const& sigmas : { gradientSigmas, tensorSigmas } ) {
+      for( dfloat s : sigmas ) {
+         if(( s > 0.0 ) && (( s < 0.8 ) || ( s > 10.0 ))) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+// The number of pixels we aim to process in one slab. This is a variable so that the tests can change it.
+dip::uint structureTensorSlabPixels = 1u << 21;
+
+} // namespace
+
+void FusedStructureTensorAnalysis(
+      Image const& in,
+      Image const& mask,
+      ImageRefArray& out,
+      StringArray const& outputs,
+      FloatArray const& gradientSigmas,
+      FloatArray const& tensorSigmas,
+      String const& method,
+      StringArray const& boundaryCondition,
+      dfloat truncation
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   dip::uint nDims = in.Dimensionality();
+   DIP_THROW_IF(( nDims < 2 ) || ( nDims > 3 ), E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF( mask.IsForged() && ( mask.Sizes() != in.Sizes() ), E::SIZES_DONT_MATCH );
+   dip::uint nOut = out.size();
+   DIP_THROW_IF( outputs.size() != nOut, E::ARRAY_SIZES_DONT_MATCH );
+   FloatArray gSigmas = gradientSigmas;
+   FloatArray tSigmas = tensorSigmas;
+   DIP_START_STACK_TRACE
+      ArrayUseParameter( gSigmas, nDims, 1.0 );
+      ArrayUseParameter( tSigmas, nDims, 5.0 );
+   DIP_END_STACK_TRACE
+   // Determine the slab size, and the halo: how many pixels on either side of a slab influence its result.
+   dip::uint lastDim = nDims - 1;
+   dip::uint size = in.Size( lastDim );
+   dfloat firTruncation = GaussianTruncation( truncation ); // The truncation used by `dip::GaussFIR`
+   dip::uint tensorHalo = HalfGaussianSize( gSigmas[ lastDim ], 1, firTruncation ) + HalfGaussianSize( tSigmas[ lastDim ], 0, firTruncation );
+   dip::uint analysisHalo = 0;
+   if( std::find( outputs.begin(), outputs.end(), "curvature" ) != outputs.end() ) {
+      analysisHalo = HalfGaussianSize( 1.0, 1, 3.0 ); // The derivatives taken in `StructureTensorAnalysis2D`
+   }
+   dip::uint halo = tensorHalo + analysisHalo;
+   dip::uint slabSize = std::max( 4 * halo, div_ceil( structureTensorSlabPixels, in.NumberOfPixels() / size ));
+   if( !UsesFIRFilters( gSigmas, tSigmas, method ) || ( slabSize >= size )) {
+      Image st;
+      DIP_STACK_TRACE_THIS( StructureTensor( in, mask, st, gSigmas, tSigmas, method, boundaryCondition, truncation ));
+      DIP_STACK_TRACE_THIS( StructureTensorAnalysis( st, out, outputs ));
+      return;
+   }
+   // The output images are written to slab by slab, they must not share data with the input
+   Image c_in = in;
+   Image c_mask = mask;
+   for( dip::uint ii = 0; ii < nOut; ++ii ) {
+      Image& img = out[ ii ].get();
+      if( img.Aliases( c_in ) || ( c_mask.IsForged() && img.Aliases( c_mask ))) {
+         DIP_STACK_TRACE_THIS( img.Strip() );
+      }
+   }
+   // Process slabs
+   RangeArray inRanges( nDims );
+   RangeArray tensorRanges( nDims );
+   RangeArray analysisRanges( nDims );
+   RangeArray outRanges( nDims );
+   ImageArray slabOut( nOut );
+   ImageRefArray slabOutRef = CreateImageRefArray( slabOut );
+   for( dip::uint start = 0; start < size; start += slabSize ) {
+      dip::uint stop = std::min( start + slabSize, size ); // one past the end
+      // Structure tensor for the slab plus its halo
+      dip::uint inStart = start > halo ? start - halo : 0;
+      dip::uint inStop = std::min( stop + halo, size );
+      inRanges[ lastDim ] = Range( static_cast< dip::sint >( inStart ), static_cast< dip::sint >( inStop - 1 ));
+      Image slabIn = c_in.At( inRanges );
+      Image slabMask;
+      if( c_mask.IsForged() ) {
+         slabMask = c_mask.At( inRanges );
+      }
+      Image st;
+      DIP_STACK_TRACE_THIS( StructureTensor( slabIn, slabMask, st, gSigmas, tSigmas, method, boundaryCondition, truncation ));
+      // Analysis on the part of the structure tensor that is correct
+      dip::uint tensorStart = start > analysisHalo ? start - analysisHalo : 0;
+      dip::uint tensorStop = std::min( stop + analysisHalo, size );
+      tensorRanges[ lastDim ] = Range( static_cast< dip::sint >( tensorStart - inStart ), static_cast< dip::sint >( tensorStop - 1 - inStart ));
+      Image slabTensor = st.At( tensorRanges );
+      DIP_STACK_TRACE_THIS( StructureTensorAnalysis( slabTensor, slabOutRef, outputs ));
+      // Copy the part of the analysis output that is correct to the output images
+      analysisRanges[ lastDim ] = Range( static_cast< dip::sint >( start - tensorStart ), static_cast< dip::sint >( stop - 1 - tensorStart ));
+      outRanges[ lastDim ] = Range( static_cast< dip::sint >( start ), static_cast< dip::sint >( stop - 1 ));
+      for( dip::uint ii = 0; ii < nOut; ++ii ) {
+         Image& img = out[ ii ].get();
+         if( start == 0 ) {
+            DIP_STACK_TRACE_THIS( img.ReForge( c_in.Sizes(), 1, slabOut[ ii ].DataType(), Option::AcceptDataTypeChange::DO_ALLOW ));
+            img.SetPixelSize( c_in.PixelSize() );
+         }
+         DIP_STACK_TRACE_THIS( img.At( outRanges ).Copy( slabOut[ ii ].At( analysisRanges )));
+      }
+   }
+}
+
 Distribution StructureAnalysis(
       Image const& in,
       Image const& mask,
@@ -360,3 +478,47 @@ Distribution StructureAnalysis(
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing FusedStructureTensorAnalysis") {
+   dip::uint slabPixels = dip::structureTensorSlabPixels;
+   dip::structureTensorSlabPixels = 1000; // Force many small slabs
+   dip::Random random( 0 );
+   // 2D
+   dip::Image img( { 50, 120 }, 1, dip::DT_SFLOAT );
+   img.Fill( 0 );
+   dip::UniformNoise( img, img, random, 0.0, 100.0 );
+   dip::StringArray outputs{ "energy", "orientation", "anisotropy1", "curvature" };
+   dip::ImageArray expected = dip::StructureTensorAnalysis( dip::StructureTensor( img, {}, { 1.0 }, { 3.0 } ), outputs );
+   dip::ImageArray result = dip::FusedStructureTensorAnalysis( img, {}, outputs, { 1.0 }, { 3.0 } );
+   DOCTEST_REQUIRE( result.size() == outputs.size() );
+   for( dip::uint ii = 0; ii < outputs.size(); ++ii ) {
+      DOCTEST_CHECK( result[ ii ].Sizes() == img.Sizes() );
+      DOCTEST_CHECK( dip::testing::CompareImages( result[ ii ], expected[ ii ], dip::Option::CompareImagesMode::APPROX, 1e-3 ));
+   }
+   // A truncation of 0 selects the default truncation, this determines the overlap between the slabs
+   expected = dip::StructureTensorAnalysis( dip::StructureTensor( img, {}, { 1.0 }, { 3.0 }, dip::S::BEST, {}, 0.0 ), outputs );
+   result = dip::FusedStructureTensorAnalysis( img, {}, outputs, { 1.0 }, { 3.0 }, dip::S::BEST, {}, 0.0 );
+   for( dip::uint ii = 0; ii < outputs.size(); ++ii ) {
+      DOCTEST_CHECK( dip::testing::CompareImages( result[ ii ], expected[ ii ], dip::Option::CompareImagesMode::APPROX, 1e-3 ));
+   }
+   // 3D, with a mask
+   img = dip::Image( { 20, 15, 60 }, 1, dip::DT_SFLOAT );
+   img.Fill( 0 );
+   dip::UniformNoise( img, img, random, 0.0, 100.0 );
+   dip::Image mask = img > 20;
+   outputs = { "l1", "l3", "cylindrical", "phi1" };
+   expected = dip::StructureTensorAnalysis( dip::StructureTensor( img, mask, { 1.0 }, { 2.0 } ), outputs );
+   result = dip::FusedStructureTensorAnalysis( img, mask, outputs, { 1.0 }, { 2.0 } );
+   for( dip::uint ii = 0; ii < outputs.size(); ++ii ) {
+      DOCTEST_CHECK( dip::testing::CompareImages( result[ ii ], expected[ ii ], dip::Option::CompareImagesMode::APPROX, 1e-3 ));
+   }
+   dip::structureTensorSlabPixels = slabPixels;
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -0,0 +1,607 @@
+/*
+ * DIPlib 3.0
+ * This file contains the bit-packed binary image and the binary morphology functions that work on it.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+
+#include "diplib.h"
+#include "diplib/packed_binary.h"
+#include "diplib/iterators.h"
+#include "diplib/multithreading.h"
+#include "binary_support.h"
+
+namespace dip {
+
+using Word = PackedBinaryImage::Word;
+
+constexpr dip::uint PackedBinaryImage::bitsPerWord;
+
+namespace {
+
+constexpr dip::uint bitsPerWord = PackedBinaryImage::bitsPerWord;
+constexpr Word allOnes = ~Word( 0 );
+
+inline dip::uint PopCount( Word word ) {
+#if defined(__GNUC__) || defined(__clang__)
+   return static_cast< dip::uint >( __builtin_popcountll( word ));
+#else
+   word = word - (( word >> 1 ) & 0x5555555555555555u );
+   word = ( word & 0x3333333333333333u ) + (( word >> 2 ) & 0x3333333333333333u );
+   word = ( word + ( word >> 4 )) & 0x0F0F0F0F0F0F0F0Fu;
+   return static_cast< dip::uint >(( word * 0x0101010101010101u ) >> 56 );
+#endif
+}
+
+// Computes the number of threads to use for processing `nRows` rows, where each row costs `operations`.
+dip::uint NumberOfThreadsForRows( dip::uint nRows, dip::uint operations ) {
+   if( nRows * operations >= threadingThreshold ) {
+      return std::min( GetNumberOfThreads(), nRows );
+   }
+   return 1;
+}
+
+// Calls `function( first, last )` for each of `nThreads` contiguous ranges of rows, using `dip::ParallelFor`.
+template< typename F >
+void ForEachRowRange( dip::uint nRows, dip::uint nThreads, F const& function ) {
+   ParallelFor( nThreads, [ & ]( dip::uint thread ) {
+      function( nRows * thread / nThreads, nRows * ( thread + 1 ) / nThreads );
+   } );
+}
+
+// A neighboring row: its offset in each of the dimensions 1 and up, and the corresponding offset in row index.
+struct RowNeighbor {
+   IntegerArray offset;
+   dip::sint delta;
+   dip::uint nonZero;   // number of non-zero elements in `offset`
+};
+
+// Lists all rows within the 3x3x... neighborhood of a row, including the row itself.
+std::vector< RowNeighbor > RowNeighborhood( UnsignedArray const& sizes ) {
+   dip::uint nDims = sizes.size();
+   std::vector< RowNeighbor > neighbors;
+   IntegerArray offset( nDims - 1, -1 );
+   while( true ) {
+      RowNeighbor neighbor{ offset, 0, 0 };
+      dip::sint stride = 1;
+      for( dip::uint ii = 0; ii < nDims - 1; ++ii ) {
+         neighbor.delta += offset[ ii ] * stride;
+         stride *= static_cast< dip::sint >( sizes[ ii + 1 ] );
+         if( offset[ ii ] != 0 ) {
+            ++neighbor.nonZero;
+         }
+      }
+      neighbors.push_back( neighbor );
+      dip::uint ii = 0;
+      for( ; ii < nDims - 1; ++ii ) {
+         if( offset[ ii ] < 1 ) {
+            ++offset[ ii ];
+            break;
+         }
+         offset[ ii ] = -1;
+      }
+      if( ii == nDims - 1 ) {
+         break;
+      }
+   }
+   return neighbors;
+}
+
+// Returns true if the row with coordinates `coords` (for dimensions 1 and up) plus `offset` is inside the image.
+inline bool RowIsInImage( UnsignedArray const& coords, IntegerArray const& offset, UnsignedArray const& sizes ) {
+   for( dip::uint ii = 0; ii < offset.size(); ++ii ) {
+      dip::sint pos = static_cast< dip::sint >( coords[ ii ] ) + offset[ ii ];
+      if(( pos < 0 ) || ( pos >= static_cast< dip::sint >( sizes[ ii + 1 ] ))) {
+         return false;
+      }
+   }
+   return true;
+}
+
+// Computes the coordinates of row `index` for dimensions 1 and up.
+inline void RowCoordinates( dip::uint index, UnsignedArray const& sizes, UnsignedArray& coords ) {
+   for( dip::uint ii = 0; ii < coords.size(); ++ii ) {
+      coords[ ii ] = index % sizes[ ii + 1 ];
+      index /= sizes[ ii + 1 ];
+   }
+}
+
+// Dilation (or erosion) of a row with the 3-pixel horizontal line. `edge` is the value of the pixels just
+// outside the row.
+template< bool DILATE >
+void HorizontalPass( Word const* in, Word* out, dip::uint nWords, Word lastMask, Word edge ) {
+   for( dip::uint ii = 0; ii < nWords; ++ii ) {
+      Word word = in[ ii ];
+      Word next = ii + 1 < nWords ? in[ ii + 1 ] : edge;
+      if( ii + 1 == nWords ) {
+         word = ( word & lastMask ) | ( edge & ~lastMask ); // the padding bits get the edge value
+      }
+      Word prev = ii > 0 ? in[ ii - 1 ] : edge;
+      Word left = ( word << 1 ) | ( prev >> ( bitsPerWord - 1 ));    // the value of pixel x-1 at position x
+      Word right = ( word >> 1 ) | ( next << ( bitsPerWord - 1 ));   // the value of pixel x+1 at position x
+      out[ ii ] = DILATE ? ( word | left | right ) : ( word & left & right );
+   }
+   out[ nWords - 1 ] &= lastMask;
+}
+
+// One iteration of the dilation (or erosion) with the given connectivity. A neighbor row at a distance of
+// `connectivity` (in number of dimensions) contributes only the pixel directly above, closer rows contribute
+// the horizontal 3-pixel neighborhood, which we compute once for the whole image into `horizontal`.
+template< bool DILATE >
+void MorphologyIteration(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      PackedBinaryImage& horizontal,
+      std::vector< RowNeighbor > const& neighborhood,
+      dip::uint connectivity,
+      bool edgeCondition
+) {
+   UnsignedArray const& sizes = in.Sizes();
+   dip::uint nRows = in.NumberOfRows();
+   dip::uint nWords = in.WordsPerRow();
+   Word lastMask = in.LastWordMask();
+   Word edge = edgeCondition ? allOnes : 0;
+   dip::uint nThreads = NumberOfThreadsForRows( nRows, nWords * neighborhood.size() );
+   ForEachRowRange( nRows, nThreads, [ & ]( dip::uint first, dip::uint last ) {
+      for( dip::uint row = first; row < last; ++row ) {
+         HorizontalPass< DILATE >( in.Row( row ), horizontal.Row( row ), nWords, lastMask, edge );
+      }
+   } );
+   // The second pass reads rows of `horizontal` written by other threads in the first pass
+   ForEachRowRange( nRows, nThreads, [ & ]( dip::uint first, dip::uint last ) {
+      UnsignedArray coords( sizes.size() - 1 );
+      for( dip::uint row = first; row < last; ++row ) {
+         Word* dest = out.Row( row );
+         std::fill( dest, dest + nWords, DILATE ? Word( 0 ) : allOnes );
+         RowCoordinates( row, sizes, coords );
+         for( auto const& neighbor : neighborhood ) {
+            if( neighbor.nonZero > connectivity ) {
+               continue;
+            }
+            if( !RowIsInImage( coords, neighbor.offset, sizes )) {
+               if( DILATE == edgeCondition ) {
+                  // The edge determines the result for this row
+                  std::fill( dest, dest + nWords, edge );
+                  break;
+               }
+               continue; // The edge doesn't change the result
+            }
+            dip::uint index = static_cast< dip::uint >( static_cast< dip::sint >( row ) + neighbor.delta );
+            Word const* src = neighbor.nonZero < connectivity ? horizontal.Row( index ) : in.Row( index );
+            for( dip::uint ii = 0; ii < nWords; ++ii ) {
+               dest[ ii ] = DILATE ? ( dest[ ii ] | src[ ii ] ) : ( dest[ ii ] & src[ ii ] );
+            }
+         }
+         dest[ nWords - 1 ] &= lastMask;
+      }
+   } );
+}
+
+template< bool DILATE >
+void PackedDilationErosion(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity,
+      dip::uint iterations,
+      String const& s_edgeCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   dip::uint nDims = in.Dimensionality();
+   DIP_THROW_IF( connectivity > static_cast< dip::sint >( nDims ), E::ILLEGAL_CONNECTIVITY );
+   bool edgeCondition;
+   DIP_STACK_TRACE_THIS( edgeCondition = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND ));
+   dip::uint connectivity0;
+   dip::uint connectivity1;
+   DIP_START_STACK_TRACE
+      connectivity0 = GetAbsBinaryConnectivity( nDims, connectivity, 0 );
+      connectivity1 = GetAbsBinaryConnectivity( nDims, connectivity, 1 );
+   DIP_END_STACK_TRACE
+   if( connectivity0 == 0 ) {
+      connectivity0 = nDims;
+   }
+   if( connectivity1 == 0 ) {
+      connectivity1 = nDims;
+   }
+   if( iterations == 0 ) {
+      out = in;
+      return;
+   }
+   std::vector< RowNeighbor > neighborhood = RowNeighborhood( in.Sizes() );
+   PackedBinaryImage horizontal( in.Sizes() );
+   PackedBinaryImage buffer( in.Sizes() );
+   // We alternate between `buffer` and `out`, such that the last iteration writes into `out`
+   PackedBinaryImage tmp;
+   if( &in == &out ) {
+      tmp = in;
+   }
+   PackedBinaryImage const& input = ( &in == &out ) ? tmp : in;
+   out.ReForge( in.Sizes() );
+   PackedBinaryImage* dest = ( iterations & 1 ) ? &out : &buffer;
+   PackedBinaryImage* src = ( iterations & 1 ) ? &buffer : &out;
+   MorphologyIteration< DILATE >( input, *dest, horizontal, neighborhood, connectivity0, edgeCondition );
+   for( dip::uint ii = 1; ii < iterations; ++ii ) {
+      std::swap( dest, src );
+      MorphologyIteration< DILATE >( *src, *dest, horizontal, neighborhood, ii & 1 ? connectivity1 : connectivity0, edgeCondition );
+   }
+   DIP_ASSERT( dest == &out );
+}
+
+} // namespace
+
+
+PackedBinaryImage::PackedBinaryImage( Image const& image ) {
+   DIP_THROW_IF( !image.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !image.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !image.DataType().IsBinary(), E::IMAGE_NOT_BINARY );
+   UnsignedArray sizes = image.Sizes();
+   Image tmp = image.QuickCopy();
+   if( sizes.empty() ) {
+      sizes = { 1 };
+      tmp.AddSingleton( 0 );
+   }
+   ReForge( sizes );
+   dip::sint stride = tmp.Stride( 0 );
+   dip::uint length = sizes[ 0 ];
+   ImageIterator< bin > it( tmp, 0 );
+   dip::uint row = 0;
+   do {
+      bin const* in = it.Pointer();
+      Word* out = Row( row );
+      for( dip::uint ii = 0; ii < length; ii += bitsPerWord ) {
+         dip::uint n = std::min( length - ii, bitsPerWord );
+         Word word = 0;
+         for( dip::uint jj = 0; jj < n; ++jj, in += stride ) {
+            word |= Word( static_cast< bool >( *in )) << jj;
+         }
+         *out++ = word;
+      }
+      ++row;
+   } while( ++it );
+}
+
+void PackedBinaryImage::Unpack( Image& out ) const {
+   DIP_THROW_IF( !IsForged(), "Packed binary image is empty" );
+   if( out.IsProtected() && ( out.DataType() != DT_BIN )) {
+      Image tmp;
+      Unpack( tmp );
+      DIP_STACK_TRACE_THIS( out.Copy( tmp ));
+      return;
+   }
+   DIP_STACK_TRACE_THIS( out.ReForge( sizes_, 1, DT_BIN ));
+   dip::sint stride = out.Stride( 0 );
+   dip::uint length = sizes_[ 0 ];
+   ImageIterator< bin > it( out, 0 );
+   dip::uint row = 0;
+   do {
+      bin* ptr = it.Pointer();
+      Word const* in = Row( row );
+      for( dip::uint ii = 0; ii < length; ii += bitsPerWord ) {
+         dip::uint n = std::min( length - ii, bitsPerWord );
+         Word word = *in++;
+         for( dip::uint jj = 0; jj < n; ++jj, ptr += stride ) {
+            *ptr = static_cast< bool >(( word >> jj ) & 1u );
+         }
+      }
+      ++row;
+   } while( ++it );
+}
+
+void PackedBinaryImage::ReForge( UnsignedArray const& sizes, bool value ) {
+   DIP_THROW_IF( sizes.empty(), E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF( sizes.product() == 0, "Image sizes must be non-zero" );
+   sizes_ = sizes;
+   wordsPerRow_ = div_ceil( sizes[ 0 ], bitsPerWord );
+   data_.assign( wordsPerRow_ * ( sizes.product() / sizes[ 0 ] ), 0 );
+   if( value ) {
+      Fill( true );
+   }
+}
+
+void PackedBinaryImage::Fill( bool value ) {
+   if( !value ) {
+      std::fill( data_.begin(), data_.end(), Word( 0 ));
+      return;
+   }
+   std::fill( data_.begin(), data_.end(), allOnes );
+   Word lastMask = LastWordMask();
+   for( dip::uint ii = wordsPerRow_ - 1; ii < data_.size(); ii += wordsPerRow_ ) {
+      data_[ ii ] = lastMask;
+   }
+}
+
+dip::uint PackedBinaryImage::Count() const {
+   dip::uint count = 0;
+   for( Word word : data_ ) {
+      count += PopCount( word );
+   }
+   return count;
+}
+
+
+void BinaryDilation(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity,
+      dip::uint iterations,
+      String const& edgeCondition
+) {
+   PackedDilationErosion< true >( in, out, connectivity, iterations, edgeCondition );
+}
+
+void BinaryErosion(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity,
+      dip::uint iterations,
+      String const& edgeCondition
+) {
+   PackedDilationErosion< false >( in, out, connectivity, iterations, edgeCondition );
+}
+
+void BinaryOpening(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity,
+      dip::uint iterations,
+      String const& edgeCondition
+) {
+   if( edgeCondition == S::BACKGROUND || edgeCondition == S::OBJECT ) {
+      BinaryErosion( in, out, connectivity, iterations, edgeCondition );
+      BinaryDilation( out, out, connectivity, iterations, edgeCondition );
+   } else {
+      // "Special handling"
+      if( edgeCondition != S::SPECIAL ) {
+         DIP_THROW_INVALID_FLAG( edgeCondition );
+      }
+      BinaryErosion( in, out, connectivity, iterations, S::OBJECT );
+      BinaryDilation( out, out, connectivity, iterations, S::BACKGROUND );
+   }
+}
+
+void BinaryClosing(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity,
+      dip::uint iterations,
+      String const& edgeCondition
+) {
+   if( edgeCondition == S::BACKGROUND || edgeCondition == S::OBJECT ) {
+      BinaryDilation( in, out, connectivity, iterations, edgeCondition );
+      BinaryErosion( out, out, connectivity, iterations, edgeCondition );
+   } else {
+      // "Special handling"
+      if( edgeCondition != S::SPECIAL ) {
+         DIP_THROW_INVALID_FLAG( edgeCondition );
+      }
+      BinaryDilation( in, out, connectivity, iterations, S::BACKGROUND );
+      BinaryErosion( out, out, connectivity, iterations, S::OBJECT );
+   }
+}
+
+
+void CountNeighbors(
+      PackedBinaryImage const& in,
+      Image& out,
+      dip::uint connectivity,
+      dip::String const& s_mode,
+      dip::String const& s_edgeCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   dip::uint nDims = in.Dimensionality();
+   DIP_THROW_IF( connectivity > nDims, E::ILLEGAL_CONNECTIVITY );
+   bool all;
+   bool edgeCondition;
+   DIP_START_STACK_TRACE
+      all = BooleanFromString( s_mode, S::ALL, S::FOREGROUND );
+      edgeCondition = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND );
+   DIP_END_STACK_TRACE
+   if( connectivity == 0 ) {
+      connectivity = nDims;
+   }
+   UnsignedArray const& sizes = in.Sizes();
+   DIP_STACK_TRACE_THIS( out.ReForge( sizes, 1, DT_UINT8 ));
+   std::vector< RowNeighbor > neighborhood = RowNeighborhood( sizes );
+   dip::uint nRows = in.NumberOfRows();
+   dip::uint nWords = in.WordsPerRow();
+   dip::uint length = sizes[ 0 ];
+   Word lastMask = in.LastWordMask();
+   Word edge = edgeCondition ? allOnes : 0;
+   // Each pixel gets a counter of `nPlanes` bits, bit `p` of all 64 counters of a word is stored in `planes[ p ]`.
+   // The largest neighborhood in 5D has 243 pixels, larger counts overflow the 8-bit output anyway.
+   constexpr dip::uint nPlanes = 8;
+   ImageIterator< uint8 > outIt( out, 0 );
+   dip::sint outStride = out.Stride( 0 );
+   std::vector< uint8* > outRows( nRows );
+   dip::uint index = 0;
+   do {
+      outRows[ index++ ] = outIt.Pointer();
+   } while( ++outIt );
+   dip::uint nThreads = NumberOfThreadsForRows( nRows, nWords * 3 * neighborhood.size() * nPlanes );
+   ForEachRowRange( nRows, nThreads, [ & ]( dip::uint first, dip::uint last ) {
+      // A copy of the neighbor row, with one extra word at each end, and the padding bits set to the edge value
+      std::vector< Word > padded( nWords + 2 );
+      std::vector< std::array< Word, nPlanes >> counts( nWords );
+      UnsignedArray coords( nDims - 1 );
+      for( dip::uint row = first; row < last; ++row ) {
+         for( auto& c : counts ) {
+            c.fill( 0 );
+         }
+         auto add = [ & ]( dip::uint ii, Word word ) {
+            // Bit-sliced increment of the counters for the bits set in `word`
+            for( dip::uint p = 0; ( p < nPlanes ) && word; ++p ) {
+               Word carry = counts[ ii ][ p ] & word;
+               counts[ ii ][ p ] ^= word;
+               word = carry;
+            }
+         };
+         RowCoordinates( row, sizes, coords );
+         for( auto const& neighbor : neighborhood ) {
+            if( neighbor.nonZero > connectivity ) {
+               continue;
+            }
+            if( RowIsInImage( coords, neighbor.offset, sizes )) {
+               Word const* src = in.Row( static_cast< dip::uint >( static_cast< dip::sint >( row ) + neighbor.delta ));
+               padded[ 0 ] = edge;
+               std::copy( src, src + nWords, padded.begin() + 1 );
+               padded[ nWords ] = ( padded[ nWords ] & lastMask ) | ( edge & ~lastMask );
+               padded[ nWords + 1 ] = edge;
+            } else {
+               std::fill( padded.begin(), padded.end(), edge );
+            }
+            bool horizontal = neighbor.nonZero < connectivity;
+            for( dip::uint ii = 0; ii < nWords; ++ii ) {
+               Word center = padded[ ii + 1 ];
+               if( neighbor.nonZero > 0 ) {
+                  add( ii, center );
+               }
+               if( horizontal ) {
+                  add( ii, ( center << 1 ) | ( padded[ ii ] >> ( bitsPerWord - 1 )));
+                  add( ii, ( center >> 1 ) | ( padded[ ii + 2 ] << ( bitsPerWord - 1 )));
+               }
+            }
+         }
+         // The pixel itself
+         Word const* self = in.Row( row );
+         for( dip::uint ii = 0; ii < nWords; ++ii ) {
+            add( ii, self[ ii ] );
+            if( !all ) {
+               for( auto& plane : counts[ ii ] ) {
+                  plane &= self[ ii ];
+               }
+            }
+         }
+         // Write out the counters
+         uint8* ptr = outRows[ row ];
+         for( dip::uint ii = 0; ii < nWords; ++ii ) {
+            dip::uint n = std::min( length - ii * bitsPerWord, bitsPerWord );
+            for( dip::uint jj = 0; jj < n; ++jj, ptr += outStride ) {
+               uint8 value = 0;
+               for( dip::uint p = 0; p < nPlanes; ++p ) {
+                  value = static_cast< uint8 >( value | ((( counts[ ii ][ p ] >> jj ) & 1u ) << p ));
+               }
+               *ptr = value;
+            }
+         }
+      }
+   } );
+}
+
+
+namespace {
+
+template< typename F >
+void PackedLogicalOperator( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs, PackedBinaryImage& out, F const& func ) {
+   DIP_THROW_IF( !lhs.IsForged() || !rhs.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( lhs.Sizes() != rhs.Sizes(), E::SIZES_DONT_MATCH );
+   if(( &out != &lhs ) && ( &out != &rhs )) {
+      out.ReForge( lhs.Sizes() );
+   }
+   dip::uint n = lhs.NumberOfRows() * lhs.WordsPerRow();
+   Word const* lhsPtr = lhs.Row( 0 );
+   Word const* rhsPtr = rhs.Row( 0 );
+   Word* outPtr = out.Row( 0 );
+   for( dip::uint ii = 0; ii < n; ++ii ) {
+      outPtr[ ii ] = func( lhsPtr[ ii ], rhsPtr[ ii ] );
+   }
+}
+
+} // namespace
+
+void And( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs, PackedBinaryImage& out ) {
+   PackedLogicalOperator( lhs, rhs, out, []( Word a, Word b ) { return a & b; } );
+}
+
+void Or( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs, PackedBinaryImage& out ) {
+   PackedLogicalOperator( lhs, rhs, out, []( Word a, Word b ) { return a | b; } );
+}
+
+void Xor( PackedBinaryImage const& lhs, PackedBinaryImage const& rhs, PackedBinaryImage& out ) {
+   PackedLogicalOperator( lhs, rhs, out, []( Word a, Word b ) { return a ^ b; } );
+}
+
+void Not( PackedBinaryImage const& in, PackedBinaryImage& out ) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   if( &out != &in ) {
+      out.ReForge( in.Sizes() );
+   }
+   dip::uint nRows = in.NumberOfRows();
+   dip::uint nWords = in.WordsPerRow();
+   Word lastMask = in.LastWordMask();
+   for( dip::uint row = 0; row < nRows; ++row ) {
+      Word const* src = in.Row( row );
+      Word* dest = out.Row( row );
+      for( dip::uint ii = 0; ii < nWords; ++ii ) {
+         dest[ ii ] = ~src[ ii ];
+      }
+      dest[ nWords - 1 ] &= lastMask; // the padding bits must stay 0
+   }
+}
+
+} // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/binary.h"
+#include "diplib/generation.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the packed binary image") {
+   dip::Random random( 0 );
+   for( auto sizes : { dip::UnsignedArray{ 150, 23 }, dip::UnsignedArray{ 64, 7, 6 }, dip::UnsignedArray{ 77 }} ) {
+      dip::Image in( sizes, 1, dip::DT_BIN );
+      in.Fill( 0 );
+      dip::BinaryNoise( in, in, random, 0.0, 0.25 );
+      dip::PackedBinaryImage packed( in );
+      DOCTEST_CHECK( packed.Count() == dip::Count( in ));
+      DOCTEST_CHECK( dip::testing::CompareImages( packed.Unpack(), in, dip::Option::CompareImagesMode::EXACT ));
+      dip::sint nDims = static_cast< dip::sint >( sizes.size() );
+      for( dip::sint connectivity = nDims > 1 ? -2 : 1; connectivity <= nDims; ++connectivity ) {
+         if( connectivity == 0 ) {
+            continue;
+         }
+         for( auto edge : { dip::S::BACKGROUND, dip::S::OBJECT } ) {
+            DOCTEST_CHECK( dip::testing::CompareImages(
+                  dip::BinaryDilation( packed, connectivity, 4, edge ).Unpack(),
+                  dip::BinaryDilation( in, connectivity, 4, edge ), dip::Option::CompareImagesMode::EXACT ));
+            DOCTEST_CHECK( dip::testing::CompareImages(
+                  dip::BinaryErosion( packed, connectivity, 3, edge ).Unpack(),
+                  dip::BinaryErosion( in, connectivity, 3, edge ), dip::Option::CompareImagesMode::EXACT ));
+            dip::uint absConnectivity = static_cast< dip::uint >( std::abs( connectivity ));
+            for( auto mode : { dip::S::FOREGROUND, dip::S::ALL } ) {
+               DOCTEST_CHECK( dip::testing::CompareImages(
+                     dip::CountNeighbors( packed, absConnectivity, mode, edge ),
+                     dip::CountNeighbors( in, absConnectivity, mode, edge ), dip::Option::CompareImagesMode::EXACT ));
+            }
+         }
+         DOCTEST_CHECK( dip::testing::CompareImages(
+               dip::BinaryClosing( packed, connectivity, 2 ).Unpack(),
+               dip::BinaryClosing( in, connectivity, 2 ), dip::Option::CompareImagesMode::EXACT ));
+         DOCTEST_CHECK( dip::testing::CompareImages(
+               dip::BinaryOpening( packed, connectivity, 2 ).Unpack(),
+               dip::BinaryOpening( in, connectivity, 2 ), dip::Option::CompareImagesMode::EXACT ));
+      }
+      dip::PackedBinaryImage other( dip::BinaryDilation( in, 1, 1 ));
+      DOCTEST_CHECK( dip::testing::CompareImages( ( packed & other ).Unpack(), in & other.Unpack(), dip::Option::CompareImagesMode::EXACT ));
+      DOCTEST_CHECK( dip::testing::CompareImages( ( packed | other ).Unpack(), in | other.Unpack(), dip::Option::CompareImagesMode::EXACT ));
+      DOCTEST_CHECK( dip::testing::CompareImages( ( packed ^ other ).Unpack(), in ^ other.Unpack(), dip::Option::CompareImagesMode::EXACT ));
+      DOCTEST_CHECK( dip::testing::CompareImages( ( ~packed ).Unpack(), !in, dip::Option::CompareImagesMode::EXACT ));
+      DOCTEST_CHECK(( ~packed ).Count() == packed.NumberOfPixels() - packed.Count() );
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -26,6 +26,36 @@
 
 namespace dip {
 
+namespace {
+
+Image ComplexToReal( Image const& in, ImageDisplay::ComplexMode complexMode ) {
+   if( !in.DataType().IsComplex() ) {
+      return in.QuickCopy();
+   }
+   switch( complexMode ) {
+      //case ImageDisplay::ComplexMode::MAGNITUDE:
+      default:
+         return Abs( in );
+      case ImageDisplay::ComplexMode::PHASE:
+         return Phase( in );
+      case ImageDisplay::ComplexMode::REAL:
+         return in.Real();
+      case ImageDisplay::ComplexMode::IMAG:
+         return in.Imaginary();
+   }
+}
+
+void FixNaNLimits( ImageDisplay::Limits& lims ) {
+   if( std::isnan( lims.lower )) {
+      lims.lower = 0.0;
+   }
+   if( std::isnan( lims.upper )) {
+      lims.upper = 255.0;
+   }
+}
+
+} // namespace
+
 // Don't call this function if mappingMode_ == MappingMode::MANUAL or mappingMode_ == MappingMode::MODULO!
 void ImageDisplay::ComputeLimits( bool set ) {
    Limits* lims;
@@ -50,7 +80,7 @@ void ImageDisplay::ComputeLimits( bool set ) {
       } else {
          lims = &( sliceLimits_[ static_cast< unsigned >( complexMode_ ) ].maxMin );
       }
-      if( std::isnan( lims->lower )) {
+      if( std::isnan( lims->lower ) && !SliceLimitsFromTable( *lims )) {
          // Compute from rgbSlice_
          tmp = rgbSlice_.QuickCopy();
          // It's already converted to RGB...
@@ -62,23 +92,7 @@ void ImageDisplay::ComputeLimits( bool set ) {
          lims->lower = 0.0;
          lims->upper = 1.0;
       } else {
-         if( tmp.DataType().IsComplex() ) {
-            switch( complexMode_ ) {
-               //case ComplexMode::MAGNITUDE:
-               default:
-                  tmp = Abs( tmp );
-                  break;
-               case ComplexMode::PHASE:
-                  tmp = Phase( tmp );
-                  break;
-               case ComplexMode::REAL:
-                  tmp = tmp.Real();
-                  break;
-               case ComplexMode::IMAG:
-                  tmp = tmp.Imaginary();
-                  break;
-            }
-         }
+         tmp = ComplexToReal( tmp, complexMode_ );
          if( mappingMode_ == MappingMode::PERCENTILE ) {
             lims->lower = static_cast< dfloat >( Image::Sample( Percentile( tmp, {}, 5.0 )));
             lims->upper = static_cast< dfloat >( Image::Sample( Percentile( tmp, {}, 95.0 )));
@@ -87,12 +101,7 @@ void ImageDisplay::ComputeLimits( bool set ) {
             lims->lower = res.Minimum();
             lims->upper = res.Maximum();
          }
-         if( std::isnan( lims->lower )) {
-            lims->lower = 0.0;
-         }
-         if( std::isnan( lims->upper )) {
-            lims->upper = 255.0;
-         }
+         FixNaNLimits( *lims );
       }
    }
    if( set ) {
@@ -107,6 +116,48 @@ void ImageDisplay::InvalidateSliceLimits() {
    }
 }
 
+bool ImageDisplay::SliceLimitsFromTable( Limits& lims ) {
+   if(( projectionMode_ != ProjectionMode::SLICE ) || ( level_ > 0 ) || !image_.IsScalar() || IsBinary() ||
+      ( image_.Dimensionality() <= ( twoDimOut_ ? 2u : 1u ))) {
+      return false;
+   }
+   bool percentile = mappingMode_ == MappingMode::PERCENTILE;
+   auto table = std::find_if( sliceLimitsTables_.begin(), sliceLimitsTables_.end(), [ & ]( SliceLimitsTable const& t ) {
+      return ( t.dim1 == dim1_ ) && ( t.dim2 == dim2_ ) && ( t.complexMode == complexMode_ ) && ( t.percentile == percentile );
+   } );
+   if( table == sliceLimitsTables_.end() ) {
+      // First slice in this direction: we don't know yet if the user will look at other slices
+      sliceLimitsTables_.push_back( { dim1_, dim2_, complexMode_, percentile, coordinates_, {}, {} } );
+      return false;
+   }
+   if( !table->lower.IsForged() ) {
+      if( std::all_of( orthogonal_.begin(), orthogonal_.end(), [ & ]( dip::uint ii ) {
+         return table->firstCoordinates[ ii ] == coordinates_[ ii ];
+      } )) {
+         return false;
+      }
+      // A second slice: compute the limits for all slices at once
+      Image tmp = ComplexToReal( image_, complexMode_ );
+      BooleanArray process( image_.Dimensionality(), false );
+      process[ dim1_ ] = true;
+      process[ dim2_ ] = true;
+      if( percentile ) {
+         Percentile( tmp, {}, table->lower, 5.0, process );
+         Percentile( tmp, {}, table->upper, 95.0, process );
+      } else {
+         Minimum( tmp, {}, table->lower, process );
+         Maximum( tmp, {}, table->upper, process );
+      }
+   }
+   UnsignedArray coords = coordinates_;
+   coords[ dim1_ ] = 0;
+   coords[ dim2_ ] = 0;
+   lims.lower = table->lower.At( coords ).As< dfloat >();
+   lims.upper = table->upper.At( coords ).As< dfloat >();
+   FixNaNLimits( lims );
+   return true;
+}
+
 ImageDisplay::Limits ImageDisplay::GetLimits( bool compute ) {
    Limits* lims;
    if( globalStretch_ ) {
@@ -123,9 +174,31 @@ ImageDisplay::Limits ImageDisplay::GetLimits( bool compute ) {
    return *lims;
 }
 
+void ImageDisplay::SetZoom( dfloat zoom ) {
+   DIP_THROW_IF( zoom <= 0.0, E::PARAMETER_OUT_OF_RANGE );
+   zoom_ = zoom;
+   dip::uint level = LevelForZoom();
+   if( level != level_ ) {
+      sizeIsDirty_ = true;
+      sliceIsDirty_ = true;
+   }
+}
+
+dip::uint ImageDisplay::LevelForZoom() {
+   if( zoom_ > 0.5 ) {
+      return 0;
+   }
+   if( pyramid_.NumberOfLevels() == 0 ) {
+      pyramid_ = ImagePyramid( image_, S::MEAN );
+   }
+   return pyramid_.LevelForZoom( zoom_, dim1_ == dim2_ ? UnsignedArray{ dim1_ } : UnsignedArray{ dim1_, dim2_ } );
+}
+
 // Compute projection
 void ImageDisplay::UpdateSlice() {
    if( sliceIsDirty_ ) {
+      level_ = LevelForZoom();
+      Image const& source = level_ == 0 ? image_ : pyramid_.Level( level_ );
       dip::uint nDims = image_.Dimensionality();
       dip::uint outDims = twoDimOut_ ? 2 : 1;
       if( nDims > outDims ) {
@@ -133,30 +206,39 @@ void ImageDisplay::UpdateSlice() {
             //case ProjectionMode::SLICE:
             default: {
                RangeArray rangeArray( nDims ); // By default, covers all image pixels
+               UnsignedArray factors = GetScaleFactors();
                for( dip::uint ii = 0; ii < nDims; ++ii ) {
                   if(( ii != dim1_ ) && ( ii != dim2_ )) {
-                     rangeArray[ ii ] = Range( static_cast< dip::sint >( coordinates_[ ii ] ));
+                     dip::uint coord = std::min( coordinates_[ ii ] / factors[ ii ], source.Size( ii ) - 1 );
+                     rangeArray[ ii ] = Range( static_cast< dip::sint >( coord ));
                   }
                }
-               slice_ = image_.At( rangeArray );
+               slice_ = source.At( rangeArray );
                break;
             }
-            case ProjectionMode::MAX: {
+            case ProjectionMode::MAX:
+            case ProjectionMode::MEAN: {
+               auto cached = std::find_if( projectionCache_.begin(), projectionCache_.end(), [ & ]( CachedProjection const& p ) {
+                  return ( p.level == level_ ) && ( p.dim1 == dim1_ ) && ( p.dim2 == dim2_ ) && ( p.mode == projectionMode_ );
+               } );
+               if( cached != projectionCache_.end() ) {
+                  slice_ = cached->projection;
+                  break;
+               }
+               // Compute into a new image: `slice_` might share data with a cached projection
                BooleanArray process( nDims, true );
                process[ dim1_ ] = false;
                process[ dim2_ ] = false;
-               if( image_.DataType().IsComplex() ) {
-                  MaximumAbs( image_, {}, slice_, process );
+               Image projection;
+               if( projectionMode_ == ProjectionMode::MEAN ) {
+                  Mean( source, {}, projection, "", process );
+               } else if( source.DataType().IsComplex() ) {
+                  MaximumAbs( source, {}, projection, process );
                } else {
-                  Maximum( image_, {}, slice_, process );
+                  Maximum( source, {}, projection, process );
                }
-               break;
-            }
-            case ProjectionMode::MEAN: {
-               BooleanArray process( nDims, true );
-               process[ dim1_ ] = false;
-               process[ dim2_ ] = false;
-               Mean( image_, {}, slice_, "", process );
+               projectionCache_.push_back( { level_, dim1_, dim2_, projectionMode_, projection } );
+               slice_ = projection;
                break;
             }
          }
@@ -166,7 +248,7 @@ void ImageDisplay::UpdateSlice() {
             slice_.PermuteDimensions( { dim1_, dim2_ } );
          }
       } else {
-         slice_ = image_.QuickCopy();
+         slice_ = source.QuickCopy();
       }
       sizeIsDirty_ = false;
       sliceIsDirty_ = false;
@@ -459,3 +541,62 @@ Image::Pixel ImageDisplay::MapSinglePixel( Image::Pixel const& input ) {
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/random.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the ImageDisplay caches") {
+   dip::Image img{ dip::UnsignedArray{ 20, 30, 10 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random );
+   dip::ImageDisplay display( img );
+
+   // Slice limits: the first slice is computed directly, the second one comes from the per-slice table
+   display.SetRange( "percentile" );
+   for( dip::uint z : { 0u, 5u, 9u } ) {
+      display.SetCoordinates( { 3, 4, z } );
+      display.Output();
+      dip::Image slice = img.At( dip::Range{}, dip::Range{}, dip::Range( static_cast< dip::sint >( z )));
+      DOCTEST_CHECK( display.GetRange().lower == dip::Percentile( slice, {}, 5.0 ).As< dip::dfloat >() );
+      DOCTEST_CHECK( display.GetRange().upper == dip::Percentile( slice, {}, 95.0 ).As< dip::dfloat >() );
+   }
+   display.SetRange( "lin" );
+   display.SetCoordinates( { 3, 4, 7 } );
+   display.Output();
+   display.SetCoordinates( { 3, 4, 2 } );
+   display.Output();
+   dip::Image slice = img.At( dip::Range{}, dip::Range{}, dip::Range( 2 ));
+   DOCTEST_CHECK( display.GetRange().lower == dip::Minimum( slice ).As< dip::dfloat >() );
+   DOCTEST_CHECK( display.GetRange().upper == dip::Maximum( slice ).As< dip::dfloat >() );
+
+   // Projections are computed only once for each direction
+   display.SetProjectionMode( "max" );
+   dip::Image projection = display.Slice();
+   DOCTEST_CHECK( projection.Sizes() == dip::UnsignedArray{ 20, 30 } );
+   display.SetDirection( 0, 2 );
+   DOCTEST_CHECK( display.Slice().Sizes() == dip::UnsignedArray{ 20, 10 } );
+   display.SetDirection( 0, 1 );
+   DOCTEST_CHECK( display.Slice().Origin() == projection.Origin() );
+   display.SetProjectionMode( "mean" );
+   DOCTEST_CHECK( display.Slice().Origin() != projection.Origin() );
+   DOCTEST_CHECK( display.Slice().At( 4, 5 ).As< dip::dfloat >() ==
+                  doctest::Approx( dip::Mean( img.At( dip::Range( 4 ), dip::Range( 5 ), dip::Range{} )).As< dip::dfloat >() ));
+
+   // Zooming out takes the slice from a pyramid level
+   display.SetProjectionMode( "slice" );
+   display.SetZoom( 0.3 );
+   DOCTEST_CHECK( display.SizeIsDirty() );
+   DOCTEST_CHECK( display.Output().Sizes() == dip::UnsignedArray{ 10, 15 } );
+   DOCTEST_CHECK( display.GetLevel() == 1 );
+   DOCTEST_CHECK( display.GetScaleFactors() == dip::UnsignedArray{ 2, 2, 2 } );
+   dip::dfloat mean = dip::Mean( img.At( dip::Range{ 4, 5 }, dip::Range{ 6, 7 }, dip::Range{ 2, 3 } )).As< dip::dfloat >();
+   DOCTEST_CHECK( display.Pixel( 2, 3 )[ 0 ].As< dip::dfloat >() == doctest::Approx( mean ));
+   display.SetZoom( 1.0 );
+   DOCTEST_CHECK( display.Output().Sizes() == dip::UnsignedArray{ 20, 30 } );
+}
+
+#endif // DIP__ENABLE_DOCTEST
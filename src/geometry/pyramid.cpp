@@ -0,0 +1,323 @@
+/*
+ * DIPlib 3.0
+ * This file contains the definition of the dip::ImagePyramid class.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <numeric>
+
+#include "diplib.h"
+#include "diplib/geometry.h"
+#include "diplib/linear.h"
+#include "diplib/file_io.h"
+
+namespace dip {
+
+namespace {
+
+constexpr char const* historyPrefix = "dip::ImagePyramid method=";
+
+String BaseFileName( String const& filename ) {
+   if( FileCompareExtension( filename, "ics" )) {
+      return filename.substr( 0, FileGetExtensionPosition( filename ));
+   }
+   return filename;
+}
+
+String LevelFileName( String const& base, dip::uint level ) {
+   return base + "_" + std::to_string( level ) + ".ics";
+}
+
+// Computes `out` from `in` by halving the sizes along the dimensions where `halve` is set.
+void Downsample( Image const& in, Image& out, BooleanArray const& halve, String const& method ) {
+   dip::uint nDims = in.Dimensionality();
+   RangeArray ranges( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      if( halve[ ii ] ) {
+         ranges[ ii ] = Range( 0, static_cast< dip::sint >( in.Size( ii ) / 2 * 2 - 2 ), 2 );
+      }
+   }
+   if( in.DataType().IsBinary() ) {
+      out.Copy( in.At( ranges ));
+   } else if( method == S::GAUSSIAN ) {
+      FloatArray sigmas( nDims, 0.0 );
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         if( halve[ ii ] ) {
+            sigmas[ ii ] = 1.0;
+         }
+      }
+      Image smooth = GaussFIR( in, sigmas, { 0 } );
+      out.Copy( smooth.At( ranges ));
+      out.Convert( in.DataType() );
+   } else {
+      // Add the 2^n subsampled images at all combinations of offsets 0 and 1 along the `n` halved dimensions
+      Image sum;
+      sum.Copy( in.At( ranges )); // `dip::Convert` would return a view into `in` if the type doesn't change
+      sum.Convert( DataType::SuggestFlex( in.DataType() ));
+      UnsignedArray halved;
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         if( halve[ ii ] ) {
+            halved.push_back( ii );
+         }
+      }
+      dip::uint nOffsets = dip::uint( 1 ) << halved.size();
+      for( dip::uint offset = 1; offset < nOffsets; ++offset ) {
+         RangeArray shifted = ranges;
+         for( dip::uint jj = 0; jj < halved.size(); ++jj ) {
+            if( offset & ( dip::uint( 1 ) << jj )) {
+               shifted[ halved[ jj ]].start = 1;
+               shifted[ halved[ jj ]].stop += 1;
+            }
+         }
+         sum += in.At( shifted );
+      }
+      sum /= static_cast< dfloat >( nOffsets );
+      out = Convert( sum, in.DataType() );
+   }
+   PixelSize pixelSize = in.PixelSize();
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      if( halve[ ii ] ) {
+         pixelSize.Scale( ii, 2.0 );
+      }
+   }
+   out.SetPixelSize( pixelSize );
+   out.SetColorSpace( in.ColorSpace() );
+}
+
+} // namespace
+
+ImagePyramid::ImagePyramid( Image const& image, String const& method, dip::uint minimumSize ) : method_( method ) {
+   DIP_THROW_IF( !image.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( image.Dimensionality() < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
+   if(( method != S::MEAN ) && ( method != S::GAUSSIAN )) {
+      DIP_THROW_INVALID_FLAG( method );
+   }
+   Plan( image.Sizes(), image.PixelSize(), minimumSize );
+   levels_[ 0 ] = image;
+}
+
+void ImagePyramid::Plan( UnsignedArray const& sizes, PixelSize const& pixelSize, dip::uint minimumSize ) {
+   dip::uint nDims = sizes.size();
+   minimumSize = std::max( minimumSize, dip::uint( 1 ));
+   // Relative pixel sizes. If the units differ between dimensions, we cannot compare them, and assume isotropy.
+   FloatArray pixel = pixelSize.AspectRatio( nDims );
+   if( std::any_of( pixel.begin(), pixel.end(), []( dfloat p ) { return p <= 0.0; } )) {
+      pixel = FloatArray( nDims, 1.0 );
+   }
+   sizes_ = { sizes };
+   factors_ = { UnsignedArray( nDims, 1 ) };
+   while( true ) {
+      UnsignedArray sz = sizes_.back();
+      UnsignedArray factor = factors_.back();
+      dfloat smallest = std::numeric_limits< dfloat >::infinity();
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         if(( sz[ ii ] > minimumSize ) && ( sz[ ii ] > 1 )) {
+            smallest = std::min( smallest, pixel[ ii ] );
+         }
+      }
+      if( smallest == std::numeric_limits< dfloat >::infinity() ) {
+         break; // No dimension can be halved
+      }
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         if(( sz[ ii ] > minimumSize ) && ( sz[ ii ] > 1 ) && ( pixel[ ii ] < 2.0 * smallest )) {
+            sz[ ii ] /= 2;
+            factor[ ii ] *= 2;
+            pixel[ ii ] *= 2.0;
+         }
+      }
+      sizes_.push_back( sz );
+      factors_.push_back( factor );
+   }
+   levels_.clear();
+   levels_.resize( sizes_.size() );
+}
+
+ImagePyramid ImagePyramid::Load( String const& filename ) {
+   String base = BaseFileName( filename );
+   ImagePyramid out;
+   out.filename_ = base;
+   FileInformation info;
+   DIP_STACK_TRACE_THIS( info = ImageReadICSInfo( LevelFileName( base, 0 )));
+   for( auto const& line : info.history ) {
+      if( line.compare( 0, std::strlen( historyPrefix ), historyPrefix ) == 0 ) {
+         out.method_ = line.substr( std::strlen( historyPrefix ));
+      }
+   }
+   DIP_THROW_IF( out.method_.empty(), "File was not written by dip::ImagePyramid::Save" );
+   // The scale factors follow from the sizes of consecutive levels
+   out.sizes_ = { info.sizes };
+   out.factors_ = { UnsignedArray( info.sizes.size(), 1 ) };
+   for( dip::uint level = 1; ImageIsICS( LevelFileName( base, level )); ++level ) {
+      DIP_STACK_TRACE_THIS( info = ImageReadICSInfo( LevelFileName( base, level )));
+      UnsignedArray const& previous = out.sizes_.back();
+      DIP_THROW_IF( info.sizes.size() != previous.size(), E::DIMENSIONALITIES_DONT_MATCH );
+      UnsignedArray factor = out.factors_.back();
+      for( dip::uint ii = 0; ii < factor.size(); ++ii ) {
+         if( info.sizes[ ii ] != previous[ ii ] ) {
+            DIP_THROW_IF( info.sizes[ ii ] != previous[ ii ] / 2, E::SIZES_DONT_MATCH );
+            factor[ ii ] *= 2;
+         }
+      }
+      out.sizes_.push_back( info.sizes );
+      out.factors_.push_back( factor );
+   }
+   out.levels_.resize( out.sizes_.size() );
+   return out;
+}
+
+void ImagePyramid::Save( String const& filename ) {
+   DIP_THROW_IF( NumberOfLevels() == 0, E::IMAGE_NOT_FORGED );
+   String base = BaseFileName( filename );
+   for( dip::uint level = 0; level < NumberOfLevels(); ++level ) {
+      DIP_STACK_TRACE_THIS( ImageWriteICS( Level( level ), LevelFileName( base, level ), { historyPrefix + method_ },
+                                           0, { "uncompressed" } ));
+   }
+}
+
+Image const& ImagePyramid::Level( dip::uint level ) {
+   DIP_THROW_IF( level >= NumberOfLevels(), E::INDEX_OUT_OF_RANGE );
+   if( !levels_[ level ].IsForged() ) {
+      if( !filename_.empty() ) {
+         DIP_STACK_TRACE_THIS( ImageReadICS( levels_[ level ], LevelFileName( filename_, level )));
+      } else {
+         // Level 0 is always forged, find the last level computed before `level`
+         dip::uint first = level;
+         while( !levels_[ first - 1 ].IsForged() ) {
+            --first;
+         }
+         for( dip::uint ii = first; ii <= level; ++ii ) {
+            BooleanArray halve( factors_[ ii ].size() );
+            for( dip::uint jj = 0; jj < halve.size(); ++jj ) {
+               halve[ jj ] = factors_[ ii ][ jj ] != factors_[ ii - 1 ][ jj ];
+            }
+            DIP_STACK_TRACE_THIS( Downsample( levels_[ ii - 1 ], levels_[ ii ], halve, method_ ));
+            DIP_ASSERT( levels_[ ii ].Sizes() == sizes_[ ii ] );
+         }
+      }
+   }
+   return levels_[ level ];
+}
+
+Image ImagePyramid::Region( dip::uint level, RangeArray const& roi ) {
+   DIP_THROW_IF( level >= NumberOfLevels(), E::INDEX_OUT_OF_RANGE );
+   if( levels_[ level ].IsForged() || filename_.empty() ) {
+      Image const& img = Level( level );
+      DIP_STACK_TRACE_THIS( return img.At( roi ));
+   }
+   Image out;
+   DIP_STACK_TRACE_THIS( ImageReadICS( out, LevelFileName( filename_, level ), roi ));
+   return out;
+}
+
+void ImagePyramid::ComputeAll() {
+   for( dip::uint level = 0; level < NumberOfLevels(); ++level ) {
+      Level( level );
+   }
+}
+
+dip::uint ImagePyramid::LevelForZoom( dfloat zoom, UnsignedArray const& dims ) const {
+   DIP_THROW_IF( NumberOfLevels() == 0, E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( zoom <= 0.0, E::PARAMETER_OUT_OF_RANGE );
+   dip::uint nDims = sizes_[ 0 ].size();
+   UnsignedArray allDims = dims;
+   if( allDims.empty() ) {
+      allDims.resize( nDims );
+      std::iota( allDims.begin(), allDims.end(), dip::uint( 0 ));
+   }
+   for( auto d : allDims ) {
+      DIP_THROW_IF( d >= nDims, E::ILLEGAL_DIMENSION );
+   }
+   // Of the levels with the largest scale factors not exceeding `1 / zoom`, pick the first one,
+   // which has the highest resolution along the other dimensions.
+   dip::uint best = 0;
+   dip::uint bestScale = 1;
+   for( dip::uint level = 1; level < NumberOfLevels(); ++level ) {
+      dip::uint scale = 1;
+      bool fits = true;
+      for( auto d : allDims ) {
+         scale *= factors_[ level ][ d ];
+         fits &= static_cast< dfloat >( factors_[ level ][ d ] ) * zoom <= 1.0;
+      }
+      if( !fits ) {
+         break;
+      }
+      if( scale > bestScale ) {
+         best = level;
+         bestScale = scale;
+      }
+   }
+   return best;
+}
+
+} // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include <cstdio>
+#include "doctest.h"
+#include "diplib/random.h"
+#include "diplib/generation.h"
+#include "diplib/statistics.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the ImagePyramid class") {
+   dip::Image img{ dip::UnsignedArray{ 64, 50, 12 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random );
+   img.SetPixelSize( dip::PixelSize{ dip::PhysicalQuantityArray{ 1 * dip::PhysicalQuantity::Micrometer(), 1 * dip::PhysicalQuantity::Micrometer(), 4 * dip::PhysicalQuantity::Micrometer() }} );
+
+   // Anisotropic pixels: the first two levels don't subsample the third dimension
+   dip::ImagePyramid pyramid( img );
+   DOCTEST_REQUIRE( pyramid.NumberOfLevels() == 7 );
+   DOCTEST_CHECK( pyramid.Sizes( 1 ) == dip::UnsignedArray{ 32, 25, 12 } );
+   DOCTEST_CHECK( pyramid.Sizes( 2 ) == dip::UnsignedArray{ 16, 12, 12 } );
+   DOCTEST_CHECK( pyramid.Sizes( 3 ) == dip::UnsignedArray{ 8, 6, 6 } );
+   DOCTEST_CHECK( pyramid.ScaleFactors( 3 ) == dip::UnsignedArray{ 8, 8, 2 } );
+
+   // Levels are the mean over the pixels they cover
+   dip::Image const& level3 = pyramid.Level( 3 );
+   DOCTEST_CHECK( level3.Sizes() == pyramid.Sizes( 3 ));
+   DOCTEST_CHECK( level3.PixelSize( 2 ) == 8 * dip::PhysicalQuantity::Micrometer() );
+   dip::dfloat mean = dip::Mean( img.At( dip::Range{ 8, 15 }, dip::Range{ 16, 23 }, dip::Range{ 2, 3 } )).As< dip::dfloat >();
+   DOCTEST_CHECK( level3.At( 1, 2, 1 ).As< dip::dfloat >() == doctest::Approx( mean ));
+
+   // Zoom
+   DOCTEST_CHECK( pyramid.LevelForZoom( 1.0 ) == 0 );
+   DOCTEST_CHECK( pyramid.LevelForZoom( 0.3 ) == 1 );
+   DOCTEST_CHECK( pyramid.LevelForZoom( 0.25, { 0, 1 } ) == 2 );
+
+   // Saving and loading, regions read from file
+   pyramid.Save( "test_pyramid" );
+   dip::ImagePyramid loaded = dip::ImagePyramid::Load( "test_pyramid.ics" );
+   DOCTEST_CHECK( loaded.NumberOfLevels() == pyramid.NumberOfLevels() );
+   DOCTEST_CHECK( loaded.ScaleFactors( 3 ) == pyramid.ScaleFactors( 3 ));
+   dip::RangeArray roi{ dip::Range{ 2, 9 }, dip::Range{ 3, 7 }, dip::Range{ 0, 5 } };
+   DOCTEST_CHECK( dip::testing::CompareImages( loaded.Region( 1, roi ), pyramid.Level( 1 ).At( roi )));
+   DOCTEST_CHECK( dip::testing::CompareImages( loaded.Level( 3 ), level3 ));
+   for( dip::uint level = 0; level < pyramid.NumberOfLevels(); ++level ) {
+      std::remove(( "test_pyramid_" + std::to_string( level ) + ".ics" ).c_str() );
+   }
+
+   // Gaussian method on an integer image
+   dip::ImagePyramid gaussian( dip::Convert( img * 100, dip::DT_UINT8 ), dip::S::GAUSSIAN, 10 );
+   DOCTEST_CHECK( gaussian.NumberOfLevels() == 4 );
+   DOCTEST_CHECK( gaussian.Level( 2 ).DataType() == dip::DT_UINT8 );
+   DOCTEST_CHECK( gaussian.Level( 3 ).Sizes() == dip::UnsignedArray{ 8, 6, 6 } );
+}
+
+#endif // DIP__ENABLE_DOCTEST
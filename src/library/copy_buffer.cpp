@@ -22,6 +22,7 @@
 
 #include "diplib.h"
 #include "diplib/library/copy_buffer.h"
+#include "diplib/library/cpu_dispatch.h"
 #include "diplib/boundary.h"
 #include "diplib/saturated_arithmetic.h"
 
@@ -59,6 +60,13 @@ static inline void CopyBufferFromTo(
       if( inStride == 0 ) {
          //std::cout << "CopyBufferFromTo<inT,outT>, mode 1\n";
          FillBufferFromTo( outBuffer, outStride, 1, pixels, 1, clamp_cast< outT >( *inBuffer ) );
+      } else if(( inStride == 1 ) && ( outStride == 1 )) {
+         //std::cout << "CopyBufferFromTo<inT,outT>, mode 2a\n";
+         CpuDispatch( [ = ]() {
+            for( dip::uint pp = 0; pp < pixels; ++pp ) {
+               outBuffer[ pp ] = clamp_cast< outT >( inBuffer[ pp ] );
+            }
+         } );
       } else {
          //std::cout << "CopyBufferFromTo<inT,outT>, mode 2\n";
          auto inIt = ConstSampleIterator< inT >( inBuffer, inStride );
@@ -0,0 +1,118 @@
+/*
+ * DIPlib 3.0
+ * This file contains definitions for functions that select code compiled for different instruction sets.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+
+#include "diplib.h"
+#include "diplib/library/cpu_dispatch.h"
+
+namespace dip {
+namespace detail {
+
+namespace {
+
+CpuLevel SupportedCpuLevel() {
+#if DIP__HAS_CPU_DISPATCH
+   __builtin_cpu_init();
+   if( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ) &&
+       __builtin_cpu_supports( "avx512dq" ) && __builtin_cpu_supports( "avx512vl" )) {
+      return CpuLevel::AVX512;
+   }
+   if( __builtin_cpu_supports( "avx2" )) {
+      return CpuLevel::AVX2;
+   }
+#endif
+   return CpuLevel::BASELINE;
+}
+
+CpuLevel const supportedCpuLevel = SupportedCpuLevel();
+
+CpuLevel InitialCpuLevel() {
+   CpuLevel level = supportedCpuLevel;
+   char const* requested = std::getenv( "DIP_CPU_LEVEL" );
+   if( requested ) {
+      String name = requested;
+      if( StringCompareCaseInsensitive( name, "baseline" )) {
+         level = CpuLevel::BASELINE;
+      } else if( StringCompareCaseInsensitive( name, "avx2" ) && ( level > CpuLevel::AVX2 )) {
+         level = CpuLevel::AVX2;
+      } // Else: "avx512" or an unknown value: keep the highest supported level
+   }
+   return level;
+}
+
+// This responds to the DIP_CPU_LEVEL environment variable.
+// Before this variable is initialized it is 0, so any code run during static initialization uses the baseline.
+CpuLevel cpuLevel = InitialCpuLevel();
+
+} // namespace
+
+CpuLevel GetCpuLevel() {
+   return cpuLevel;
+}
+
+CpuLevel SetCpuLevel( CpuLevel level ) {
+   CpuLevel previous = cpuLevel;
+   cpuLevel = std::min( level, supportedCpuLevel );
+   return previous;
+}
+
+} // namespace detail
+} // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/math.h"
+#include "diplib/generation.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the CPU dispatch") {
+   // Results must be identical for all instruction set levels
+   dip::Image a{ dip::UnsignedArray{ 257, 31 }, 1, dip::DT_SFLOAT };
+   dip::Image b = a.Similar();
+   dip::Random random( 0 );
+   a.Fill( 100 );
+   b.Fill( 100 );
+   dip::GaussianNoise( a, a, random, 2500.0 );
+   dip::GaussianNoise( b, b, random, 2500.0 );
+   dip::Image a8 = dip::Convert( a, dip::DT_UINT8 );
+   dip::Image b8 = dip::Convert( b, dip::DT_UINT8 );
+   dip::detail::CpuLevel level = dip::detail::SetCpuLevel( dip::detail::CpuLevel::BASELINE );
+   DOCTEST_CHECK( dip::detail::GetCpuLevel() == dip::detail::CpuLevel::BASELINE );
+   dip::Image ref1 = a + b;
+   dip::Image ref2 = a8 - b8;
+   dip::Image ref3 = a < b;
+   dip::Image ref4 = dip::Sqrt( dip::Abs( a ));
+   dip::Image ref5 = dip::Convert( a, dip::DT_SINT16 );
+   dip::Image ref6 = a8 * 3;
+   for( auto l : { dip::detail::CpuLevel::AVX2, dip::detail::CpuLevel::AVX512 } ) {
+      dip::detail::SetCpuLevel( l );
+      DOCTEST_CHECK( dip::detail::GetCpuLevel() <= l );
+      DOCTEST_CHECK( dip::testing::CompareImages( a + b, ref1, dip::Option::CompareImagesMode::EXACT ));
+      DOCTEST_CHECK( dip::testing::CompareImages( a8 - b8, ref2, dip::Option::CompareImagesMode::EXACT ));
+      DOCTEST_CHECK( dip::testing::CompareImages( a < b, ref3, dip::Option::CompareImagesMode::EXACT ));
+      DOCTEST_CHECK( dip::testing::CompareImages( dip::Sqrt( dip::Abs( a )), ref4, dip::Option::CompareImagesMode::EXACT ));
+      DOCTEST_CHECK( dip::testing::CompareImages( dip::Convert( a, dip::DT_SINT16 ), ref5, dip::Option::CompareImagesMode::EXACT ));
+      DOCTEST_CHECK( dip::testing::CompareImages( a8 * 3, ref6, dip::Option::CompareImagesMode::EXACT ));
+   }
+   dip::detail::SetCpuLevel( level );
+}
+
+#endif // DIP__ENABLE_DOCTEST
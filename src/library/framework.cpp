@@ -20,6 +20,7 @@
 
 #include "diplib.h"
 #include "diplib/framework.h"
+#include "framework_support.h"
 
 namespace dip {
 namespace Framework {
@@ -130,5 +131,143 @@ dip::uint OptimalProcessingDim(
    return OptimalProcessingDim_internal( sizes, in.Strides() );
 }
 
+
+std::vector< dip::uint > ChunkSizes( dip::uint nUnits, dip::uint nThreads, WorkSchedule schedule ) {
+   constexpr dip::uint chunksPerThread = 8; // for the dynamic schedule
+   std::vector< dip::uint > chunks;
+   if(( nThreads <= 1 ) || ( nUnits <= 1 )) {
+      chunks.push_back( nUnits );
+      return chunks;
+   }
+   if( schedule == WorkSchedule::Guided ) {
+      // Each chunk is a fraction of the remaining work, such that threads that start late or run slow
+      // can still be balanced out by the small chunks at the end
+      dip::uint remaining = nUnits;
+      while( remaining > 0 ) {
+         dip::uint size = div_ceil( remaining, 2 * nThreads );
+         chunks.push_back( size );
+         remaining -= size;
+      }
+      return chunks;
+   }
+   dip::uint size = div_ceil( nUnits, schedule == WorkSchedule::Dynamic ? nThreads * chunksPerThread : nThreads );
+   for( dip::uint start = 0; start < nUnits; start += size ) {
+      chunks.push_back( std::min( size, nUnits - start ));
+   }
+   return chunks;
+}
+
+std::vector< LineChunk > SplitLines(
+      UnsignedArray const& sizes,
+      dip::uint processingDim,
+      dip::uint nThreads,
+      WorkSchedule schedule
+) {
+   dip::uint nDims = sizes.size();
+   dip::uint nLines = sizes.product() / sizes[ processingDim ];
+   std::vector< dip::uint > chunkSizes = ChunkSizes( nLines, nThreads, schedule );
+   std::vector< LineChunk > chunks( chunkSizes.size() );
+   chunks[ 0 ].start = UnsignedArray( nDims, 0 );
+   chunks[ 0 ].nLines = chunkSizes[ 0 ];
+   for( dip::uint ii = 1; ii < chunks.size(); ++ii ) {
+      UnsignedArray& start = chunks[ ii ].start;
+      start = chunks[ ii - 1 ].start;
+      chunks[ ii ].nLines = chunkSizes[ ii ];
+      // To advance the iterator by the number of lines in the previous chunk, we increment it in whole-line steps.
+      dip::uint firstDim = processingDim == 0 ? 1 : 0;
+      dip::uint remaining = chunkSizes[ ii - 1 ];
+      do {
+         for( dip::uint dd = 0; dd < nDims; ++dd ) {
+            if( dd == firstDim ) {
+               dip::uint n = sizes[ dd ] - start[ dd ];
+               if( remaining >= n ) {
+                  // Rewinding, next loop iteration will increment the next coordinate
+                  remaining -= n;
+                  start[ dd ] = 0;
+               } else {
+                  // Forward by `remaining`, then we're done.
+                  start[ dd ] += remaining;
+                  remaining = 0;
+                  break;
+               }
+            } else if( dd != processingDim ) {
+               // Increment coordinate
+               ++start[ dd ];
+               // Check whether we reached the last pixel of the line
+               if( start[ dd ] < sizes[ dd ] ) {
+                  break;
+               }
+               // Rewind, the next loop iteration will increment the next coordinate
+               start[ dd ] = 0;
+            }
+         }
+      } while( remaining > 0 );
+   }
+   return chunks;
+}
+
 } // namespace Framework
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include <numeric>
+#include "doctest.h"
+#include "diplib/nonlinear.h"
+#include "diplib/random.h"
+#include "diplib/generation.h"
+#include "diplib/statistics.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the division of work among threads") {
+   for( auto schedule : { dip::WorkSchedule::Static, dip::WorkSchedule::Dynamic, dip::WorkSchedule::Guided } ) {
+      std::vector< dip::uint > sizes = dip::Framework::ChunkSizes( 1000, 4, schedule );
+      DOCTEST_CHECK( std::accumulate( sizes.begin(), sizes.end(), dip::uint( 0 )) == 1000 );
+      DOCTEST_CHECK( *std::max_element( sizes.begin(), sizes.end() ) == sizes[ 0 ] );
+      DOCTEST_CHECK( *std::min_element( sizes.begin(), sizes.end() ) > 0 );
+      DOCTEST_CHECK( dip::Framework::ChunkSizes( 1000, 1, schedule ).size() == 1 );
+   }
+   DOCTEST_CHECK( dip::Framework::ChunkSizes( 1000, 4, dip::WorkSchedule::Static ).size() == 4 );
+   DOCTEST_CHECK( dip::Framework::ChunkSizes( 1000, 4, dip::WorkSchedule::Dynamic ).size() == 32 );
+   DOCTEST_CHECK( dip::Framework::ChunkSizes( 1000, 4, dip::WorkSchedule::Guided ).size() > 4 );
+
+   // Chunks of lines along dimension 1 of a 3D image: the start coordinates advance along dimensions 0 and 2
+   auto chunks = dip::Framework::SplitLines( { 7, 20, 5 }, 1, 4, dip::WorkSchedule::Dynamic );
+   DOCTEST_REQUIRE( chunks.size() == 18 ); // 35 lines in chunks of 2
+   DOCTEST_CHECK( chunks[ 1 ].start == dip::UnsignedArray{ 2, 0, 0 } );
+   DOCTEST_CHECK( chunks[ 4 ].start == dip::UnsignedArray{ 1, 0, 1 } );
+   DOCTEST_CHECK( chunks[ 17 ].start == dip::UnsignedArray{ 6, 0, 4 } );
+   DOCTEST_CHECK( chunks[ 17 ].nLines == 1 );
+
+   // The frameworks produce the same results for all schedules, and report their timing
+   dip::Image img{ dip::UnsignedArray{ 200, 150 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random );
+   dip::Image scanRef = img * 3 + 2;
+   dip::Image fullRef = dip::MedianFilter( img, { 5 } );
+   std::vector< dip::ThreadTiming > scanTiming;
+   std::vector< dip::ThreadTiming > fullTiming;
+   dip::SetThreadTimingHook( [ & ]( dip::String const& framework, std::vector< dip::ThreadTiming > const& timing ) {
+      ( framework == "Scan" ? scanTiming : fullTiming ) = timing;
+   } );
+   for( auto schedule : { dip::WorkSchedule::Dynamic, dip::WorkSchedule::Guided } ) {
+      dip::SetWorkSchedule( schedule );
+      dip::Image scan = img * 3 + 2;
+      DOCTEST_CHECK( dip::Count( scan != scanRef ) == 0 );
+      DOCTEST_REQUIRE( !scanTiming.empty() );
+      DOCTEST_CHECK( scanTiming.size() <= dip::GetNumberOfThreads() );
+      dip::Image full = dip::MedianFilter( img, { 5 } );
+      DOCTEST_CHECK( dip::Count( full != fullRef ) == 0 );
+      DOCTEST_REQUIRE( !fullTiming.empty() );
+      dip::uint lines = 0;
+      for( auto const& t : fullTiming ) {
+         lines += t.lines;
+         DOCTEST_CHECK( t.seconds >= 0 );
+      }
+      DOCTEST_CHECK( lines == 150 );
+   }
+   dip::SetWorkSchedule( dip::WorkSchedule::Static );
+   dip::SetThreadTimingHook( {} );
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -24,6 +24,7 @@
 #include "diplib/generic_iterators.h"
 #include "diplib/library/copy_buffer.h"
 #include "diplib/multithreading.h"
+#include "framework_support.h"
 
 namespace dip {
 namespace Framework {
@@ -164,121 +165,90 @@ void Full(
 
    // Determine the number of threads we'll be using
    dip::uint nThreads = 1;
+   ThreadingPlanner planner( typeid( lineFilter ));
    if( !opts.Contains( FullOption::NoMultiThreading )) {
-      nThreads = std::min( GetNumberOfThreads(), nLines );
-      if( nThreads > 1 ) {
+      dip::uint maxThreads = std::min( GetNumberOfThreads(), nLines );
+      if( planner.NeedsOperations( maxThreads )) {
          dip::uint operations;
          DIP_STACK_TRACE_THIS( operations = nLines *
                lineFilter.GetNumberOfOperations( lineLength, input.TensorElements(), pixelTableOffsets.NumberOfPixels(), pixelTableOffsets.Runs().size() ));
-         // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
-         if( operations < threadingThreshold ) {
-            nThreads = 1;
-         }
+         // Starting threads is only worth while if the work saved compensates for the overhead
+         nThreads = planner.NumberOfThreads( operations, maxThreads );
       }
    }
 
    //std::cout << "Starting " << nThreads << " threads\n";
    DIP_STACK_TRACE_THIS( lineFilter.SetNumberOfThreads( nThreads, pixelTableOffsets ));
 
-   // Divide the image domain into nThreads chunks for split processing. The last chunk will have same or fewer
-   // image lines to process.
-   dip::uint nLinesPerThread = div_ceil( nLines, nThreads );
-   std::vector< UnsignedArray > startCoords( nThreads );
-   dip::uint nDims = sizes.size();
-   startCoords[ 0 ] = UnsignedArray( nDims, 0 );
-   for( dip::uint ii = 1; ii < nThreads; ++ii ) {
-      startCoords[ ii ] = startCoords[ ii - 1 ];
-      // To advance the iterator nLinesPerThread times, we increment it in whole-line steps.
-      dip::uint firstDim = processingDim == 0 ? 1 : 0;
-      dip::uint remaining = nLinesPerThread;
-      do {
-         for( dip::uint dd = 0; dd < nDims; ++dd ) {
-            if( dd == firstDim ) {
-               dip::uint n = sizes[ dd ] - startCoords[ ii ][ dd ];
-               if( remaining >= n ) {
-                  // Rewinding, next loop iteration will increment the next coordinate
-                  remaining -= n;
-                  startCoords[ ii ][ dd ] = 0;
-               } else {
-                  // Forward by `remaining`, then we're done.
-                  startCoords[ ii ][ dd ] += remaining;
-                  remaining = 0;
-                  break;
-               }
-            } else if( dd != processingDim ) {
-               // Increment coordinate
-               ++startCoords[ ii ][ dd ];
-               // Check whether we reached the last pixel of the line
-               if( startCoords[ ii ][ dd ] < sizes[ dd ] ) {
-                  break;
-               }
-               // Rewind, the next loop iteration will increment the next coordinate
-               startCoords[ ii ][ dd ] = 0;
-            }
-         }
-      } while( remaining > 0 );
-   }
+   // Divide the image domain into chunks of image lines, which the threads pick up as they become idle.
+   std::vector< LineChunk > chunks = SplitLines( sizes, processingDim, nThreads, GetWorkSchedule() );
+   ChunkDispenser dispenser( nThreads );
+   ThreadTimer timer( nThreads );
 
    // Start threads, each thread makes its own buffers
    AssertionError assertionError;
    ParameterError parameterError;
    RunTimeError runTimeError;
    Error error;
-   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
    try {
-      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
-
-      // Create input buffer data struct
-      FullBuffer inBuffer;
-      inBuffer.tensorLength = input.TensorElements();
-      inBuffer.tensorStride = input.TensorStride();
-      inBuffer.stride = input.Stride( processingDim );
-      inBuffer.buffer = nullptr;
+      ParallelFor( nThreads, [ & ]( dip::uint thread ) {
+         // Create input buffer data struct
+         FullBuffer inBuffer;
+         inBuffer.tensorLength = input.TensorElements();
+         inBuffer.tensorStride = input.TensorStride();
+         inBuffer.stride = input.Stride( processingDim );
+         inBuffer.buffer = nullptr;
 
-      // Create output buffer data struct and allocate buffer if necessary
-      std::vector< uint8 > outputBuffer;
-      FullBuffer outBuffer;
-      outBuffer.tensorLength = output.TensorElements();
-      if( useOutBuffer ) {
-         outBuffer.tensorStride = 1;
-         outBuffer.stride = static_cast< dip::sint >( outBuffer.tensorLength );
-         outputBuffer.resize( lineLength * outBufferType.SizeOf() * outBuffer.tensorLength );
-         outBuffer.buffer = outputBuffer.data();
-      } else {
-         outBuffer.tensorStride = output.TensorStride();
-         outBuffer.stride = output.Stride( processingDim );
-         outBuffer.buffer = nullptr;
-      }
-
-      // Loop over nLinesPerThread image lines
-      GenericJointImageIterator< 2 > it( { input, output }, processingDim );
-      it.SetCoordinates( startCoords[ thread ] );
-      FullLineFilterParameters fullLineFilterParameters{
-            inBuffer, outBuffer, lineLength, processingDim, it.Coordinates(), pixelTableOffsets, thread
-      }; // Takes inBuffer, outBuffer, it.Coordinates(), pixelTableOffsets as references
-      for( dip::uint ii = 0; ( ii < nLinesPerThread ) && it; ++ii, ++it ) {
-         inBuffer.buffer = it.InPointer();
-         if( !useOutBuffer ) {
-            // Point output buffer to right line in output image
-            outBuffer.buffer = it.OutPointer();
-         }
-         // Filter the line
-         lineFilter.Filter( fullLineFilterParameters );
+         // Create output buffer data struct and allocate buffer if necessary
+         std::vector< uint8 > outputBuffer;
+         FullBuffer outBuffer;
+         outBuffer.tensorLength = output.TensorElements();
          if( useOutBuffer ) {
-            // Copy output buffer to output image
-            detail::CopyBuffer(
-                  outBuffer.buffer,
-                  outBufferType,
-                  outBuffer.stride,
-                  outBuffer.tensorStride,
-                  it.OutPointer(),
-                  output.DataType(),
-                  output.Stride( processingDim ),
-                  output.TensorStride(),
-                  lineLength,
-                  outBuffer.tensorLength );
+            outBuffer.tensorStride = 1;
+            outBuffer.stride = static_cast< dip::sint >( outBuffer.tensorLength );
+            outputBuffer.resize( lineLength * outBufferType.SizeOf() * outBuffer.tensorLength );
+            outBuffer.buffer = outputBuffer.data();
+         } else {
+            outBuffer.tensorStride = output.TensorStride();
+            outBuffer.stride = output.Stride( processingDim );
+            outBuffer.buffer = nullptr;
          }
-      }
+
+         auto startTime = timer.Start();
+         GenericJointImageIterator< 2 > it( { input, output }, processingDim );
+         FullLineFilterParameters fullLineFilterParameters{
+               inBuffer, outBuffer, lineLength, processingDim, it.Coordinates(), pixelTableOffsets, thread
+         }; // Takes inBuffer, outBuffer, it.Coordinates(), pixelTableOffsets as references
+         for( dip::uint chunk = thread; chunk < chunks.size(); chunk = dispenser.Next() ) {
+            // Loop over the image lines in this chunk
+            it.SetCoordinates( chunks[ chunk ].start );
+            for( dip::uint ii = 0; ( ii < chunks[ chunk ].nLines ) && it; ++ii, ++it ) {
+               inBuffer.buffer = it.InPointer();
+               if( !useOutBuffer ) {
+                  // Point output buffer to right line in output image
+                  outBuffer.buffer = it.OutPointer();
+               }
+               // Filter the line
+               lineFilter.Filter( fullLineFilterParameters );
+               if( useOutBuffer ) {
+                  // Copy output buffer to output image
+                  detail::CopyBuffer(
+                        outBuffer.buffer,
+                        outBufferType,
+                        outBuffer.stride,
+                        outBuffer.tensorStride,
+                        it.OutPointer(),
+                        output.DataType(),
+                        output.Stride( processingDim ),
+                        output.TensorStride(),
+                        lineLength,
+                        outBuffer.tensorLength );
+               }
+            }
+            timer.AddChunk( thread, chunks[ chunk ].nLines );
+         }
+         timer.Stop( thread, startTime );
+      } );
    } catch( dip::AssertionError const& e ) {
       if( !assertionError.IsSet() ) {
          assertionError = e;
@@ -317,6 +287,8 @@ void Full(
    if( error.IsSet() ) {
       throw error;
    }
+   planner.Done();
+   timer.Report( "Full" );
 }
 
 } // namespace Framework
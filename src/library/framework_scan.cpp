@@ -22,6 +22,7 @@
 #include "diplib/framework.h"
 #include "diplib/library/copy_buffer.h"
 #include "diplib/multithreading.h"
+#include "framework_support.h"
 
 namespace dip {
 namespace Framework {
@@ -311,10 +312,11 @@ void Scan(
    }
 
    dip::uint processingDim = 0;
-   dip::uint nLines = 1;
    dip::uint lineLength = 0;
    dip::uint bufferSize = 0;
    dip::uint nThreads = 1;
+   std::vector< LineChunk > chunks;
+   ThreadingPlanner planner( typeid( lineFilter ));
    if( scan1D ) {
 
       // One image line --- Iterate over sections of the image if we need large buffers or we want to use parallelism ---
@@ -329,34 +331,34 @@ void Scan(
 
       // Determine the number of threads we'll be using
       if( !opts.Contains( ScanOption::NoMultiThreading )) {
-         nThreads = GetNumberOfThreads();
-         if( nThreads > 1 ) {
+         dip::uint maxThreads = GetNumberOfThreads();
+         if( planner.NeedsOperations( maxThreads )) {
             dip::uint operations;
             DIP_STACK_TRACE_THIS( operations = lineLength * lineFilter.GetNumberOfOperations( nIn, nOut, ( nIn > 0 ? in[ 0 ] : out[ 0 ] ).TensorElements() ));
-            // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
-            if( operations < threadingThreshold ) {
-               nThreads = 1;
-            }
+            // Starting threads is only worth while if the work saved compensates for the overhead
+            nThreads = planner.NumberOfThreads( operations, maxThreads );
          }
       }
 
-      // Chunk size if we use threads
-      if( nThreads > 1 ) {
-         lineLength = bufferSize = div_ceil( lineLength, nThreads );
+      // Divide the line into chunks of pixels, which the threads pick up as they become idle.
+      // For this case, `LineChunk::nLines` is the number of pixels in the chunk.
+      std::vector< dip::uint > chunkSizes = ChunkSizes( lineLength, nThreads, GetWorkSchedule() );
+      chunks.resize( chunkSizes.size() );
+      dip::uint start = 0;
+      for( dip::uint ii = 0; ii < chunks.size(); ++ii ) {
+         chunks[ ii ].start = UnsignedArray( 1, start );
+         chunks[ ii ].nLines = chunkSizes[ ii ];
+         start += chunkSizes[ ii ];
       }
+      // The first chunk is the largest one
+      bufferSize = chunkSizes[ 0 ];
       // Chunk size if we'll be copying data to buffers
       if( needBuffers ) {
          if( bufferSize > MAX_BUFFER_SIZE ) {
-            // Divide each thread's work into equal chunks, smaller than MAX_BUFFER_SIZE
-            nLines = div_ceil( bufferSize, MAX_BUFFER_SIZE );
-            bufferSize = div_ceil( bufferSize, nLines );
+            // Divide each chunk into equal sections, smaller than MAX_BUFFER_SIZE
+            bufferSize = div_ceil( bufferSize, div_ceil( bufferSize, MAX_BUFFER_SIZE ));
          }
       }
-      nLines *= nThreads;
-
-      // Many of these variables have a slightly different (but equivalent) meaning if `scan1D`
-      // For example: `nLines` is the total number of chunks to process.
-      // `lineLength` is the number of pixels that each thread will process.
 
    } else {
 
@@ -365,69 +367,25 @@ void Scan(
       // Determine the best processing dimension.
       processingDim = OptimalProcessingDim( nIn > 0 ? in[ 0 ] : out[ 0 ] );
       lineLength = bufferSize = sizes[ processingDim ];
-      nLines = sizes.product() / bufferSize;
+      dip::uint nLines = sizes.product() / bufferSize;
 
       // Determine the number of threads we'll be using
       if( !opts.Contains( ScanOption::NoMultiThreading )) {
-         nThreads = std::min( GetNumberOfThreads(), nLines );
-         if( nThreads > 1 ) {
+         dip::uint maxThreads = std::min( GetNumberOfThreads(), nLines );
+         if( planner.NeedsOperations( maxThreads )) {
             dip::uint operations;
             DIP_STACK_TRACE_THIS( operations = nLines * lineLength * lineFilter.GetNumberOfOperations( nIn, nOut, ( nIn > 0 ? in[ 0 ] : out[ 0 ] ).TensorElements() ));
-            // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
-            if( operations < threadingThreshold ) {
-               nThreads = 1;
-            }
+            // Starting threads is only worth while if the work saved compensates for the overhead
+            nThreads = planner.NumberOfThreads( operations, maxThreads );
          }
       }
 
-   }
+      // Divide the image domain into chunks of image lines, which the threads pick up as they become idle.
+      chunks = SplitLines( sizes, processingDim, nThreads, GetWorkSchedule() );
 
-   // Divide the image domain into nThreads chunks for split processing. The last chunk will have same or fewer
-   // image lines to process.
-   dip::uint nLinesPerThread = div_ceil( nLines, nThreads );
-   std::vector< UnsignedArray > startCoords( nThreads );
-   if( scan1D ) {
-      startCoords[ 0 ] = UnsignedArray( 1, 0 );
-      for( dip::uint ii = 1; ii < nThreads; ++ii ) {
-         startCoords[ ii ] = startCoords[ ii - 1 ];
-         startCoords[ ii ][ 0 ] += lineLength;        // `lineLength` in this case is the number of pixels per thread
-      }
-   } else {
-      dip::uint nDims = sizes.size();
-      startCoords[ 0 ] = UnsignedArray( nDims, 0 );
-      for( dip::uint ii = 1; ii < nThreads; ++ii ) {
-         startCoords[ ii ] = startCoords[ ii - 1 ];
-         // To advance the iterator nLinesPerThread times, we increment it in whole-line steps.
-         dip::uint firstDim = processingDim == 0 ? 1 : 0;
-         dip::uint remaining = nLinesPerThread;
-         do {
-            for( dip::uint dd = 0; dd < nDims; ++dd ) {
-               if( dd == firstDim ) {
-                  dip::uint n = sizes[ dd ] - startCoords[ ii ][ dd ];
-                  if (remaining >= n) {
-                     // Rewinding, next loop iteration will increment the next coordinate
-                     remaining -= n;
-                     startCoords[ ii ][ dd ] = 0;
-                  } else {
-                     // Forward by `remaining`, then we're done.
-                     startCoords[ ii ][ dd ] += remaining;
-                     remaining = 0;
-                     break;
-                  }
-               } else if( dd != processingDim ) {
-                  // Increment coordinate
-                  ++startCoords[ ii ][ dd ];
-                  // Check whether we reached the last pixel of the line
-                  if( startCoords[ ii ][ dd ] < sizes[ dd ] ) {
-                     break;
-                  }
-                  // Rewind, the next loop iteration will increment the next coordinate
-                  startCoords[ ii ][ dd ] = 0;
-               }
-            }
-         } while( remaining > 0 );
-      }
    }
+   ChunkDispenser dispenser( nThreads );
+   ThreadTimer timer( nThreads );
 
    //std::cout << "Starting " << nThreads << " threads\n";
    DIP_STACK_TRACE_THIS( lineFilter.SetNumberOfThreads( nThreads ));
@@ -437,193 +395,200 @@ void Scan(
    ParameterError parameterError;
    RunTimeError runTimeError;
    Error error;
-   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
    try {
-      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
-      std::vector< std::vector< uint8 >> buffers; // The outer one here is not a DimensionArray, because it won't delete() its contents
+      ParallelFor( nThreads, [ & ]( dip::uint thread ) {
+         std::vector< std::vector< uint8 >> buffers; // The outer one here is not a DimensionArray, because it won't delete() its contents
 
-      // Create input buffer data structs and allocate buffers
-      std::vector< ScanBuffer > inBuffers( nIn );  // We don't use DimensionArray here either, but we could
-      for( dip::uint ii = 0; ii < nIn; ++ii ) {
-         if( inUseBuffer[ ii ] ) {
-            if( lookUpTables[ ii ].empty() ) {
-               inBuffers[ ii ].tensorLength = in[ ii ].TensorElements();
-            } else {
-               inBuffers[ ii ].tensorLength = lookUpTables[ ii ].size();
-            }
-            inBuffers[ ii ].tensorStride = 1;
-            if( in[ ii ].Stride( processingDim ) == 0 ) {
-               // A stride of 0 means all pixels are the same, allocate space for a single pixel
-               inBuffers[ ii ].stride = 0;
-               buffers.emplace_back( inBufferTypes[ ii ].SizeOf() * inBuffers[ ii ].tensorLength );
-            } else {
-               inBuffers[ ii ].stride = static_cast< dip::sint >( inBuffers[ ii ].tensorLength );
-               buffers.emplace_back( bufferSize * inBufferTypes[ ii ].SizeOf() * inBuffers[ ii ].tensorLength );
-            }
-            inBuffers[ ii ].buffer = buffers.back().data();
-         } else {
-            inBuffers[ ii ].tensorLength = in[ ii ].TensorElements();
-            inBuffers[ ii ].tensorStride = in[ ii ].TensorStride();
-            inBuffers[ ii ].stride = in[ ii ].Stride( processingDim );
-            inBuffers[ ii ].buffer = nullptr;
-         }
-      }
-
-      // Create output buffer data structs and allocate buffers
-      std::vector< ScanBuffer > outBuffers( nOut );
-      for( dip::uint ii = 0; ii < nOut; ++ii ) {
-         if( outUseBuffer[ ii ] ) {
-            outBuffers[ ii ].tensorLength = out[ ii ].TensorElements();
-            outBuffers[ ii ].tensorStride = 1;
-            outBuffers[ ii ].stride = static_cast< dip::sint >( outBuffers[ ii ].tensorLength );
-            buffers.emplace_back( bufferSize * outBufferTypes[ ii ].SizeOf() * outBuffers[ ii ].tensorLength );
-            outBuffers[ ii ].buffer = buffers.back().data();
-         } else {
-            outBuffers[ ii ].tensorLength = out[ ii ].TensorElements();
-            outBuffers[ ii ].tensorStride = out[ ii ].TensorStride();
-            outBuffers[ ii ].stride = out[ ii ].Stride( processingDim );
-            outBuffers[ ii ].buffer = nullptr;
-         }
-      }
-
-      /*
-      std::cout << "dip::Framework::Scan -- buffers\n";
-      std::cout << "   sizes = " << sizes << std::endl;
-      std::cout << "   processing dimension = " << processingDim << std::endl;
-      std::cout << "   buffer size = " << bufferSize << std::endl;
-      for( dip::uint ii = 0; ii < nIn; ++ii ) {
-         std::cout << "   in[" << ii << "]: use buffer: " << ( inUseBuffer[ii] ? "yes" : "no" ) << std::endl;
-         std::cout << "      buffer stride: " << inBuffers[ii].stride << std::endl;
-         std::cout << "      buffer tensorStride: " << inBuffers[ii].tensorStride << std::endl;
-         std::cout << "      buffer tensorLength: " << inBuffers[ii].tensorLength << std::endl;
-         std::cout << "      buffer type: " << inBufferTypes[ii] << std::endl;
-      }
-      for( dip::uint ii = 0; ii < nOut; ++ii ) {
-         std::cout << "   out[" << ii << "]: use buffer: " << ( outUseBuffer[ii] ? "yes" : "no" ) << std::endl;
-         std::cout << "      buffer stride: " << outBuffers[ii].stride << std::endl;
-         std::cout << "      buffer tensorStride: " << outBuffers[ii].tensorStride << std::endl;
-         std::cout << "      buffer tensorLength: " << outBuffers[ii].tensorLength << std::endl;
-         std::cout << "      buffer type: " << outBufferTypes[ii] << std::endl;
-      }
-      */
-
-      UnsignedArray position = startCoords[ thread ];
-      ScanLineFilterParameters scanLineFilterParams{
-            inBuffers, outBuffers, bufferSize, processingDim, position, tensorToSpatial, thread
-      }; // Takes inBuffers, outBuffers, position as references
-      IntegerArray inOffsets( nIn );
-      for( dip::uint ii = 0; ii < nIn; ++ii ) {
-         inOffsets[ ii ] = in[ ii ].Offset( position );
-      }
-      IntegerArray outOffsets( nOut );
-      for( dip::uint ii = 0; ii < nOut; ++ii ) {
-         outOffsets[ ii ] = out[ ii ].Offset( position );
-      }
-      dip::uint lastCoord = 0;
-      if( scan1D ) {
-         lastCoord = position[ 0 ] + lineLength;
-         lastCoord = std::min( lastCoord, sizes[ 0 ] );
-      }
-
-      // Loop over nLinesPerThread image lines
-      for( dip::uint jj = 0; jj < nLinesPerThread ; ++jj ) {
-
-         // Make `bufferSize` smaller if it's the last chunk in a 1D image
-         if( scan1D ) {
-            if( position[ 0 ] >= lastCoord ) { // This *should* not happen...
-               break;
-            }
-            scanLineFilterParams.bufferLength = std::min( bufferSize, lastCoord - position[ 0 ] );
-         }
-
-         // Get pointers to input and output lines
+         // Create input buffer data structs and allocate buffers
+         std::vector< ScanBuffer > inBuffers( nIn );  // We don't use DimensionArray here either, but we could
          for( dip::uint ii = 0; ii < nIn; ++ii ) {
             if( inUseBuffer[ ii ] ) {
-               // If inOffsets[ii] and is the same as in the previous iteration, we don't need
-               // to copy the buffer over again. This happens with singleton-expanded input images.
-               // But it's easier to copy, and also safer as the lineFilter function could be bad and write in its input!
-               detail::CopyBuffer(
-                     in[ ii ].Pointer( inOffsets[ ii ] ),
-                     in[ ii ].DataType(),
-                     in[ ii ].Stride( processingDim ),
-                     in[ ii ].TensorStride(),
-                     inBuffers[ ii ].buffer,
-                     inBufferTypes[ ii ],
-                     inBuffers[ ii ].stride,
-                     inBuffers[ ii ].tensorStride,
-                     scanLineFilterParams.bufferLength, // if stride == 0, only a single pixel will be copied, because they're all the same
-                     inBuffers[ ii ].tensorLength,
-                     lookUpTables[ ii ] );
+               if( lookUpTables[ ii ].empty() ) {
+                  inBuffers[ ii ].tensorLength = in[ ii ].TensorElements();
+               } else {
+                  inBuffers[ ii ].tensorLength = lookUpTables[ ii ].size();
+               }
+               inBuffers[ ii ].tensorStride = 1;
+               if( in[ ii ].Stride( processingDim ) == 0 ) {
+                  // A stride of 0 means all pixels are the same, allocate space for a single pixel
+                  inBuffers[ ii ].stride = 0;
+                  buffers.emplace_back( inBufferTypes[ ii ].SizeOf() * inBuffers[ ii ].tensorLength );
+               } else {
+                  inBuffers[ ii ].stride = static_cast< dip::sint >( inBuffers[ ii ].tensorLength );
+                  buffers.emplace_back( bufferSize * inBufferTypes[ ii ].SizeOf() * inBuffers[ ii ].tensorLength );
+               }
+               inBuffers[ ii ].buffer = buffers.back().data();
             } else {
-               inBuffers[ ii ].buffer = in[ ii ].Pointer( inOffsets[ ii ] );
-            }
-         }
-         for( dip::uint ii = 0; ii < nOut; ++ii ) {
-            if( !outUseBuffer[ ii ] ) {
-               outBuffers[ ii ].buffer = out[ ii ].Pointer( outOffsets[ ii ] );
+               inBuffers[ ii ].tensorLength = in[ ii ].TensorElements();
+               inBuffers[ ii ].tensorStride = in[ ii ].TensorStride();
+               inBuffers[ ii ].stride = in[ ii ].Stride( processingDim );
+               inBuffers[ ii ].buffer = nullptr;
             }
          }
 
-         // Filter the line
-         lineFilter.Filter( scanLineFilterParams );
-
-         // Copy back the line from output buffer to the image
+         // Create output buffer data structs and allocate buffers
+         std::vector< ScanBuffer > outBuffers( nOut );
          for( dip::uint ii = 0; ii < nOut; ++ii ) {
             if( outUseBuffer[ ii ] ) {
-               detail::CopyBuffer(
-                     outBuffers[ ii ].buffer,
-                     outBufferTypes[ ii ],
-                     outBuffers[ ii ].stride,
-                     outBuffers[ ii ].tensorStride,
-                     out[ ii ].Pointer( outOffsets[ ii ] ),
-                     out[ ii ].DataType(),
-                     out[ ii ].Stride( processingDim ),
-                     out[ ii ].TensorStride(),
-                     scanLineFilterParams.bufferLength,
-                     outBuffers[ ii ].tensorLength );
+               outBuffers[ ii ].tensorLength = out[ ii ].TensorElements();
+               outBuffers[ ii ].tensorStride = 1;
+               outBuffers[ ii ].stride = static_cast< dip::sint >( outBuffers[ ii ].tensorLength );
+               buffers.emplace_back( bufferSize * outBufferTypes[ ii ].SizeOf() * outBuffers[ ii ].tensorLength );
+               outBuffers[ ii ].buffer = buffers.back().data();
+            } else {
+               outBuffers[ ii ].tensorLength = out[ ii ].TensorElements();
+               outBuffers[ ii ].tensorStride = out[ ii ].TensorStride();
+               outBuffers[ ii ].stride = out[ ii ].Stride( processingDim );
+               outBuffers[ ii ].buffer = nullptr;
             }
          }
 
-         // Determine which line to process next until we're done
-         if( scan1D ) {
-            position[ 0 ] += bufferSize;
+         /*
+         std::cout << "dip::Framework::Scan -- buffers\n";
+         std::cout << "   sizes = " << sizes << std::endl;
+         std::cout << "   processing dimension = " << processingDim << std::endl;
+         std::cout << "   buffer size = " << bufferSize << std::endl;
+         for( dip::uint ii = 0; ii < nIn; ++ii ) {
+            std::cout << "   in[" << ii << "]: use buffer: " << ( inUseBuffer[ii] ? "yes" : "no" ) << std::endl;
+            std::cout << "      buffer stride: " << inBuffers[ii].stride << std::endl;
+            std::cout << "      buffer tensorStride: " << inBuffers[ii].tensorStride << std::endl;
+            std::cout << "      buffer tensorLength: " << inBuffers[ii].tensorLength << std::endl;
+            std::cout << "      buffer type: " << inBufferTypes[ii] << std::endl;
+         }
+         for( dip::uint ii = 0; ii < nOut; ++ii ) {
+            std::cout << "   out[" << ii << "]: use buffer: " << ( outUseBuffer[ii] ? "yes" : "no" ) << std::endl;
+            std::cout << "      buffer stride: " << outBuffers[ii].stride << std::endl;
+            std::cout << "      buffer tensorStride: " << outBuffers[ii].tensorStride << std::endl;
+            std::cout << "      buffer tensorLength: " << outBuffers[ii].tensorLength << std::endl;
+            std::cout << "      buffer type: " << outBufferTypes[ii] << std::endl;
+         }
+         */
+
+         auto startTime = timer.Start();
+         UnsignedArray position( sizes.size(), 0 );
+         ScanLineFilterParameters scanLineFilterParams{
+               inBuffers, outBuffers, bufferSize, processingDim, position, tensorToSpatial, thread
+         }; // Takes inBuffers, outBuffers, position as references
+         IntegerArray inOffsets( nIn );
+         IntegerArray outOffsets( nOut );
+         for( dip::uint chunk = thread; chunk < chunks.size(); chunk = dispenser.Next() ) {
+            position = chunks[ chunk ].start;
             for( dip::uint ii = 0; ii < nIn; ++ii ) {
-               inOffsets[ ii ] += static_cast< dip::sint >( bufferSize ) * in[ ii ].Stride( 0 );
+               inOffsets[ ii ] = in[ ii ].Offset( position );
             }
             for( dip::uint ii = 0; ii < nOut; ++ii ) {
-               outOffsets[ ii ] += static_cast< dip::sint >( bufferSize ) * out[ ii ].Stride( 0 );
+               outOffsets[ ii ] = out[ ii ].Offset( position );
             }
-         } else {
-            dip::uint dd;
-            for( dd = 0; dd < sizes.size(); dd++ ) {
-               if( dd != processingDim ) {
-                  ++position[ dd ];
-                  for( dip::uint ii = 0; ii < nIn; ++ii ) {
-                     inOffsets[ ii ] += in[ ii ].Stride( dd );
+            dip::uint lastCoord = 0;
+            dip::uint nLines = chunks[ chunk ].nLines;
+            if( scan1D ) {
+               lastCoord = position[ 0 ] + nLines;
+               nLines = div_ceil( nLines, bufferSize );
+            }
+
+            // Loop over the image lines (or sections of the 1D image) in this chunk
+            for( dip::uint jj = 0; jj < nLines; ++jj ) {
+
+               // Make `bufferSize` smaller if it's the last chunk in a 1D image
+               if( scan1D ) {
+                  if( position[ 0 ] >= lastCoord ) { // This *should* not happen...
+                     break;
                   }
-                  for( dip::uint ii = 0; ii < nOut; ++ii ) {
-                     outOffsets[ ii ] += out[ ii ].Stride( dd );
+                  scanLineFilterParams.bufferLength = std::min( bufferSize, lastCoord - position[ 0 ] );
+               }
+
+               // Get pointers to input and output lines
+               for( dip::uint ii = 0; ii < nIn; ++ii ) {
+                  if( inUseBuffer[ ii ] ) {
+                     // If inOffsets[ii] and is the same as in the previous iteration, we don't need
+                     // to copy the buffer over again. This happens with singleton-expanded input images.
+                     // But it's easier to copy, and also safer as the lineFilter function could be bad and write in its input!
+                     detail::CopyBuffer(
+                           in[ ii ].Pointer( inOffsets[ ii ] ),
+                           in[ ii ].DataType(),
+                           in[ ii ].Stride( processingDim ),
+                           in[ ii ].TensorStride(),
+                           inBuffers[ ii ].buffer,
+                           inBufferTypes[ ii ],
+                           inBuffers[ ii ].stride,
+                           inBuffers[ ii ].tensorStride,
+                           scanLineFilterParams.bufferLength, // if stride == 0, only a single pixel will be copied, because they're all the same
+                           inBuffers[ ii ].tensorLength,
+                           lookUpTables[ ii ] );
+                  } else {
+                     inBuffers[ ii ].buffer = in[ ii ].Pointer( inOffsets[ ii ] );
                   }
-                  // Check whether we reached the last pixel of the line
-                  if( position[ dd ] != sizes[ dd ] ) {
-                     break;
+               }
+               for( dip::uint ii = 0; ii < nOut; ++ii ) {
+                  if( !outUseBuffer[ ii ] ) {
+                     outBuffers[ ii ].buffer = out[ ii ].Pointer( outOffsets[ ii ] );
                   }
-                  // Rewind along this dimension
+               }
+
+               // Filter the line
+               lineFilter.Filter( scanLineFilterParams );
+
+               // Copy back the line from output buffer to the image
+               for( dip::uint ii = 0; ii < nOut; ++ii ) {
+                  if( outUseBuffer[ ii ] ) {
+                     detail::CopyBuffer(
+                           outBuffers[ ii ].buffer,
+                           outBufferTypes[ ii ],
+                           outBuffers[ ii ].stride,
+                           outBuffers[ ii ].tensorStride,
+                           out[ ii ].Pointer( outOffsets[ ii ] ),
+                           out[ ii ].DataType(),
+                           out[ ii ].Stride( processingDim ),
+                           out[ ii ].TensorStride(),
+                           scanLineFilterParams.bufferLength,
+                           outBuffers[ ii ].tensorLength );
+                  }
+               }
+
+               // Determine which line to process next until we're done
+               if( scan1D ) {
+                  position[ 0 ] += bufferSize;
                   for( dip::uint ii = 0; ii < nIn; ++ii ) {
-                     inOffsets[ ii ] -= static_cast< dip::sint >( position[ dd ] ) * in[ ii ].Stride( dd );
+                     inOffsets[ ii ] += static_cast< dip::sint >( bufferSize ) * in[ ii ].Stride( 0 );
                   }
                   for( dip::uint ii = 0; ii < nOut; ++ii ) {
-                     outOffsets[ ii ] -= static_cast< dip::sint >( position[ dd ] ) * out[ ii ].Stride( dd );
+                     outOffsets[ ii ] += static_cast< dip::sint >( bufferSize ) * out[ ii ].Stride( 0 );
+                  }
+               } else {
+                  dip::uint dd;
+                  for( dd = 0; dd < sizes.size(); dd++ ) {
+                     if( dd != processingDim ) {
+                        ++position[ dd ];
+                        for( dip::uint ii = 0; ii < nIn; ++ii ) {
+                           inOffsets[ ii ] += in[ ii ].Stride( dd );
+                        }
+                        for( dip::uint ii = 0; ii < nOut; ++ii ) {
+                           outOffsets[ ii ] += out[ ii ].Stride( dd );
+                        }
+                        // Check whether we reached the last pixel of the line
+                        if( position[ dd ] != sizes[ dd ] ) {
+                           break;
+                        }
+                        // Rewind along this dimension
+                        for( dip::uint ii = 0; ii < nIn; ++ii ) {
+                           inOffsets[ ii ] -= static_cast< dip::sint >( position[ dd ] ) * in[ ii ].Stride( dd );
+                        }
+                        for( dip::uint ii = 0; ii < nOut; ++ii ) {
+                           outOffsets[ ii ] -= static_cast< dip::sint >( position[ dd ] ) * out[ ii ].Stride( dd );
+                        }
+                        position[ dd ] = 0;
+                        // Continue loop to increment along next dimension
+                     }
+                  }
+                  if( dd == sizes.size() ) {
+                     break;            // We're done!
                   }
-                  position[ dd ] = 0;
-                  // Continue loop to increment along next dimension
                }
             }
-            if( dd == sizes.size() ) {
-               break;            // We're done!
-            }
+            timer.AddChunk( thread, nLines );
          }
-      }
+         timer.Stop( thread, startTime );
+      } );
    } catch( dip::AssertionError const& e ) {
       if( !assertionError.IsSet() ) {
          assertionError = e;
@@ -662,6 +627,8 @@ void Scan(
    if( error.IsSet() ) {
       throw error;
    }
+   planner.Done();
+   timer.Report( "Scan" );
 }
 
 } // namespace Framework
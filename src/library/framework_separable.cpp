@@ -23,6 +23,7 @@
 #include "diplib/generic_iterators.h"
 #include "diplib/library/copy_buffer.h"
 #include "diplib/multithreading.h"
+#include "framework_support.h"
 
 namespace dip {
 namespace Framework {
@@ -202,7 +203,8 @@ void Separable(
 
    // Determine the number of threads we'll be using
    dip::uint nThreads = 1;
-   if( !opts.Contains( SeparableOption::NoMultiThreading ) && ( GetNumberOfThreads() > 1 )) {
+   ThreadingPlanner planner( typeid( lineFilter ));
+   if( !opts.Contains( SeparableOption::NoMultiThreading ) && planner.NeedsOperations( GetNumberOfThreads() )) {
       dip::uint operations = 0;
       dip::uint maxNLines = 0;
       UnsignedArray sizes = input.Sizes();
@@ -216,12 +218,10 @@ void Separable(
          }
          //std::cout << "lineLength = " << lineLength << ", nLines = " << nLines << ", operations = " << operations << std::endl;
       }
-      // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
+      // Starting threads is only worth while if the work saved compensates for the overhead
       //std::cout << "GetNumberOfThreads() = " << GetNumberOfThreads() << ", maxNLines = " << maxNLines << ", operations = " << operations << std::endl;
-      if( operations >= threadingThreshold ) {
-         // We can't do more threads than the max, and we can't do more threads than lines we have to process
-         nThreads = std::min( GetNumberOfThreads(), maxNLines );
-      }
+      // We can't do more threads than the max, and we can't do more threads than lines we have to process
+      nThreads = planner.NumberOfThreads( operations, std::min( GetNumberOfThreads(), maxNLines ));
       // Note that we pick the number of threads according to the dimension where most threads can be used.
       // It is possible that one dimension has fewer image lines than threads we're starting. We need to deal
       // with this below.
@@ -241,229 +241,221 @@ void Separable(
    ParameterError parameterError;
    RunTimeError runTimeError;
    Error error;
-   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
    try {
-      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
-
       // The temporary buffers, if needed, will be stored here (each thread their own!)
-      std::vector< uint8 > inBufferStorage;
-      std::vector< uint8 > outBufferStorage;
+      std::vector< std::vector< uint8 >> inBufferStorage( nThreads );
+      std::vector< std::vector< uint8 >> outBufferStorage( nThreads );
 
       // Iterate over the dimensions to be processed. This loop should not parallelized!
       for( dip::uint rep = 0; rep < order.size(); ++rep ) {
          dip::uint processingDim = order[ rep ];
 
-         #pragma omp master
-         {
-            // First step always reads from input, other steps read from outImage, which is either intermediate or output
-            inImage = (( rep == 0 ) ? ( input ) : ( outImage )).QuickCopy();
-            // Last step always writes to output, other steps write to intermediate or output
-            UnsignedArray sizes = inImage.Sizes();
-            outImage = (( rep == order.size() - 1 ) ? ( output ) : ( useIntermediate ? intermediate : output )).QuickCopy();
-            sizes[ processingDim ] = outSizes[ processingDim ];
-            outImage.dip__SetSizes( sizes );
-
-            //std::cout << "dip::Framework::Separable(), processingDim = " << processingDim << std::endl;
-            //std::cout << "   inImage.Origin() = " << inImage.Origin() << std::endl;
-            //std::cout << "   inImage.Sizes() = " << inImage.Sizes() << std::endl;
-            //std::cout << "   inImage.Strides() = " << inImage.Strides() << std::endl;
-            //std::cout << "   outImage.Origin() = " << outImage.Origin() << std::endl;
-            //std::cout << "   outImage.Sizes() = " << outImage.Sizes() << std::endl;
-            //std::cout << "   outImage.Strides() = " << outImage.Strides() << std::endl;
-
-            // Divide the image domain into nThreads chunks for split processing. The last chunk will have same or fewer
-            // image lines to process.
-            nLinesPerThread = div_ceil( inImage.NumberOfPixels() / inSizes[ processingDim ], nThreads );
-            DIP_ASSERT( nLinesPerThread == div_ceil( outImage.NumberOfPixels() / outSizes[ processingDim ], nThreads ));
-            startCoords[ 0 ] = UnsignedArray( nDims, 0 );
-            for( dip::uint ii = 1; ii < nThreads; ++ii ) {
-               startCoords[ ii ] = startCoords[ ii - 1 ];
-               // To advance the iterator nLinesPerThread times, we increment it in whole-line steps.
-               dip::uint firstDim = processingDim == 0 ? 1 : 0;
-               dip::uint remaining = nLinesPerThread;
-               do {
-                  for( dip::uint dd = 0; dd < nDims; ++dd ) {
-                     if( dd == firstDim ) {
-                        dip::uint n = sizes[ dd ] - startCoords[ ii ][ dd ];
-                        if (remaining >= n) {
-                           // Rewinding, next loop iteration will increment the next coordinate
-                           remaining -= n;
-                           startCoords[ ii ][ dd ] = 0;
-                        } else {
-                           // Forward by `remaining`, then we're done.
-                           startCoords[ ii ][ dd ] += remaining;
-                           remaining = 0;
-                           break;
-                        }
-                     } else if( dd != processingDim ) {
-                        // Increment coordinate
-                        ++startCoords[ ii ][ dd ];
-                        // Check whether we reached the last pixel of the line
-                        if( startCoords[ ii ][ dd ] < sizes[ dd ] ) {
-                           break;
-                        }
-                        // Rewind, the next loop iteration will increment the next coordinate
+         // First step always reads from input, other steps read from outImage, which is either intermediate or output
+         inImage = (( rep == 0 ) ? ( input ) : ( outImage )).QuickCopy();
+         // Last step always writes to output, other steps write to intermediate or output
+         UnsignedArray sizes = inImage.Sizes();
+         outImage = (( rep == order.size() - 1 ) ? ( output ) : ( useIntermediate ? intermediate : output )).QuickCopy();
+         sizes[ processingDim ] = outSizes[ processingDim ];
+         outImage.dip__SetSizes( sizes );
+
+         //std::cout << "dip::Framework::Separable(), processingDim = " << processingDim << std::endl;
+         //std::cout << "   inImage.Origin() = " << inImage.Origin() << std::endl;
+         //std::cout << "   inImage.Sizes() = " << inImage.Sizes() << std::endl;
+         //std::cout << "   inImage.Strides() = " << inImage.Strides() << std::endl;
+         //std::cout << "   outImage.Origin() = " << outImage.Origin() << std::endl;
+         //std::cout << "   outImage.Sizes() = " << outImage.Sizes() << std::endl;
+         //std::cout << "   outImage.Strides() = " << outImage.Strides() << std::endl;
+
+         // Divide the image domain into nThreads chunks for split processing. The last chunk will have same or fewer
+         // image lines to process.
+         nLinesPerThread = div_ceil( inImage.NumberOfPixels() / inSizes[ processingDim ], nThreads );
+         DIP_ASSERT( nLinesPerThread == div_ceil( outImage.NumberOfPixels() / outSizes[ processingDim ], nThreads ));
+         startCoords[ 0 ] = UnsignedArray( nDims, 0 );
+         for( dip::uint ii = 1; ii < nThreads; ++ii ) {
+            startCoords[ ii ] = startCoords[ ii - 1 ];
+            // To advance the iterator nLinesPerThread times, we increment it in whole-line steps.
+            dip::uint firstDim = processingDim == 0 ? 1 : 0;
+            dip::uint remaining = nLinesPerThread;
+            do {
+               for( dip::uint dd = 0; dd < nDims; ++dd ) {
+                  if( dd == firstDim ) {
+                     dip::uint n = sizes[ dd ] - startCoords[ ii ][ dd ];
+                     if (remaining >= n) {
+                        // Rewinding, next loop iteration will increment the next coordinate
+                        remaining -= n;
                         startCoords[ ii ][ dd ] = 0;
+                     } else {
+                        // Forward by `remaining`, then we're done.
+                        startCoords[ ii ][ dd ] += remaining;
+                        remaining = 0;
+                        break;
                      }
-                  }
-               } while( remaining > 0 );
-               // If we went past the last line to process, set startCoords to an empty array, the corresponding
-               // thread will not do any work. This situation arises when there are fewer image lines than threads
-               // along this dimension.
-               for( dip::uint jj = 0; jj < sizes.size(); ++jj ) {
-                  if( startCoords[ ii ][ jj ] >= sizes[ jj ] ) {
-                     startCoords[ ii ] = {}; //
-                     break;
+                  } else if( dd != processingDim ) {
+                     // Increment coordinate
+                     ++startCoords[ ii ][ dd ];
+                     // Check whether we reached the last pixel of the line
+                     if( startCoords[ ii ][ dd ] < sizes[ dd ] ) {
+                        break;
+                     }
+                     // Rewind, the next loop iteration will increment the next coordinate
+                     startCoords[ ii ][ dd ] = 0;
                   }
                }
-               // If we have set startCoords to an empty array, the next ones will all also be empty.
-               if( startCoords[ ii ].empty() ) {
-                  for( ; ii < nThreads; ++ii ) {
-                     startCoords[ ii ] = {};
-                  }
+            } while( remaining > 0 );
+            // If we went past the last line to process, set startCoords to an empty array, the corresponding
+            // thread will not do any work. This situation arises when there are fewer image lines than threads
+            // along this dimension.
+            for( dip::uint jj = 0; jj < sizes.size(); ++jj ) {
+               if( startCoords[ ii ][ jj ] >= sizes[ jj ] ) {
+                  startCoords[ ii ] = {}; //
                   break;
                }
             }
-            //for( dip::uint ii = 1; ii < nThreads; ++ii ) {
-            //   std::cout << "   startCoords[ " << ii << " ] = " << startCoords[ ii ] << std::endl;
-            //}
-         }
-         #pragma omp barrier
-
-         if( !startCoords[ thread ].empty() ) {
-
-            // Some values to use during this iteration
-            dip::uint inLength = inSizes[ processingDim ];
-            DIP_ASSERT( inLength == inImage.Size( processingDim ));
-            dip::uint inBorder = border[ processingDim ];
-            dip::uint outLength = outSizes[ processingDim ];
-            dip::uint outBorder = opts.Contains( SeparableOption::UseOutputBorder ) ? inBorder : 0;
-
-            // Determine if we need to make a temporary buffer for this dimension
-            bool inUseBuffer = ( inImage.DataType() != bufferType ) || !lookUpTable.empty() || ( inBorder > 0 ) || opts.Contains( SeparableOption::UseInputBuffer );
-            bool outUseBuffer = ( outImage.DataType() != bufferType ) || ( outBorder > 0 );
-            if( !outUseBuffer && opts.Contains( SeparableOption::UseOutputBuffer )) {
-               // We can cheat a little here if UseOutputBuffer is given: if the samples are contiguous, there's no need to actually use the buffer.
-               outUseBuffer = !((( outImage.TensorElements() == 1 ) || ( outImage.TensorStride() == 1 ))
-                     && ( outImage.Stride( processingDim ) == static_cast< dip::sint >( outImage.TensorElements() )));
-            }
-            if( !inUseBuffer && !outUseBuffer && ( inImage.Origin() == outImage.Origin() )) {
-               // If input and output images are the same, we need to use at least one buffer!
-               inUseBuffer = true;
+            // If we have set startCoords to an empty array, the next ones will all also be empty.
+            if( startCoords[ ii ].empty() ) {
+               for( ; ii < nThreads; ++ii ) {
+                  startCoords[ ii ] = {};
+               }
+               break;
             }
+         }
+         //for( dip::uint ii = 1; ii < nThreads; ++ii ) {
+         //   std::cout << "   startCoords[ " << ii << " ] = " << startCoords[ ii ] << std::endl;
+         //}
+
+         // Process the lines in parallel; the next iteration starts when all threads have finished their work
+         ParallelFor( nThreads, [ & ]( dip::uint thread ) {
+            if( !startCoords[ thread ].empty() ) {
+
+               // Some values to use during this iteration
+               dip::uint inLength = inSizes[ processingDim ];
+               DIP_ASSERT( inLength == inImage.Size( processingDim ));
+               dip::uint inBorder = border[ processingDim ];
+               dip::uint outLength = outSizes[ processingDim ];
+               dip::uint outBorder = opts.Contains( SeparableOption::UseOutputBorder ) ? inBorder : 0;
+
+               // Determine if we need to make a temporary buffer for this dimension
+               bool inUseBuffer = ( inImage.DataType() != bufferType ) || !lookUpTable.empty() || ( inBorder > 0 ) || opts.Contains( SeparableOption::UseInputBuffer );
+               bool outUseBuffer = ( outImage.DataType() != bufferType ) || ( outBorder > 0 );
+               if( !outUseBuffer && opts.Contains( SeparableOption::UseOutputBuffer )) {
+                  // We can cheat a little here if UseOutputBuffer is given: if the samples are contiguous, there's no need to actually use the buffer.
+                  outUseBuffer = !((( outImage.TensorElements() == 1 ) || ( outImage.TensorStride() == 1 ))
+                        && ( outImage.Stride( processingDim ) == static_cast< dip::sint >( outImage.TensorElements() )));
+               }
+               if( !inUseBuffer && !outUseBuffer && ( inImage.Origin() == outImage.Origin() )) {
+                  // If input and output images are the same, we need to use at least one buffer!
+                  inUseBuffer = true;
+               }
 
-            // Create buffer data structs and (re-)allocate buffers
-            SeparableBuffer inBuffer;
-            inBuffer.length = inLength;
-            inBuffer.border = inBorder;
-            if( inUseBuffer ) {
-               if( lookUpTable.empty() ) {
-                  inBuffer.tensorLength = inImage.TensorElements();
+               // Create buffer data structs and (re-)allocate buffers
+               SeparableBuffer inBuffer;
+               inBuffer.length = inLength;
+               inBuffer.border = inBorder;
+               if( inUseBuffer ) {
+                  if( lookUpTable.empty() ) {
+                     inBuffer.tensorLength = inImage.TensorElements();
+                  } else {
+                     inBuffer.tensorLength = lookUpTable.size();
+                  }
+                  inBuffer.tensorStride = 1;
+                  if( inImage.Stride( processingDim ) == 0 ) {
+                     // A stride of 0 means all pixels are the same, allocate space for a single pixel
+                     inBuffer.stride = 0;
+                     inBufferStorage[ thread ].resize( bufferType.SizeOf() * inBuffer.tensorLength );
+                     //std::cout << "   Using input buffer, stride = 0\n";
+                  } else {
+                     inBuffer.stride = static_cast< dip::sint >( inBuffer.tensorLength );
+                     inBufferStorage[ thread ].resize(( inLength + 2 * inBorder ) * bufferType.SizeOf() * inBuffer.tensorLength );
+                     //std::cout << "   Using input buffer, size = " << inBufferStorage[ thread ].size() << std::endl;
+                  }
+                  inBuffer.buffer = inBufferStorage[ thread ].data() + inBorder * bufferType.SizeOf() * inBuffer.tensorLength;
                } else {
-                  inBuffer.tensorLength = lookUpTable.size();
+                  inBuffer.tensorLength = inImage.TensorElements();
+                  inBuffer.tensorStride = inImage.TensorStride();
+                  inBuffer.stride = inImage.Stride( processingDim );
+                  inBuffer.buffer = nullptr;
+                  //std::cout << "   Not using input buffer\n";
                }
-               inBuffer.tensorStride = 1;
-               if( inImage.Stride( processingDim ) == 0 ) {
-                  // A stride of 0 means all pixels are the same, allocate space for a single pixel
-                  inBuffer.stride = 0;
-                  inBufferStorage.resize( bufferType.SizeOf() * inBuffer.tensorLength );
-                  //std::cout << "   Using input buffer, stride = 0\n";
+               SeparableBuffer outBuffer;
+               outBuffer.length = outLength;
+               outBuffer.border = outBorder;
+               outBuffer.tensorLength = outImage.TensorElements();
+               if( outUseBuffer ) {
+                  outBuffer.tensorStride = 1;
+                  outBuffer.stride = static_cast< dip::sint >( outBuffer.tensorLength );
+                  outBufferStorage[ thread ].resize(( outLength + 2 * outBorder ) * bufferType.SizeOf() * outBuffer.tensorLength );
+                  outBuffer.buffer = outBufferStorage[ thread ].data() + outBorder * bufferType.SizeOf() * outBuffer.tensorLength;
+                  //std::cout << "   Using output buffer, size = " << outBufferStorage[ thread ].size() << std::endl;
                } else {
-                  inBuffer.stride = static_cast< dip::sint >( inBuffer.tensorLength );
-                  inBufferStorage.resize(( inLength + 2 * inBorder ) * bufferType.SizeOf() * inBuffer.tensorLength );
-                  //std::cout << "   Using input buffer, size = " << inBufferStorage.size() << std::endl;
+                  outBuffer.tensorStride = outImage.TensorStride();
+                  outBuffer.stride = outImage.Stride( processingDim );
+                  outBuffer.buffer = nullptr;
+                  //std::cout << "   Not using output buffer\n";
                }
-               inBuffer.buffer = inBufferStorage.data() + inBorder * bufferType.SizeOf() * inBuffer.tensorLength;
-            } else {
-               inBuffer.tensorLength = inImage.TensorElements();
-               inBuffer.tensorStride = inImage.TensorStride();
-               inBuffer.stride = inImage.Stride( processingDim );
-               inBuffer.buffer = nullptr;
-               //std::cout << "   Not using input buffer\n";
-            }
-            SeparableBuffer outBuffer;
-            outBuffer.length = outLength;
-            outBuffer.border = outBorder;
-            outBuffer.tensorLength = outImage.TensorElements();
-            if( outUseBuffer ) {
-               outBuffer.tensorStride = 1;
-               outBuffer.stride = static_cast< dip::sint >( outBuffer.tensorLength );
-               outBufferStorage.resize(( outLength + 2 * outBorder ) * bufferType.SizeOf() * outBuffer.tensorLength );
-               outBuffer.buffer = outBufferStorage.data() + outBorder * bufferType.SizeOf() * outBuffer.tensorLength;
-               //std::cout << "   Using output buffer, size = " << outBufferStorage.size() << std::endl;
-            } else {
-               outBuffer.tensorStride = outImage.TensorStride();
-               outBuffer.stride = outImage.Stride( processingDim );
-               outBuffer.buffer = nullptr;
-               //std::cout << "   Not using output buffer\n";
-            }
 
-            // Loop over nLinesPerThread image lines
-            GenericJointImageIterator< 2 > it( { inImage, outImage }, processingDim );
-            it.SetCoordinates( startCoords[ thread ] );
-            SeparableLineFilterParameters separableLineFilterParams{
-                  inBuffer, outBuffer, processingDim, rep, order.size(), it.Coordinates(), tensorToSpatial, thread
-            }; // Takes inBuffer, outBuffer, it.Coordinates() as references
-            for( dip::uint ii = 0; ( ii < nLinesPerThread ) && it; ++ii, ++it ) {
-               // Get pointers to input and output lines
-               if( inUseBuffer ) {
-                  detail::CopyBuffer(
-                        it.InPointer(),
-                        inImage.DataType(),
-                        inImage.Stride( processingDim ),
-                        inImage.TensorStride(),
-                        inBuffer.buffer,
-                        bufferType,
-                        inBuffer.stride,
-                        inBuffer.tensorStride,
-                        inLength, // if stride == 0, only a single pixel will be copied, because they're all the same
-                        inBuffer.tensorLength,
-                        lookUpTable );
-                  if(( inBorder > 0 ) && ( inBuffer.stride != 0 )) {
-                     detail::ExpandBuffer(
+               // Loop over nLinesPerThread image lines
+               GenericJointImageIterator< 2 > it( { inImage, outImage }, processingDim );
+               it.SetCoordinates( startCoords[ thread ] );
+               SeparableLineFilterParameters separableLineFilterParams{
+                     inBuffer, outBuffer, processingDim, rep, order.size(), it.Coordinates(), tensorToSpatial, thread
+               }; // Takes inBuffer, outBuffer, it.Coordinates() as references
+               for( dip::uint ii = 0; ( ii < nLinesPerThread ) && it; ++ii, ++it ) {
+                  // Get pointers to input and output lines
+                  if( inUseBuffer ) {
+                     detail::CopyBuffer(
+                           it.InPointer(),
+                           inImage.DataType(),
+                           inImage.Stride( processingDim ),
+                           inImage.TensorStride(),
                            inBuffer.buffer,
                            bufferType,
                            inBuffer.stride,
                            inBuffer.tensorStride,
-                           inLength,
+                           inLength, // if stride == 0, only a single pixel will be copied, because they're all the same
                            inBuffer.tensorLength,
-                           inBorder,
-                           inBorder,
-                           boundaryConditions[ processingDim ] );
+                           lookUpTable );
+                     if(( inBorder > 0 ) && ( inBuffer.stride != 0 )) {
+                        detail::ExpandBuffer(
+                              inBuffer.buffer,
+                              bufferType,
+                              inBuffer.stride,
+                              inBuffer.tensorStride,
+                              inLength,
+                              inBuffer.tensorLength,
+                              inBorder,
+                              inBorder,
+                              boundaryConditions[ processingDim ] );
+                     }
+                  } else {
+                     inBuffer.buffer = it.InPointer();
+                  }
+                  if( !outUseBuffer ) {
+                     outBuffer.buffer = it.OutPointer();
                   }
-               } else {
-                  inBuffer.buffer = it.InPointer();
-               }
-               if( !outUseBuffer ) {
-                  outBuffer.buffer = it.OutPointer();
-               }
 
-               // Filter the line
-               lineFilter.Filter( separableLineFilterParams );
+                  // Filter the line
+                  lineFilter.Filter( separableLineFilterParams );
 
-               // Copy back the line from output buffer to the image
-               if( outUseBuffer ) {
-                  detail::CopyBuffer(
-                        outBuffer.buffer,
-                        bufferType,
-                        outBuffer.stride,
-                        outBuffer.tensorStride,
-                        it.OutPointer(),
-                        outImage.DataType(),
-                        outImage.Stride( processingDim ),
-                        outImage.TensorStride(),
-                        outLength,
-                        outBuffer.tensorLength );
+                  // Copy back the line from output buffer to the image
+                  if( outUseBuffer ) {
+                     detail::CopyBuffer(
+                           outBuffer.buffer,
+                           bufferType,
+                           outBuffer.stride,
+                           outBuffer.tensorStride,
+                           it.OutPointer(),
+                           outImage.DataType(),
+                           outImage.Stride( processingDim ),
+                           outImage.TensorStride(),
+                           outLength,
+                           outBuffer.tensorLength );
+                  }
                }
             }
-         }
-
-         // Wait to start the next iteration until all threads have finished their work
-         #pragma omp barrier
+         } );
 
          // Clear the tensor look-up table: if it was defined, then the intermediate data now has a full matrix
          // as tensor shape and we don't need it any more.
-         #pragma omp master
          lookUpTable.clear();
       }
    } catch( dip::AssertionError const& e ) {
@@ -504,6 +496,7 @@ void Separable(
    if( error.IsSet() ) {
       throw error;
    }
+   planner.Done();
 }
 
 } // namespace Framework
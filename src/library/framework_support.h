@@ -0,0 +1,134 @@
+/*
+ * DIPlib 3.0
+ * This file declares internal functions used by the Scan and Full frameworks to divide work among threads.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_FRAMEWORK_SUPPORT_H
+#define DIP_FRAMEWORK_SUPPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <typeinfo>
+
+#include "diplib.h"
+#include "diplib/multithreading.h"
+
+namespace dip {
+namespace Framework {
+
+// Splits `nUnits` work units into chunks to be processed by `nThreads` threads, according to `schedule`.
+// Returns the size of each chunk, in the order in which they are to be handed out. The first chunk is
+// always the largest one. With a single thread, there is always a single chunk.
+DIP_NO_EXPORT std::vector< dip::uint > ChunkSizes( dip::uint nUnits, dip::uint nThreads, WorkSchedule schedule );
+
+// A chunk of consecutive image lines: `start` are the coordinates of the first pixel of the first line.
+struct DIP_NO_EXPORT LineChunk {
+   UnsignedArray start;
+   dip::uint nLines;
+};
+
+// Splits the image lines along `processingDim` of an image of size `sizes` into chunks as given by
+// `ChunkSizes`, and computes the coordinates for the start of each chunk.
+DIP_NO_EXPORT std::vector< LineChunk > SplitLines(
+      UnsignedArray const& sizes,
+      dip::uint processingDim,
+      dip::uint nThreads,
+      WorkSchedule schedule
+);
+
+// Hands out chunks to threads. Thread `thread` first processes chunk `thread`, then calls `Next` to get the
+// next chunk, until it gets an index out of range. This way each thread processes at least one chunk (line
+// filters often initialize their per-thread data on the first call), and with the static schedule each thread
+// processes exactly the one chunk, as always.
+class DIP_NO_EXPORT ChunkDispenser {
+   public:
+      explicit ChunkDispenser( dip::uint nThreads ) : next_( nThreads ) {}
+      dip::uint Next() {
+         return next_++;
+      }
+   private:
+      std::atomic< dip::uint > next_;
+};
+
+// Measures per-thread timing, only if a `dip::ThreadTimingHook` is set.
+class DIP_NO_EXPORT ThreadTimer {
+   public:
+      explicit ThreadTimer( dip::uint nThreads ) : enabled_( static_cast< bool >( GetThreadTimingHook() )) {
+         if( enabled_ ) {
+            timing_.resize( nThreads );
+         }
+      }
+      // Call at the start of the thread's work
+      std::chrono::steady_clock::time_point Start() const {
+         return enabled_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+      }
+      // Call after each chunk processed
+      void AddChunk( dip::uint thread, dip::uint nLines ) {
+         if( enabled_ ) {
+            ++timing_[ thread ].chunks;
+            timing_[ thread ].lines += nLines;
+         }
+      }
+      // Call at the end of the thread's work
+      void Stop( dip::uint thread, std::chrono::steady_clock::time_point start ) {
+         if( enabled_ ) {
+            timing_[ thread ].seconds = std::chrono::duration< dfloat >( std::chrono::steady_clock::now() - start ).count();
+         }
+      }
+      // Call after all threads are done
+      void Report( String const& framework ) const {
+         if( enabled_ ) {
+            GetThreadTimingHook()( framework, timing_ );
+         }
+      }
+   private:
+      bool enabled_;
+      std::vector< ThreadTiming > timing_;
+};
+
+// Chooses the number of threads for a framework function, using the `dip::ThreadingCostModel`. While
+// `dip::CalibrateThreading` runs in this thread, instead always chooses a single thread, and measures the
+// time spent by the line filter for the calibration. Framework calls nested within a measured call are
+// not measured.
+class DIP_NO_EXPORT ThreadingPlanner {
+   public:
+      // `lineFilter` is the type of the line filter (i.e. `typeid( lineFilter )`)
+      explicit ThreadingPlanner( std::type_info const& lineFilter );
+      ~ThreadingPlanner();
+      ThreadingPlanner( ThreadingPlanner const& ) = delete;
+      ThreadingPlanner& operator=( ThreadingPlanner const& ) = delete;
+      // True if `NumberOfThreads` needs to be called: if multiple threads are available or while calibrating.
+      bool NeedsOperations( dip::uint maxThreads ) const {
+         return ( maxThreads > 1 ) || measuring_;
+      }
+      // Returns the number of threads to use for doing `operations` operations, at most `maxThreads`
+      dip::uint NumberOfThreads( dip::uint operations, dip::uint maxThreads );
+      // Call after all the work is done
+      void Done();
+   private:
+      char const* lineFilter_;
+      bool calibrating_;      // `dip::CalibrateThreading` runs in this thread
+      bool measuring_;        // this call is to be measured
+      bool started_ = false;  // the time measurement was started
+      dip::uint operations_ = 0;
+      std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace Framework
+} // namespace dip
+
+#endif // DIP_FRAMEWORK_SUPPORT_H
@@ -18,6 +18,14 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "diplib.h"
 #include "diplib/multithreading.h"
 
 namespace dip {
@@ -26,6 +34,19 @@ namespace {
 
 dip::uint maxNumberOfThreads = static_cast< dip::uint >( omp_get_max_threads() ); // This responds to the OMP_NUM_THREADS environment variable.
 
+// Set while the current thread runs a task for `ParallelFor`.
+thread_local bool insideTask = false;
+
+std::shared_ptr< TaskScheduler > DefaultTaskScheduler() {
+   return std::make_shared< WorkStealingTaskScheduler >( static_cast< dip::uint >( omp_get_max_threads() ));
+}
+
+std::shared_ptr< TaskScheduler > taskScheduler = DefaultTaskScheduler();
+
+WorkSchedule workSchedule = WorkSchedule::Static;
+
+ThreadTimingHook threadTimingHook;
+
 }
 
 void SetNumberOfThreads( dip::uint nThreads ) {
@@ -37,7 +58,391 @@ void SetNumberOfThreads( dip::uint nThreads ) {
 }
 
 dip::uint GetNumberOfThreads() {
-   return maxNumberOfThreads;
+#ifdef _OPENMP
+   // Inside a parallel region, a nested parallel region gets only one thread unless nested parallelism is enabled.
+   // Our algorithms divide the work according to the number of threads requested, so we must not request more.
+   if( omp_get_active_level() >= omp_get_max_active_levels() ) {
+      return 1;
+   }
+#endif
+   if( insideTask ) {
+      return 1;
+   }
+   return std::min( maxNumberOfThreads, taskScheduler->Concurrency() );
+}
+
+namespace {
+
+// The state of a call to `WorkStealingTaskScheduler::Run`. Each participating thread has a slot, with a range of
+// task indices that it processes from the front. When its range is empty, it takes the back half of another
+// thread's range.
+class WorkStealingJob {
+   public:
+      WorkStealingJob( std::function< void( dip::uint ) > const& task, dip::uint nTasks, dip::uint nSlots )
+            : task_( &task ), nTasks_( nTasks ), ranges_( nSlots ) {
+         for( dip::uint ii = 0; ii < nSlots; ++ii ) {
+            ranges_[ ii ].begin = ii * nTasks / nSlots;
+            ranges_[ ii ].end = ( ii + 1 ) * nTasks / nSlots;
+         }
+      }
+
+      dip::uint NumberOfSlots() const { return ranges_.size(); }
+
+      // Runs tasks until there are none left to claim, `slot` must be unique to this thread
+      void Work( dip::uint slot ) {
+         dip::uint count = 0;
+         dip::uint index;
+         do {
+            while( Pop( slot, index )) {
+               ( *task_ )( index );
+               ++count;
+            }
+         } while( Steal( slot ));
+         if( count > 0 ) {
+            std::lock_guard< std::mutex > lock( mutex_ );
+            done_ += count;
+            if( done_ == nTasks_ ) {
+               finished_.notify_all();
+            }
+         }
+      }
+
+      // Waits for tasks that are still running in other threads
+      void Wait() {
+         std::unique_lock< std::mutex > lock( mutex_ );
+         finished_.wait( lock, [ this ] { return done_ == nTasks_; } );
+      }
+
+   private:
+      struct Range {
+         std::mutex mutex;
+         dip::uint begin = 0;
+         dip::uint end = 0;
+      };
+
+      std::function< void( dip::uint ) > const* task_; // Not used after all tasks are done
+      dip::uint nTasks_;
+      std::vector< Range > ranges_;
+      dip::uint done_ = 0;
+      std::mutex mutex_;
+      std::condition_variable finished_;
+
+      bool Pop( dip::uint slot, dip::uint& index ) {
+         Range& range = ranges_[ slot ];
+         std::lock_guard< std::mutex > lock( range.mutex );
+         if( range.begin == range.end ) {
+            return false;
+         }
+         index = range.begin++;
+         return true;
+      }
+
+      bool Steal( dip::uint slot ) {
+         for( dip::uint ii = 1; ii < ranges_.size(); ++ii ) {
+            Range& victim = ranges_[ ( slot + ii ) % ranges_.size() ];
+            dip::uint begin, end;
+            {
+               std::lock_guard< std::mutex > lock( victim.mutex );
+               dip::uint remaining = victim.end - victim.begin;
+               if( remaining == 0 ) {
+                  continue;
+               }
+               end = victim.end;
+               victim.end -= ( remaining + 1 ) / 2;
+               begin = victim.end;
+            }
+            // Our own range is empty, and other threads don't add to it
+            Range& own = ranges_[ slot ];
+            std::lock_guard< std::mutex > lock( own.mutex );
+            own.begin = begin;
+            own.end = end;
+            return true;
+         }
+         return false;
+      }
+};
+
+} // namespace
+
+// The threads of a `WorkStealingTaskScheduler`. Each thread waits for a job, takes a slot in it, and works
+// on it until no tasks are left to claim.
+class WorkStealingTaskScheduler::Pool {
+   public:
+      explicit Pool( dip::uint nThreads ) : nThreads_( nThreads ) {}
+
+      ~Pool() {
+         {
+            std::lock_guard< std::mutex > lock( mutex_ );
+            stop_ = true;
+         }
+         wake_.notify_all();
+         for( auto& thread : threads_ ) {
+            thread.join();
+         }
+      }
+
+      // Makes `job` available to the pool's threads, slot 0 is reserved for the calling thread
+      void Submit( std::shared_ptr< WorkStealingJob > const& job ) {
+         std::call_once( started_, [ this ] {
+            threads_.reserve( nThreads_ );
+            for( dip::uint ii = 0; ii < nThreads_; ++ii ) {
+               threads_.emplace_back( [ this ] { WorkerLoop(); } );
+            }
+         } );
+         {
+            std::lock_guard< std::mutex > lock( mutex_ );
+            jobs_.push_back( Entry{ job, 1 } );
+         }
+         if( job->NumberOfSlots() > 2 ) {
+            wake_.notify_all();
+         } else {
+            wake_.notify_one();
+         }
+      }
+
+      // Removes `job` if not all its slots were taken
+      void Withdraw( std::shared_ptr< WorkStealingJob > const& job ) {
+         std::lock_guard< std::mutex > lock( mutex_ );
+         auto it = std::find_if( jobs_.begin(), jobs_.end(), [ & ]( Entry const& entry ) { return entry.job == job; } );
+         if( it != jobs_.end() ) {
+            jobs_.erase( it );
+         }
+      }
+
+   private:
+      struct Entry {
+         std::shared_ptr< WorkStealingJob > job;
+         dip::uint nextSlot;
+      };
+
+      dip::uint nThreads_;
+      std::vector< std::thread > threads_;
+      std::once_flag started_;
+      std::deque< Entry > jobs_;
+      std::mutex mutex_;
+      std::condition_variable wake_;
+      bool stop_ = false;
+
+      void WorkerLoop() {
+         while( true ) {
+            std::shared_ptr< WorkStealingJob > job;
+            dip::uint slot;
+            {
+               std::unique_lock< std::mutex > lock( mutex_ );
+               wake_.wait( lock, [ this ] { return stop_ || !jobs_.empty(); } );
+               if( stop_ ) {
+                  return;
+               }
+               Entry& entry = jobs_.front();
+               job = entry.job;
+               slot = entry.nextSlot++;
+               if( entry.nextSlot == job->NumberOfSlots() ) {
+                  jobs_.pop_front();
+               }
+            }
+            job->Work( slot );
+         }
+      }
+};
+
+WorkStealingTaskScheduler::WorkStealingTaskScheduler( dip::uint nThreads )
+      : concurrency_( std::max< dip::uint >( nThreads, 1 )) {
+   pool_ = std::make_unique< Pool >( concurrency_ - 1 );
+}
+
+WorkStealingTaskScheduler::~WorkStealingTaskScheduler() = default;
+
+void WorkStealingTaskScheduler::Run( dip::uint nTasks, std::function< void( dip::uint ) > const& task ) {
+   dip::uint nSlots = std::min( std::min( concurrency_, maxNumberOfThreads ), nTasks );
+   if( nSlots <= 1 ) {
+      for( dip::uint ii = 0; ii < nTasks; ++ii ) {
+         task( ii );
+      }
+      return;
+   }
+   // The pool's threads can take a slot after this function returns, so they share ownership of the job
+   auto job = std::make_shared< WorkStealingJob >( task, nTasks, nSlots );
+   pool_->Submit( job );
+   job->Work( 0 );
+   pool_->Withdraw( job );
+   job->Wait();
+}
+
+void ExecutorTaskScheduler::Run( dip::uint nTasks, std::function< void( dip::uint ) > const& task ) {
+   if( nTasks == 0 ) {
+      return;
+   }
+   // Tasks are claimed through `next`, by the calling thread and by the jobs submitted to the executor.
+   // The jobs can start after this function returns, so they share ownership of the state.
+   struct State {
+      std::function< void( dip::uint ) > const* task;
+      dip::uint nTasks;
+      std::atomic< dip::uint > next{ 0 };
+      dip::uint done = 0;
+      std::mutex mutex;
+      std::condition_variable finished;
+      void Work() {
+         dip::uint count = 0;
+         for( dip::uint ii = next++; ii < nTasks; ii = next++ ) {
+            ( *task )( ii );
+            ++count;
+         }
+         if( count > 0 ) {
+            std::lock_guard< std::mutex > lock( mutex );
+            done += count;
+            if( done == nTasks ) {
+               finished.notify_all();
+            }
+         }
+      }
+   };
+   auto state = std::make_shared< State >();
+   state->task = &task;
+   state->nTasks = nTasks;
+   dip::uint nJobs = std::min( concurrency_, nTasks ) - 1;
+   for( dip::uint ii = 0; ii < nJobs; ++ii ) {
+      submit_( [ state ]() { state->Work(); } );
+   }
+   state->Work();
+   // Wait for the tasks that are still running in other threads. Jobs that start later don't touch `task`.
+   std::unique_lock< std::mutex > lock( state->mutex );
+   state->finished.wait( lock, [ & ] { return state->done == nTasks; } );
+}
+
+void SetTaskScheduler( std::shared_ptr< TaskScheduler > scheduler ) {
+   if( scheduler ) {
+      taskScheduler = std::move( scheduler );
+   } else {
+      taskScheduler = DefaultTaskScheduler();
+   }
+}
+
+TaskScheduler& GetTaskScheduler() {
+   return *taskScheduler;
+}
+
+void SetWorkSchedule( WorkSchedule schedule ) {
+   workSchedule = schedule;
+}
+
+WorkSchedule GetWorkSchedule() {
+   return workSchedule;
+}
+
+void SetThreadTimingHook( ThreadTimingHook hook ) {
+   threadTimingHook = std::move( hook );
+}
+
+ThreadTimingHook const& GetThreadTimingHook() {
+   return threadTimingHook;
+}
+
+void ParallelFor( dip::uint n, std::function< void( dip::uint ) > const& function ) {
+   if( n == 0 ) {
+      return;
+   }
+   if(( n == 1 ) || ( GetNumberOfThreads() == 1 )) {
+      for( dip::uint ii = 0; ii < n; ++ii ) {
+         function( ii );
+      }
+      return;
+   }
+   // Exceptions cannot propagate out of the tasks, we catch the first one and throw it after
+   std::exception_ptr error;
+   std::mutex errorMutex;
+   std::atomic< bool > failed{ false };
+   taskScheduler->Run( n, [ & ]( dip::uint ii ) {
+      if( failed ) {
+         return;
+      }
+      bool wasInsideTask = insideTask; // The calling thread can run tasks too
+      insideTask = true;
+      try {
+         function( ii );
+      } catch( ... ) {
+         std::lock_guard< std::mutex > lock( errorMutex );
+         if( !error ) {
+            error = std::current_exception();
+         }
+         failed = true;
+      }
+      insideTask = wasInsideTask;
+   } );
+   if( error ) {
+      std::rethrow_exception( error );
+   }
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/linear.h"
+#include "diplib/random.h"
+#include "diplib/generation.h"
+#include "diplib/statistics.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::ParallelFor") {
+   std::vector< dip::uint > nThreads( 50, 0 );
+   dip::ParallelFor( nThreads.size(), [ & ]( dip::uint ii ) {
+      nThreads[ ii ] = dip::GetNumberOfThreads(); // always 1 inside the parallel region
+   } );
+   DOCTEST_CHECK( std::all_of( nThreads.begin(), nThreads.end(), []( dip::uint n ) { return n == 1; } ));
+   DOCTEST_CHECK_THROWS( dip::ParallelFor( 10, []( dip::uint ii ) {
+      DIP_THROW_IF( ii == 3, "Test exception" );
+   } ));
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::WorkStealingTaskScheduler") {
+   dip::WorkStealingTaskScheduler scheduler( 4 );
+   DOCTEST_CHECK( scheduler.Concurrency() == 4 );
+   // Tasks with very different costs, each must run exactly once
+   std::vector< std::atomic< dip::uint >> count( 200 );
+   auto task = [ & ]( dip::uint ii ) {
+      if( ii < 10 ) {
+         std::this_thread::sleep_for( std::chrono::milliseconds( 2 ));
+      }
+      ++count[ ii ];
+   };
+   scheduler.Run( count.size(), task );
+   DOCTEST_CHECK( std::all_of( count.begin(), count.end(), []( std::atomic< dip::uint > const& n ) { return n == 1; } ));
+   // Concurrent calls, and calls from within a task
+   std::thread other( [ & ] { scheduler.Run( count.size(), task ); } );
+   scheduler.Run( 4, [ & ]( dip::uint ii ) {
+      scheduler.Run( count.size() / 4, [ & ]( dip::uint jj ) { task( ii * count.size() / 4 + jj ); } );
+   } );
+   other.join();
+   DOCTEST_CHECK( std::all_of( count.begin(), count.end(), []( std::atomic< dip::uint > const& n ) { return n == 3; } ));
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::ExecutorTaskScheduler") {
+   std::vector< dip::uint > count( 20, 0 );
+   auto task = [ & ]( dip::uint ii ) { ++count[ ii ]; };
+   // An executor that doesn't run any jobs before `Run` returns: the calling thread must do all the work
+   std::vector< std::function< void() >> queue;
+   dip::ExecutorTaskScheduler deferred( [ & ]( std::function< void() > job ) { queue.push_back( std::move( job )); }, 4 );
+   deferred.Run( count.size(), task );
+   DOCTEST_CHECK( queue.size() == 3 );
+   for( auto& job : queue ) {
+      job(); // There's no work left for these
+   }
+   DOCTEST_CHECK( std::all_of( count.begin(), count.end(), []( dip::uint n ) { return n == 1; } ));
+   // An executor that runs jobs immediately
+   auto immediate = []( std::function< void() > job ) { job(); };
+   dip::ExecutorTaskScheduler( immediate, 4 ).Run( count.size(), task );
+   DOCTEST_CHECK( std::all_of( count.begin(), count.end(), []( dip::uint n ) { return n == 2; } ));
+   // The frameworks produce the same results with a different scheduler
+   dip::Image img{ dip::UnsignedArray{ 200, 150 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random );
+   dip::Image ref = dip::Gauss( img, { 3.0 } );
+   dip::SetTaskScheduler( std::make_shared< dip::ExecutorTaskScheduler >( immediate, 3 ));
+   DOCTEST_CHECK( dip::GetNumberOfThreads() <= 3 );
+   dip::Image result = dip::Gauss( img, { 3.0 } );
+   dip::SetTaskScheduler( nullptr );
+   DOCTEST_CHECK( dip::Count( result != ref ) == 0 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -0,0 +1,402 @@
+/*
+ * DIPlib 3.0
+ * This file contains the definition of the threading cost model and its calibration.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+
+#include "diplib.h"
+#include "diplib/multithreading.h"
+#include "diplib/generation.h"
+#include "diplib/linear.h"
+#include "diplib/math.h"
+#include "diplib/morphology.h"
+#include "diplib/nonlinear.h"
+#include "diplib/random.h"
+#include "framework_support.h"
+
+namespace dip {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+dfloat SecondsSince( Clock::time_point start ) {
+   return std::chrono::duration< dfloat >( Clock::now() - start ).count();
+}
+
+// Time spent and operations done, per line filter
+struct FilterCost {
+   dfloat seconds = 0;
+   dfloat operations = 0;
+};
+using CalibrationRecord = std::map< String, FilterCost >;
+
+// Set while `CalibrateThreading` runs in this thread.
+thread_local CalibrationRecord* calibrationRecord = nullptr;
+
+// Set while a framework function is being measured in this thread, so that nested calls are not measured too.
+thread_local bool measurementRunning = false;
+
+// Identifies this build of the library. Line filter type names (the keys in `filterCostFactors`) are generated
+// by the compiler, and only meaningful within one build.
+String BuildIdentifier() {
+#ifdef DIP_VERSION_STRING
+   String id = "DIPlib " DIP_VERSION_STRING;
+#else
+   String id = "DIPlib";
+#endif
+#if defined( __clang__ )
+   id += ", clang " __clang_version__;
+#elif defined( __GNUC__ )
+   id += ", gcc " __VERSION__;
+#elif defined( _MSC_FULL_VER )
+   id += ", msvc " + std::to_string( _MSC_FULL_VER );
+#endif
+   return id;
+}
+
+// Median time of running `ParallelFor` with `nTasks` tasks that do nothing
+dfloat ParallelForOverhead( dip::uint nTasks ) {
+   constexpr dip::uint repetitions = 25;
+   std::vector< dfloat > times( repetitions );
+   for( auto& time : times ) {
+      auto start = Clock::now();
+      ParallelFor( nTasks, []( dip::uint ) {} );
+      time = SecondsSince( start );
+   }
+   std::nth_element( times.begin(), times.begin() + repetitions / 2, times.end() );
+   return times[ repetitions / 2 ];
+}
+
+std::once_flag costModelInitialized;
+ThreadingCostModel costModel;
+
+// Set while `InitializeCostModel` runs in this thread.
+thread_local bool initializingCostModel = false;
+
+// Reads the model from the file given by `DIP_THREADING_MODEL`, or creates that file.
+void InitializeCostModel() {
+   char const* filename = std::getenv( "DIP_THREADING_MODEL" );
+   if( !filename || !*filename ) {
+      return;
+   }
+   if( std::ifstream( filename )) {
+      try {
+         costModel = LoadThreadingCostModel( filename );
+         return;
+      } catch( Error const& ) {
+         // The file is not valid, overwrite it below
+      }
+   }
+   initializingCostModel = true;
+   try {
+      costModel = CalibrateThreading();
+   } catch( ... ) {
+      initializingCostModel = false;
+      throw;
+   }
+   initializingCostModel = false;
+   try {
+      SaveThreadingCostModel( costModel, filename );
+   } catch( Error const& ) {
+      // We can't write the file, we'll use the calibration for this process only
+   }
+}
+
+} // namespace
+
+dip::uint ThreadingCostModel::NumberOfThreads( dip::uint operations, dip::uint maxThreads, String const& filter ) const {
+   dfloat work = static_cast< dfloat >( operations ) * operationCost;
+   if( !filter.empty() ) {
+      auto it = filterCostFactors.find( filter );
+      if( it != filterCostFactors.end() ) {
+         work *= it->second;
+      }
+   }
+   // The expected time is convex in the number of threads, we stop at the first one that doesn't improve
+   dip::uint nThreads = 1;
+   dfloat time = work;
+   for( dip::uint n = 2; n <= maxThreads; ++n ) {
+      dfloat t = work / static_cast< dfloat >( n ) + startupCost + threadCost * static_cast< dfloat >( n - 1 );
+      if( t >= time ) {
+         break;
+      }
+      nThreads = n;
+      time = t;
+   }
+   return nThreads;
+}
+
+ThreadingCostModel CalibrateThreading() {
+   ThreadingCostModel model;
+
+   // Overhead of starting threads
+   dip::uint maxThreads = GetNumberOfThreads();
+   if( maxThreads > 1 ) {
+      ParallelForOverhead( maxThreads ); // Warm up the thread pool
+      dfloat twoThreads = ParallelForOverhead( 2 );
+      if( maxThreads > 2 ) {
+         dfloat allThreads = ParallelForOverhead( maxThreads );
+         model.threadCost = std::max( 0.0, ( allThreads - twoThreads ) / static_cast< dfloat >( maxThreads - 2 ));
+      }
+      model.startupCost = std::max( 0.0, twoThreads - model.threadCost );
+   }
+
+   // Throughput of typical line filters, in a single thread
+   Image img{ UnsignedArray{ 512, 512 }, 1, DT_SFLOAT };
+   img.Fill( 0 );
+   Random random( 0 );
+   UniformNoise( img, img, random, 0.0, 255.0 );
+   Image img8 = Convert( img, DT_UINT8 );
+   std::vector< std::function< void() >> suite = {
+         [ & ]() { Image out = img + img; },
+         [ & ]() { Image out = img8 + img8; },
+         [ & ]() { Image out = img * img; },
+         [ & ]() { Image out = Sqrt( img ); },
+         [ & ]() { Image out = Gauss( img, { 2.0 } ); },
+         [ & ]() { Image out = Uniform( img8, { 7 } ); },
+         [ & ]() { Image out = MedianFilter( img8, { 5 } ); },
+         [ & ]() { Image out = Dilation( img8, { 7, S::ELLIPTIC } ); },
+   };
+   // The first run warms up the caches, and is not used
+   CalibrationRecord warmUp;
+   CalibrationRecord record;
+   try {
+      for( dip::uint ii = 0; ii < 4; ++ii ) {
+         calibrationRecord = ii == 0 ? &warmUp : &record;
+         for( auto& function : suite ) {
+            function();
+         }
+      }
+   } catch( ... ) {
+      calibrationRecord = nullptr;
+      throw;
+   }
+   calibrationRecord = nullptr;
+   dfloat seconds = 0;
+   dfloat operations = 0;
+   for( auto const& cost : record ) {
+      seconds += cost.second.seconds;
+      operations += cost.second.operations;
+   }
+   if(( seconds > 0 ) && ( operations > 0 )) {
+      model.operationCost = seconds / operations;
+      for( auto const& cost : record ) {
+         if(( cost.second.seconds > 0 ) && ( cost.second.operations > 0 )) {
+            model.filterCostFactors[ cost.first ] = cost.second.seconds / cost.second.operations / model.operationCost;
+         }
+      }
+   }
+   return model;
+}
+
+void SaveThreadingCostModel( ThreadingCostModel const& model, String const& filename ) {
+   std::ofstream file( filename );
+   if( !file ) {
+      DIP_THROW_RUNTIME( "Could not open the file for writing: " + filename );
+   }
+   file.precision( std::numeric_limits< dfloat >::max_digits10 );
+   file << "# DIPlib threading cost model\n";
+   file << "build " << BuildIdentifier() << '\n';
+   file << "operationCost " << model.operationCost << '\n';
+   file << "threadCost " << model.threadCost << '\n';
+   file << "startupCost " << model.startupCost << '\n';
+   for( auto const& factor : model.filterCostFactors ) {
+      // The name goes last, it could contain spaces
+      file << "filter " << factor.second << ' ' << factor.first << '\n';
+   }
+   if( !file ) {
+      DIP_THROW_RUNTIME( "Could not write to the file: " + filename );
+   }
+}
+
+ThreadingCostModel LoadThreadingCostModel( String const& filename ) {
+   std::ifstream file( filename );
+   if( !file ) {
+      DIP_THROW_RUNTIME( "Could not open the file for reading: " + filename );
+   }
+   ThreadingCostModel model;
+   String build;
+   String line;
+   while( std::getline( file, line )) {
+      if( line.empty() || ( line[ 0 ] == '#' )) {
+         continue;
+      }
+      std::istringstream fields( line );
+      String key;
+      fields >> key;
+      if( key == "build" ) {
+         fields.ignore( 1 ); // The space in front of the identifier
+         std::getline( fields, build );
+         continue;
+      }
+      dfloat value;
+      fields >> value;
+      if( !fields ) {
+         DIP_THROW_RUNTIME( "Malformed threading cost model file: " + filename );
+      }
+      if( key == "operationCost" ) {
+         model.operationCost = value;
+      } else if( key == "threadCost" ) {
+         model.threadCost = value;
+      } else if( key == "startupCost" ) {
+         model.startupCost = value;
+      } else if( key == "filter" ) {
+         fields.ignore( 1 ); // The space in front of the name
+         String name;
+         std::getline( fields, name );
+         if( name.empty() ) {
+            DIP_THROW_RUNTIME( "Malformed threading cost model file: " + filename );
+         }
+         model.filterCostFactors[ name ] = value;
+      } else {
+         DIP_THROW_RUNTIME( "Malformed threading cost model file: " + filename );
+      }
+   }
+   if( build != BuildIdentifier() ) {
+      // The line filter names are not valid for this build
+      model.filterCostFactors.clear();
+   }
+   return model;
+}
+
+void SetThreadingCostModel( ThreadingCostModel model ) {
+   std::call_once( costModelInitialized, [] {} ); // The environment variable is no longer relevant
+   costModel = std::move( model );
+}
+
+ThreadingCostModel const& GetThreadingCostModel() {
+   if( initializingCostModel ) {
+      // Called from within the calibration, the default model must do
+      static ThreadingCostModel const defaultModel;
+      return defaultModel;
+   }
+   std::call_once( costModelInitialized, InitializeCostModel );
+   return costModel;
+}
+
+namespace Framework {
+
+ThreadingPlanner::ThreadingPlanner( std::type_info const& lineFilter )
+      : lineFilter_( lineFilter.name() ),
+        calibrating_( calibrationRecord != nullptr ),
+        measuring_( calibrating_ && !measurementRunning ) {}
+
+ThreadingPlanner::~ThreadingPlanner() {
+   if( started_ ) {
+      measurementRunning = false;
+   }
+}
+
+dip::uint ThreadingPlanner::NumberOfThreads( dip::uint operations, dip::uint maxThreads ) {
+   if( measuring_ ) {
+      operations_ = operations;
+      start_ = Clock::now();
+      started_ = true;
+      measurementRunning = true;
+      return 1;
+   }
+   if( calibrating_ ) {
+      // A call nested within one that is being measured
+      return 1;
+   }
+   return GetThreadingCostModel().NumberOfThreads( operations, maxThreads, lineFilter_ );
+}
+
+void ThreadingPlanner::Done() {
+   // Framework calls with `NoMultiThreading` don't call `NumberOfThreads`, and are not measured
+   if( started_ && calibrationRecord ) {
+      FilterCost& cost = ( *calibrationRecord )[ lineFilter_ ];
+      cost.seconds += SecondsSince( start_ );
+      cost.operations += static_cast< dfloat >( operations_ );
+   }
+}
+
+} // namespace Framework
+
+} // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include <cstdio>
+#include "doctest.h"
+#include "diplib/statistics.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the threading cost model") {
+   // The default model reproduces the fixed threshold
+   dip::ThreadingCostModel model;
+   DOCTEST_CHECK( model.NumberOfThreads( dip::threadingThreshold - 1000, 8 ) == 1 );
+   DOCTEST_CHECK( model.NumberOfThreads( dip::threadingThreshold + 1000, 8 ) > 1 );
+   DOCTEST_CHECK( model.NumberOfThreads( 1000 * dip::threadingThreshold, 8 ) == 8 );
+   DOCTEST_CHECK( model.NumberOfThreads( 1000 * dip::threadingThreshold, 1 ) == 1 );
+   // More threads for more work, and fewer for more expensive threads
+   model.threadCost = 1e-4;
+   dip::uint n = model.NumberOfThreads( 1000 * dip::threadingThreshold, 64 );
+   DOCTEST_CHECK( n > 2 );
+   DOCTEST_CHECK( n < 64 );
+   DOCTEST_CHECK( model.NumberOfThreads( 10000 * dip::threadingThreshold, 64 ) > n );
+   // An expensive line filter gets more threads
+   model.filterCostFactors[ "expensive" ] = 100;
+   DOCTEST_CHECK( model.NumberOfThreads( 1000 * dip::threadingThreshold, 64, "expensive" ) > n );
+
+   // Calibration measures the line filters used, and survives a round trip through a file
+   model = dip::CalibrateThreading();
+   DOCTEST_CHECK( model.operationCost > 0 );
+   DOCTEST_CHECK( model.startupCost >= 0 );
+   DOCTEST_CHECK( model.threadCost >= 0 );
+   DOCTEST_REQUIRE( model.filterCostFactors.size() >= 5 );
+   for( auto const& factor : model.filterCostFactors ) {
+      DOCTEST_CHECK( factor.second > 0 );
+      DOCTEST_CHECK( factor.second < 1000 ); // filters differ in cost, but not by orders of magnitude
+   }
+   dip::String filename = "threading_model_test.txt";
+   dip::SaveThreadingCostModel( model, filename );
+   dip::ThreadingCostModel copy = dip::LoadThreadingCostModel( filename );
+   DOCTEST_CHECK( copy.operationCost == model.operationCost );
+   DOCTEST_CHECK( copy.startupCost == model.startupCost );
+   DOCTEST_CHECK( copy.threadCost == model.threadCost );
+   DOCTEST_CHECK( copy.filterCostFactors == model.filterCostFactors );
+   // A file from a different build keeps the thread costs, but not the line filter names
+   {
+      std::ofstream file( filename );
+      file << "build some other compiler\noperationCost 1e-9\nthreadCost 2e-6\nstartupCost 1e-5\nfilter 2 " << model.filterCostFactors.begin()->first << '\n';
+   }
+   copy = dip::LoadThreadingCostModel( filename );
+   std::remove( filename.c_str() );
+   DOCTEST_CHECK( copy.operationCost == 1e-9 );
+   DOCTEST_CHECK( copy.threadCost == 2e-6 );
+   DOCTEST_CHECK( copy.filterCostFactors.empty() );
+
+   // The frameworks produce the same results with the calibrated model
+   dip::Image img{ dip::UnsignedArray{ 300, 200 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random );
+   dip::Image ref = dip::Gauss( img, { 2.0 } );
+   dip::ThreadingCostModel previous = dip::GetThreadingCostModel();
+   dip::SetThreadingCostModel( model );
+   dip::Image result = dip::Gauss( img, { 2.0 } );
+   dip::SetThreadingCostModel( previous );
+   DOCTEST_CHECK( dip::Count( result != ref ) == 0 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
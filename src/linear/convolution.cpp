@@ -18,6 +18,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstdlib>   // std::malloc, std::free
 
 #include "diplib.h"
@@ -26,6 +27,9 @@
 #include "diplib/framework.h"
 #include "diplib/pixel_table.h"
 #include "diplib/overload.h"
+#include "diplib/boundary.h"
+#include "diplib/dft.h"
+#include "diplib/multithreading.h"
 
 namespace dip {
 
@@ -464,8 +468,22 @@ namespace {
 template< typename TPI >
 class GeneralConvolutionLineFilter : public Framework::FullLineFilter {
    public:
+      GeneralConvolutionLineFilter( dip::uint nWeights ) : nWeights_( nWeights ) {}
       virtual void SetNumberOfThreads( dip::uint, PixelTableOffsets const& pixelTable ) override {
-         offsets_ = pixelTable.Offsets();
+         // Pixels with a zero weight don't contribute to the output, we skip them
+         std::vector< dfloat > const& weights = pixelTable.Weights();
+         std::vector< dip::sint > const& offsets = pixelTable.Offsets();
+         offsets_.clear();
+         weights_.clear();
+         for( dip::uint ii = 0; ii < weights.size(); ++ii ) {
+            if( weights[ ii ] != 0.0 ) {
+               offsets_.push_back( offsets[ ii ] );
+               weights_.push_back( static_cast< FloatType< TPI >>( weights[ ii ] ));
+            }
+         }
+      }
+      virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint nTensorElements, dip::uint, dip::uint nRuns ) override {
+         return FullLineFilter::GetNumberOfOperations( lineLength, nTensorElements, nWeights_, nRuns );
       }
       virtual void Filter( Framework::FullLineFilterParameters const& params ) override {
          TPI* in = static_cast< TPI* >( params.inBuffer.buffer );
@@ -473,14 +491,12 @@ class GeneralConvolutionLineFilter : public Framework::FullLineFilter {
          TPI* out = static_cast< TPI* >( params.outBuffer.buffer );
          dip::sint outStride = params.outBuffer.stride;
          dip::uint length = params.bufferLength;
-         PixelTableOffsets const& pixelTable = params.pixelTable;
-         std::vector< dfloat > const& weights = pixelTable.Weights();
          for( dip::uint ii = 0; ii < length; ++ii ) {
             TPI sum = 0;
             auto ito = offsets_.begin();
-            auto itw = weights.begin();
+            auto itw = weights_.begin();
             while( ito != offsets_.end() ) {
-               sum += in[ *ito ] * static_cast< FloatType< TPI >>( *itw );
+               sum += in[ *ito ] * *itw;
                ++ito;
                ++itw;
             }
@@ -490,9 +506,18 @@ class GeneralConvolutionLineFilter : public Framework::FullLineFilter {
          }
       }
    private:
+      dip::uint nWeights_;
       std::vector< dip::sint > offsets_;
+      std::vector< FloatType< TPI >> weights_;
 };
 
+// The number of non-zero weights in the kernel, the direct convolution only visits these pixels.
+dip::uint NumberOfNonZeroWeights( Kernel const& kernel, dip::uint nDims ) {
+   dip::PixelTable pixelTable = kernel.PixelTable( nDims, 0 );
+   std::vector< dfloat > const& weights = pixelTable.Weights();
+   return static_cast< dip::uint >( std::count_if( weights.begin(), weights.end(), []( dfloat w ) { return w != 0.0; } ));
+}
+
 } // namespace
 
 void GeneralConvolution(
@@ -514,11 +539,401 @@ void GeneralConvolution(
       BoundaryConditionArray bc = StringArrayToBoundaryConditionArray( boundaryCondition );
       DataType dtype = DataType::SuggestFlex( in.DataType() );
       std::unique_ptr< Framework::FullLineFilter > lineFilter;
-      DIP_OVL_NEW_FLEX( lineFilter, GeneralConvolutionLineFilter, (), dtype );
+      DIP_OVL_NEW_FLEX( lineFilter, GeneralConvolutionLineFilter, ( NumberOfNonZeroWeights( filter, in.Dimensionality() )), dtype );
       Framework::Full( in, out, dtype, dtype, dtype, 1, bc, filter, *lineFilter, Framework::FullOption::AsScalarImage );
    DIP_END_STACK_TRACE
 }
 
+namespace {
+
+// The output pixels only depend on input pixels at most `filterSizes[ii]/2` away: extending the image by this
+// amount prevents the periodic convolution computed through the DFT from wrapping around.
+UnsignedArray FilterBorder( UnsignedArray const& filterSizes ) {
+   UnsignedArray border = filterSizes;
+   for( auto& b : border ) {
+      b /= 2;
+   }
+   return border;
+}
+
+// Sizes of the image extended by `border` on each side, and padded to sizes for which the DFT is efficient.
+UnsignedArray ExtendedFourierSizes( UnsignedArray const& inSizes, UnsignedArray const& border ) {
+   UnsignedArray sizes = inSizes;
+   for( dip::uint ii = 0; ii < sizes.size(); ++ii ) {
+      sizes[ ii ] = GetOptimalDFTSize( sizes[ ii ] + 2 * border[ ii ] );
+      DIP_THROW_IF( sizes[ ii ] == 0, "Image too large for the Fourier transform" );
+   }
+   return sizes;
+}
+
+// Computes the convolution through the Fourier domain, like `dip::ConvolveFT`, but extends the image using the
+// boundary condition, and pads it to sizes for which the DFT is efficient.
+void ExtendedConvolveFT(
+      Image const& in,
+      Image const& filter,
+      Image& out,
+      BoundaryConditionArray const& bc
+) {
+   dip::uint nDims = in.Dimensionality();
+   UnsignedArray border = FilterBorder( filter.Sizes() );
+   UnsignedArray sizes = ExtendedFourierSizes( in.Sizes(), border );
+   Image tmp;
+   ExtendImage( in, tmp, border, bc );
+   if( tmp.Sizes() != sizes ) {
+      tmp = tmp.Pad( sizes, Option::CropLocation::TOP_LEFT );
+   }
+   ConvolveFT( tmp, filter, tmp );
+   RangeArray window( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      window[ ii ] = Range{ static_cast< dip::sint >( border[ ii ] ), static_cast< dip::sint >( border[ ii ] + in.Size( ii ) - 1 ) };
+   }
+   tmp = tmp.At( window );
+   tmp.SetPixelSize( in.PixelSize() );
+   out.ReForge( tmp, Option::AcceptDataTypeChange::DO_ALLOW );
+   out.Copy( tmp );
+}
+
+// The blocked Fourier convolution computes the convolution tile by tile, using the overlap-save method. Each tile
+// is read from the input image with a border of `border` pixels on each side, filled using the boundary condition
+// where the tile extends past the image edge. This border is discarded after the convolution. Tiles are processed
+// in parallel, each thread needs scratch memory for only one tile, rather than for the whole image.
+
+// The number of pixels in a tile (including its border) that we aim for. Tiles are larger if the filter is large.
+constexpr dip::uint blockedFourierTilePixels = 1u << 18;
+
+struct BlockedFourierLayout {
+   UnsignedArray ftSizes;     // Sizes of the DFT computed for each tile, including the border
+   UnsignedArray tileSizes;   // Number of output pixels computed per tile
+   UnsignedArray nTiles;      // Number of tiles along each dimension
+};
+
+BlockedFourierLayout ComputeBlockedFourierLayout( UnsignedArray const& sizes, UnsignedArray const& border ) {
+   dip::uint nDims = sizes.size();
+   // A tile never needs to be larger than the whole image
+   UnsignedArray maxSizes = ExtendedFourierSizes( sizes, border );
+   BlockedFourierLayout layout;
+   layout.ftSizes.resize( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      dip::uint size = std::max( 8 * border[ ii ], dip::uint( 16 ));
+      layout.ftSizes[ ii ] = size < maxSizes[ ii ] ? GetOptimalDFTSize( size ) : maxSizes[ ii ];
+   }
+   // Grow the tile along the dimension where the border takes up the largest fraction of it
+   while( layout.ftSizes.product() < blockedFourierTilePixels ) {
+      dip::uint dim = nDims;
+      dfloat overhead = -1.0;
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         if( layout.ftSizes[ ii ] < maxSizes[ ii ] ) {
+            dfloat fraction = static_cast< dfloat >( 2 * border[ ii ] + 1 ) / static_cast< dfloat >( layout.ftSizes[ ii ] );
+            if( fraction > overhead ) {
+               overhead = fraction;
+               dim = ii;
+            }
+         }
+      }
+      if( dim == nDims ) {
+         break; // The tile covers the whole image
+      }
+      dip::uint size = 2 * layout.ftSizes[ dim ];
+      layout.ftSizes[ dim ] = size < maxSizes[ dim ] ? GetOptimalDFTSize( size ) : maxSizes[ dim ];
+   }
+   layout.tileSizes.resize( nDims );
+   layout.nTiles.resize( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      layout.tileSizes[ ii ] = std::min( layout.ftSizes[ ii ] - 2 * border[ ii ], sizes[ ii ] );
+      layout.nTiles[ ii ] = div_ceil( sizes[ ii ], layout.tileSizes[ ii ] );
+   }
+   return layout;
+}
+
+// A section of a tile, along one dimension, that is copied from the input image
+struct TileSection {
+   dip::sint tileStart;
+   dip::sint imageStart;
+   dip::sint length;
+};
+
+void ConvolveTile(
+      Image const& in,
+      Image const& filterFT,
+      Image& out,
+      BoundaryConditionArray const& bc,
+      BlockedFourierLayout const& layout,
+      UnsignedArray const& border,
+      UnsignedArray const& tileCoords,
+      bool real
+) {
+   dip::uint nDims = in.Dimensionality();
+   RangeArray outWindow( nDims );         // The output pixels computed by this tile
+   RangeArray tileOutWindow( nDims );     // The same pixels, within the tile
+   RangeArray tileWindow( nDims );        // The part of the tile that represents the input image plus border
+   RangeArray regionWindow( nDims );      // The part of `tileWindow` that is copied from the image
+   std::vector< std::vector< TileSection >> sections( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      dip::sint size = static_cast< dip::sint >( in.Size( ii ));
+      dip::sint b = static_cast< dip::sint >( border[ ii ] );
+      dip::sint start = static_cast< dip::sint >( tileCoords[ ii ] * layout.tileSizes[ ii ] );
+      dip::sint length = std::min( static_cast< dip::sint >( layout.tileSizes[ ii ] ), size - start );
+      outWindow[ ii ] = Range{ start, start + length - 1 };
+      tileOutWindow[ ii ] = Range{ b, b + length - 1 };
+      dip::sint first = start - b;           // The first image coordinate covered by the tile
+      dip::sint width = length + 2 * b;      // The number of image coordinates covered by the tile
+      tileWindow[ ii ] = Range{ 0, width - 1 };
+      if( bc[ ii ] == BoundaryCondition::PERIODIC ) {
+         // Copy everything from the image, wrapping around as needed
+         regionWindow[ ii ] = Range{ 0, width - 1 };
+         for( dip::sint x = first; x < first + width; ) {
+            dip::sint pos = (( x % size ) + size ) % size;
+            dip::sint n = std::min( size - pos, first + width - x );
+            sections[ ii ].push_back( { x - first, pos, n } );
+            x += n;
+         }
+      } else {
+         // Copy the part that overlaps the image, the remainder is filled in by `ExtendRegion`
+         dip::sint lower = std::max( first, dip::sint( 0 ));
+         dip::sint upper = std::min( first + width, size );
+         regionWindow[ ii ] = Range{ lower - first, upper - first - 1 };
+         sections[ ii ].push_back( { lower - first, lower, upper - lower } );
+      }
+   }
+   Image tile( layout.ftSizes, in.TensorElements(), DataType::SuggestFlex( in.DataType() ));
+   tile.Fill( 0 );
+   // Copy all combinations of sections from the image into the tile
+   UnsignedArray index( nDims, 0 );
+   RangeArray tileRange( nDims );
+   RangeArray imageRange( nDims );
+   while( true ) {
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         TileSection const& section = sections[ ii ][ index[ ii ]];
+         tileRange[ ii ] = Range{ section.tileStart, section.tileStart + section.length - 1 };
+         imageRange[ ii ] = Range{ section.imageStart, section.imageStart + section.length - 1 };
+      }
+      Image destination = tile.At( tileRange );
+      destination.Copy( in.At( imageRange ));
+      dip::uint ii = 0;
+      for( ; ii < nDims; ++ii ) {
+         ++index[ ii ];
+         if( index[ ii ] < sections[ ii ].size() ) {
+            break;
+         }
+         index[ ii ] = 0;
+      }
+      if( ii == nDims ) {
+         break;
+      }
+   }
+   Image tileView = tile.At( tileWindow );
+   ExtendRegion( tileView, regionWindow, bc );
+   // Convolve
+   FourierTransform( tile, tile );
+   MultiplySampleWise( tile, filterFT, tile, tile.DataType() );
+   StringSet options{ S::INVERSE };
+   if( real ) {
+      options.insert( S::REAL );
+   }
+   FourierTransform( tile, tile, options );
+   // Write the valid part of the result to the output
+   Image destination = out.At( outWindow );
+   destination.Copy( tile.At( tileOutWindow ));
+}
+
+void BlockedConvolveFT(
+      Image const& c_in,
+      Image const& filter,
+      Image& out,
+      BoundaryConditionArray bc
+) {
+   Image in = c_in.QuickCopy();
+   PixelSize pixelSize = c_in.PixelSize();
+   dip::uint nDims = in.Dimensionality();
+   BoundaryArrayUseParameter( bc, nDims );
+   UnsignedArray border = FilterBorder( filter.Sizes() );
+   BlockedFourierLayout layout = ComputeBlockedFourierLayout( in.Sizes(), border );
+   // The filter's Fourier transform is shared by all tiles
+   Image filterFT = FourierTransform( filter.Pad( layout.ftSizes ));
+   bool real = in.DataType().IsReal() && filter.DataType().IsReal();
+   DataType dtype = real ? DataType::SuggestFlex( in.DataType() ) : DataType::SuggestComplex( in.DataType() );
+   // Tiles read input pixels that are written to by other tiles, so we cannot work in place
+   if( out.Aliases( in )) {
+      out.Strip();
+   }
+   out.ReForge( in.Sizes(), in.TensorElements(), dtype, Option::AcceptDataTypeChange::DO_ALLOW );
+   out.ReshapeTensor( in.Tensor() );
+   out.SetPixelSize( pixelSize );
+   dip::uint nTiles = layout.nTiles.product();
+   ParallelFor( nTiles, [ & ]( dip::uint tile ) {
+      UnsignedArray tileCoords( nDims );
+      dip::uint index = tile;
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         tileCoords[ ii ] = index % layout.nTiles[ ii ];
+         index /= layout.nTiles[ ii ];
+      }
+      ConvolveTile( in, filterFT, out, bc, layout, border, tileCoords, real );
+   } );
+}
+
+// The cost model used by `dip::Convolution` to select the best method. Costs are expressed in the same units as
+// those returned by the `GetNumberOfOperations` methods of the line filters. The operation counts below match those
+// of the line filters that implement each of the methods. The overhead of using multiple threads is taken from the
+// calibrated `dip::ThreadingCostModel`, converted to operations, such that the frameworks would choose the same
+// number of threads.
+
+dfloat ParallelCost( dfloat operations, dip::uint nThreads ) {
+   ThreadingCostModel const& model = GetThreadingCostModel();
+   dip::uint n = model.NumberOfThreads( static_cast< dip::uint >( operations ), nThreads );
+   if( n > 1 ) {
+      dfloat overhead = ( model.startupCost + model.threadCost * static_cast< dfloat >( n - 1 )) / model.operationCost;
+      return operations / static_cast< dfloat >( n ) + overhead;
+   }
+   return operations;
+}
+
+// Operations per pixel for one pass of the DFT over M pixels, of which there are log2(M). Each radix-2 butterfly
+// updates two pixels with a complex multiply-add (10 flops), and reads and writes the real and imaginary parts of
+// both (8 memory accesses); we round the resulting 9 per pixel up to 10 for the twiddle factors.
+constexpr dfloat dftOperationsPerPixel = 10.0;
+// Operations per pixel for the multiplication in the frequency domain: half the spectrum is computed for real
+// data, each value is a complex multiplication (6 flops) plus loading both operands.
+constexpr dfloat spectrumMultiplicationOperationsPerPixel = 4.0;
+// Operations per pixel for extending and padding the image, and cropping the result: a read and a write each,
+// counting the zero padding as one operation.
+constexpr dfloat paddingOperationsPerPixel = 3.0;
+
+dfloat SeparableCost( UnsignedArray const& sizes, dip::uint nTensor, OneDimensionalFilterArray const& filterArray, dip::uint nThreads ) {
+   dfloat nPixels = static_cast< dfloat >( sizes.product() * nTensor );
+   dfloat cost = 0;
+   for( auto const& f : filterArray ) {
+      dfloat length = static_cast< dfloat >( f.filter.size() / ( f.isComplex ? 2 : 1 ));
+      if( length > 1 ) {
+         // Copying to and from the line buffer, plus the multiply-adds (4 for complex filters)
+         cost += ParallelCost( nPixels * ( 2.0 + 2.0 * length * ( f.isComplex ? 4.0 : 1.0 )), nThreads );
+      }
+   }
+   return cost;
+}
+
+// `nWeights` is the number of non-zero filter weights.
+dfloat DirectCost( UnsignedArray const& sizes, dip::uint nTensor, dip::uint nWeights, dip::uint nThreads ) {
+   dfloat nPixels = static_cast< dfloat >( sizes.product() );
+   dfloat nKernel = static_cast< dfloat >( nWeights );
+   // Multiply-adds, and iterating over the pixel table and its weights, as in `GeneralConvolutionLineFilter`
+   return ParallelCost( nPixels * ( static_cast< dfloat >( nTensor ) * nKernel + 3.0 * nKernel ), nThreads );
+}
+
+dfloat FourierCost( UnsignedArray const& sizes, dip::uint nTensor, UnsignedArray const& filterSizes, dip::uint nThreads ) {
+   UnsignedArray ftSizes = ExtendedFourierSizes( sizes, FilterBorder( filterSizes ));
+   dfloat M = static_cast< dfloat >( ftSizes.product() );
+   dfloat T = static_cast< dfloat >( nTensor );
+   dfloat transform = ParallelCost( dftOperationsPerPixel * M * std::log2( M ), nThreads );
+   // Forward transforms of image and filter, inverse transform of result, multiplication in the frequency domain.
+   dfloat cost = ( 2.0 * T + 1.0 ) * transform + ParallelCost( spectrumMultiplicationOperationsPerPixel * M * T, nThreads );
+   // Extending and padding the image and cropping the result are done in a single thread.
+   cost += paddingOperationsPerPixel * M * T;
+   return cost;
+}
+
+dfloat BlockedFourierCost( UnsignedArray const& sizes, dip::uint nTensor, UnsignedArray const& filterSizes, dip::uint nThreads ) {
+   BlockedFourierLayout layout = ComputeBlockedFourierLayout( sizes, FilterBorder( filterSizes ));
+   dfloat M = static_cast< dfloat >( layout.ftSizes.product() );
+   dfloat T = static_cast< dfloat >( nTensor );
+   dip::uint nTiles = layout.nTiles.product();
+   // Forward and inverse transform, multiplication in the frequency domain, filling the tile and copying
+   // the result, for each tile. Tiles are distributed over the threads.
+   dfloat tileCost = 2.0 * T * dftOperationsPerPixel * M * std::log2( M )
+                     + spectrumMultiplicationOperationsPerPixel * M * T + paddingOperationsPerPixel * M * T;
+   dfloat cost = ParallelCost( static_cast< dfloat >( nTiles ) * tileCost, std::min( nThreads, nTiles ));
+   // Transform of the filter
+   cost += ParallelCost( dftOperationsPerPixel * M * std::log2( M ), nThreads );
+   return cost;
+}
+
+} // namespace
+
+void Convolution(
+      Image const& in,
+      Image const& c_filter,
+      Image& out,
+      String const& method,
+      StringArray const& boundaryCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !c_filter.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !c_filter.IsScalar(), E::IMAGE_NOT_SCALAR );
+   dip::uint nDims = in.Dimensionality();
+   DIP_THROW_IF( c_filter.Dimensionality() > nDims, E::DIMENSIONALITIES_DONT_MATCH );
+   Image filter = c_filter.QuickCopy();
+   if( filter.Dimensionality() < nDims ) {
+      filter.ExpandDimensionality( nDims );
+   }
+   enum class Method { SEPARABLE, DIRECT, FOURIER, BLOCKED_FOURIER };
+   Method selected = Method::DIRECT;
+   OneDimensionalFilterArray filterArray;
+   if( method == S::SEPARABLE ) {
+      DIP_STACK_TRACE_THIS( filterArray = SeparateFilter( filter ));
+      DIP_THROW_IF( filterArray.empty(), "The filter is not separable" );
+      selected = Method::SEPARABLE;
+   } else if( method == S::DIRECT ) {
+      selected = Method::DIRECT;
+   } else if( method == S::FOURIER ) {
+      selected = Method::FOURIER;
+   } else if( method == S::OVERLAP_SAVE ) {
+      selected = Method::BLOCKED_FOURIER;
+   } else if( method == S::BEST ) {
+      if( filter.DataType().IsBinary() ) {
+         // `dip::Uniform` is cheaper than any of the alternatives
+         selected = Method::DIRECT;
+      } else {
+         DIP_START_STACK_TRACE
+            dip::uint nThreads = GetNumberOfThreads();
+            dip::uint nTensor = in.TensorElements();
+            filterArray = SeparateFilter( filter );
+            dfloat bestCost = std::numeric_limits< dfloat >::max();
+            if( !filterArray.empty() ) {
+               bestCost = SeparableCost( in.Sizes(), nTensor, filterArray, nThreads );
+               selected = Method::SEPARABLE;
+            }
+            if( filter.DataType().IsReal() ) {
+               dfloat cost = DirectCost( in.Sizes(), nTensor, NumberOfNonZeroWeights( Kernel{ filter }, nDims ), nThreads );
+               if( cost < bestCost ) {
+                  bestCost = cost;
+                  selected = Method::DIRECT;
+               }
+            }
+            dfloat cost = FourierCost( in.Sizes(), nTensor, filter.Sizes(), nThreads );
+            if( cost < bestCost ) {
+               bestCost = cost;
+               selected = Method::FOURIER;
+            }
+            cost = BlockedFourierCost( in.Sizes(), nTensor, filter.Sizes(), nThreads );
+            if( cost < bestCost ) {
+               selected = Method::BLOCKED_FOURIER;
+            }
+         DIP_END_STACK_TRACE
+      }
+   } else {
+      DIP_THROW_INVALID_FLAG( method );
+   }
+   DIP_START_STACK_TRACE
+      switch( selected ) {
+         case Method::SEPARABLE:
+            SeparableConvolution( in, out, filterArray, boundaryCondition );
+            break;
+         case Method::DIRECT:
+            GeneralConvolution( in, filter, out, boundaryCondition );
+            break;
+         case Method::FOURIER: {
+            BoundaryConditionArray bc = StringArrayToBoundaryConditionArray( boundaryCondition );
+            ExtendedConvolveFT( in, filter, out, bc );
+            break;
+         }
+         case Method::BLOCKED_FOURIER: {
+            BoundaryConditionArray bc = StringArrayToBoundaryConditionArray( boundaryCondition );
+            BlockedConvolveFT( in, filter, out, bc );
+            break;
+         }
+      }
+   DIP_END_STACK_TRACE
+}
+
 
 } // namespace dip
 
@@ -528,6 +943,8 @@ void GeneralConvolution(
 #include "diplib/statistics.h"
 #include "diplib/generation.h"
 #include "diplib/iterators.h"
+#include "diplib/random.h"
+#include "diplib/testing.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the separable convolution") {
    dip::dfloat meanval = 9563.0;
@@ -615,4 +1032,47 @@ DOCTEST_TEST_CASE("[DIPlib] testing the separable convolution") {
    DOCTEST_CHECK( dip::Mean( out1 - out2 ).As< dip::dfloat >() / meanval == doctest::Approx( 0.0 ));
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the convolution method selection") {
+   dip::Image img{ dip::UnsignedArray{ 40, 30 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random, 0.0, 100.0 );
+   // A separable filter with an even size along one dimension
+   dip::Image filter{ dip::UnsignedArray{ 7, 4 }, 1, dip::DT_DFLOAT };
+   dip::ImageIterator< dip::dfloat > it( filter );
+   do {
+      dip::dfloat x = static_cast< dip::dfloat >( it.Coordinates()[ 0 ] );
+      dip::dfloat y = static_cast< dip::dfloat >( it.Coordinates()[ 1 ] );
+      *it = ( 1.0 + x ) * ( 4.0 - y ) / 112.0;
+   } while( ++it );
+   dip::Image direct = dip::Convolution( img, filter, "direct", { "mirror" } );
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Convolution( img, filter, "separable", { "mirror" } ), direct, 1e-2 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Convolution( img, filter, "fourier", { "mirror" } ), direct, 1e-2 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Convolution( img, filter, "best", { "mirror" } ), direct, 1e-2 ));
+   // A non-separable filter
+   filter.At( 2, 1 ) = 1.0;
+   DOCTEST_CHECK_THROWS( dip::Convolution( img, filter, "separable" ));
+   direct = dip::Convolution( img, filter, "direct", { "add zeros" } );
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Convolution( img, filter, "fourier", { "add zeros" } ), direct, 1e-2 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Convolution( img, filter, "overlap save", { "add zeros" } ), direct, 1e-2 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Convolution( img, filter, "best", { "add zeros" } ), direct, 1e-2 ));
+   // A large, sparse filter: the direct method skips the zero weights
+   dip::Image sparse{ dip::UnsignedArray{ 21, 15 }, 1, dip::DT_DFLOAT };
+   sparse.Fill( 0 );
+   sparse.At( 0, 0 ) = 0.5;
+   sparse.At( 10, 7 ) = 0.25;
+   sparse.At( 20, 3 ) = -0.25;
+   direct = dip::Convolution( img, sparse, "direct", { "periodic" } );
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Convolution( img, sparse, "fourier", { "periodic" } ), direct, 1e-2 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Convolution( img, sparse, "best", { "periodic" } ), direct, 1e-2 ));
+   // An image large enough to be split into multiple tiles
+   img = dip::Image{ dip::UnsignedArray{ 1000, 700 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::UniformNoise( img, img, random, 0.0, 100.0 );
+   for( auto const& bc : { dip::S::PERIODIC, dip::S::SYMMETRIC_MIRROR } ) {
+      direct = dip::Convolution( img, filter, "direct", { bc } );
+      DOCTEST_CHECK( dip::testing::CompareImages( dip::Convolution( img, filter, "overlap save", { bc } ), direct, 1e-2 ));
+   }
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -0,0 +1,162 @@
+/*
+ * DIPlib 3.0
+ * This file contains the definition of the dip::FourierFilterBank class.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diplib.h"
+#include "diplib/linear.h"
+#include "diplib/math.h"
+#include "diplib/transform.h"
+#include "diplib/multithreading.h"
+
+namespace dip {
+
+FourierFilterBank::FourierFilterBank( Image const& filters, bool conjugateSymmetric )
+      : conjugateSymmetric_( conjugateSymmetric ) {
+   DIP_THROW_IF( !filters.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !filters.DataType().IsFloat() && !filters.DataType().IsComplex(), E::DATA_TYPE_NOT_SUPPORTED );
+   // Always make a copy, the filters must not change while this object exists
+   filters_.Copy( filters );
+   filters_.Convert( filters.DataType().IsComplex() ? DT_SCOMPLEX : DT_SFLOAT );
+}
+
+void FourierFilterBank::Apply(
+      Image const& in,
+      Image& out,
+      String const& inRepresentation,
+      String const& outRepresentation
+) const {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( in.Sizes() != filters_.Sizes(), E::SIZES_DONT_MATCH );
+   bool spatialDomainInput;
+   DIP_STACK_TRACE_THIS( spatialDomainInput = BooleanFromString( inRepresentation, S::SPATIAL, S::FREQUENCY ));
+   bool spatialDomainOutput;
+   DIP_STACK_TRACE_THIS( spatialDomainOutput = BooleanFromString( outRepresentation, S::SPATIAL, S::FREQUENCY ));
+   bool outputIsReal = conjugateSymmetric_ && spatialDomainInput && !in.DataType().IsComplex() && spatialDomainOutput;
+   DIP_START_STACK_TRACE
+      // Get Fourier-domain representation of input image, before reforging `out` in case `&in==&out`.
+      Image ftIn;
+      if( spatialDomainInput ) {
+         ftIn = FourierTransform( in );
+      } else {
+         ftIn = in.QuickCopy();
+         if( in.Aliases( out )) {
+            out.Strip(); // We cannot work in-place.
+         }
+      }
+      // Apply all filters at once
+      Image tmp;
+      Image& filtered = spatialDomainOutput ? tmp : out; // Write directly in out if we won't do inverse Fourier transform
+      MultiplySampleWise( filters_, ftIn, filtered, DT_SCOMPLEX );
+      // Compute the inverse Fourier transform of all tensor elements together
+      if( spatialDomainOutput ) {
+         StringSet options = { S::INVERSE };
+         if( outputIsReal ) {
+            options.insert( S::REAL );
+         }
+         FourierTransform( filtered, out, options );
+      }
+      out.ReshapeTensor( filters_.Tensor() );
+   DIP_END_STACK_TRACE
+}
+
+void FourierFilterBank::Apply(
+      ImageConstRefArray const& in,
+      ImageRefArray& out,
+      String const& inRepresentation,
+      String const& outRepresentation
+) const {
+   dip::uint nImages = in.size();
+   DIP_THROW_IF( out.size() != nImages, E::ARRAY_SIZES_DONT_MATCH );
+   auto apply = [ & ]( dip::uint ii ) {
+      Apply( in[ ii ].get(), out[ ii ].get(), inRepresentation, outRepresentation );
+   };
+   if( nImages * filters_.NumberOfSamples() < threadingThreshold ) {
+      for( dip::uint ii = 0; ii < nImages; ++ii ) {
+         apply( ii );
+      }
+   } else {
+      ParallelFor( nImages, apply );
+   }
+}
+
+} // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/analysis.h"
+#include "diplib/generation.h"
+#include "diplib/random.h"
+#include "diplib/statistics.h"
+
+namespace {
+dip::dfloat MaxAbsDifference( dip::Image const& a, dip::Image const& b ) {
+   return dip::Maximum( dip::MaximumTensorElement( dip::Abs( a - b ))).As< dip::dfloat >();
+}
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the FourierFilterBank class") {
+   dip::Image img{ dip::UnsignedArray{ 64, 48 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random );
+
+   // Log-Gabor filter bank with orientations: complex-valued output, each element is the input filtered by one filter
+   dip::FourierFilterBank bank = dip::CreateLogGaborFilterBank( img.Sizes(), { 3.0, 6.0 }, 0.75, 4 );
+   dip::Image out = bank.Apply( img );
+   DOCTEST_CHECK( out.DataType() == dip::DT_SCOMPLEX );
+   DOCTEST_CHECK( out.TensorRows() == 4 );
+   DOCTEST_CHECK( out.TensorColumns() == 2 );
+   dip::Image filter = bank.Filters()[ dip::UnsignedArray{ 1, 1 }];
+   dip::Image ref = dip::FourierTransform( dip::FourierTransform( img ) * filter, { "inverse" } );
+   DOCTEST_CHECK( MaxAbsDifference( out[ dip::UnsignedArray{ 1, 1 }], ref ) < 1e-5 );
+
+   // Only scales: real-valued output
+   bank = dip::CreateLogGaborFilterBank( img.Sizes(), { 3.0, 24.0 }, 0.41, 1 );
+   dip::Image scales = bank.Apply( img );
+   DOCTEST_CHECK( scales.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( scales.TensorElements() == 2 );
+
+   // Monogenic signal: the even component is the scale-filtered image, the odd components its Riesz transform
+   bank = dip::CreateMonogenicFilterBank( img.Sizes(), { 3.0, 24.0 }, 0.41 );
+   out = bank.Apply( img );
+   DOCTEST_CHECK( out.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( out.TensorRows() == 3 );
+   DOCTEST_CHECK( out.TensorColumns() == 2 );
+   DOCTEST_CHECK( MaxAbsDifference( out[ dip::UnsignedArray{ 0, 1 }], scales[ 1 ] ) < 1e-5 );
+   ref = dip::RieszTransform( scales[ 0 ] );
+   DOCTEST_CHECK( MaxAbsDifference( out[ dip::UnsignedArray{ 1, 0 }], ref[ 0 ] ) < 1e-5 );
+   DOCTEST_CHECK( MaxAbsDifference( out[ dip::UnsignedArray{ 2, 0 }], ref[ 1 ] ) < 1e-5 );
+
+   // Many images in parallel, frequency-domain output
+   dip::ImageArray images( 5 );
+   for( auto& im : images ) {
+      im = dip::UniformNoise( img, random );
+   }
+   dip::ImageArray results( images.size() );
+   dip::ImageRefArray resultRefs = dip::CreateImageRefArray( results );
+   bank.Apply( dip::CreateImageConstRefArray( images ), resultRefs, dip::S::SPATIAL, dip::S::FREQUENCY );
+   for( dip::uint ii = 0; ii < images.size(); ++ii ) {
+      DOCTEST_CHECK( results[ ii ].DataType() == dip::DT_SCOMPLEX );
+      ref = bank.Apply( images[ ii ], dip::S::SPATIAL, dip::S::FREQUENCY );
+      DOCTEST_CHECK( MaxAbsDifference( results[ ii ], ref ) == 0 );
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -170,8 +170,20 @@ void GaborFIR(
 
 namespace {
 
-void ApplyScaleFilters(
-      Image const& ftIn,
+void CheckLogGaborParameters(
+      UnsignedArray const& sizes,
+      FloatArray const& wavelengths,
+      dfloat bandwidth,
+      dip::uint nOrientations
+) {
+   DIP_THROW_IF( sizes.empty() || !sizes.all(), "Raw image sizes not valid" );
+   DIP_THROW_IF( wavelengths.empty(), E::ARRAY_PARAMETER_EMPTY );
+   DIP_THROW_IF( nOrientations < 1, E::INVALID_PARAMETER );
+   DIP_THROW_IF( bandwidth <= 0, E::INVALID_PARAMETER );
+   DIP_THROW_IF(( nOrientations > 1 ) && ( sizes.size() != 2 ), E::DIMENSIONALITY_NOT_SUPPORTED );
+}
+
+void MakeScaleFilters(
       Image& radius,
       ImageArray& outar,
       FloatArray const& wavelengths,
@@ -189,148 +201,54 @@ void ApplyScaleFilters(
    dip::uint nFrequencyScales = wavelengths.size();
    outar.resize( nFrequencyScales );
    for( dip::uint scale = 0; scale < nFrequencyScales; ++scale ) {
-      Image tmp;
-      if( !ftIn.IsForged() ) {
-         outar[ scale ].ReForge( radius.Sizes(), 1, DT_SFLOAT );
-         tmp = outar[ scale ];
-         tmp.Protect();
-      }
       dfloat wavelength = wavelengths[ scale ];
       auto lineFilter = Framework::NewMonadicScanLineFilter< sfloat >( [ wavelength, expScaling ]( auto its ){
          return static_cast< sfloat >( std::exp( -std::pow( std::log( *its[ 0 ] * wavelength ), 2 ) * expScaling ));
       }, 50 );
-      Framework::ScanMonadic( radius, tmp, DT_SFLOAT, DT_SFLOAT, 1, *lineFilter );
-      if( ftIn.IsForged() ) {
-         Multiply( tmp, ftIn, outar[ scale ] ); // output is complex-valued
-      }
+      Framework::ScanMonadic( radius, outar[ scale ], DT_SFLOAT, DT_SFLOAT, 1, *lineFilter );
       outar[ scale ].At( center ) = 0;
    }
 }
 
-} // namespace
-
-void LogGaborFilterBank(
-      Image const& in,
-      Image& out,
+// Creates the real-valued, frequency-domain log-Gabor filters as a nOrientations x nFrequencyScales tensor image.
+Image MakeLogGaborFilters(
+      UnsignedArray const& sizes,
       FloatArray const& wavelengths,
       dfloat bandwidth,
-      dip::uint nOrientations,
-      String const& inRepresentation,
-      String const& outRepresentation
+      dip::uint nOrientations
 ) {
-   DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
-   DIP_THROW_IF( !in.Sizes().all(), "Raw image sizes not valid" ); // must test valid sizes in case it's not forged
    dip::uint nFrequencyScales = wavelengths.size();
-   DIP_THROW_IF( nFrequencyScales < 1, E::ARRAY_PARAMETER_EMPTY );
-   DIP_THROW_IF( nOrientations < 1, E::INVALID_PARAMETER );
-   DIP_THROW_IF( bandwidth <= 0, E::INVALID_PARAMETER );
-   bool onlyScale = nOrientations == 1;
-   dip::uint nDims = in.Dimensionality();
-   DIP_THROW_IF( !onlyScale && ( nDims != 2 ), E::DIMENSIONALITY_NOT_SUPPORTED );
-   bool spatialDomainOutput;
-   DIP_STACK_TRACE_THIS( spatialDomainOutput = BooleanFromString( outRepresentation, S::SPATIAL, S::FREQUENCY ));
-   bool inputIsReal = true; // if no input image is given, it's like we're given a delta pulse image -- it's real.
-   Image ftIn;
-   if( in.IsForged() ) {
-      // Get Fourier-domain representation of input image
-      bool spatialDomainInput;
-      DIP_STACK_TRACE_THIS( spatialDomainInput = BooleanFromString( inRepresentation, S::SPATIAL, S::FREQUENCY ));
-      if( spatialDomainInput ) {
-         inputIsReal = !in.DataType().IsComplex();
-         ftIn = FourierTransform( in );
-      } else {
-         inputIsReal = false;
-         ftIn = in;
-         if( ftIn.Aliases( out )) {
-            out.Strip(); // cannot work in-place
-         }
-      }
-   } else {
-      ftIn.SetSizes( in.Sizes() ); // Copy over the sizes array.
-   }
-
-   // Options:
-   //  - !in.IsForged()
-   //     - inputIsReal
-   //        - onlyScale
-   //           - FD output => real
-   //           - SD output => real
-   //        - !onlyScale
-   //           - FD output => real
-   //           - SD output => complex
-   //     - !inputIsReal
-   //        - does not happen!
-   //  - in.IsForged()
-   //     - inputIsReal
-   //        - onlyScale
-   //           - FD output => complex
-   //           - SD output => real
-   //        - !onlyScale
-   //           - FD output => complex
-   //           - SD output => complex
-   //     - !inputIsReal
-   //        - onlyScale
-   //           - FD output => complex
-   //           - SD output => complex
-   //        - !onlyScale
-   //           - FD output => complex
-   //           - SD output => complex
-   bool ouputIsReal = ( !in.IsForged() && ( onlyScale || !spatialDomainOutput ))
-                      || ( in.IsForged() && inputIsReal && onlyScale && spatialDomainOutput );
-
-   // Options for inverse transform
-   StringSet options = { S::INVERSE };
-   if( spatialDomainOutput && ouputIsReal ) {
-      options.insert( S::REAL );
-   }
-
-   // Forge output tensor image
-   DataType outDataType = ouputIsReal ? DT_SFLOAT : DT_SCOMPLEX;
-   out.ReForge( ftIn.Sizes(), nOrientations * nFrequencyScales, outDataType, Option::AcceptDataTypeChange::DONT_ALLOW );
+   Image out( sizes, nOrientations * nFrequencyScales, DT_SFLOAT );
    out.ReshapeTensor( nOrientations, nFrequencyScales );
 
    // Create coordinates image
-   Image coord = CreateCoordinates( ftIn.Sizes(), { "frequency" } );
+   Image coord = CreateCoordinates( sizes, { "frequency" } );
    Image radius = Norm( coord );
-   UnsignedArray center = ftIn.Sizes();
+   UnsignedArray center = sizes;
    center /= 2;
    radius.At( center ) = 1; // Value at origin should not be 0, so we can take the log later on
    DIP_ASSERT( radius.DataType() == DT_SFLOAT );
 
-   if( onlyScale ) {
-
-      // Create scale filtered images
-      // ApplyScaleFilters produces a SCOMPLEX output if ftIn.IsForged(), otherwise it is SFLOAT
-      // If the type matches the output type's, write directly to output
+   if( nOrientations == 1 ) {
+      // Write scale filters directly to output
       ImageArray outar( nFrequencyScales );
-      if( ftIn.IsForged() ^ ouputIsReal ) {
-         for( dip::uint scale = 0; scale < nFrequencyScales; ++scale ) {
-            outar[ scale ] = out[ scale ];
-            outar[ scale ].Protect();
-         }
-      }
-      ApplyScaleFilters( ftIn, radius, outar, wavelengths, bandwidth );
-
-      if( spatialDomainOutput ) {
-         // Apply inverse Fourier transform
-         for( dip::uint scale = 0; scale < nFrequencyScales; ++scale ) {
-            Image tmp = out[ scale ];
-            tmp.Protect();
-            FourierTransform( outar[ scale ], tmp, options );
-         }
+      for( dip::uint scale = 0; scale < nFrequencyScales; ++scale ) {
+         outar[ scale ] = out[ scale ];
+         outar[ scale ].Protect();
       }
-      return; // We're done!
+      MakeScaleFilters( radius, outar, wavelengths, bandwidth );
+      return out; // We're done!
    }
 
    // If we're here, we're dealing with a 2D image, and want 2 or more orientations.
 
-   // Apply scale filters to the input
+   // Make scale filters
    ImageArray scaleFilter;
-   ApplyScaleFilters( ftIn, radius, scaleFilter, wavelengths, bandwidth );
+   MakeScaleFilters( radius, scaleFilter, wavelengths, bandwidth );
    coord /= radius;
    DIP_ASSERT( coord.DataType() == DT_SFLOAT );
 
-   // Construct and apply angle filters to the previous result
+   // Construct angle filters and combine with the scale filters
    dfloat sigmaTheta = pi / static_cast< dfloat >( nOrientations ) / 1.3; // magic constant, see Kovesi.
    dfloat expScaling = 1.0 / ( 2.0 * sigmaTheta * sigmaTheta );
    for( dip::uint orientation = 0; orientation < nOrientations; ++orientation ) {
@@ -344,17 +262,62 @@ void LogGaborFilterBank(
          return static_cast< sfloat >( std::exp(( *its[ 0 ] ) * ( *its[ 0 ] ) * -expScaling ));
       }, 30 );
       Framework::ScanMonadic( radialFilter, radialFilter, DT_SFLOAT, DT_SFLOAT, 1, *lineFilter );
-      // Filter each scale with this angle selection filter
+      // Combine each scale with this angle selection filter
       for( dip::uint scale = 0; scale < nFrequencyScales; ++scale ) {
          Image destination = out[ UnsignedArray{ orientation, scale } ];
          destination.Protect();          // ensure it will not be reforged
-         Image tempStorage;
-         Image& ftDestination = ( spatialDomainOutput && ouputIsReal ) ? tempStorage : destination;
-         Multiply( radialFilter, scaleFilter[ scale ], ftDestination );
-         if( spatialDomainOutput ) {
-            FourierTransform( ftDestination, destination, options );
-         }
+         Multiply( radialFilter, scaleFilter[ scale ], destination );
+      }
+   }
+   return out;
+}
+
+} // namespace
+
+FourierFilterBank CreateLogGaborFilterBank(
+      UnsignedArray const& sizes,
+      FloatArray const& wavelengths,
+      dfloat bandwidth,
+      dip::uint nOrientations
+) {
+   DIP_START_STACK_TRACE
+      CheckLogGaborParameters( sizes, wavelengths, bandwidth, nOrientations );
+      // The filters are real-valued, and symmetric only if there's no angular selection
+      return FourierFilterBank( MakeLogGaborFilters( sizes, wavelengths, bandwidth, nOrientations ), nOrientations == 1 );
+   DIP_END_STACK_TRACE
+}
+
+void LogGaborFilterBank(
+      Image const& in,
+      Image& out,
+      FloatArray const& wavelengths,
+      dfloat bandwidth,
+      dip::uint nOrientations,
+      String const& inRepresentation,
+      String const& outRepresentation
+) {
+   DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_STACK_TRACE_THIS( CheckLogGaborParameters( in.Sizes(), wavelengths, bandwidth, nOrientations ));
+   if( in.IsForged() ) {
+      // Filter the image
+      DIP_STACK_TRACE_THIS( CreateLogGaborFilterBank( in.Sizes(), wavelengths, bandwidth, nOrientations )
+                                  .Apply( in, out, inRepresentation, outRepresentation ));
+      return;
+   }
+   // If no input image is given, it's like we're given a delta pulse image: return the filters themselves
+   bool spatialDomainOutput;
+   DIP_STACK_TRACE_THIS( spatialDomainOutput = BooleanFromString( outRepresentation, S::SPATIAL, S::FREQUENCY ));
+   Image filters = MakeLogGaborFilters( in.Sizes(), wavelengths, bandwidth, nOrientations );
+   if( spatialDomainOutput ) {
+      // The spatial-domain filters are real-valued only if there's no angular selection
+      StringSet options = { S::INVERSE };
+      if( nOrientations == 1 ) {
+         options.insert( S::REAL );
       }
+      DIP_STACK_TRACE_THIS( FourierTransform( filters, out, options ));
+      out.ReshapeTensor( nOrientations, wavelengths.size() );
+   } else {
+      out = filters;
    }
 }
 
@@ -25,19 +25,12 @@
 #include "diplib/overload.h"
 #include "diplib/transform.h"
 #include "diplib/iterators.h"
+#include "gauss_support.h"
 
 namespace dip {
 
 namespace {
 
-inline dip::uint HalfGaussianSize(
-      dfloat sigma,
-      dip::uint derivativeOrder,
-      dfloat truncation
-) {
-   return clamp_cast< dip::uint >( std::ceil(( truncation + 0.5 * static_cast< dfloat >( derivativeOrder )) * sigma ));
-}
-
 // Creates a half Gaussian kernel, with the x=0 at the right end (last element) of the output array.
 std::vector< dfloat > MakeHalfGaussian(
       dfloat sigma,
@@ -172,9 +165,7 @@ void CreateGauss(
    dip::uint nDims = sigmas.size();
    DIP_STACK_TRACE_THIS( ArrayUseParameter( orders, nDims, dip::uint( 0 )));
    DIP_STACK_TRACE_THIS( ArrayUseParameter( exponents, nDims, dip::uint( 0 )));
-   if( truncation <= 0.0 ) {
-      truncation = 3;   // Default truncation
-   }
+   truncation = GaussianTruncation( truncation );
 
    std::vector< std::vector< dfloat >> gaussians( nDims );
    UnsignedArray outSizes( nDims );
@@ -220,9 +211,7 @@ void GaussFIR(
       ArrayUseParameter( sigmas, nDims, 1.0 );
       ArrayUseParameter( order, nDims, dip::uint( 0 ));
    DIP_END_STACK_TRACE
-   if( truncation <= 0.0 ) {
-      truncation = 3;   // Default truncation
-   }
+   truncation = GaussianTruncation( truncation );
    OneDimensionalFilterArray filter( nDims );
    BooleanArray process( nDims, true );
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
@@ -363,9 +352,7 @@ void GaussFT(
       ArrayUseParameter( sigmas, nDims, 1.0 );
       ArrayUseParameter( order, nDims, dip::uint( 0 ));
    DIP_END_STACK_TRACE
-   if( truncation <= 0.0 ) {
-      truncation = 3;   // Default truncation
-   }
+   truncation = GaussianTruncation( truncation );
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
       if( in.Size( ii ) == 1 ) {
          sigmas[ ii ] = 0;
@@ -0,0 +1,45 @@
+/*
+ * DIPlib 3.0
+ * This file contains support functions for gauss.cpp, also used where the size of its kernels must be known.
+ *
+ * (c)2018, Cris Luengo.
+ * Based on original DIPlib code: (c)1995-2014, Delft University of Technology.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_GAUSS_SUPPORT_H
+#define DIP_GAUSS_SUPPORT_H
+
+#include "diplib.h"
+
+namespace dip {
+
+// The truncation actually used by the Gaussian filters: a value of 0 or less selects the default.
+inline dfloat GaussianTruncation( dfloat truncation ) {
+   return truncation <= 0.0 ? 3.0 : truncation;
+}
+
+// The number of pixels on either side of the origin of a FIR Gaussian kernel. `truncation` must already have
+// been processed by `GaussianTruncation`.
+inline dip::uint HalfGaussianSize(
+      dfloat sigma,
+      dip::uint derivativeOrder,
+      dfloat truncation
+) {
+   return clamp_cast< dip::uint >( std::ceil(( truncation + 0.5 * static_cast< dfloat >( derivativeOrder )) * sigma ));
+}
+
+} // namespace dip
+
+#endif // DIP_GAUSS_SUPPORT_H
@@ -19,9 +19,15 @@
  * limitations under the License.
  */
 
+#include <atomic>
+
 #include "diplib.h"
 #include "diplib/linear.h"
 #include "diplib/framework.h"
+#include "diplib/boundary.h"
+#include "diplib/multithreading.h"
+#include "diplib/library/copy_buffer.h"
+#include "diplib/library/cpu_dispatch.h"
 
 namespace dip {
 
@@ -441,16 +447,302 @@ dip__GaussIIRParams dip__FillGaussIIRParams(
    return params;
 }
 
+// A set of samples taken from `N` different image lines, at the same position along the line. The arithmetic
+// operators work element-wise, such that each lane sees exactly the same sequence of operations as a `dfloat`
+// would, and the compiler can map these operations onto SIMD registers (one AVX-512 register, or two AVX2
+// registers, holds 8 doubles).
+struct GaussIIRLanes {
+   static constexpr dip::uint N = 8;
+   dfloat v[ N ];
+
+   GaussIIRLanes() = default;
+   GaussIIRLanes( dfloat s ) { for( dip::uint k = 0; k < N; ++k ) { v[ k ] = s; }}
+
+   GaussIIRLanes& operator+=( GaussIIRLanes const& rhs ) { for( dip::uint k = 0; k < N; ++k ) { v[ k ] += rhs.v[ k ]; } return *this; }
+   GaussIIRLanes& operator-=( GaussIIRLanes const& rhs ) { for( dip::uint k = 0; k < N; ++k ) { v[ k ] -= rhs.v[ k ]; } return *this; }
+};
+inline GaussIIRLanes operator+( GaussIIRLanes lhs, GaussIIRLanes const& rhs ) { lhs += rhs; return lhs; }
+inline GaussIIRLanes operator-( GaussIIRLanes lhs, GaussIIRLanes const& rhs ) { lhs -= rhs; return lhs; }
+inline GaussIIRLanes operator-( GaussIIRLanes lhs ) {
+   for( dip::uint k = 0; k < GaussIIRLanes::N; ++k ) { lhs.v[ k ] = -lhs.v[ k ]; }
+   return lhs;
+}
+inline GaussIIRLanes operator*( dfloat lhs, GaussIIRLanes rhs ) {
+   for( dip::uint k = 0; k < GaussIIRLanes::N; ++k ) { rhs.v[ k ] = lhs * rhs.v[ k ]; }
+   return rhs;
+}
+inline GaussIIRLanes operator/( GaussIIRLanes lhs, dfloat rhs ) {
+   for( dip::uint k = 0; k < GaussIIRLanes::N; ++k ) { lhs.v[ k ] /= rhs; }
+   return lhs;
+}
+
+// The recursive filter. `p0` is the input line, `p1` is a temporary buffer, and `p2` the output line, each
+// of `length` samples, including the border. `T` is either `dfloat`, to filter a single image line, or
+// `GaussIIRLanes`, to filter `GaussIIRLanes::N` image lines simultaneously.
+template< typename T >
+void GaussIIRRecursion( T const* p0, T* p1, T* p2, dip::uint length, dip__GaussIIRParams const& fParams ) {
+   auto const& a1 = fParams.a1;
+   auto const& a2 = fParams.a2;
+   auto const& b1 = fParams.b1;
+   auto const& b2 = fParams.b2;
+   dfloat c = ( fParams.cc );
+
+   auto const& orderMA = fParams.iir_order_num;
+   auto const& orderAR = fParams.iir_order_den;
+   dip::uint order1 = std::max( orderAR[ 0 ], orderMA[ 0 ] );
+   dip::uint order2 = std::max( orderAR[ 3 ], orderMA[ 3 ] );
+   bool copy_forward = false;
+   bool copy_backward = false;
+   if( ( orderMA[ 0 ] == 0 ) && ( a1[ 0 ] == 1.0 ) ) {
+      copy_forward = true;
+   }
+   if( ( orderMA[ 3 ] == 0 ) && ( a2[ 0 ] == 1.0 ) ) {
+      copy_backward = true;
+   }
+
+   // Recursive forward scan
+   dip::uint ii = 0;
+   T r1, r2, r3, r4, r5;
+   switch( order1 ) {
+      case 3:
+         if( copy_forward ) {
+            r1 = r2 = r3 = p0[ 0 ] / ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] );
+            for( ; ii < length - 3; ii += 3 ) {
+               r3 = p1[ ii ] = p0[ ii ] - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3;
+               r2 = p1[ ii + 1 ] = p0[ ii + 1 ] - b1[ 1 ] * r3 - b1[ 2 ] * r1 - b1[ 3 ] * r2;
+               r1 = p1[ ii + 2 ] = p0[ ii + 2 ] - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r1;
+            }
+         }
+         break;
+
+      case 4:
+         if( copy_forward ) {
+            r1 = r2 = r3 = r4 = p0[ 0 ] / ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] );
+            for( ; ii < length - 4; ii += 4 ) {
+               r4 = p1[ ii ] = p0[ ii ]
+                               - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3 - b1[ 4 ] * r4;
+               r3 = p1[ ii + 1 ] = p0[ ii + 1 ]
+                                   - b1[ 1 ] * r4 - b1[ 2 ] * r1 - b1[ 3 ] * r2 - b1[ 4 ] * r3;
+               r2 = p1[ ii + 2 ] = p0[ ii + 2 ]
+                                   - b1[ 1 ] * r3 - b1[ 2 ] * r4 - b1[ 3 ] * r1 - b1[ 4 ] * r2;
+               r1 = p1[ ii + 3 ] = p0[ ii + 3 ]
+                                   - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r4 - b1[ 4 ] * r1;
+            }
+         } else if( a1[ 0 ] == 0.5 && a1[ 1 ] == 0.0 && a1[ 2 ] == -0.5 && a1[ 3 ] == 0.0 ) {
+            r1 = r2 = r3 = r4 = ( p0[ 1 ] - p0[ 0 ] ) /
+                                ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] );
+            for( ii = 0; ii < 2; ++ii ) {
+               p1[ ii ] = r1;
+            }
+            for( ; ii < length - 4; ii += 4 ) {
+               r4 = p1[ ii ] = 0.5 * ( p0[ ii ] - p0[ ii - 2 ] )
+                               - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3 - b1[ 4 ] * r4;
+               r3 = p1[ ii + 1 ] = 0.5 * ( p0[ ii + 1 ] - p0[ ii - 1 ] )
+                                   - b1[ 1 ] * r4 - b1[ 2 ] * r1 - b1[ 3 ] * r2 - b1[ 4 ] * r3;
+               r2 = p1[ ii + 2 ] = 0.5 * ( p0[ ii + 2 ] - p0[ ii ] )
+                                   - b1[ 1 ] * r3 - b1[ 2 ] * r4 - b1[ 3 ] * r1 - b1[ 4 ] * r2;
+               r1 = p1[ ii + 3 ] = 0.5 * ( p0[ ii + 3 ] - p0[ ii + 1 ] )
+                                   - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r4 - b1[ 4 ] * r1;
+            }
+         }
+         break;
+
+      case 5:
+         if( copy_forward ) {
+            r1 = r2 = r3 = r4 = r5 = p0[ 0 ] /
+                                     ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] + b1[ 5 ] );
+            for( ; ii < length - 5; ii += 5 ) {
+               r5 = p1[ ii ] = p0[ ii ]
+                               - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3 - b1[ 4 ] * r4 - b1[ 5 ] * r5;
+               r4 = p1[ ii + 1 ] = p0[ ii + 1 ]
+                                   - b1[ 1 ] * r5 - b1[ 2 ] * r1 - b1[ 3 ] * r2 - b1[ 4 ] * r3 - b1[ 5 ] * r4;
+               r3 = p1[ ii + 2 ] = p0[ ii + 2 ]
+                                   - b1[ 1 ] * r4 - b1[ 2 ] * r5 - b1[ 3 ] * r1 - b1[ 4 ] * r2 - b1[ 5 ] * r3;
+               r2 = p1[ ii + 3 ] = p0[ ii + 3 ]
+                                   - b1[ 1 ] * r3 - b1[ 2 ] * r4 - b1[ 3 ] * r5 - b1[ 4 ] * r1 - b1[ 5 ] * r2;
+               r1 = p1[ ii + 4 ] = p0[ ii + 4 ]
+                                   - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r4 - b1[ 4 ] * r5 - b1[ 5 ] * r1;
+            }
+         } else if( a1[ 0 ] == 1.0 && a1[ 1 ] == -1.0 && a1[ 2 ] == 0.0 && a1[ 3 ] == 0.0 ) {
+            r1 = r2 = r3 = r4 = r5 = ( p0[ 1 ] - p0[ 0 ] ) /
+                                     ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] + b1[ 5 ] );
+            p1[ ii++ ] = r1;
+            for( ; ii < length - 5; ii += 5 ) {
+               r5 = p1[ ii ] = p0[ ii ] - p0[ ii - 1 ]
+                               - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3 - b1[ 4 ] * r4 - b1[ 5 ] * r5;
+               r4 = p1[ ii + 1 ] = p0[ ii + 1 ] - p0[ ii ]
+                                   - b1[ 1 ] * r5 - b1[ 2 ] * r1 - b1[ 3 ] * r2 - b1[ 4 ] * r3 - b1[ 5 ] * r4;
+               r3 = p1[ ii + 2 ] = p0[ ii + 2 ] - p0[ ii + 1 ]
+                                   - b1[ 1 ] * r4 - b1[ 2 ] * r5 - b1[ 3 ] * r1 - b1[ 4 ] * r2 - b1[ 5 ] * r3;
+               r2 = p1[ ii + 3 ] = p0[ ii + 3 ] - p0[ ii + 2 ]
+                                   - b1[ 1 ] * r3 - b1[ 2 ] * r4 - b1[ 3 ] * r5 - b1[ 4 ] * r1 - b1[ 5 ] * r2;
+               r1 = p1[ ii + 4 ] = p0[ ii + 4 ] - p0[ ii + 3 ]
+                                   - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r4 - b1[ 4 ] * r5 - b1[ 5 ] * r1;
+            }
+         }
+         break;
+
+      default:
+         break;
+   }
+
+   // Compute the first order1 values for arbitrary coefficients a & b
+   T val = 0.0;
+   for( dip::uint jj = orderMA[ 1 ]; jj <= orderMA[ 2 ]; ++jj ) {
+      val += ( a1[ jj ] * p0[ orderMA[ 2 ] - jj ] );
+   }
+   r1 = val / ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] + b1[ 5 ] );
+   for( ; ii < order1; ++ii ) {
+      p1[ ii ] = r1;
+   }
+   for( ; ii < length; ++ii ) {
+      if( !copy_forward ) {
+         val = 0.0;
+         for( dip::uint jj = orderMA[ 1 ]; jj <= orderMA[ 2 ]; ++jj ) {
+            val += ( a1[ jj ] * p0[ ii - jj ] );
+         }
+      } else {
+         val = p0[ ii ];
+      }
+      for( dip::uint jj = orderAR[ 1 ]; jj <= orderAR[ 2 ]; ++jj ) {
+         val -= ( b1[ jj ] * p1[ ii - jj ] );
+      }
+      p1[ ii ] = val;
+   }
+
+   // Iterative & recursive backward scan
+   ii = length - 1;
+   switch( order2 ) {
+      case 3:
+         if( copy_backward ) {
+            r1 = r2 = r3 = c * p1[ length - 1 ] / ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] );
+            for( ; ii >= 3; ii -= 3 ) {
+               r3 = p2[ ii ] = c * p1[ ii ] - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3;
+               r2 = p2[ ii - 1 ] = c * p1[ ii - 1 ] - b2[ 1 ] * r3 - b2[ 2 ] * r1 - b2[ 3 ] * r2;
+               r1 = p2[ ii - 2 ] = c * p1[ ii - 2 ] - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r1;
+            }
+         }
+         break;
+
+      case 4:
+         if( copy_backward ) {
+            r1 = r2 = r3 = r4 = c * p1[ length - 1 ] /
+                                ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] );
+            for( ; ii >= 4; ii -= 4 ) {
+               r4 = p2[ ii ] = c * p1[ ii ]
+                               - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3 - b2[ 4 ] * r4;
+               r3 = p2[ ii - 1 ] = c * p1[ ii - 1 ]
+                                   - b2[ 1 ] * r4 - b2[ 2 ] * r1 - b2[ 3 ] * r2 - b2[ 4 ] * r3;
+               r2 = p2[ ii - 2 ] = c * p1[ ii - 2 ]
+                                   - b2[ 1 ] * r3 - b2[ 2 ] * r4 - b2[ 3 ] * r1 - b2[ 4 ] * r2;
+               r1 = p2[ ii - 3 ] = c * p1[ ii - 3 ]
+                                   - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r4 - b2[ 4 ] * r1;
+            }
+         } else if( a2[ 0 ] == 0.0 && a2[ 1 ] == 1.0 && a2[ 2 ] == 0.0 && a2[ 3 ] == 0.0 ) {
+            r1 = r2 = r3 = r4 = c * p1[ length - 1 ] /
+                                ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] );
+            p2[ ii ] = r1;
+            ii -= 1;
+            for( ; ii >= 4; ii -= 4 ) {
+               r4 = p2[ ii ] = c * p1[ ii + 1 ]
+                               - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3 - b2[ 4 ] * r4;
+               r3 = p2[ ii - 1 ] = c * p1[ ii ]
+                                   - b2[ 1 ] * r4 - b2[ 2 ] * r1 - b2[ 3 ] * r2 - b2[ 4 ] * r3;
+               r2 = p2[ ii - 2 ] = c * p1[ ii - 1 ]
+                                   - b2[ 1 ] * r3 - b2[ 2 ] * r4 - b2[ 3 ] * r1 - b2[ 4 ] * r2;
+               r1 = p2[ ii - 3 ] = c * p1[ ii - 2 ]
+                                   - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r4 - b2[ 4 ] * r1;
+            }
+         }
+         break;
+
+      case 5:
+         if( copy_backward ) {
+            r1 = r2 = r3 = r4 = r5 = c * p1[ length - 1 ] /
+                                     ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] + b2[ 5 ] );
+            for( ; ii >= 5; ii -= 5 ) {
+               r5 = p2[ ii ] = c * p1[ ii ]
+                               - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3 - b2[ 4 ] * r4 - b2[ 5 ] * r5;
+               r4 = p2[ ii - 1 ] = c * p1[ ii - 1 ]
+                                   - b2[ 1 ] * r5 - b2[ 2 ] * r1 - b2[ 3 ] * r2 - b2[ 4 ] * r3 - b2[ 5 ] * r4;
+               r3 = p2[ ii - 2 ] = c * p1[ ii - 2 ]
+                                   - b2[ 1 ] * r4 - b2[ 2 ] * r5 - b2[ 3 ] * r1 - b2[ 4 ] * r2 - b2[ 5 ] * r3;
+               r2 = p2[ ii - 3 ] = c * p1[ ii - 3 ]
+                                   - b2[ 1 ] * r3 - b2[ 2 ] * r4 - b2[ 3 ] * r5 - b2[ 4 ] * r1 - b2[ 5 ] * r2;
+               r1 = p2[ ii - 4 ] = c * p1[ ii - 4 ]
+                                   - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r4 - b2[ 4 ] * r5 - b2[ 5 ] * r1;
+            }
+         } else if( a2[ 0 ] == -1.0 && a2[ 1 ] == 1.0 && a2[ 2 ] == 0.0 && a2[ 3 ] == 0.0 ) {
+            r1 = r2 = r3 = r4 = r5 = c * ( -p1[ length - 2 ] + p1[ length - 1 ] ) /
+                                     ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] + b2[ 5 ] );
+            p2[ ii ] = r1;
+            ii -= 1;
+            for( ; ii >= 5; ii -= 5 ) {
+               r5 = p2[ ii ] = c * ( -p1[ ii ] + p1[ ii + 1 ] )
+                               - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3 - b2[ 4 ] * r4 - b2[ 5 ] * r5;
+               r4 = p2[ ii - 1 ] = c * ( -p1[ ii - 1 ] + p1[ ii ] )
+                                   - b2[ 1 ] * r5 - b2[ 2 ] * r1 - b2[ 3 ] * r2 - b2[ 4 ] * r3 - b2[ 5 ] * r4;
+               r3 = p2[ ii - 2 ] = c * ( -p1[ ii - 2 ] + p1[ ii - 1 ] )
+                                   - b2[ 1 ] * r4 - b2[ 2 ] * r5 - b2[ 3 ] * r1 - b2[ 4 ] * r2 - b2[ 5 ] * r3;
+               r2 = p2[ ii - 3 ] = c * ( -p1[ ii - 3 ] + p1[ ii - 2 ] )
+                                   - b2[ 1 ] * r3 - b2[ 2 ] * r4 - b2[ 3 ] * r5 - b2[ 4 ] * r1 - b2[ 5 ] * r2;
+               r1 = p2[ ii - 4 ] = c * ( -p1[ ii - 4 ] + p1[ ii - 3 ] )
+                                   - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r4 - b2[ 4 ] * r5 - b2[ 5 ] * r1;
+            }
+         }
+         break;
+
+      default:
+         break;
+   }
+
+   // Compute the first order2 values for arbitrary coefficients a & b
+   val = 0.0;
+   for( dip::uint jj = orderMA[ 4 ]; jj <= orderMA[ 5 ]; ++jj ) {
+      val += ( a2[ jj ] * p1[ length - 1 - orderMA[ 5 ] + jj ] );
+   }
+   r1 = val / ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] + b2[ 5 ] );
+   for( ; ii > length - 1 - order2; --ii ) {
+      p2[ ii ] = c * r1;
+   }
+   ++ii;
+   while( ii > 0 ) {
+      --ii;
+      if( !copy_backward ) {
+         val = 0.0;
+         for( dip::uint jj = orderMA[ 4 ]; jj <= orderMA[ 5 ]; ++jj ) {
+            val += ( a2[ jj ] * p1[ ii + jj ] );
+         }
+         val = c * val;
+      } else {
+         val = c * p1[ ii ];
+      }
+
+      for( dip::uint jj = orderAR[ 4 ]; jj <= orderAR[ 5 ]; ++jj ) {
+         val -= ( b2[ jj ] * p2[ ii + jj ] );
+      }
+      p2[ ii ] = val;
+   }
+}
+
+// The number of operations per sample for filtering with `fParams`: a multiply-add for each coefficient of the
+// forward and backward recursions, plus copying the sample to and from the buffer.
+dip::uint GaussIIROperationsPerSample( dip__GaussIIRParams const& fParams ) {
+   auto const& orderMA = fParams.iir_order_num;
+   auto const& orderAR = fParams.iir_order_den;
+   dip::uint nCoefficients = ( orderMA[ 2 ] - orderMA[ 1 ] + 1 ) + ( orderAR[ 2 ] - orderAR[ 1 ] + 1 )
+                           + ( orderMA[ 5 ] - orderMA[ 4 ] + 1 ) + ( orderAR[ 5 ] - orderAR[ 4 ] + 1 );
+   return 2 * nCoefficients + 2;
+}
+
 class GaussIIRLineFilter : public Framework::SeparableLineFilter {
    public:
       GaussIIRLineFilter( std::vector< dip__GaussIIRParams > const& filterParams ) : filterParams_( filterParams ) {}
       virtual void SetNumberOfThreads( dip::uint threads ) override {
          buffers_.resize( threads );
       }
-      virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint, dip::uint, dip::uint /*procDim*/ ) override {
-         // TODO: figure out how filter parameters affect amount of computation
-         //dip__GaussIIRParams const& fParams = filterParams_[ procDim ];
-         return lineLength * 40;
+      virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint, dip::uint, dip::uint procDim ) override {
+         return lineLength * GaussIIROperationsPerSample( filterParams_[ procDim ] );
       }
       virtual void Filter( Framework::SeparableLineFilterParameters const& params ) override {
          dfloat* in = static_cast< dfloat* >( params.inBuffer.buffer );
@@ -464,257 +756,88 @@ class GaussIIRLineFilter : public Framework::SeparableLineFilter {
          out -= fParams.border;
          dip::uint length = params.inBuffer.length + fParams.border * 2;
          buffers_[ params.thread ].resize( length ); // won't do anything if buffer is already of correct size.
-         dfloat* p1 = buffers_[ params.thread ].data();
-
-         auto const& a1 = fParams.a1;
-         auto const& a2 = fParams.a2;
-         auto const& b1 = fParams.b1;
-         auto const& b2 = fParams.b2;
-         dfloat c = ( fParams.cc );
-
-         auto const& orderMA = fParams.iir_order_num;
-         auto const& orderAR = fParams.iir_order_den;
-         dip::uint order1 = std::max( orderAR[ 0 ], orderMA[ 0 ] );
-         dip::uint order2 = std::max( orderAR[ 3 ], orderMA[ 3 ] );
-         bool copy_forward = false;
-         bool copy_backward = false;
-         if( ( orderMA[ 0 ] == 0 ) && ( a1[ 0 ] == 1.0 ) ) {
-            copy_forward = true;
-         }
-         if( ( orderMA[ 3 ] == 0 ) && ( a2[ 0 ] == 1.0 ) ) {
-            copy_backward = true;
-         }
-
-         // Recursive forward scan
-         dfloat* p0 = in;
-         dip::uint ii = 0;
-         dfloat r1, r2, r3, r4, r5;
-         switch( order1 ) {
-            case 3:
-               if( copy_forward ) {
-                  r1 = r2 = r3 = p0[ 0 ] / ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] );
-                  for( ; ii < length - 3; ii += 3 ) {
-                     r3 = p1[ ii ] = p0[ ii ] - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3;
-                     r2 = p1[ ii + 1 ] = p0[ ii + 1 ] - b1[ 1 ] * r3 - b1[ 2 ] * r1 - b1[ 3 ] * r2;
-                     r1 = p1[ ii + 2 ] = p0[ ii + 2 ] - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r1;
-                  }
-               }
-               break;
-
-            case 4:
-               if( copy_forward ) {
-                  r1 = r2 = r3 = r4 = p0[ 0 ] / ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] );
-                  for( ; ii < length - 4; ii += 4 ) {
-                     r4 = p1[ ii ] = p0[ ii ]
-                                     - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3 - b1[ 4 ] * r4;
-                     r3 = p1[ ii + 1 ] = p0[ ii + 1 ]
-                                         - b1[ 1 ] * r4 - b1[ 2 ] * r1 - b1[ 3 ] * r2 - b1[ 4 ] * r3;
-                     r2 = p1[ ii + 2 ] = p0[ ii + 2 ]
-                                         - b1[ 1 ] * r3 - b1[ 2 ] * r4 - b1[ 3 ] * r1 - b1[ 4 ] * r2;
-                     r1 = p1[ ii + 3 ] = p0[ ii + 3 ]
-                                         - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r4 - b1[ 4 ] * r1;
-                  }
-               } else if( a1[ 0 ] == 0.5 && a1[ 1 ] == 0.0 && a1[ 2 ] == -0.5 && a1[ 3 ] == 0.0 ) {
-                  r1 = r2 = r3 = r4 = ( p0[ 1 ] - p0[ 0 ] ) /
-                                      ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] );
-                  for( ii = 0; ii < 2; ++ii ) {
-                     p1[ ii ] = r1;
-                  }
-                  for( ; ii < length - 4; ii += 4 ) {
-                     r4 = p1[ ii ] = 0.5 * ( p0[ ii ] - p0[ ii - 2 ] )
-                                     - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3 - b1[ 4 ] * r4;
-                     r3 = p1[ ii + 1 ] = 0.5 * ( p0[ ii + 1 ] - p0[ ii - 1 ] )
-                                         - b1[ 1 ] * r4 - b1[ 2 ] * r1 - b1[ 3 ] * r2 - b1[ 4 ] * r3;
-                     r2 = p1[ ii + 2 ] = 0.5 * ( p0[ ii + 2 ] - p0[ ii ] )
-                                         - b1[ 1 ] * r3 - b1[ 2 ] * r4 - b1[ 3 ] * r1 - b1[ 4 ] * r2;
-                     r1 = p1[ ii + 3 ] = 0.5 * ( p0[ ii + 3 ] - p0[ ii + 1 ] )
-                                         - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r4 - b1[ 4 ] * r1;
-                  }
-               }
-               break;
+         GaussIIRRecursion( in, buffers_[ params.thread ].data(), out, length, fParams );
+      }
+   private:
+      std::vector< dip__GaussIIRParams > const& filterParams_; // one of each dimension
+      std::vector< std::vector< dfloat >> buffers_; // one for each thread
+};
 
-            case 5:
-               if( copy_forward ) {
-                  r1 = r2 = r3 = r4 = r5 = p0[ 0 ] /
-                                           ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] + b1[ 5 ] );
-                  for( ; ii < length - 5; ii += 5 ) {
-                     r5 = p1[ ii ] = p0[ ii ]
-                                     - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3 - b1[ 4 ] * r4 - b1[ 5 ] * r5;
-                     r4 = p1[ ii + 1 ] = p0[ ii + 1 ]
-                                         - b1[ 1 ] * r5 - b1[ 2 ] * r1 - b1[ 3 ] * r2 - b1[ 4 ] * r3 - b1[ 5 ] * r4;
-                     r3 = p1[ ii + 2 ] = p0[ ii + 2 ]
-                                         - b1[ 1 ] * r4 - b1[ 2 ] * r5 - b1[ 3 ] * r1 - b1[ 4 ] * r2 - b1[ 5 ] * r3;
-                     r2 = p1[ ii + 3 ] = p0[ ii + 3 ]
-                                         - b1[ 1 ] * r3 - b1[ 2 ] * r4 - b1[ 3 ] * r5 - b1[ 4 ] * r1 - b1[ 5 ] * r2;
-                     r1 = p1[ ii + 4 ] = p0[ ii + 4 ]
-                                         - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r4 - b1[ 4 ] * r5 - b1[ 5 ] * r1;
-                  }
-               } else if( a1[ 0 ] == 1.0 && a1[ 1 ] == -1.0 && a1[ 2 ] == 0.0 && a1[ 3 ] == 0.0 ) {
-                  r1 = r2 = r3 = r4 = r5 = ( p0[ 1 ] - p0[ 0 ] ) /
-                                           ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] + b1[ 5 ] );
-                  p1[ ii++ ] = r1;
-                  for( ; ii < length - 5; ii += 5 ) {
-                     r5 = p1[ ii ] = p0[ ii ] - p0[ ii - 1 ]
-                                     - b1[ 1 ] * r1 - b1[ 2 ] * r2 - b1[ 3 ] * r3 - b1[ 4 ] * r4 - b1[ 5 ] * r5;
-                     r4 = p1[ ii + 1 ] = p0[ ii + 1 ] - p0[ ii ]
-                                         - b1[ 1 ] * r5 - b1[ 2 ] * r1 - b1[ 3 ] * r2 - b1[ 4 ] * r3 - b1[ 5 ] * r4;
-                     r3 = p1[ ii + 2 ] = p0[ ii + 2 ] - p0[ ii + 1 ]
-                                         - b1[ 1 ] * r4 - b1[ 2 ] * r5 - b1[ 3 ] * r1 - b1[ 4 ] * r2 - b1[ 5 ] * r3;
-                     r2 = p1[ ii + 3 ] = p0[ ii + 3 ] - p0[ ii + 2 ]
-                                         - b1[ 1 ] * r3 - b1[ 2 ] * r4 - b1[ 3 ] * r5 - b1[ 4 ] * r1 - b1[ 5 ] * r2;
-                     r1 = p1[ ii + 4 ] = p0[ ii + 4 ] - p0[ ii + 3 ]
-                                         - b1[ 1 ] * r2 - b1[ 2 ] * r3 - b1[ 3 ] * r4 - b1[ 4 ] * r5 - b1[ 5 ] * r1;
-                  }
-               }
-               break;
+static_assert( sizeof( GaussIIRLanes ) == GaussIIRLanes::N * sizeof( dfloat ), "GaussIIRLanes must not be padded" );
 
-            default:
-               break;
-         }
+// Filters all image lines along dimension `dim` of `in`, writing the result to `out`, which has the same sizes
+// and can be the same image. Both are scalar images of a real type. Image lines are processed in blocks of
+// `GaussIIRLanes::N`, chosen to be adjacent along the dimension with the smallest stride in `in`, such that
+// gathering them into the interleaved buffer reads mostly contiguous memory. Each line is converted to double
+// precision in that buffer, like the separable framework does, so there are no image-sized intermediates.
+void GaussIIRMultiLine( Image const& in, Image const& out, dip::uint dim, dip__GaussIIRParams const& fParams, BoundaryCondition bc ) {
+   constexpr dip::uint N = GaussIIRLanes::N;
+   dip::uint nDims = in.Dimensionality();
+   UnsignedArray const& sizes = in.Sizes();
+   dip::uint laneDim = dim == 0 ? 1 : 0;
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      if(( ii != dim ) && ( sizes[ ii ] > 1 ) &&
+         (( sizes[ laneDim ] == 1 ) || ( std::abs( in.Stride( ii )) < std::abs( in.Stride( laneDim ))))) {
+         laneDim = ii;
+      }
+   }
+   UnsignedArray blocks = sizes;
+   blocks[ dim ] = 1;
+   blocks[ laneDim ] = div_ceil( sizes[ laneDim ], N );
+   dip::uint nBlocks = blocks.product();
+   dip::uint length = sizes[ dim ];
+   dip::uint border = fParams.border;
+   dip::uint bufferLength = length + 2 * border;
+   DataType inType = in.DataType();
+   DataType outType = out.DataType();
+   dip::sint inLaneStride = in.Stride( laneDim ) * static_cast< dip::sint >( inType.SizeOf() ); // in bytes
+   dip::sint outLaneStride = out.Stride( laneDim ) * static_cast< dip::sint >( outType.SizeOf() );
 
-         // Compute the first order1 values for arbitrary coefficients a & b
-         dfloat val = 0.0;
-         for( dip::uint jj = orderMA[ 1 ]; jj <= orderMA[ 2 ]; ++jj ) {
-            val += ( a1[ jj ] * p0[ orderMA[ 2 ] - jj ] );
-         }
-         r1 = val / ( 1.0 + b1[ 1 ] + b1[ 2 ] + b1[ 3 ] + b1[ 4 ] + b1[ 5 ] );
-         for( ; ii < order1; ++ii ) {
-            p1[ ii ] = r1;
-         }
-         for( ; ii < length; ++ii ) {
-            if( !copy_forward ) {
-               val = 0.0;
-               for( dip::uint jj = orderMA[ 1 ]; jj <= orderMA[ 2 ]; ++jj ) {
-                  val += ( a1[ jj ] * p0[ ii - jj ] );
-               }
-            } else {
-               val = p0[ ii ];
+   dip::uint operations = nBlocks * N * bufferLength * GaussIIROperationsPerSample( fParams );
+   dip::uint nThreads = std::min( GetThreadingCostModel().NumberOfThreads( operations, GetNumberOfThreads() ), nBlocks );
+   // Each thread has its own buffers, and takes one block at the time
+   std::atomic< dip::uint > nextBlock{ 0 };
+   ParallelFor( nThreads, [ & ]( dip::uint ) {
+      std::vector< GaussIIRLanes > buffer( 3 * bufferLength );
+      GaussIIRLanes* inBuf = buffer.data();
+      GaussIIRLanes* tmpBuf = inBuf + bufferLength;
+      GaussIIRLanes* outBuf = tmpBuf + bufferLength;
+      UnsignedArray coords( nDims );
+      for( dip::uint block = nextBlock++; block < nBlocks; block = nextBlock++ ) {
+         // Find the first pixel of the first line in this block
+         dip::uint index = block;
+         dip::uint nLanes = N;
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            coords[ ii ] = index % blocks[ ii ];
+            index /= blocks[ ii ];
+            if( ii == laneDim ) {
+               coords[ ii ] *= N;
+               nLanes = std::min( N, sizes[ ii ] - coords[ ii ] );
             }
-            for( dip::uint jj = orderAR[ 1 ]; jj <= orderAR[ 2 ]; ++jj ) {
-               val -= ( b1[ jj ] * p1[ ii - jj ] );
-            }
-            p1[ ii ] = val;
          }
-
-         // Iterative & recursive backward scan
-         dfloat* p2 = out;
-         ii = length - 1;
-         switch( order2 ) {
-            case 3:
-               if( copy_backward ) {
-                  r1 = r2 = r3 = c * p1[ length - 1 ] / ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] );
-                  for( ; ii >= 3; ii -= 3 ) {
-                     r3 = p2[ ii ] = c * p1[ ii ] - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3;
-                     r2 = p2[ ii - 1 ] = c * p1[ ii - 1 ] - b2[ 1 ] * r3 - b2[ 2 ] * r1 - b2[ 3 ] * r2;
-                     r1 = p2[ ii - 2 ] = c * p1[ ii - 2 ] - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r1;
-                  }
-               }
-               break;
-
-            case 4:
-               if( copy_backward ) {
-                  r1 = r2 = r3 = r4 = c * p1[ length - 1 ] /
-                                      ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] );
-                  for( ; ii >= 4; ii -= 4 ) {
-                     r4 = p2[ ii ] = c * p1[ ii ]
-                                     - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3 - b2[ 4 ] * r4;
-                     r3 = p2[ ii - 1 ] = c * p1[ ii - 1 ]
-                                         - b2[ 1 ] * r4 - b2[ 2 ] * r1 - b2[ 3 ] * r2 - b2[ 4 ] * r3;
-                     r2 = p2[ ii - 2 ] = c * p1[ ii - 2 ]
-                                         - b2[ 1 ] * r3 - b2[ 2 ] * r4 - b2[ 3 ] * r1 - b2[ 4 ] * r2;
-                     r1 = p2[ ii - 3 ] = c * p1[ ii - 3 ]
-                                         - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r4 - b2[ 4 ] * r1;
-                  }
-               } else if( a2[ 0 ] == 0.0 && a2[ 1 ] == 1.0 && a2[ 2 ] == 0.0 && a2[ 3 ] == 0.0 ) {
-                  r1 = r2 = r3 = r4 = c * p1[ length - 1 ] /
-                                      ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] );
-                  p2[ ii ] = r1;
-                  ii -= 1;
-                  for( ; ii >= 4; ii -= 4 ) {
-                     r4 = p2[ ii ] = c * p1[ ii + 1 ]
-                                     - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3 - b2[ 4 ] * r4;
-                     r3 = p2[ ii - 1 ] = c * p1[ ii ]
-                                         - b2[ 1 ] * r4 - b2[ 2 ] * r1 - b2[ 3 ] * r2 - b2[ 4 ] * r3;
-                     r2 = p2[ ii - 2 ] = c * p1[ ii - 1 ]
-                                         - b2[ 1 ] * r3 - b2[ 2 ] * r4 - b2[ 3 ] * r1 - b2[ 4 ] * r2;
-                     r1 = p2[ ii - 3 ] = c * p1[ ii - 2 ]
-                                         - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r4 - b2[ 4 ] * r1;
-                  }
-               }
-               break;
-
-            case 5:
-               if( copy_backward ) {
-                  r1 = r2 = r3 = r4 = r5 = c * p1[ length - 1 ] /
-                                           ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] + b2[ 5 ] );
-                  for( ; ii >= 5; ii -= 5 ) {
-                     r5 = p2[ ii ] = c * p1[ ii ]
-                                     - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3 - b2[ 4 ] * r4 - b2[ 5 ] * r5;
-                     r4 = p2[ ii - 1 ] = c * p1[ ii - 1 ]
-                                         - b2[ 1 ] * r5 - b2[ 2 ] * r1 - b2[ 3 ] * r2 - b2[ 4 ] * r3 - b2[ 5 ] * r4;
-                     r3 = p2[ ii - 2 ] = c * p1[ ii - 2 ]
-                                         - b2[ 1 ] * r4 - b2[ 2 ] * r5 - b2[ 3 ] * r1 - b2[ 4 ] * r2 - b2[ 5 ] * r3;
-                     r2 = p2[ ii - 3 ] = c * p1[ ii - 3 ]
-                                         - b2[ 1 ] * r3 - b2[ 2 ] * r4 - b2[ 3 ] * r5 - b2[ 4 ] * r1 - b2[ 5 ] * r2;
-                     r1 = p2[ ii - 4 ] = c * p1[ ii - 4 ]
-                                         - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r4 - b2[ 4 ] * r5 - b2[ 5 ] * r1;
-                  }
-               } else if( a2[ 0 ] == -1.0 && a2[ 1 ] == 1.0 && a2[ 2 ] == 0.0 && a2[ 3 ] == 0.0 ) {
-                  r1 = r2 = r3 = r4 = r5 = c * ( -p1[ length - 2 ] + p1[ length - 1 ] ) /
-                                           ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] + b2[ 5 ] );
-                  p2[ ii ] = r1;
-                  ii -= 1;
-                  for( ; ii >= 5; ii -= 5 ) {
-                     r5 = p2[ ii ] = c * ( -p1[ ii ] + p1[ ii + 1 ] )
-                                     - b2[ 1 ] * r1 - b2[ 2 ] * r2 - b2[ 3 ] * r3 - b2[ 4 ] * r4 - b2[ 5 ] * r5;
-                     r4 = p2[ ii - 1 ] = c * ( -p1[ ii - 1 ] + p1[ ii ] )
-                                         - b2[ 1 ] * r5 - b2[ 2 ] * r1 - b2[ 3 ] * r2 - b2[ 4 ] * r3 - b2[ 5 ] * r4;
-                     r3 = p2[ ii - 2 ] = c * ( -p1[ ii - 2 ] + p1[ ii - 1 ] )
-                                         - b2[ 1 ] * r4 - b2[ 2 ] * r5 - b2[ 3 ] * r1 - b2[ 4 ] * r2 - b2[ 5 ] * r3;
-                     r2 = p2[ ii - 3 ] = c * ( -p1[ ii - 3 ] + p1[ ii - 2 ] )
-                                         - b2[ 1 ] * r3 - b2[ 2 ] * r4 - b2[ 3 ] * r5 - b2[ 4 ] * r1 - b2[ 5 ] * r2;
-                     r1 = p2[ ii - 4 ] = c * ( -p1[ ii - 4 ] + p1[ ii - 3 ] )
-                                         - b2[ 1 ] * r2 - b2[ 2 ] * r3 - b2[ 3 ] * r4 - b2[ 4 ] * r5 - b2[ 5 ] * r1;
-                  }
-               }
-               break;
-
-            default:
-               break;
+         // Gather the lines into the interleaved buffer, unused lanes are set to 0
+         uint8 const* inPtr = static_cast< uint8 const* >( in.Pointer( coords ));
+         for( dip::uint kk = 0; kk < nLanes; ++kk ) {
+            detail::CopyBuffer( inPtr + static_cast< dip::sint >( kk ) * inLaneStride, inType, in.Stride( dim ), 0,
+                                inBuf[ border ].v + kk, DT_DFLOAT, static_cast< dip::sint >( N ), 0, length, 1 );
          }
-
-         // Compute the first order2 values for arbitrary coefficients a & b
-         val = 0.0;
-         for( dip::uint jj = orderMA[ 4 ]; jj <= orderMA[ 5 ]; ++jj ) {
-            val += ( a2[ jj ] * p1[ length - 1 - orderMA[ 5 ] + jj ] );
+         for( dip::uint jj = 0; jj < length; ++jj ) {
+            std::fill( inBuf[ border + jj ].v + nLanes, inBuf[ border + jj ].v + N, 0.0 );
          }
-         r1 = val / ( 1.0 + b2[ 1 ] + b2[ 2 ] + b2[ 3 ] + b2[ 4 ] + b2[ 5 ] );
-         for( ; ii > length - 1 - order2; --ii ) {
-            p2[ ii ] = c * r1;
+         if( border > 0 ) {
+            // Each buffer element is treated as a pixel with `N` tensor elements
+            detail::ExpandBuffer( inBuf[ border ].v, DT_DFLOAT, static_cast< dip::sint >( N ), 1, length, N, border, border, bc );
          }
-         ++ii;
-         while( ii > 0 ) {
-            --ii;
-            if( !copy_backward ) {
-               val = 0.0;
-               for( dip::uint jj = orderMA[ 4 ]; jj <= orderMA[ 5 ]; ++jj ) {
-                  val += ( a2[ jj ] * p1[ ii + jj ] );
-               }
-               val = c * val;
-            } else {
-               val = c * p1[ ii ];
-            }
-
-            for( dip::uint jj = orderAR[ 4 ]; jj <= orderAR[ 5 ]; ++jj ) {
-               val -= ( b2[ jj ] * p2[ ii + jj ] );
-            }
-            p2[ ii ] = val;
+         detail::CpuDispatch( [ & ]() { GaussIIRRecursion( inBuf, tmpBuf, outBuf, bufferLength, fParams ); } );
+         // Scatter the results into the output image
+         uint8* outPtr = static_cast< uint8* >( out.Pointer( coords ));
+         for( dip::uint kk = 0; kk < nLanes; ++kk ) {
+            detail::CopyBuffer( outBuf[ border ].v + kk, DT_DFLOAT, static_cast< dip::sint >( N ), 0,
+                                outPtr + static_cast< dip::sint >( kk ) * outLaneStride, outType, out.Stride( dim ), 0, length, 1 );
          }
       }
-   private:
-      std::vector< dip__GaussIIRParams > const& filterParams_; // one of each dimension
-      std::vector< std::vector< dfloat >> buffers_; // one for each thread
-};
+   } );
+}
 
 } // namespace
 
@@ -770,6 +893,39 @@ void GaussIIR(
          process[ ii ] = false;
       }
    }
+   DataType outType = DataType::SuggestFlex( in.DataType() );
+   if( in.DataType().IsReal() && ( nDims > 1 ) && ( !out.IsProtected() || ( out.DataType() == outType ))) {
+      // Filter multiple image lines simultaneously. The first pass reads from the input image, the other
+      // passes work in place in the output image.
+      DIP_START_STACK_TRACE
+         BoundaryConditionArray bc = StringArrayToBoundaryConditionArray( boundaryCondition );
+         BoundaryArrayUseParameter( bc, nDims );
+         Image input = in.QuickCopy();
+         if( out.IsOverlappingView( input )) {
+            out.Strip();
+         }
+         out.ReForge( input.Sizes(), input.TensorElements(), outType, Option::AcceptDataTypeChange::DO_ALLOW );
+         out.ReshapeTensor( input.Tensor() );
+         out.SetPixelSize( in.PixelSize() );
+         out.SetColorSpace( in.ColorSpace() );
+         Image output = out.QuickCopy();
+         if( !input.IsScalar() ) {
+            input.TensorToSpatial(); // adds a dimension at the end, which we don't process
+            output.TensorToSpatial();
+         }
+         bool first = true;
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            if( process[ ii ] ) {
+               GaussIIRMultiLine( first ? input : output, output, ii, filterParams[ ii ], bc[ ii ] );
+               first = false;
+            }
+         }
+         if( first ) {
+            output.Copy( input );
+         }
+      DIP_END_STACK_TRACE
+      return;
+   }
    // Call the separable framework
    DIP_START_STACK_TRACE
       // handle boundary condition array (checks are made in Framework::Separable, no need to repeat them here)
@@ -800,6 +956,7 @@ void GaussIIR(
 #include "diplib/statistics.h"
 #include "diplib/iterators.h"
 #include "diplib/testing.h"
+#include "diplib/geometry.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the IIR Gaussian filter") {
 
@@ -872,4 +1029,54 @@ DOCTEST_TEST_CASE("[DIPlib] testing the IIR Gaussian filter") {
    DOCTEST_CHECK( r1.At( 128 ).As< dip::dfloat >() == doctest::Approx( 6.0 ));
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the IIR Gaussian filter on multiple lines simultaneously") {
+   // Multi-dimensional images filter multiple lines at once, 1D images use the separable framework.
+   // 13 lines: one full block of 8 lines and one partial block.
+   dip::Image img{ dip::UnsignedArray{ 60, 13 }, 1, dip::DT_DFLOAT };
+   dip::ImageIterator< dip::dfloat > it( img );
+   do {
+      auto const& coords = it.Coordinates();
+      *it = std::sin( 0.3 * static_cast< dip::dfloat >( coords[ 0 ] * ( coords[ 1 ] + 1 ))) + static_cast< dip::dfloat >( coords[ 1 ] );
+   } while( ++it );
+   for( dip::uint dim = 0; dim < 2; ++dim ) {
+      dip::FloatArray sigmas{ 0.0, 0.0 };
+      sigmas[ dim ] = 4.0;
+      dip::UnsignedArray order{ 0, 0 };
+      order[ dim ] = 1;
+      dip::Image r1 = dip::GaussIIR( img, sigmas, order, { "asym mirror", "periodic" } );
+      DOCTEST_REQUIRE( r1.DataType() == dip::DT_DFLOAT );
+      dip::RangeArray window( 2 );
+      for( dip::uint ii = 0; ii < img.Size( 1 - dim ); ++ii ) {
+         window[ 1 - dim ] = dip::Range{ static_cast< dip::sint >( ii ) };
+         dip::Image line = img.At( window );
+         line.Squeeze();
+         dip::Image r2 = dip::GaussIIR( line, { 4.0 }, { 1 }, { dim == 0 ? "asym mirror" : "periodic" } );
+         line = r1.At( window );
+         line.Squeeze();
+         DOCTEST_CHECK( dip::testing::CompareImages( line, r2, 1e-12 ));
+      }
+   }
+   // Single-precision images are filtered in double precision, and stored in single precision between passes
+   dip::Image r1 = dip::GaussIIR( img, { 3.0, 2.0 } );
+   dip::Image r2 = dip::GaussIIR( dip::Convert( img, dip::DT_SFLOAT ), { 3.0, 2.0 } );
+   DOCTEST_REQUIRE( r2.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( dip::testing::CompareImages( r1, r2, 1e-5 ));
+   // Filtering in place, and integer input
+   r2 = img.Copy();
+   dip::GaussIIR( r2, r2, { 3.0, 2.0 } );
+   DOCTEST_CHECK( dip::testing::CompareImages( r1, r2, 1e-12 ));
+   dip::Image integer = dip::Convert( img * 10, dip::DT_SINT16 );
+   r1 = dip::GaussIIR( dip::Convert( integer, dip::DT_SFLOAT ), { 3.0, 2.0 } );
+   r2 = dip::GaussIIR( integer, { 3.0, 2.0 } );
+   DOCTEST_REQUIRE( r2.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( dip::testing::CompareImages( r1, r2, 1e-12 ));
+   // Tensor images filter each tensor element independently
+   dip::Image img2 = img * 2;
+   dip::Image img3 = -img;
+   dip::Image color = dip::JoinChannels( { img, img2, img3 } );
+   r1 = dip::GaussIIR( color, { 3.0, 2.0 } );
+   DOCTEST_REQUIRE( r1.TensorElements() == 3 );
+   DOCTEST_CHECK( dip::testing::CompareImages( r1[ 1 ], dip::GaussIIR( color[ 1 ], { 3.0, 2.0 } ), 1e-12 ));
+}
+
 #endif // DIP__ENABLE_DOCTEST
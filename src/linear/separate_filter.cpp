@@ -86,8 +86,11 @@ OneDimensionalFilterArray SeparateFilter( Image const& c_in ) {
    OneDimensionalFilterArray out( ndims );
    // Complex data is handled a little differently from real data
    bool isComplex = c_in.DataType().IsComplex();
-   // Copy the input image, we will need it as a scratch pad
-   Image filter = Convert( c_in, isComplex ? DT_DCOMPLEX : DT_DFLOAT ); // Filter is DFLOAT or DCOMPLEX and has normal strides
+   // Copy the input image, we will need it as a scratch pad. Note that `dip::Convert` would not copy the data
+   // if `c_in` already is of the right type, we'd be writing into the caller's image.
+   Image filter;
+   filter.ReForge( c_in.Sizes(), 1, isComplex ? DT_DCOMPLEX : DT_DFLOAT );
+   filter.Copy( c_in ); // Filter is DFLOAT or DCOMPLEX and has normal strides
    DIP_ASSERT( filter.HasNormalStrides() );
    UnsignedArray sizes = filter.Sizes();
    dip::uint nPixels = sizes.product();
@@ -23,6 +23,7 @@
 #include "diplib/statistics.h"
 #include "diplib/framework.h"
 #include "diplib/overload.h"
+#include "diplib/library/cpu_dispatch.h"
 
 namespace dip {
 
@@ -59,6 +60,17 @@ class ClipLineFilter: public Framework::ScanLineFilter {
          auto inStride = params.inBuffer[ 0 ].stride;
          TPI* out = static_cast< TPI* >( params.outBuffer[ 0 ].buffer );
          auto outStride = params.outBuffer[ 0 ].stride;
+         if(( inStride == 1 ) && ( outStride == 1 )) {
+            TPI low = low_;
+            TPI high = high_;
+            dip::uint const bufferLength = params.bufferLength;
+            detail::CpuDispatch( [ = ]() {
+               for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+                  out[ ii ] = clamp( in[ ii ], low, high );
+               }
+            } );
+            return;
+         }
          for( dip::uint ii = 0; ii < params.bufferLength; ++ii ) {
             *out = clamp( *in, low_, high_ );
             in += inStride;
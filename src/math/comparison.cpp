@@ -21,75 +21,19 @@
 #include "diplib.h"
 #include "diplib/framework.h"
 #include "diplib/overload.h"
+#include "dispatched_line_filter.h"
 
 namespace dip {
 
 namespace {
 
-// This are the same class as Framework::VariadicScanLineFilter, but with a binary output.
-template< dip::uint N, typename TPI, typename F >
-class VariadicScanLineFilterBinOut : public Framework::ScanLineFilter {
-   // Note that N is a compile-time constant, and consequently the compiler should be able to optimize all the loops
-   // over N.
-   public:
-      static_assert( N > 0, "VariadicScanLineFilterBinOut does not work without input images" );
-      VariadicScanLineFilterBinOut( F const& func ) : func_( func ) {}
-      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         DIP_ASSERT( params.inBuffer.size() == N );
-         DIP_ASSERT( params.outBuffer.size() == 1 );
-         std::array< TPI const*, N > in;
-         std::array< dip::sint, N > inStride;
-         std::array< dip::sint, N > inTensorStride;
-         dip::uint const bufferLength = params.bufferLength;
-         dip::uint const tensorLength = params.outBuffer[ 0 ].tensorLength; // all buffers have same number of tensor elements
-         for( dip::uint ii = 0; ii < N; ++ii ) {
-            in[ ii ] = static_cast< TPI const* >( params.inBuffer[ ii ].buffer );
-            inStride[ ii ] = params.inBuffer[ ii ].stride;
-            if( tensorLength > 1 ) {
-               inTensorStride[ ii ] = params.inBuffer[ ii ].tensorStride;
-            }
-            DIP_ASSERT( params.inBuffer[ ii ].tensorLength == tensorLength );
-         }
-         bin* out = static_cast< bin* >( params.outBuffer[ 0 ].buffer );
-         dip::sint const outStride = params.outBuffer[ 0 ].stride;
-         dip::sint const outTensorStride = params.outBuffer[ 0 ].tensorStride;
-         if( tensorLength > 1 ) {
-            for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
-               std::array< TPI const*, N > inT = in;
-               bin* outT = out;
-               for( dip::uint jj = 0; jj < tensorLength; ++jj ) {
-                  *outT = func_( inT );
-                  for( dip::uint ii = 0; ii < N; ++ii ) {
-                     inT[ ii ] += inTensorStride[ ii ];
-                  }
-                  outT += outTensorStride;
-               }
-               for( dip::uint ii = 0; ii < N; ++ii ) {
-                  in[ ii ] += inStride[ ii ];
-               }
-               out += outStride;
-            }
-         } else {
-            for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
-               *out = func_( in );
-               for( dip::uint ii = 0; ii < N; ++ii ) {
-                  in[ ii ] += inStride[ ii ];
-               }
-               out += outStride;
-            }
-         }
-      }
-   private:
-      F func_;
-};
-
 template< typename TPI, typename F >
 std::unique_ptr< Framework::ScanLineFilter > NewDyadicScanLineFilterBinOut( F const& func ) {
-   return static_cast< std::unique_ptr< Framework::ScanLineFilter >>( new VariadicScanLineFilterBinOut< 2, TPI, F >( func ));
+   return static_cast< std::unique_ptr< Framework::ScanLineFilter >>( new detail::DispatchedScanLineFilter< 2, TPI, bin, F >( func ));
 }
 template< typename TPI, typename F >
 std::unique_ptr< Framework::ScanLineFilter > NewTriadicScanLineFilterBinOut( F const& func ) {
-   return static_cast< std::unique_ptr< Framework::ScanLineFilter >>( new VariadicScanLineFilterBinOut< 3, TPI, F >( func ));
+   return static_cast< std::unique_ptr< Framework::ScanLineFilter >>( new detail::DispatchedScanLineFilter< 3, TPI, bin, F >( func ));
 }
 
 } // namespace
@@ -0,0 +1,146 @@
+/*
+ * DIPlib 3.0
+ * This file defines a scan line filter that compiles its inner loop for multiple instruction sets.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_DISPATCHED_LINE_FILTER_H
+#define DIP_DISPATCHED_LINE_FILTER_H
+
+#include <array>
+
+#include "diplib.h"
+#include "diplib/framework.h"
+#include "diplib/library/cpu_dispatch.h"
+
+namespace dip {
+
+namespace detail {
+
+// The loop over contiguous buffers, as simple as possible so that the compiler can vectorize it.
+template< dip::uint N, typename TPI, typename TPO, typename F >
+inline void ContiguousScanLoop( std::array< TPI const*, N > in, TPO* out, dip::uint length, F const& func ) {
+   for( dip::uint kk = 0; kk < length; ++kk ) {
+      out[ kk ] = func( in );
+      for( dip::uint ii = 0; ii < N; ++ii ) {
+         ++in[ ii ];
+      }
+   }
+}
+
+// This is the same as `dip::Framework::VariadicScanLineFilter`, but the output sample type `TPO` can differ
+// from the input sample type `TPI`, and the loop over contiguous, scalar buffers is compiled for multiple
+// instruction sets through `dip::detail::CpuDispatch`. Input buffers with a stride of 0 (a singleton-expanded
+// image, typically a constant operand) are first copied into a contiguous buffer.
+template< dip::uint N, typename TPI, typename TPO, typename F >
+class DispatchedScanLineFilter : public Framework::ScanLineFilter {
+   public:
+      static_assert( N > 0, "DispatchedScanLineFilter does not work without input images" );
+      DispatchedScanLineFilter( F const& func, dip::uint cost = 1 ) : func_( func ), cost_( cost ) {}
+      virtual void SetNumberOfThreads( dip::uint threads ) override {
+         buffers_.resize( threads );
+      }
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint nTensorElements ) override {
+         return cost_ * nTensorElements;
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         DIP_ASSERT( params.inBuffer.size() == N );
+         DIP_ASSERT( params.outBuffer.size() == 1 );
+         std::array< TPI const*, N > in;
+         std::array< dip::sint, N > inStride;
+         std::array< dip::sint, N > inTensorStride;
+         dip::uint const bufferLength = params.bufferLength;
+         dip::uint const tensorLength = params.outBuffer[ 0 ].tensorLength; // all buffers have same number of tensor elements
+         bool contiguous = tensorLength == 1;
+         dip::uint nExpanded = 0;
+         for( dip::uint ii = 0; ii < N; ++ii ) {
+            in[ ii ] = static_cast< TPI const* >( params.inBuffer[ ii ].buffer );
+            inStride[ ii ] = params.inBuffer[ ii ].stride;
+            if( tensorLength > 1 ) {
+               inTensorStride[ ii ] = params.inBuffer[ ii ].tensorStride;
+            }
+            DIP_ASSERT( params.inBuffer[ ii ].tensorLength == tensorLength );
+            if( inStride[ ii ] == 0 ) {
+               ++nExpanded;
+            } else if( inStride[ ii ] != 1 ) {
+               contiguous = false;
+            }
+         }
+         TPO* out = static_cast< TPO* >( params.outBuffer[ 0 ].buffer );
+         dip::sint const outStride = params.outBuffer[ 0 ].stride;
+         dip::sint const outTensorStride = params.outBuffer[ 0 ].tensorStride;
+         if( contiguous && ( outStride == 1 )) {
+            if( nExpanded > 0 ) {
+               std::vector< TPI >& buffer = buffers_[ params.thread ];
+               buffer.resize( nExpanded * bufferLength );
+               TPI* ptr = buffer.data();
+               for( dip::uint ii = 0; ii < N; ++ii ) {
+                  if( inStride[ ii ] == 0 ) {
+                     std::fill( ptr, ptr + bufferLength, *in[ ii ] );
+                     in[ ii ] = ptr;
+                     ptr += bufferLength;
+                  }
+               }
+            }
+            F const& func = func_;
+            CpuDispatch( [ & ]() { ContiguousScanLoop( in, out, bufferLength, func ); } );
+         } else if( tensorLength > 1 ) {
+            for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
+               std::array< TPI const*, N > inT = in;
+               TPO* outT = out;
+               for( dip::uint jj = 0; jj < tensorLength; ++jj ) {
+                  *outT = func_( inT );
+                  for( dip::uint ii = 0; ii < N; ++ii ) {
+                     inT[ ii ] += inTensorStride[ ii ];
+                  }
+                  outT += outTensorStride;
+               }
+               for( dip::uint ii = 0; ii < N; ++ii ) {
+                  in[ ii ] += inStride[ ii ];
+               }
+               out += outStride;
+            }
+         } else {
+            for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
+               *out = func_( in );
+               for( dip::uint ii = 0; ii < N; ++ii ) {
+                  in[ ii ] += inStride[ ii ];
+               }
+               out += outStride;
+            }
+         }
+      }
+   private:
+      F func_;
+      dip::uint cost_ = 1;
+      std::vector< std::vector< TPI >> buffers_; // one for each thread
+};
+
+template< typename TPI, typename F >
+inline std::unique_ptr< Framework::ScanLineFilter > NewDispatchedMonadicScanLineFilter( F const& func, dip::uint cost = 1 ) {
+   return static_cast< std::unique_ptr< Framework::ScanLineFilter >>( new DispatchedScanLineFilter< 1, TPI, TPI, F >( func, cost ));
+}
+
+template< typename TPI, typename F >
+inline std::unique_ptr< Framework::ScanLineFilter > NewDispatchedDyadicScanLineFilter( F const& func, dip::uint cost = 1 ) {
+   return static_cast< std::unique_ptr< Framework::ScanLineFilter >>( new DispatchedScanLineFilter< 2, TPI, TPI, F >( func, cost ));
+}
+
+} // namespace detail
+
+} // namespace dip
+
+#endif // DIP_DISPATCHED_LINE_FILTER_H
@@ -22,6 +22,7 @@
 #include "diplib/math.h"
 #include "diplib/framework.h"
 #include "diplib/overload.h"
+#include "diplib/library/cpu_dispatch.h"
 
 namespace dip {
 
@@ -49,6 +50,20 @@ void Hypot( Image const& a, Image const& b, Image& out ) {
 
 namespace {
 
+template< typename TPI >
+inline void AccumulateFirst( TPI const* in, TPI* out, dip::uint length ) {
+   for( dip::uint kk = 0; kk < length; ++kk ) {
+      out[ kk ] = in[ kk ];
+   }
+}
+
+template< typename TPI, typename F >
+inline void Accumulate( TPI const* in, TPI* out, dip::uint length, F const& func ) {
+   for( dip::uint kk = 0; kk < length; ++kk ) {
+      out[ kk ] = func( out[ kk ], in[ kk ] );
+   }
+}
+
 template< typename TPI, typename F >
 class MultiScanLineFilter : public Framework::ScanLineFilter {
    public:
@@ -63,6 +78,24 @@ class MultiScanLineFilter : public Framework::ScanLineFilter {
          }
          TPI* out = static_cast< TPI* >( params.outBuffer[ 0 ].buffer );
          dip::sint const outStride = params.outBuffer[ 0 ].stride;
+         bool contiguous = outStride == 1;
+         for( dip::uint ii = 0; ii < N; ++ii ) {
+            contiguous &= params.inBuffer[ ii ].stride == 1;
+            // The output buffer is written before all inputs are read, so it cannot be one of the inputs
+            contiguous &= ( ii == 0 ) || ( in[ ii ] != out );
+         }
+         if( contiguous ) {
+            // Process one input at the time, accumulating into the output buffer. This is the same sequence
+            // of operations as below, but the inner loop can be vectorized.
+            F const& func = func_;
+            detail::CpuDispatch( [ & ]() {
+               AccumulateFirst( in[ 0 ], out, bufferLength );
+               for( dip::uint ii = 1; ii < N; ++ii ) {
+                  Accumulate( in[ ii ], out, bufferLength, func );
+               }
+            } );
+            return;
+         }
          for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
             TPI res = *in[ 0 ];
             in[ 0 ] += params.inBuffer[ 0 ].stride;
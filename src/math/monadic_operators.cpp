@@ -24,6 +24,7 @@
 #include "diplib/math.h"
 #include "diplib/framework.h"
 #include "diplib/overload.h"
+#include "dispatched_line_filter.h"
 
 namespace dip {
 
@@ -83,7 +84,7 @@ inline std::unique_ptr< Framework::ScanLineFilter > NewBinScanLineFilter( F cons
       DIP_THROW_IF( !in.DataType().IsA( inputDomain_ ), E::DATA_TYPE_NOT_SUPPORTED ); \
       DataType dtype = DataType::SuggestFlex( in.DataType() ); \
       std::unique_ptr <Framework::ScanLineFilter> scanLineFilter; \
-      DIP_OVL_CALL_ASSIGN_FLEX( scanLineFilter, Framework::NewMonadicScanLineFilter, ( functionLambda_, cost_ ), dtype ); \
+      DIP_OVL_CALL_ASSIGN_FLEX( scanLineFilter, detail::NewDispatchedMonadicScanLineFilter, ( functionLambda_, cost_ ), dtype ); \
       DIP_STACK_TRACE_THIS( Framework::ScanMonadic( in, out, dtype, dtype, in.TensorElements(), *scanLineFilter, \
             Framework::ScanOption::NoSingletonExpansion + Framework::ScanOption::TensorAsSpatialDim )); \
    }
@@ -93,7 +94,7 @@ inline std::unique_ptr< Framework::ScanLineFilter > NewBinScanLineFilter( F cons
       DIP_THROW_IF( !in.DataType().IsA( inputDomain_ ), E::DATA_TYPE_NOT_SUPPORTED ); \
       DataType dtype = DataType::SuggestFloat( in.DataType() ); \
       std::unique_ptr <Framework::ScanLineFilter> scanLineFilter; \
-      DIP_OVL_CALL_ASSIGN_FLOAT( scanLineFilter, Framework::NewMonadicScanLineFilter, ( functionLambda_, cost_ ), dtype ); \
+      DIP_OVL_CALL_ASSIGN_FLOAT( scanLineFilter, detail::NewDispatchedMonadicScanLineFilter, ( functionLambda_, cost_ ), dtype ); \
       DIP_STACK_TRACE_THIS( Framework::ScanMonadic( in, out, dtype, dtype, in.TensorElements(), *scanLineFilter, \
             Framework::ScanOption::NoSingletonExpansion + Framework::ScanOption::TensorAsSpatialDim )); \
    }
@@ -103,7 +104,7 @@ inline std::unique_ptr< Framework::ScanLineFilter > NewBinScanLineFilter( F cons
       DIP_THROW_IF( !in.DataType().IsA( inputDomain_ ), E::DATA_TYPE_NOT_SUPPORTED ); \
       DataType dtype = DataType::SuggestFloat( in.DataType() ); \
       std::unique_ptr <Framework::ScanLineFilter> scanLineFilter; \
-      DIP_OVL_CALL_ASSIGN_FLOAT( scanLineFilter, Framework::NewMonadicScanLineFilter, ( functionLambda_, cost_ ), dtype ); \
+      DIP_OVL_CALL_ASSIGN_FLOAT( scanLineFilter, detail::NewDispatchedMonadicScanLineFilter, ( functionLambda_, cost_ ), dtype ); \
       DIP_STACK_TRACE_THIS( Framework::ScanMonadic( in, out, dtype, dtype, in.TensorElements(), *scanLineFilter, \
             Framework::ScanOption::NoSingletonExpansion + Framework::ScanOption::TensorAsSpatialDim )); \
    }
@@ -151,6 +152,14 @@ class AbsLineFilter : public Framework::ScanLineFilter {
          dip::uint const bufferLength = params.bufferLength;
          AbsType< TPI >* out = static_cast< AbsType< TPI >* >( params.outBuffer[ 0 ].buffer );
          dip::sint const outStride = params.outBuffer[ 0 ].stride;
+         if(( inStride == 1 ) && ( outStride == 1 )) {
+            detail::CpuDispatch( [ = ]() {
+               for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
+                  out[ kk ] = static_cast< AbsType< TPI >>( std::abs( in[ kk ] ));
+               }
+            } );
+            return;
+         }
          for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
             *out = static_cast< AbsType< TPI >>( std::abs( *in ));
             in += inStride;
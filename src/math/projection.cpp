@@ -18,11 +18,14 @@
  * limitations under the License.
  */
 
+#include <cstring>
+
 #include "diplib.h"
 #include "diplib/statistics.h"
 #include "diplib/framework.h"
 #include "diplib/overload.h"
 #include "diplib/iterators.h"
+#include "diplib/multithreading.h"
 #include "diplib/library/copy_buffer.h"
 
 namespace dip {
@@ -36,10 +39,122 @@ class ProjectionScanFunction {
       virtual void Project( Image const& in, Image const& mask, void* out, dip::uint thread ) = 0;
       // The derived class can define this function if it needs this information ahead of time.
       virtual void SetNumberOfThreads( dip::uint /*threads*/ ) {}
+      // The derived class can define this function to give the cost of processing one input sample, in
+      // operations. It is used to determine how many threads to use.
+      virtual dip::uint OperationsPerSample() const { return 2; }
+      // The derived class can define the following three functions if its result can be computed by combining
+      // results over parts of the sub-image. This allows `ProjectionScan` to use multiple threads to compute
+      // a single output sample. `ProjectPartial` will be called once for each of the parts given to
+      // `SetNumberOfThreads` (possibly concurrently), each with a different part of the sub-image.
+      // `MergePartialResults` is then called once to combine these partial results in order and write the
+      // output sample to `out`, as `Project` does.
+      virtual bool SupportsPartialResults() const { return false; }
+      virtual void ProjectPartial( Image const& /*in*/, Image const& /*mask*/, dip::uint /*thread*/ ) {}
+      virtual void MergePartialResults( void* /*out*/ ) {}
       // A virtual destructor guarantees that we can destroy a derived class by a pointer to base
       virtual ~ProjectionScanFunction() {}
 };
 
+// A base class for projection functions that can be computed by combining partial results. The derived class
+// defines the type `Partial` of the partial result, `Accumulate` computes it for a sub-image, `Combine` adds a
+// partial result to another one, and `Finalize` writes the output sample.
+template< typename Partial >
+class MergeableProjectionScanFunction : public ProjectionScanFunction {
+   public:
+      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+         Finalize( Accumulate( in, mask ), out );
+      }
+      virtual void SetNumberOfThreads( dip::uint threads ) override {
+         partial_.resize( threads );
+      }
+      virtual bool SupportsPartialResults() const override { return true; }
+      virtual void ProjectPartial( Image const& in, Image const& mask, dip::uint thread ) override {
+         partial_[ thread ] = Accumulate( in, mask );
+      }
+      virtual void MergePartialResults( void* out ) override {
+         for( dip::uint ii = 1; ii < partial_.size(); ++ii ) {
+            Combine( partial_[ 0 ], partial_[ ii ] );
+         }
+         Finalize( partial_[ 0 ], out );
+      }
+   protected:
+      virtual Partial Accumulate( Image const& in, Image const& mask ) = 0;
+      virtual void Combine( Partial& result, Partial const& other ) = 0;
+      virtual void Finalize( Partial const& result, void* out ) = 0;
+   private:
+      std::vector< Partial > partial_;
+};
+
+// Calls `function.Project` for a single output sample, using `outBuffer` if it's forged to convert the result
+// to the data type of `out`.
+inline void ProjectSingleSample(
+      ProjectionScanFunction& function,
+      Image const& in,
+      Image const& mask,
+      Image const& out,
+      Image const& outBuffer,
+      dip::uint thread
+) {
+   if( outBuffer.IsForged() ) {
+      function.Project( in, mask, outBuffer.Origin(), thread );
+      // Copy data from output buffer to output image
+      detail::CopyBuffer( outBuffer.Origin(), outBuffer.DataType(), 1, 1,
+                          out.Origin(), out.DataType(), 1, 1, 1, 1 );
+   } else {
+      function.Project( in, mask, out.Origin(), thread );
+   }
+}
+
+// Number of parts a sub-image is split into to compute a single output sample from partial results. This
+// does not depend on the number of threads, so that the result doesn't either.
+constexpr dip::uint projectionParts = 16;
+
+// Computes a single output sample by projecting `projectionParts` slabs of `in`, in parallel if `parallel`,
+// and merging the partial results in order. `function` must support partial results.
+void ProjectSingleSampleInParts(
+      ProjectionScanFunction& function,
+      Image const& in,
+      Image const& mask,
+      Image const& out,
+      Image const& outBuffer,
+      bool parallel
+) {
+   // Split along the largest dimension
+   dip::uint dim = 0;
+   for( dip::uint ii = 1; ii < in.Dimensionality(); ++ii ) {
+      if( in.Size( ii ) > in.Size( dim )) {
+         dim = ii;
+      }
+   }
+   dip::uint size = in.Size( dim );
+   dip::uint nParts = std::min( projectionParts, size );
+   function.SetNumberOfThreads( nParts );
+   auto projectPart = [ & ]( dip::uint part ) {
+      RangeArray ranges( in.Dimensionality() );
+      ranges[ dim ] = Range{ static_cast< dip::sint >( part * size / nParts ),
+                             static_cast< dip::sint >(( part + 1 ) * size / nParts ) - 1 };
+      Image partIn = in.At( ranges );
+      Image partMask;
+      if( mask.IsForged() ) {
+         partMask = mask.At( ranges );
+      }
+      function.ProjectPartial( partIn, partMask, part );
+   };
+   if( parallel ) {
+      ParallelFor( nParts, projectPart );
+   } else {
+      for( dip::uint part = 0; part < nParts; ++part ) {
+         projectPart( part );
+      }
+   }
+   void* dest = outBuffer.IsForged() ? outBuffer.Origin() : out.Origin();
+   function.MergePartialResults( dest );
+   if( outBuffer.IsForged() ) {
+      detail::CopyBuffer( outBuffer.Origin(), outBuffer.DataType(), 1, 1,
+                          out.Origin(), out.DataType(), 1, 1, 1, 1 );
+   }
+}
+
 void ProjectionScan(
       Image const& c_in,
       Image const& c_mask,
@@ -128,17 +243,31 @@ void ProjectionScan(
       nDims = outSizes.size();
    }
 
+   // Create a temporary output buffer, to collect a single sample in the data type requested by the calling function
+   Image outBuffer;
+   if( output.DataType() != outImageType ) {
+      // We need a temporary space for the output sample also, because `function.Project` expects `outImageType`.
+      outBuffer.SetDataType( outImageType );
+      outBuffer.Forge(); // By default it's a single sample.
+   }
+
+   // Determine the number of threads we'll be using, from the cost of processing all input samples. Whether a
+   // sub-image is split into parts depends only on its size, so that the result doesn't depend on the number
+   // of threads.
+   dip::uint operationsPerSample = function.OperationsPerSample() + ( hasMask ? 1 : 0 );
+   dip::uint nThreads = GetThreadingCostModel().NumberOfThreads( input.NumberOfPixels() * operationsPerSample,
+                                                                 GetNumberOfThreads() );
+   bool splitSubImages = function.SupportsPartialResults()
+                         && ( procSizes.product() * operationsPerSample >= threadingThreshold );
+
    // Do we need to loop at all?
    if( process.all() ) {
       //std::cout << "Projection framework: no need to loop!\n";
-      function.SetNumberOfThreads( 1 );
-      if( output.DataType() != outImageType ) {
-         Image outBuffer( {}, 1, outImageType );
-         function.Project( input, mask, outBuffer.Origin(), 0 );
-         detail::CopyBuffer( outBuffer.Origin(), outBuffer.DataType(), 1, 1,
-                             output.Origin(), output.DataType(), 1, 1, 1, 1 );
+      if( splitSubImages ) {
+         DIP_STACK_TRACE_THIS( ProjectSingleSampleInParts( function, input, mask, output, outBuffer, nThreads > 1 ));
       } else {
-         function.Project( input, mask, output.Origin(), 0 );
+         function.SetNumberOfThreads( 1 );
+         ProjectSingleSample( function, input, mask, output, outBuffer, 0 );
       }
       return;
    }
@@ -146,12 +275,6 @@ void ProjectionScan(
    // Can we treat the images as if they were 1D?
    // TODO: This is an opportunity for improving performance if the non-processing dimensions in in, mask and out have the same layout and simple stride
 
-   // TODO: Determine the number of threads we'll be using. The size of the data has an influence. As is the number of sub-images that we can generate
-   function.SetNumberOfThreads( 1 );
-
-   // TODO: Start threads, each thread makes its own temp image.
-   dip::uint thread = 0;
-
    // Create view over input image, that spans the processing dimensions
    Image tempIn;
    tempIn.CopyProperties( input );
@@ -194,58 +317,93 @@ void ProjectionScan(
    nDims = jj;
    tempOut.SetSizes( outSizes );
    tempOut.dip__SetOrigin( output.Origin() );
-   // Create a temporary output buffer, to collect a single sample in the data type requested by the calling function
-   bool useOutputBuffer = false;
-   Image outBuffer;
-   if( output.DataType() != outImageType ) {
-      // We need a temporary space for the output sample also, because `function.Project` expects `outImageType`.
-      outBuffer.SetDataType( outImageType );
-      outBuffer.Forge(); // By default it's a single sample.
-      useOutputBuffer = true;
+   dip::uint nOutPixels = outSizes.product();
+
+   // If there are few output pixels, we use the threads to compute each output sample instead
+   if(( nOutPixels < projectionParts ) && splitSubImages ) {
+      UnsignedArray position( nDims, 0 );
+      for( dip::uint ii = 0; ii < nOutPixels; ++ii ) {
+         DIP_STACK_TRACE_THIS( ProjectSingleSampleInParts( function, tempIn, tempMask, tempOut, outBuffer, nThreads > 1 ));
+         // Next output pixel
+         for( dip::uint dd = 0; dd < nDims; dd++ ) {
+            ++position[ dd ];
+            tempIn.dip__ShiftOrigin( inStride[ dd ] );
+            if( hasMask ) {
+               tempMask.dip__ShiftOrigin( maskStride[ dd ] );
+            }
+            tempOut.dip__ShiftOrigin( outStride[ dd ] );
+            if( position[ dd ] != outSizes[ dd ] ) {
+               break;
+            }
+            tempIn.dip__ShiftOrigin( -inStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            if( hasMask ) {
+               tempMask.dip__ShiftOrigin( -maskStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            }
+            tempOut.dip__ShiftOrigin( -outStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            position[ dd ] = 0;
+         }
+      }
+      return;
    }
 
-   // Iterate over the pixels in the output image. For each, we create a view in the input image.
-   UnsignedArray position( nDims, 0 );
-   for( ;; ) {
-
-      // Do the thing
-      if( useOutputBuffer ) {
-         function.Project( tempIn, tempMask, outBuffer.Origin(), thread );
-         // Copy data from output buffer to output image
-         detail::CopyBuffer( outBuffer.Origin(), outBuffer.DataType(), 1, 1,
-                             tempOut.Origin(), tempOut.DataType(), 1, 1, 1, 1 );
-      } else {
-         function.Project( tempIn, tempMask, tempOut.Origin(), thread );
+   // Otherwise, each thread computes a contiguous range of output pixels
+   nThreads = std::min( nThreads, nOutPixels );
+   function.SetNumberOfThreads( nThreads );
+
+   ParallelFor( nThreads, [ & ]( dip::uint thread ) {
+      // Each thread makes its own temp images
+      Image threadIn = tempIn;
+      Image threadMask = tempMask;
+      Image threadOut = tempOut;
+      Image threadOutBuffer;
+      if( outBuffer.IsForged() ) {
+         threadOutBuffer.ReForge( outBuffer );
       }
 
-      // Next output pixel
-      dip::uint dd;
-      for( dd = 0; dd < nDims; dd++ ) {
-         ++position[ dd ];
-         tempIn.dip__ShiftOrigin( inStride[ dd ]);
-         if( hasMask ) {
-            tempMask.dip__ShiftOrigin( maskStride[ dd ]);
-         }
-         tempOut.dip__ShiftOrigin( outStride[ dd ]);
-         // Check whether we reached the last pixel of the line
-         if( position[ dd ] != outSizes[ dd ] ) {
-            break;
-         }
-         // Rewind along this dimension
-         tempIn.dip__ShiftOrigin( -inStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+      // Find the first output pixel for this thread
+      dip::uint first = thread * nOutPixels / nThreads;
+      dip::uint last = ( thread + 1 ) * nOutPixels / nThreads;
+      UnsignedArray position( nDims, 0 );
+      dip::uint index = first;
+      for( dip::uint dd = 0; dd < nDims; ++dd ) {
+         position[ dd ] = index % outSizes[ dd ];
+         index /= outSizes[ dd ];
+         threadIn.dip__ShiftOrigin( inStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
          if( hasMask ) {
-            tempMask.dip__ShiftOrigin( -maskStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            threadMask.dip__ShiftOrigin( maskStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
          }
-         tempOut.dip__ShiftOrigin( -outStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
-         position[ dd ] = 0;
-         // Continue loop to increment along next dimension
+         threadOut.dip__ShiftOrigin( outStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
       }
-      if( dd == nDims ) {
-         break;            // We're done!
-      }
-   }
 
-   // TODO: End threads.
+      // Iterate over the pixels in the output image. For each, we create a view in the input image.
+      for( dip::uint ii = first; ii < last; ++ii ) {
+
+         // Do the thing
+         ProjectSingleSample( function, threadIn, threadMask, threadOut, threadOutBuffer, thread );
+
+         // Next output pixel
+         for( dip::uint dd = 0; dd < nDims; dd++ ) {
+            ++position[ dd ];
+            threadIn.dip__ShiftOrigin( inStride[ dd ] );
+            if( hasMask ) {
+               threadMask.dip__ShiftOrigin( maskStride[ dd ] );
+            }
+            threadOut.dip__ShiftOrigin( outStride[ dd ] );
+            // Check whether we reached the last pixel of the line
+            if( position[ dd ] != outSizes[ dd ] ) {
+               break;
+            }
+            // Rewind along this dimension
+            threadIn.dip__ShiftOrigin( -inStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            if( hasMask ) {
+               threadMask.dip__ShiftOrigin( -maskStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            }
+            threadOut.dip__ShiftOrigin( -outStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            position[ dd ] = 0;
+            // Continue loop to increment along next dimension
+         }
+      }
+   } );
 }
 
 } // namespace
@@ -253,11 +411,18 @@ void ProjectionScan(
 
 namespace {
 
+// The partial result for the projections that compute a sum or a mean
+template< typename T >
+struct SumAndCount {
+   T sum = 0;
+   dip::uint n = 0;
+};
+
 template< typename TPI, bool ComputeMean_ >
-class ProjectionSumMean : public ProjectionScanFunction {
+class ProjectionSumMean : public MergeableProjectionScanFunction< SumAndCount< FlexType< TPI >>> {
       using TPO = FlexType< TPI >;
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+   protected:
+      virtual SumAndCount< TPO > Accumulate( Image const& in, Image const& mask ) override {
          dip::uint n = 0;
          TPO sum = 0;
          if( mask.IsForged() ) {
@@ -281,11 +446,18 @@ class ProjectionSumMean : public ProjectionScanFunction {
                n = in.NumberOfPixels();
             }
          }
+         return { sum, n };
+      }
+      virtual void Combine( SumAndCount< TPO >& result, SumAndCount< TPO > const& other ) override {
+         result.sum += other.sum;
+         result.n += other.n;
+      }
+      virtual void Finalize( SumAndCount< TPO > const& result, void* out ) override {
          if( ComputeMean_ ) {
-            *static_cast< TPO* >( out ) = ( n > 0 ) ? ( sum / static_cast< FloatType< TPI >>( n ))
-                                                    : ( sum );
+            *static_cast< TPO* >( out ) = ( result.n > 0 ) ? ( result.sum / static_cast< FloatType< TPI >>( result.n ))
+                                                           : ( result.sum );
          } else {
-            *static_cast< TPO* >( out ) = sum;
+            *static_cast< TPO* >( out ) = result.sum;
          }
       }
 };
@@ -297,9 +469,10 @@ template< typename TPI >
 using ProjectionMean = ProjectionSumMean< TPI, true >;
 
 template< typename TPI >
-class ProjectionMeanDirectional : public ProjectionScanFunction {
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+class ProjectionMeanDirectional : public MergeableProjectionScanFunction< DirectionalStatisticsAccumulator > {
+   protected:
+      virtual dip::uint OperationsPerSample() const override { return 40; } // `sin` and `cos`
+      virtual DirectionalStatisticsAccumulator Accumulate( Image const& in, Image const& mask ) override {
          DirectionalStatisticsAccumulator acc;
          if( mask.IsForged() ) {
             JointImageIterator< TPI, bin > it( { in, mask } );
@@ -316,7 +489,13 @@ class ProjectionMeanDirectional : public ProjectionScanFunction {
                acc.Push( static_cast< dfloat >( *it ));
             } while( ++it );
          }
-         *static_cast< FloatType< TPI >* >( out ) = static_cast< FloatType< TPI >>( acc.Mean() ); // Is the same as FlexType< TPI > because TPI is not complex here.
+         return acc;
+      }
+      virtual void Combine( DirectionalStatisticsAccumulator& result, DirectionalStatisticsAccumulator const& other ) override {
+         result += other;
+      }
+      virtual void Finalize( DirectionalStatisticsAccumulator const& result, void* out ) override {
+         *static_cast< FloatType< TPI >* >( out ) = static_cast< FloatType< TPI >>( result.Mean() ); // Is the same as FlexType< TPI > because TPI is not complex here.
       }
 };
 
@@ -354,9 +533,9 @@ void Sum(
 namespace {
 
 template< typename TPI >
-class ProjectionProduct : public ProjectionScanFunction {
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+class ProjectionProduct : public MergeableProjectionScanFunction< FlexType< TPI >> {
+   protected:
+      virtual FlexType< TPI > Accumulate( Image const& in, Image const& mask ) override {
          FlexType< TPI > product = 1.0;
          if( mask.IsForged() ) {
             JointImageIterator< TPI, bin > it( { in, mask } );
@@ -373,7 +552,13 @@ class ProjectionProduct : public ProjectionScanFunction {
                product *= static_cast< FlexType< TPI >>( *it );
             } while( ++it );
          }
-         *static_cast< FlexType< TPI >* >( out ) = product;
+         return product;
+      }
+      virtual void Combine( FlexType< TPI >& result, FlexType< TPI > const& other ) override {
+         result *= other;
+      }
+      virtual void Finalize( FlexType< TPI > const& result, void* out ) override {
+         *static_cast< FlexType< TPI >* >( out ) = result;
       }
 };
 
@@ -393,10 +578,10 @@ void Product(
 namespace {
 
 template< typename TPI, bool ComputeMean_ >
-class ProjectionSumMeanAbs : public ProjectionScanFunction {
+class ProjectionSumMeanAbs : public MergeableProjectionScanFunction< SumAndCount< FloatType< TPI >>> {
       using TPO = FlexType< TPI >;
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+   protected:
+      virtual SumAndCount< FloatType< TPI >> Accumulate( Image const& in, Image const& mask ) override {
          dip::uint n = 0;
          FloatType< TPI > sum = 0;
          if( mask.IsForged() ) {
@@ -420,11 +605,18 @@ class ProjectionSumMeanAbs : public ProjectionScanFunction {
                n = in.NumberOfPixels();
             }
          }
+         return { sum, n };
+      }
+      virtual void Combine( SumAndCount< FloatType< TPI > >& result, SumAndCount< FloatType< TPI > > const& other ) override {
+         result.sum += other.sum;
+         result.n += other.n;
+      }
+      virtual void Finalize( SumAndCount< FloatType< TPI > > const& result, void* out ) override {
          if( ComputeMean_ ) {
-            *static_cast< TPO* >( out ) = ( n > 0 ) ? ( sum / static_cast< FloatType< TPI >>( n ))
-                                                    : ( sum );
+            *static_cast< TPO* >( out ) = ( result.n > 0 ) ? ( result.sum / static_cast< FloatType< TPI >>( result.n ))
+                                                           : ( result.sum );
          } else {
-            *static_cast< TPO* >( out ) = sum;
+            *static_cast< TPO* >( out ) = result.sum;
          }
       }
 };
@@ -470,10 +662,10 @@ void SumAbs(
 namespace {
 
 template< typename TPI, bool ComputeMean_ >
-class ProjectionSumMeanSquare : public ProjectionScanFunction {
+class ProjectionSumMeanSquare : public MergeableProjectionScanFunction< SumAndCount< FlexType< TPI >>> {
       using TPO = FlexType< TPI >;
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+   protected:
+      virtual SumAndCount< TPO > Accumulate( Image const& in, Image const& mask ) override {
          dip::uint n = 0;
          TPO sum = 0;
          if( mask.IsForged() ) {
@@ -499,11 +691,18 @@ class ProjectionSumMeanSquare : public ProjectionScanFunction {
                n = in.NumberOfPixels();
             }
          }
+         return { sum, n };
+      }
+      virtual void Combine( SumAndCount< TPO >& result, SumAndCount< TPO > const& other ) override {
+         result.sum += other.sum;
+         result.n += other.n;
+      }
+      virtual void Finalize( SumAndCount< TPO > const& result, void* out ) override {
          if( ComputeMean_ ) {
-            *static_cast< TPO* >( out ) = ( n > 0 ) ? ( sum / static_cast< FloatType< TPI >>( n ))
-                                                    : ( sum );
+            *static_cast< TPO* >( out ) = ( result.n > 0 ) ? ( result.sum / static_cast< FloatType< TPI >>( result.n ))
+                                                           : ( result.sum );
          } else {
-            *static_cast< TPO* >( out ) = sum;
+            *static_cast< TPO* >( out ) = result.sum;
          }
       }
 };
@@ -549,11 +748,11 @@ void SumSquare(
 namespace {
 
 template< typename TPI, bool ComputeMean_ >
-class ProjectionSumMeanSquareModulus : public ProjectionScanFunction {
+class ProjectionSumMeanSquareModulus : public MergeableProjectionScanFunction< SumAndCount< FloatType< TPI >>> {
       // TPI is a complex type.
       using TPO = FloatType< TPI >;
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+   protected:
+      virtual SumAndCount< TPO > Accumulate( Image const& in, Image const& mask ) override {
          dip::uint n = 0;
          TPO sum = 0;
          if( mask.IsForged() ) {
@@ -581,11 +780,18 @@ class ProjectionSumMeanSquareModulus : public ProjectionScanFunction {
                n = in.NumberOfPixels();
             }
          }
+         return { sum, n };
+      }
+      virtual void Combine( SumAndCount< TPO >& result, SumAndCount< TPO > const& other ) override {
+         result.sum += other.sum;
+         result.n += other.n;
+      }
+      virtual void Finalize( SumAndCount< TPO > const& result, void* out ) override {
          if( ComputeMean_ ) {
-            *static_cast< TPO* >( out ) = ( n > 0 ) ? ( sum / static_cast< TPO >( n ))
-                                                    : ( sum );
+            *static_cast< TPO* >( out ) = ( result.n > 0 ) ? ( result.sum / static_cast< TPO >( result.n ))
+                                                           : ( result.sum );
          } else {
-            *static_cast< TPO* >( out ) = sum;
+            *static_cast< TPO* >( out ) = result.sum;
          }
       }
 };
@@ -631,10 +837,11 @@ void SumSquareModulus(
 namespace {
 
 template< typename TPI, typename ACC >
-class ProjectionVariance : public ProjectionScanFunction {
+class ProjectionVariance : public MergeableProjectionScanFunction< ACC > {
    public:
       ProjectionVariance( bool computeStD ) : computeStD_( computeStD ) {}
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+   protected:
+      virtual ACC Accumulate( Image const& in, Image const& mask ) override {
          ACC acc;
          if( mask.IsForged() ) {
             JointImageIterator< TPI, bin > it( { in, mask } );
@@ -651,8 +858,14 @@ class ProjectionVariance : public ProjectionScanFunction {
                acc.Push( static_cast< dfloat >( *it ));
             } while( ++it );
          }
+         return acc;
+      }
+      virtual void Combine( ACC& result, ACC const& other ) override {
+         result += other;
+      }
+      virtual void Finalize( ACC const& result, void* out ) override {
          *static_cast< FloatType< TPI >* >( out ) = clamp_cast< FloatType< TPI >>(
-               computeStD_ ? acc.StandardDeviation() : acc.Variance() );
+               computeStD_ ? result.StandardDeviation() : result.Variance() );
       }
    private:
       bool computeStD_ = true;
@@ -733,9 +946,9 @@ struct MinComputer {
 };
 
 template< typename TPI, typename Computer >
-class ProjectionMaxMin : public ProjectionScanFunction {
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+class ProjectionMaxMin : public MergeableProjectionScanFunction< TPI > {
+   protected:
+      virtual TPI Accumulate( Image const& in, Image const& mask ) override {
          TPI res = Computer::init_value;
          if( mask.IsForged() ) {
             JointImageIterator< TPI, bin > it( { in, mask } );
@@ -752,7 +965,13 @@ class ProjectionMaxMin : public ProjectionScanFunction {
                res = Computer::compare( res, *it );
             } while( ++it );
          }
-         *static_cast< TPI* >( out ) = res;
+         return res;
+      }
+      virtual void Combine( TPI& result, TPI const& other ) override {
+         result = Computer::compare( result, other );
+      }
+      virtual void Finalize( TPI const& result, void* out ) override {
+         *static_cast< TPI* >( out ) = result;
       }
 };
 
@@ -797,10 +1016,10 @@ void Minimum(
 namespace {
 
 template< typename TPI, typename Computer >
-class ProjectionMaxMinAbs : public ProjectionScanFunction {
+class ProjectionMaxMinAbs : public MergeableProjectionScanFunction< AbsType< TPI >> {
       using TPO = AbsType< TPI >;
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+   protected:
+      virtual TPO Accumulate( Image const& in, Image const& mask ) override {
          TPO res = Computer::init_value;
          if( mask.IsForged() ) {
             JointImageIterator< TPI, bin > it( { in, mask } );
@@ -817,7 +1036,13 @@ class ProjectionMaxMinAbs : public ProjectionScanFunction {
                res = Computer::compare( res, static_cast< TPO >( abs( *it )));
             } while( ++it );
          }
-         *static_cast< TPO* >( out ) = res;
+         return res;
+      }
+      virtual void Combine( TPO& result, TPO const& other ) override {
+         result = Computer::compare( result, other );
+      }
+      virtual void Finalize( TPO const& result, void* out ) override {
+         *static_cast< TPO* >( out ) = result;
       }
 };
 
@@ -865,22 +1090,265 @@ void MinimumAbs(
 
 namespace {
 
+// Order-preserving mapping of sample values to unsigned integer keys, used by `RadixSelect`.
+template< typename TPI > struct RadixKey;
+template<> struct RadixKey< bin > {
+   using Key = uint8;
+   static Key ToKey( bin v ) { return static_cast< Key >( static_cast< bool >( v )); }
+   static bin FromKey( Key k ) { return k != 0; }
+};
+template<> struct RadixKey< uint8 > {
+   using Key = uint8;
+   static Key ToKey( uint8 v ) { return v; }
+   static uint8 FromKey( Key k ) { return k; }
+};
+template<> struct RadixKey< uint16 > {
+   using Key = uint16;
+   static Key ToKey( uint16 v ) { return v; }
+   static uint16 FromKey( Key k ) { return k; }
+};
+template<> struct RadixKey< uint32 > {
+   using Key = uint32;
+   static Key ToKey( uint32 v ) { return v; }
+   static uint32 FromKey( Key k ) { return k; }
+};
+// Signed integers: flip the sign bit
+template< typename TPI, typename K >
+struct SignedRadixKey {
+   using Key = K;
+   static constexpr Key signBit = static_cast< Key >( Key( 1 ) << ( sizeof( Key ) * 8 - 1 ));
+   static Key ToKey( TPI v ) { return static_cast< Key >( static_cast< Key >( v ) ^ signBit ); }
+   static TPI FromKey( Key k ) { return static_cast< TPI >( static_cast< Key >( k ^ signBit )); }
+};
+template<> struct RadixKey< sint8 > : public SignedRadixKey< sint8, uint8 > {};
+template<> struct RadixKey< sint16 > : public SignedRadixKey< sint16, uint16 > {};
+template<> struct RadixKey< sint32 > : public SignedRadixKey< sint32, uint32 > {};
+// Floating-point values: flip all bits of negative values, and only the sign bit of positive values
+template< typename TPI, typename K >
+struct FloatRadixKey {
+   using Key = K;
+   static constexpr Key signBit = static_cast< Key >( Key( 1 ) << ( sizeof( Key ) * 8 - 1 ));
+   static Key ToKey( TPI v ) {
+      Key k;
+      std::memcpy( &k, &v, sizeof( Key ));
+      return ( k & signBit ) ? static_cast< Key >( ~k ) : static_cast< Key >( k | signBit );
+   }
+   static TPI FromKey( Key k ) {
+      k = ( k & signBit ) ? static_cast< Key >( k ^ signBit ) : static_cast< Key >( ~k );
+      TPI v;
+      std::memcpy( &v, &k, sizeof( Key ));
+      return v;
+   }
+};
+template<> struct RadixKey< sfloat > : public FloatRadixKey< sfloat, uint32 > {};
+template<> struct RadixKey< dfloat > : public FloatRadixKey< dfloat, std::uint64_t > {};
+
+// Calls `func( value )` for each sample in `in` selected by `mask`.
+template< typename TPI, typename F >
+void ForEachSample( Image const& in, Image const& mask, F const& func ) {
+   if( mask.IsForged() ) {
+      JointImageIterator< TPI, bin > it( { in, mask } );
+      it.OptimizeAndFlatten();
+      do {
+         if( it.template Sample< 1 >() ) {
+            func( it.template Sample< 0 >() );
+         }
+      } while( ++it );
+   } else {
+      ImageIterator< TPI > it( in );
+      it.OptimizeAndFlatten();
+      do {
+         func( *it );
+      } while( ++it );
+   }
+}
+
+// Finds the sample of a given rank without copying the image data, using a constant amount of memory.
+//
+// The exact selection is a radix select: the samples are mapped to order-preserving unsigned integer keys, and
+// each pass over the data computes a histogram of the next 16 bits of the keys, among those samples whose keys
+// start with the bits determined so far. The histogram tells us the next 16 bits of the key of the sample with
+// the requested rank. 8 and 16-bit images need a single pass, 32-bit images two, and double-precision images up
+// to four. As soon as the number of candidate samples is small enough, these are copied into a buffer and
+// selected with `std::nth_element`, so that typically no more than two passes are needed.
+//
+// The approximate selection computes the sample range in a first pass, and a histogram with 2^16 bins over that
+// range in a second pass. The result is the lower bound of the bin containing the sample with the requested
+// rank; the error is thus smaller than the bin width, (max-min)/2^16. For integer images with a range of up to
+// 2^16, the result is exact.
+//
+// The image is split into slabs that are processed in parallel, each thread computes its own histogram.
+template< typename TPI >
+class RadixSelect {
+      using Key = typename RadixKey< TPI >::Key;
+      static constexpr dip::uint keyBits = sizeof( Key ) * 8;
+      static constexpr dip::uint maxDigitBits = 16;
+      static constexpr dip::uint approximateBins = dip::uint( 1 ) << 16;
+      static constexpr dip::uint maxCandidates = dip::uint( 1 ) << 18; // candidates are collected in a buffer once there are this few
+   public:
+      RadixSelect( Image const& in, Image const& mask, dip::uint nThreads ) {
+         // Split along the largest dimension
+         dip::uint dim = 0;
+         for( dip::uint ii = 1; ii < in.Dimensionality(); ++ii ) {
+            if( in.Size( ii ) > in.Size( dim )) {
+               dim = ii;
+            }
+         }
+         dip::uint size = in.Size( dim );
+         nThreads = std::max< dip::uint >( 1, std::min( nThreads, size ));
+         parts_.resize( nThreads );
+         partMasks_.resize( nThreads );
+         for( dip::uint ii = 0; ii < nThreads; ++ii ) {
+            RangeArray ranges( in.Dimensionality() );
+            ranges[ dim ] = Range{ static_cast< dip::sint >( ii * size / nThreads ),
+                                   static_cast< dip::sint >(( ii + 1 ) * size / nThreads ) - 1 };
+            parts_[ ii ] = in.At( ranges );
+            if( mask.IsForged() ) {
+               partMasks_[ ii ] = mask.At( ranges );
+            }
+         }
+      }
+
+      // Returns the value of the sample with rank `rank` (0-based) among the selected samples
+      TPI Select( dip::uint rank ) const {
+         Key prefix = 0;
+         dip::uint prefixBits = 0;
+         while( prefixBits < keyBits ) {
+            dip::uint digitBits = std::min( maxDigitBits, keyBits - prefixBits );
+            dip::uint shift = keyBits - prefixBits - digitBits;
+            // Compute histogram of the next `digitBits` bits of the keys that match the prefix
+            std::vector< dip::uint > histogram = ComputeHistogram( dip::uint( 1 ) << digitBits,
+                  [ prefix, prefixBits, shift, digitBits ]( TPI value, dip::uint& bin ) {
+                     Key key = RadixKey< TPI >::ToKey( value );
+                     if(( prefixBits > 0 ) && (( key >> ( shift + digitBits )) != prefix )) {
+                        return false;
+                     }
+                     bin = static_cast< dip::uint >(( key >> shift ) & (( Key( 1 ) << digitBits ) - 1 ));
+                     return true;
+                  } );
+            dip::uint bin = FindBin( histogram, rank );
+            prefix = static_cast< Key >(( prefixBits > 0 ? ( prefix << digitBits ) : 0 ) | bin );
+            prefixBits += digitBits;
+            if(( prefixBits < keyBits ) && ( histogram[ bin ] <= maxCandidates )) {
+               // Few enough candidates left, collect them and select
+               return SelectFromCandidates( rank, histogram[ bin ], prefix, keyBits - prefixBits );
+            }
+         }
+         return RadixKey< TPI >::FromKey( prefix );
+      }
+
+      // Returns an approximation to the value of the sample with rank `rank` (0-based) among the selected samples
+      TPI SelectApproximate( dip::uint rank ) const {
+         dip::uint nThreads = parts_.size();
+         std::vector< TPI > minima( nThreads, std::numeric_limits< TPI >::max() );
+         std::vector< TPI > maxima( nThreads, std::numeric_limits< TPI >::lowest() );
+         ParallelFor( nThreads, [ & ]( dip::uint thread ) {
+            TPI& lo = minima[ thread ];
+            TPI& hi = maxima[ thread ];
+            ForEachSample< TPI >( parts_[ thread ], partMasks_[ thread ], [ & ]( TPI value ) {
+               lo = std::min( lo, value );
+               hi = std::max( hi, value );
+            } );
+         } );
+         dfloat lo = static_cast< dfloat >( *std::min_element( minima.begin(), minima.end() ));
+         dfloat hi = static_cast< dfloat >( *std::max_element( maxima.begin(), maxima.end() ));
+         if( !( hi > lo )) {
+            return static_cast< TPI >( lo );
+         }
+         dfloat scale = static_cast< dfloat >( approximateBins ) / ( hi - lo );
+         std::vector< dip::uint > histogram = ComputeHistogram( approximateBins, [ lo, scale ]( TPI value, dip::uint& bin ) {
+            bin = std::min( static_cast< dip::uint >(( static_cast< dfloat >( value ) - lo ) * scale ), approximateBins - 1 );
+            return true;
+         } );
+         dfloat value = lo + static_cast< dfloat >( FindBin( histogram, rank )) / scale;
+         if( std::numeric_limits< TPI >::is_integer ) {
+            value = std::ceil( value - 1e-9 ); // the lower bound of the bin, rounded up to the first integer in the bin
+         }
+         return clamp_cast< TPI >( value );
+      }
+
+   private:
+      std::vector< Image > parts_;
+      std::vector< Image > partMasks_;
+
+      // Computes a histogram with `nBins` bins in parallel. `binOf( value, bin )` returns false if `value` is
+      // not to be counted, and otherwise sets `bin`.
+      template< typename F >
+      std::vector< dip::uint > ComputeHistogram( dip::uint nBins, F const& binOf ) const {
+         dip::uint nThreads = parts_.size();
+         std::vector< std::vector< dip::uint >> histograms( nThreads );
+         ParallelFor( nThreads, [ & ]( dip::uint thread ) {
+            std::vector< dip::uint >& histogram = histograms[ thread ];
+            histogram.resize( nBins, 0 );
+            ForEachSample< TPI >( parts_[ thread ], partMasks_[ thread ], [ & ]( TPI value ) {
+               dip::uint bin;
+               if( binOf( value, bin )) {
+                  ++histogram[ bin ];
+               }
+            } );
+         } );
+         for( dip::uint ii = 1; ii < nThreads; ++ii ) {
+            std::transform( histograms[ 0 ].begin(), histograms[ 0 ].end(), histograms[ ii ].begin(),
+                            histograms[ 0 ].begin(), std::plus< dip::uint >() );
+         }
+         return std::move( histograms[ 0 ] );
+      }
+
+      // Finds the bin that contains the sample with rank `rank`, and updates `rank` to be relative to that bin
+      static dip::uint FindBin( std::vector< dip::uint > const& histogram, dip::uint& rank ) {
+         dip::uint bin = 0;
+         while(( bin < histogram.size() - 1 ) && ( rank >= histogram[ bin ] )) {
+            rank -= histogram[ bin ];
+            ++bin;
+         }
+         return bin;
+      }
+
+      // Collects the `n` samples whose key starts with `prefix` (the `remainingBits` lower bits are free),
+      // and selects the one with rank `rank` among them.
+      TPI SelectFromCandidates( dip::uint rank, dip::uint n, Key prefix, dip::uint remainingBits ) const {
+         dip::uint nThreads = parts_.size();
+         std::vector< std::vector< TPI >> candidates( nThreads );
+         ParallelFor( nThreads, [ & ]( dip::uint thread ) {
+            ForEachSample< TPI >( parts_[ thread ], partMasks_[ thread ], [ & ]( TPI value ) {
+               if(( RadixKey< TPI >::ToKey( value ) >> remainingBits ) == prefix ) {
+                  candidates[ thread ].push_back( value );
+               }
+            } );
+         } );
+         std::vector< TPI >& buffer = candidates[ 0 ];
+         buffer.reserve( n );
+         for( dip::uint ii = 1; ii < nThreads; ++ii ) {
+            buffer.insert( buffer.end(), candidates[ ii ].begin(), candidates[ ii ].end() );
+         }
+         DIP_ASSERT( buffer.size() == n );
+         auto ourGuy = buffer.begin() + static_cast< dip::sint >( rank );
+         std::nth_element( buffer.begin(), ourGuy, buffer.end() );
+         return *ourGuy;
+      }
+};
+
 template< typename TPI >
 class ProjectionPercentile : public ProjectionScanFunction {
    public:
-      ProjectionPercentile( dfloat percentile ) : percentile_( percentile ) {}
+      // If `streaming`, the samples are not copied to a buffer, `RadixSelect` is used instead.
+      ProjectionPercentile( dfloat percentile, bool streaming, bool approximate )
+            : percentile_( percentile ), streaming_( streaming ), approximate_( approximate ) {}
       virtual void Project( Image const& in, Image const& mask, void* out, dip::uint thread ) override {
-         dip::uint N;
-         if( mask.IsForged() ) {
-            N = Count( mask );
-         } else {
-            N = in.NumberOfPixels();
-         }
+         dip::uint N = NumberOfSamples( in, mask );
          if( N == 0 ) {
             *static_cast< TPI* >( out ) = TPI{};
             return;
          }
          dip::sint rank = round_cast( static_cast< dfloat >(N - 1) * percentile_ / 100.0 );
+         if( streaming_ ) {
+            // If we're called from within a parallel region, this will use a single thread
+            dip::uint nThreads = GetThreadingCostModel().NumberOfThreads( N * OperationsPerSample(), GetNumberOfThreads() );
+            RadixSelect< TPI > selector( in, mask, nThreads );
+            *static_cast< TPI* >( out ) = approximate_ ? selector.SelectApproximate( static_cast< dip::uint >( rank ))
+                                                       : selector.Select( static_cast< dip::uint >( rank ));
+            return;
+         }
          buffer_[ thread ].resize( N );
 #if 0 // Strategy 1: Copy data to buffer, and partition at the same time. The issue is finding a good pivot
          auto leftIt = buffer_[ thread ].begin();
@@ -928,7 +1396,52 @@ class ProjectionPercentile : public ProjectionScanFunction {
             std::nth_element( ++leftIt, ourGuy, buffer_[ thread ].end() );
          } // else: ourGuy == leftIt, which is already sorted correctly.
 #else // Strategy 1: Copy data to buffer, let std lib do the partitioning using its OK pivot strategy
-         auto outIt = buffer_[ thread ].begin();
+         CopySamples( in, mask, buffer_[ thread ] );
+         auto ourGuy = buffer_[ thread ].begin() + rank;
+         std::nth_element( buffer_[ thread ].begin(), ourGuy, buffer_[ thread ].end() );
+#endif
+         *static_cast< TPI* >( out ) = *ourGuy;
+      }
+      virtual dip::uint OperationsPerSample() const override { return 10; } // copy and partition
+      void SetNumberOfThreads( dip::uint threads ) override {
+         buffer_.resize( threads );
+      }
+      // Each thread copies its part of the data to its buffer, the merge step concatenates these buffers.
+      // When streaming, `Project` uses multiple threads by itself.
+      virtual bool SupportsPartialResults() const override { return !streaming_; }
+      virtual void ProjectPartial( Image const& in, Image const& mask, dip::uint thread ) override {
+         buffer_[ thread ].resize( NumberOfSamples( in, mask ));
+         if( !buffer_[ thread ].empty() ) {
+            CopySamples( in, mask, buffer_[ thread ] );
+         }
+      }
+      virtual void MergePartialResults( void* out ) override {
+         std::vector< TPI >& buffer = buffer_[ 0 ];
+         for( dip::uint ii = 1; ii < buffer_.size(); ++ii ) {
+            buffer.insert( buffer.end(), buffer_[ ii ].begin(), buffer_[ ii ].end() );
+         }
+         if( buffer.empty() ) {
+            *static_cast< TPI* >( out ) = TPI{};
+            return;
+         }
+         dip::sint rank = round_cast( static_cast< dfloat >( buffer.size() - 1 ) * percentile_ / 100.0 );
+         auto ourGuy = buffer.begin() + rank;
+         std::nth_element( buffer.begin(), ourGuy, buffer.end() );
+         *static_cast< TPI* >( out ) = *ourGuy;
+      }
+   private:
+      std::vector< std::vector< TPI >> buffer_;
+      dfloat percentile_;
+      bool streaming_;
+      bool approximate_;
+
+      static dip::uint NumberOfSamples( Image const& in, Image const& mask ) {
+         return mask.IsForged() ? Count( mask ) : in.NumberOfPixels();
+      }
+
+      // Copies the samples of `in` selected by `mask` into `buffer`, which must have the right size.
+      static void CopySamples( Image const& in, Image const& mask, std::vector< TPI >& buffer ) {
+         auto outIt = buffer.begin();
          if( mask.IsForged() ) {
             JointImageIterator< TPI, bin > it( { in, mask } );
             it.OptimizeAndFlatten();
@@ -944,17 +1457,7 @@ class ProjectionPercentile : public ProjectionScanFunction {
                *( outIt++ ) = *it;
             } while( ++it );
          }
-         auto ourGuy = buffer_[ thread ].begin() + rank;
-         std::nth_element( buffer_[ thread ].begin(), ourGuy, buffer_[ thread ].end() );
-#endif
-         *static_cast< TPI* >( out ) = *ourGuy;
-      }
-      void SetNumberOfThreads( dip::uint threads ) override {
-         buffer_.resize( threads );
       }
-   private:
-      std::vector< std::vector< TPI >> buffer_;
-      dfloat percentile_;
 };
 
 } // namespace
@@ -964,16 +1467,34 @@ void Percentile(
       Image const& mask,
       Image& out,
       dfloat percentile,
-      BooleanArray const& process
+      BooleanArray const& process,
+      String const& mode
 ) {
    DIP_THROW_IF(( percentile < 0.0 ) || ( percentile > 100.0 ), E::PARAMETER_OUT_OF_RANGE );
+   bool approximate;
+   DIP_STACK_TRACE_THIS( approximate = BooleanFromString( mode, S::APPROXIMATE, S::EXACT ));
    if( percentile == 0.0 ) {
       Minimum( in, mask, out, process );
    } else if( percentile == 100.0 ) {
       Maximum( in, mask, out, process );
    } else {
+      DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+      // Number of pixels in each projected sub-image
+      dip::uint subImageSize = 1;
+      for( dip::uint ii = 0; ii < in.Dimensionality(); ++ii ) {
+         if( process.empty() || (( ii < process.size() ) && process[ ii ] )) {
+            subImageSize *= in.Size( ii );
+         }
+      }
+      // Large sub-images are not copied into a buffer. For 8 and 16-bit images, the streaming algorithm needs
+      // a single pass over the data, and is cheaper than copying for all but the smallest sub-images.
+      constexpr dip::uint maxBufferSize = dip::uint( 1 ) << 24; // bytes
+      dip::uint sizeOf = in.DataType().SizeOf();
+      bool streaming = approximate || ( subImageSize * sizeOf > maxBufferSize ) ||
+                       (( sizeOf <= 2 ) && ( subImageSize >= ( dip::uint( 1 ) << 16 )));
+      approximate &= !in.DataType().IsBinary(); // the exact algorithm needs a single pass for binary images
       std::unique_ptr< ProjectionScanFunction > lineFilter;
-      DIP_OVL_NEW_NONCOMPLEX( lineFilter, ProjectionPercentile, ( percentile ), in.DataType() );
+      DIP_OVL_NEW_NONCOMPLEX( lineFilter, ProjectionPercentile, ( percentile, streaming, approximate ), in.DataType() );
       ProjectionScan( in, mask, out, in.DataType(), process, *lineFilter );
    }
 }
@@ -981,9 +1502,9 @@ void Percentile(
 namespace {
 
 template< typename TPI >
-class ProjectionAll : public ProjectionScanFunction {
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+class ProjectionAll : public MergeableProjectionScanFunction< bin > {
+   protected:
+      virtual bin Accumulate( Image const& in, Image const& mask ) override {
          bool all = true;
          if( mask.IsForged() ) {
             JointImageIterator< TPI, bin > it( { in, mask } );
@@ -1004,7 +1525,13 @@ class ProjectionAll : public ProjectionScanFunction {
                }
             } while( ++it );
          }
-         *static_cast< bin* >( out ) = all;
+         return all;
+      }
+      virtual void Combine( bin& result, bin const& other ) override {
+         result = result && other;
+      }
+      virtual void Finalize( bin const& result, void* out ) override {
+         *static_cast< bin* >( out ) = result;
       }
 };
 
@@ -1024,9 +1551,9 @@ void All(
 namespace {
 
 template< typename TPI >
-class ProjectionAny : public ProjectionScanFunction {
-   public:
-      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint ) override {
+class ProjectionAny : public MergeableProjectionScanFunction< bin > {
+   protected:
+      virtual bin Accumulate( Image const& in, Image const& mask ) override {
          bool any = false;
          if( mask.IsForged() ) {
             JointImageIterator< TPI, bin > it( { in, mask } );
@@ -1047,7 +1574,13 @@ class ProjectionAny : public ProjectionScanFunction {
                }
             } while( ++it );
          }
-         *static_cast< bin* >( out ) = any;
+         return any;
+      }
+      virtual void Combine( bin& result, bin const& other ) override {
+         result = result || other;
+      }
+      virtual void Finalize( bin const& result, void* out ) override {
+         *static_cast< bin* >( out ) = result;
       }
 };
 
@@ -1326,6 +1859,10 @@ void PositionPercentile(
 
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
+#include "diplib/math.h"
+#include "diplib/generation.h"
+#include "diplib/random.h"
+#include "diplib/multithreading.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the projection functions") {
    // We mostly test that the ProjectionScan framework works appropriately.
@@ -1386,4 +1923,83 @@ DOCTEST_TEST_CASE("[DIPlib] testing the projection functions") {
          std::atan2( std::sin( 1 ), std::cos( 1 ) + ( 3 * 4 * 2 - 1 ))));
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the parallel projection functions") {
+   // Results computed with multiple threads should match those computed with a single thread
+   dip::Image img{ dip::UnsignedArray{ 300, 250 }, 3, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random, 0.0, 100.0 );
+   dip::Image mask = img[ 0 ] > 30;
+   dip::BooleanArray process{ false, true };
+   auto compute = [ & ]() {
+      dip::ImageArray res;
+      res.push_back( dip::Sum( img ));
+      res.push_back( dip::Mean( img, mask ));
+      res.push_back( dip::Maximum( img[ 1 ] ));
+      res.push_back( dip::Minimum( img, mask, process ));
+      res.push_back( dip::Percentile( img[ 2 ], {}, 30.0 ));
+      res.push_back( dip::Percentile( img, mask, 70.0, process ));
+      res.push_back( dip::StandardDeviation( img[ 0 ], mask ));
+      res.push_back( dip::Any( img[ 0 ] > 99.99 ));
+      res.push_back( dip::PositionMaximum( img[ 1 ], {}, 1 ));
+      return res;
+   };
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::ImageArray reference = compute();
+   dip::SetNumberOfThreads( 4 );
+   dip::ImageArray result = compute();
+   dip::SetNumberOfThreads( nThreads );
+   for( dip::uint ii = 0; ii < result.size(); ++ii ) {
+      DOCTEST_CHECK( result[ ii ].Sizes() == reference[ ii ].Sizes() );
+      DOCTEST_CHECK( result[ ii ].TensorElements() == reference[ ii ].TensorElements() );
+      // Sums are accumulated in a different order, allow for rounding differences
+      dip::Image diff = dip::Abs( dip::Convert( result[ ii ], dip::DT_DFLOAT ) - reference[ ii ] );
+      dip::dfloat scale = std::max( 1.0, dip::Maximum( dip::MaximumAbs( reference[ ii ] )).As< dip::dfloat >() );
+      DOCTEST_CHECK( dip::Maximum( dip::MaximumTensorElement( diff )).As< dip::dfloat >() <= 1e-5 * scale );
+   }
+}
+
+namespace {
+
+template< typename TPI >
+TPI SortedRank( dip::Image const& img, dip::Image const& mask, dip::uint rank ) {
+   std::vector< TPI > values;
+   dip::ForEachSample< TPI >( img, mask, [ & ]( TPI v ) { values.push_back( v ); } );
+   std::sort( values.begin(), values.end() );
+   return values[ rank ];
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("[DIPlib] testing the streaming percentile selection") {
+   dip::Image img{ dip::UnsignedArray{ 200, 150 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::GaussianNoise( img, img, random, 1e4 );
+   dip::Image mask = img > -50;
+   // Exact selection of floating-point values, with many candidates
+   dip::RadixSelect< dip::sfloat > selector( img, {}, 3 );
+   for( dip::uint rank : { dip::uint( 0 ), dip::uint( 1234 ), img.NumberOfPixels() - 1 } ) {
+      DOCTEST_CHECK( selector.Select( rank ) == SortedRank< dip::sfloat >( img, {}, rank ));
+   }
+   // Negative and positive integers, with mask
+   dip::Image intImg = dip::Convert( img, dip::DT_SINT32 );
+   dip::uint n = dip::Count( mask );
+   dip::RadixSelect< dip::sint32 > intSelector( intImg, mask, 2 );
+   DOCTEST_CHECK( intSelector.Select( n / 3 ) == SortedRank< dip::sint32 >( intImg, mask, n / 3 ));
+   DOCTEST_CHECK( intSelector.Select( n - 1 ) == SortedRank< dip::sint32 >( intImg, mask, n - 1 ));
+   // Approximate selection, within one bin of the exact value
+   dip::dfloat range = dip::Maximum( img ).As< dip::dfloat >() - dip::Minimum( img ).As< dip::dfloat >();
+   dip::sfloat exact = SortedRank< dip::sfloat >( img, {}, 20000 );
+   DOCTEST_CHECK( std::abs( selector.SelectApproximate( 20000 ) - exact ) <= range / 65536.0 );
+   // Through `dip::Percentile`: 16-bit images always use the streaming algorithm, and must match the buffered result
+   dip::Image img16 = dip::Convert( img + 50000, dip::DT_UINT16 );
+   dip::Image result = dip::Percentile( img16, mask, 80.0 );
+   DOCTEST_CHECK( result.DataType() == dip::DT_UINT16 );
+   DOCTEST_CHECK( result.As< dip::dfloat >() == dip::Percentile( dip::Convert( img16, dip::DT_SFLOAT ), mask, 80.0 ).As< dip::dfloat >() );
+   result = dip::Percentile( img16, {}, 25.0, {}, "approximate" );
+   DOCTEST_CHECK( result.As< dip::dfloat >() == dip::Percentile( img16, {}, 25.0 ).As< dip::dfloat >() ); // range < 65536
+}
+
 #endif // DIP__ENABLE_DOCTEST
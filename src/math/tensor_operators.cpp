@@ -21,6 +21,7 @@
 #include "diplib/framework.h"
 #include "diplib/overload.h"
 #include "diplib/iterators.h"
+#include "diplib/library/cpu_dispatch.h"
 
 namespace dip {
 
@@ -159,6 +160,434 @@ struct GreaterMagnitude {
    }
 };
 
+//
+// Closed-form eigendecomposition of 2x2 and 3x3 symmetric matrices
+//
+// A whole image line is processed at once. The unique tensor elements are first copied to one contiguous array
+// each (structure of arrays), so that the loops below can be vectorized; they are compiled for multiple
+// instruction sets through `dip::detail::CpuDispatch`. Eigenvalues are sorted by magnitude, largest first, as
+// in `dip::SymmetricEigenDecomposition`.
+//
+
+enum class SymmetricEigenOutput {
+      VALUES,           // all eigenvalues
+      LARGEST_VALUE,    // the eigenvalue with the largest magnitude
+      SMALLEST_VALUE,   // the eigenvalue with the smallest magnitude
+      DECOMPOSITION,    // all eigenvalues and all eigenvectors
+      LARGEST_VECTOR,   // the eigenvector for the largest eigenvalue
+      SMALLEST_VECTOR   // the eigenvector for the smallest eigenvalue
+};
+
+bool UseClosedFormSymmetricEigen( Image const& in ) {
+   return ( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && !in.DataType().IsComplex() &&
+          (( in.TensorRows() == 2 ) || ( in.TensorRows() == 3 ));
+}
+
+// Sorts `a` and `b` such that `a` has the largest magnitude.
+template< typename T >
+inline void SortByMagnitude( T& a, T& b ) {
+   bool swap = std::abs( a ) < std::abs( b );
+   T tmp = swap ? b : a;
+   b = swap ? a : b;
+   a = tmp;
+}
+
+// Input: xx, yy, xy. Output: lambdas[ 0 ], lambdas[ 1 ]. If `vectors` is not null, also the eigenvectors:
+// vectors[ 0 ], vectors[ 1 ] for the first one, vectors[ 2 ], vectors[ 3 ] for the second one.
+template< typename T >
+void SymmetricEigen2( std::array< T const*, 3 > const& in, std::array< T*, 2 > const& lambdas, T* const* vectors, dip::uint length ) {
+   T const* xx = in[ 0 ];
+   T const* yy = in[ 1 ];
+   T const* xy = in[ 2 ];
+   T* lambda1 = lambdas[ 0 ];
+   T* lambda2 = lambdas[ 1 ];
+   if( !vectors ) {
+      for( dip::uint kk = 0; kk < length; ++kk ) {
+         T mean = ( xx[ kk ] + yy[ kk ] ) / 2;
+         T diff = ( xx[ kk ] - yy[ kk ] ) / 2;
+         T radius = std::sqrt( diff * diff + xy[ kk ] * xy[ kk ] );
+         T a = mean + radius;
+         T b = mean - radius;
+         SortByMagnitude( a, b );
+         lambda1[ kk ] = a;
+         lambda2[ kk ] = b;
+      }
+   } else {
+      T* v1x = vectors[ 0 ];
+      T* v1y = vectors[ 1 ];
+      T* v2x = vectors[ 2 ];
+      T* v2y = vectors[ 3 ];
+      for( dip::uint kk = 0; kk < length; ++kk ) {
+         T mean = ( xx[ kk ] + yy[ kk ] ) / 2;
+         T diff = ( xx[ kk ] - yy[ kk ] ) / 2;
+         T radius = std::sqrt( diff * diff + xy[ kk ] * xy[ kk ] );
+         // (px,py) is the eigenvector for `mean + radius`, computed in the numerically stable way
+         T px = diff >= 0 ? diff + radius : xy[ kk ];
+         T py = diff >= 0 ? xy[ kk ] : radius - diff;
+         T norm = std::sqrt( px * px + py * py );
+         bool isotropic = norm == 0;
+         norm = isotropic ? T( 1 ) : norm;
+         px = isotropic ? T( 1 ) : px / norm;
+         py = isotropic ? T( 0 ) : py / norm;
+         T a = mean + radius;
+         T b = mean - radius;
+         bool swap = std::abs( a ) < std::abs( b );
+         lambda1[ kk ] = swap ? b : a;
+         lambda2[ kk ] = swap ? a : b;
+         v1x[ kk ] = swap ? -py : px;
+         v1y[ kk ] = swap ? px : py;
+         v2x[ kk ] = swap ? px : -py;
+         v2y[ kk ] = swap ? py : px;
+      }
+   }
+}
+
+// Computes the eigenvector of the 3x3 symmetric matrix for eigenvalue `lambda` as the largest cross product of
+// two rows of `A - lambda I`. Returns false if that cross product is too small compared to the matrix norm
+// for the result to be accurate.
+template< typename T >
+inline bool EigenVector3( T xx, T yy, T zz, T xy, T xz, T yz, T lambda, T& vx, T& vy, T& vz ) {
+   xx -= lambda;
+   yy -= lambda;
+   zz -= lambda;
+   T c01x = xy * yz - xz * yy;   // row0 x row1
+   T c01y = xz * xy - xx * yz;
+   T c01z = xx * yy - xy * xy;
+   T c02x = xy * zz - xz * yz;   // row0 x row2
+   T c02y = xz * xz - xx * zz;
+   T c02z = xx * yz - xy * xz;
+   T c12x = yy * zz - yz * yz;   // row1 x row2
+   T c12y = yz * xz - xy * zz;
+   T c12z = xy * yz - yy * xz;
+   T n01 = c01x * c01x + c01y * c01y + c01z * c01z;
+   T n02 = c02x * c02x + c02y * c02y + c02z * c02z;
+   T n12 = c12x * c12x + c12y * c12y + c12z * c12z;
+   T norm = n01;
+   vx = c01x;
+   vy = c01y;
+   vz = c01z;
+   if( n02 > norm ) {
+      norm = n02;
+      vx = c02x;
+      vy = c02y;
+      vz = c02z;
+   }
+   if( n12 > norm ) {
+      norm = n12;
+      vx = c12x;
+      vy = c12y;
+      vz = c12z;
+   }
+   T scale = xx * xx + yy * yy + zz * zz + 2 * ( xy * xy + xz * xz + yz * yz );
+   constexpr T tolerance = std::is_same< T, sfloat >::value ? T( 1e-6 ) : T( 1e-12 );
+   if( !( norm > tolerance * scale * scale )) {
+      return false;
+   }
+   norm = 1 / std::sqrt( norm );
+   vx *= norm;
+   vy *= norm;
+   vz *= norm;
+   return true;
+}
+
+// Input: xx, yy, zz, xy, xz, yz. Output: lambdas[ 0 ], lambdas[ 1 ], lambdas[ 2 ]. If `vectors` is not null,
+// also the eigenvectors: vectors[ 0 ] through vectors[ 2 ] for the first one, etc. `scratch` has space for
+// `3 * length` values.
+template< typename T >
+void SymmetricEigen3( std::array< T const*, 6 > const& in, std::array< T*, 3 > const& lambdas, T* const* vectors, T* scratch, dip::uint length ) {
+   T const* xx = in[ 0 ];
+   T const* yy = in[ 1 ];
+   T const* zz = in[ 2 ];
+   T const* xy = in[ 3 ];
+   T const* xz = in[ 4 ];
+   T const* yz = in[ 5 ];
+   T* lambda1 = lambdas[ 0 ];
+   T* lambda2 = lambdas[ 1 ];
+   T* lambda3 = lambdas[ 2 ];
+   T* cos1 = scratch;
+   T* cos3 = scratch + length;
+   T* rr = scratch + 2 * length;
+   // Trigonometric solution of the characteristic polynomial (O.K. Smith, Comm. ACM 4(4):168, 1961).
+   // First part: q = trace / 3 (in `lambda1`), p = norm of (A - qI) / sqrt(6) (in `lambda2`),
+   // and r = det(A - qI) / ( 2 p^3 ) (in `cos1`).
+   for( dip::uint kk = 0; kk < length; ++kk ) {
+      T q = ( xx[ kk ] + yy[ kk ] + zz[ kk ] ) / 3;
+      T a = xx[ kk ] - q;
+      T b = yy[ kk ] - q;
+      T c = zz[ kk ] - q;
+      T offDiagonal = xy[ kk ] * xy[ kk ] + xz[ kk ] * xz[ kk ] + yz[ kk ] * yz[ kk ];
+      T p = std::sqrt(( a * a + b * b + c * c + 2 * offDiagonal ) / 6 );
+      T det = a * ( b * c - yz[ kk ] * yz[ kk ] )
+              - xy[ kk ] * ( xy[ kk ] * c - yz[ kk ] * xz[ kk ] )
+              + xz[ kk ] * ( xy[ kk ] * yz[ kk ] - b * xz[ kk ] );
+      T p3 = p * p * p;
+      T r = p3 > 0 ? det / ( 2 * ( p3 > 0 ? p3 : T( 1 ))) : T( 0 );
+      lambda1[ kk ] = q;
+      lambda2[ kk ] = p;
+      rr[ kk ] = std::min( std::max( r, T( -1 )), T( 1 ));
+   }
+   // Second part: the transcendental functions, which the compiler doesn't vectorize.
+   constexpr T third = T( 1.0 / 3.0 );
+   constexpr T twoThirdsPi = T( 2.0 / 3.0 * pi );
+   for( dip::uint kk = 0; kk < length; ++kk ) {
+      T phi = std::acos( rr[ kk ] ) * third;
+      cos1[ kk ] = std::cos( phi );
+      cos3[ kk ] = std::cos( phi + twoThirdsPi );
+   }
+   // Third part: the eigenvalues, sorted by magnitude. For a diagonal matrix, the diagonal elements are
+   // returned unchanged.
+   for( dip::uint kk = 0; kk < length; ++kk ) {
+      T q = lambda1[ kk ];
+      T p = lambda2[ kk ];
+      T e1 = q + 2 * p * cos1[ kk ];
+      T e3 = q + 2 * p * cos3[ kk ];
+      T e2 = 3 * q - e1 - e3;
+      bool diagonal = ( xy[ kk ] == 0 ) && ( xz[ kk ] == 0 ) && ( yz[ kk ] == 0 );
+      e1 = diagonal ? xx[ kk ] : e1;
+      e2 = diagonal ? yy[ kk ] : e2;
+      e3 = diagonal ? zz[ kk ] : e3;
+      SortByMagnitude( e1, e2 );
+      SortByMagnitude( e2, e3 );
+      SortByMagnitude( e1, e2 );
+      lambda1[ kk ] = e1;
+      lambda2[ kk ] = e2;
+      lambda3[ kk ] = e3;
+   }
+   // When two eigenvalues are (nearly) equal, `r` is close to -1 or 1, where `acos` is badly conditioned. We use
+   // the iterative algorithm for these pixels.
+   constexpr T rLimit = std::is_same< T, sfloat >::value ? T( 1 - 1e-2 ) : T( 1 - 1e-6 );
+   for( dip::uint kk = 0; kk < length; ++kk ) {
+      if(( std::abs( rr[ kk ] ) > rLimit ) && !(( xy[ kk ] == 0 ) && ( xz[ kk ] == 0 ) && ( yz[ kk ] == 0 ))) {
+         std::array< dfloat, 9 > matrix{{ xx[ kk ], xy[ kk ], xz[ kk ],
+                                          xy[ kk ], yy[ kk ], yz[ kk ],
+                                          xz[ kk ], yz[ kk ], zz[ kk ] }};
+         std::array< dfloat, 3 > dlambda;
+         SymmetricEigenDecomposition3( matrix.data(), dlambda.data() );
+         lambda1[ kk ] = static_cast< T >( dlambda[ 0 ] );
+         lambda2[ kk ] = static_cast< T >( dlambda[ 1 ] );
+         lambda3[ kk ] = static_cast< T >( dlambda[ 2 ] );
+      }
+   }
+   if( !vectors ) {
+      return;
+   }
+   // The eigenvectors. We compute the eigenvector for the eigenvalue that is best separated from the other two,
+   // then the one for the next best separated one, and the third one is perpendicular to these two. If the
+   // eigenvalues are too close together for this to be accurate, we use the iterative algorithm instead.
+   for( dip::uint kk = 0; kk < length; ++kk ) {
+      std::array< T, 3 > lambda{{ lambda1[ kk ], lambda2[ kk ], lambda3[ kk ] }};
+      std::array< T, 9 > v;
+      bool success = true;
+      if(( xy[ kk ] == 0 ) && ( xz[ kk ] == 0 ) && ( yz[ kk ] == 0 )) {
+         // Diagonal matrix: the eigenvectors are the unit vectors, in the order of the sorted eigenvalues
+         std::array< T, 3 > diagonal{{ xx[ kk ], yy[ kk ], zz[ kk ] }};
+         std::array< bool, 3 > used{{ false, false, false }};
+         v.fill( 0 );
+         for( dip::uint ii = 0; ii < 3; ++ii ) {
+            for( dip::uint jj = 0; jj < 3; ++jj ) {
+               if( !used[ jj ] && ( diagonal[ jj ] == lambda[ ii ] )) {
+                  used[ jj ] = true;
+                  v[ ii * 3 + jj ] = 1;
+                  break;
+               }
+            }
+         }
+      } else {
+         std::array< T, 3 > separation{{
+               std::min( std::abs( lambda[ 0 ] - lambda[ 1 ] ), std::abs( lambda[ 0 ] - lambda[ 2 ] )),
+               std::min( std::abs( lambda[ 1 ] - lambda[ 0 ] ), std::abs( lambda[ 1 ] - lambda[ 2 ] )),
+               std::min( std::abs( lambda[ 2 ] - lambda[ 0 ] ), std::abs( lambda[ 2 ] - lambda[ 1 ] ))
+         }};
+         std::array< dip::uint, 3 > order{{ 0, 1, 2 }};
+         if( separation[ order[ 0 ]] < separation[ order[ 1 ]] ) { std::swap( order[ 0 ], order[ 1 ] ); }
+         if( separation[ order[ 1 ]] < separation[ order[ 2 ]] ) { std::swap( order[ 1 ], order[ 2 ] ); }
+         if( separation[ order[ 0 ]] < separation[ order[ 1 ]] ) { std::swap( order[ 0 ], order[ 1 ] ); }
+         T* u = &v[ order[ 0 ] * 3 ];
+         T* w = &v[ order[ 1 ] * 3 ];
+         T* t = &v[ order[ 2 ] * 3 ];
+         success = EigenVector3( xx[ kk ], yy[ kk ], zz[ kk ], xy[ kk ], xz[ kk ], yz[ kk ], lambda[ order[ 0 ]], u[ 0 ], u[ 1 ], u[ 2 ] ) &&
+                   EigenVector3( xx[ kk ], yy[ kk ], zz[ kk ], xy[ kk ], xz[ kk ], yz[ kk ], lambda[ order[ 1 ]], w[ 0 ], w[ 1 ], w[ 2 ] );
+         if( success ) {
+            // Make `w` exactly perpendicular to `u`
+            T dot = u[ 0 ] * w[ 0 ] + u[ 1 ] * w[ 1 ] + u[ 2 ] * w[ 2 ];
+            w[ 0 ] -= dot * u[ 0 ];
+            w[ 1 ] -= dot * u[ 1 ];
+            w[ 2 ] -= dot * u[ 2 ];
+            T norm = 1 / std::sqrt( w[ 0 ] * w[ 0 ] + w[ 1 ] * w[ 1 ] + w[ 2 ] * w[ 2 ] );
+            w[ 0 ] *= norm;
+            w[ 1 ] *= norm;
+            w[ 2 ] *= norm;
+            t[ 0 ] = u[ 1 ] * w[ 2 ] - u[ 2 ] * w[ 1 ];
+            t[ 1 ] = u[ 2 ] * w[ 0 ] - u[ 0 ] * w[ 2 ];
+            t[ 2 ] = u[ 0 ] * w[ 1 ] - u[ 1 ] * w[ 0 ];
+         }
+      }
+      if( !success ) {
+         std::array< dfloat, 9 > matrix{{ xx[ kk ], xy[ kk ], xz[ kk ],
+                                          xy[ kk ], yy[ kk ], yz[ kk ],
+                                          xz[ kk ], yz[ kk ], zz[ kk ] }};
+         std::array< dfloat, 3 > dlambda;
+         std::array< dfloat, 9 > dv;
+         SymmetricEigenDecomposition3( matrix.data(), dlambda.data(), dv.data() );
+         for( dip::uint ii = 0; ii < 3; ++ii ) {
+            lambda[ ii ] = static_cast< T >( dlambda[ ii ] );
+         }
+         for( dip::uint ii = 0; ii < 9; ++ii ) {
+            v[ ii ] = static_cast< T >( dv[ ii ] );
+         }
+         lambda1[ kk ] = lambda[ 0 ];
+         lambda2[ kk ] = lambda[ 1 ];
+         lambda3[ kk ] = lambda[ 2 ];
+      }
+      for( dip::uint ii = 0; ii < 9; ++ii ) {
+         vectors[ ii ][ kk ] = v[ ii ];
+      }
+   }
+}
+
+template< typename T, dip::uint N >
+class SymmetricEigenLineFilter : public Framework::ScanLineFilter {
+   public:
+      static constexpr dip::uint nElements = N * ( N + 1 ) / 2;
+      SymmetricEigenLineFilter( SymmetricEigenOutput output ) : output_( output ) {}
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override {
+         return NeedVectors() ? 100 * N : 40 * N;
+      }
+      virtual void SetNumberOfThreads( dip::uint threads ) override {
+         buffers_.resize( threads );
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         dip::uint const bufferLength = params.bufferLength;
+         bool needVectors = NeedVectors();
+         // Buffer layout: the input tensor elements, the eigenvalues, the eigenvectors, scratch space
+         dip::uint nArrays = nElements + N + ( needVectors ? N * N : 0 ) + 3;
+         std::vector< T >& buffer = buffers_[ params.thread ];
+         buffer.resize( nArrays * bufferLength );
+         T* ptr = buffer.data();
+         std::array< T const*, nElements > in;
+         T const* inPtr = static_cast< T const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint const inStride = params.inBuffer[ 0 ].stride;
+         dip::sint const inTensorStride = params.inBuffer[ 0 ].tensorStride;
+         DIP_ASSERT( params.inBuffer[ 0 ].tensorLength == nElements );
+         for( dip::uint ii = 0; ii < nElements; ++ii ) {
+            T const* src = inPtr + static_cast< dip::sint >( ii ) * inTensorStride;
+            for( dip::uint kk = 0; kk < bufferLength; ++kk, src += inStride ) {
+               ptr[ kk ] = *src;
+            }
+            in[ ii ] = ptr;
+            ptr += bufferLength;
+         }
+         std::array< T*, N > lambdas;
+         for( dip::uint ii = 0; ii < N; ++ii ) {
+            lambdas[ ii ] = ptr;
+            ptr += bufferLength;
+         }
+         std::array< T*, N * N > vectors;
+         if( needVectors ) {
+            for( dip::uint ii = 0; ii < N * N; ++ii ) {
+               vectors[ ii ] = ptr;
+               ptr += bufferLength;
+            }
+         }
+         T* scratch = ptr;
+         T* const* vectorsPtr = needVectors ? vectors.data() : nullptr;
+         detail::CpuDispatch( [ & ]() { Compute( in, lambdas, vectorsPtr, scratch, bufferLength ); } );
+         // Write output
+         switch( output_ ) {
+            case SymmetricEigenOutput::VALUES:
+               WriteOutput( params.outBuffer[ 0 ], lambdas.data(), N, bufferLength );
+               break;
+            case SymmetricEigenOutput::LARGEST_VALUE:
+               WriteOutput( params.outBuffer[ 0 ], lambdas.data(), 1, bufferLength );
+               break;
+            case SymmetricEigenOutput::SMALLEST_VALUE:
+               WriteOutput( params.outBuffer[ 0 ], lambdas.data() + N - 1, 1, bufferLength );
+               break;
+            case SymmetricEigenOutput::DECOMPOSITION:
+               WriteOutput( params.outBuffer[ 0 ], lambdas.data(), N, bufferLength );
+               WriteOutput( params.outBuffer[ 1 ], vectors.data(), N * N, bufferLength );
+               break;
+            case SymmetricEigenOutput::LARGEST_VECTOR:
+               WriteOutput( params.outBuffer[ 0 ], vectors.data(), N, bufferLength );
+               break;
+            case SymmetricEigenOutput::SMALLEST_VECTOR:
+               WriteOutput( params.outBuffer[ 0 ], vectors.data() + N * ( N - 1 ), N, bufferLength );
+               break;
+         }
+      }
+   private:
+      SymmetricEigenOutput output_;
+      std::vector< std::vector< T >> buffers_; // one for each thread
+
+      bool NeedVectors() const {
+         return ( output_ == SymmetricEigenOutput::DECOMPOSITION ) ||
+                ( output_ == SymmetricEigenOutput::LARGEST_VECTOR ) ||
+                ( output_ == SymmetricEigenOutput::SMALLEST_VECTOR );
+      }
+
+      static void Compute( std::array< T const*, 3 > const& in, std::array< T*, 2 > const& lambdas, T* const* vectors, T*, dip::uint length ) {
+         SymmetricEigen2( in, lambdas, vectors, length );
+      }
+      static void Compute( std::array< T const*, 6 > const& in, std::array< T*, 3 > const& lambdas, T* const* vectors, T* scratch, dip::uint length ) {
+         SymmetricEigen3( in, lambdas, vectors, scratch, length );
+      }
+
+      static void WriteOutput( Framework::ScanBuffer const& outBuffer, T* const* arrays, dip::uint n, dip::uint length ) {
+         DIP_ASSERT( outBuffer.tensorLength == n );
+         T* outPtr = static_cast< T* >( outBuffer.buffer );
+         for( dip::uint ii = 0; ii < n; ++ii ) {
+            T* dest = outPtr + static_cast< dip::sint >( ii ) * outBuffer.tensorStride;
+            T const* src = arrays[ ii ];
+            for( dip::uint kk = 0; kk < length; ++kk, dest += outBuffer.stride ) {
+               *dest = src[ kk ];
+            }
+         }
+      }
+};
+
+// Computes eigenvalues and/or eigenvectors of a 2x2 or 3x3 symmetric matrix image, see `UseClosedFormSymmetricEigen`.
+// `outar` has one image, or two images for `SymmetricEigenOutput::DECOMPOSITION`.
+void ClosedFormSymmetricEigen( Image const& in, ImageRefArray& outar, SymmetricEigenOutput output ) {
+   dip::uint n = in.TensorRows();
+   DataType outtype = DataType::SuggestFlex( in.DataType() );
+   DataType buffertype = outtype == DT_SFLOAT ? DT_SFLOAT : DT_DFLOAT;
+   std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
+   if( buffertype == DT_SFLOAT ) {
+      if( n == 2 ) {
+         scanLineFilter.reset( new SymmetricEigenLineFilter< sfloat, 2 >( output ));
+      } else {
+         scanLineFilter.reset( new SymmetricEigenLineFilter< sfloat, 3 >( output ));
+      }
+   } else {
+      if( n == 2 ) {
+         scanLineFilter.reset( new SymmetricEigenLineFilter< dfloat, 2 >( output ));
+      } else {
+         scanLineFilter.reset( new SymmetricEigenLineFilter< dfloat, 3 >( output ));
+      }
+   }
+   UnsignedArray nTensorElements;
+   switch( output ) {
+      case SymmetricEigenOutput::VALUES:
+         nTensorElements = { n };
+         break;
+      case SymmetricEigenOutput::LARGEST_VALUE:
+      case SymmetricEigenOutput::SMALLEST_VALUE:
+         nTensorElements = { 1 };
+         break;
+      case SymmetricEigenOutput::DECOMPOSITION:
+         nTensorElements = { n, n * n };
+         break;
+      case SymmetricEigenOutput::LARGEST_VECTOR:
+      case SymmetricEigenOutput::SMALLEST_VECTOR:
+         nTensorElements = { n };
+         break;
+   }
+   DataTypeArray outBufferTypes( outar.size(), buffertype );
+   DataTypeArray outImageTypes( outar.size(), outtype );
+   DIP_STACK_TRACE_THIS( Framework::Scan( { in }, outar, { buffertype }, outBufferTypes, outImageTypes,
+                                          nTensorElements, *scanLineFilter ));
+}
+
 } // namespace
 
 
@@ -528,6 +957,9 @@ void Eigenvalues( Image const& in, Image& out ) {
    } else if( in.TensorShape() == Tensor::Shape::DIAGONAL_MATRIX ) {
       DIP_STACK_TRACE_THIS( out.Copy( in.Diagonal() ));
       DIP_STACK_TRACE_THIS( SortTensorElementsByMagnitude( out ));
+   } else if( UseClosedFormSymmetricEigen( in )) {
+      ImageRefArray outar{ out };
+      DIP_STACK_TRACE_THIS( ClosedFormSymmetricEigen( in, outar, SymmetricEigenOutput::VALUES ));
    } else {
       dip::uint n = in.TensorRows();
       DataType intype = in.DataType();
@@ -536,23 +968,9 @@ void Eigenvalues( Image const& in, Image& out ) {
       DataType outtype;
       std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
       if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
-         switch( n ) {
-            case 2:
-               scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-                     []( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition2( pin, pout ); }, 400 * 2 // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
-               );
-               break;
-            case 3:
-               scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-                     []( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition3( pin, pout ); }, 400 * 3 // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
-               );
-               break;
-            default:
-               scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-                     [ n ]( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition( n, pin, pout ); }, 400 * n // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
-               );
-               break;
-         }
+         scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
+               [ n ]( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition( n, pin, pout ); }, 400 * n // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
+         );
          inbuffertype = outbuffertype = DT_DFLOAT;
          outtype = DataType::SuggestFlex( intype );
       } else {
@@ -622,44 +1040,6 @@ class SelectEigenvalueLineFilter : public Framework::ScanLineFilter {
       std::vector< std::vector< TPO >> buffers_; // one for each thread
 };
 
-template< typename TPI, typename TPO, typename F >
-class SelectEigenvalueLineFilterN : public Framework::ScanLineFilter {
-   public:
-      SelectEigenvalueLineFilterN( F function, dip::uint n, bool first ) : function_( function ), n_( n ), first_( first ) {}
-      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint tensorElements ) override {
-         return ( typeid( TPI ) == typeid( dfloat ) ? 400 : 800 ) * tensorElements;
-      }
-      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         dip::uint const bufferLength = params.bufferLength;
-         ConstLineIterator< TPI > in(
-               static_cast< TPI const* >( params.inBuffer[ 0 ].buffer ),
-               bufferLength,
-               params.inBuffer[ 0 ].stride,
-               params.inBuffer[ 0 ].tensorLength,
-               params.inBuffer[ 0 ].tensorStride
-         );
-         LineIterator< TPO > out(
-               static_cast< TPO* >( params.outBuffer[ 0 ].buffer ),
-               bufferLength,
-               params.outBuffer[ 0 ].stride,
-               params.outBuffer[ 0 ].tensorLength, // == 1
-               params.outBuffer[ 0 ].tensorStride
-         );
-         std::array< TPO, 3 > buf; // NOTE!!! `function_` is either `SymmetricEigenDecomposition2` or `SymmetricEigenDecomposition3`
-         TPO* bufFront = buf.data();
-         TPO* bufBack = bufFront + ( n_ - 1 );
-         // Compute
-         do {
-            function_( in.begin(), buf.data(), nullptr );
-            *out = first_ ? *bufFront : *bufBack;
-         } while( ++in, ++out );
-      }
-   private:
-      F function_;
-      dip::uint n_;
-      bool first_;
-};
-
 void SelectEigenvalue( Image const& in, Image& out, bool first ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.Tensor().IsSquare(), "The eigenvalues can only be computed from square matrices" );
@@ -667,6 +1047,10 @@ void SelectEigenvalue( Image const& in, Image& out, bool first ) {
       out = in;
    } else if( in.TensorShape() == Tensor::Shape::DIAGONAL_MATRIX ) {
       DIP_STACK_TRACE_THIS( MaximumAbsTensorElement( in, out ));
+   } else if( UseClosedFormSymmetricEigen( in )) {
+      ImageRefArray outar{ out };
+      DIP_STACK_TRACE_THIS( ClosedFormSymmetricEigen( in, outar, first ? SymmetricEigenOutput::LARGEST_VALUE
+                                                                       : SymmetricEigenOutput::SMALLEST_VALUE ));
    } else {
       dip::uint n = in.TensorRows();
       DataType intype = in.DataType();
@@ -675,22 +1059,9 @@ void SelectEigenvalue( Image const& in, Image& out, bool first ) {
       DataType outtype;
       std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
       if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
-         using funcType0 = void ( * )( ConstSampleIterator< dfloat >, SampleIterator< dfloat >, SampleIterator< dfloat > );
          using funcType = void ( * )( dip::uint, ConstSampleIterator< dfloat >, SampleIterator< dfloat >, SampleIterator< dfloat > );
-         switch( n ) {
-            case 2:
-               scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
-                     new SelectEigenvalueLineFilterN< dfloat, dfloat, funcType0 >( &SymmetricEigenDecomposition2, 2, first ));
-               break;
-            case 3:
-               scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
-                     new SelectEigenvalueLineFilterN< dfloat, dfloat, funcType0 >( &SymmetricEigenDecomposition3, 3, first ));
-               break;
-            default:
-               scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
-                     new SelectEigenvalueLineFilter< dfloat, dfloat, funcType >( &SymmetricEigenDecomposition, n, first ));
-               break;
-         }
+         scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
+               new SelectEigenvalueLineFilter< dfloat, dfloat, funcType >( &SymmetricEigenDecomposition, n, first ));
          inbuffertype = DT_DFLOAT;
          outbuffertype = DT_DFLOAT;
          outtype = DataType::SuggestFlex( intype );
@@ -736,6 +1107,12 @@ void EigenDecomposition( Image const& in, Image& out, Image& eigenvectors ) {
       //SortTensorElementsByMagnitude( in, out );
       //Identity( in, eigenvectors );
       // TODO: the `eigenvectors` have to be sorted in the same way as `out`.
+   } else if( UseClosedFormSymmetricEigen( in )) {
+      dip::uint n = in.TensorRows();
+      ImageRefArray outar{ out, eigenvectors };
+      DIP_STACK_TRACE_THIS( ClosedFormSymmetricEigen( in, outar, SymmetricEigenOutput::DECOMPOSITION ));
+      eigenvectors.ReshapeTensor( n, n );
+      out.ReshapeTensorAsDiagonal();
    } else {
       dip::uint n = in.TensorRows();
       DataType intype = in.DataType();
@@ -744,23 +1121,9 @@ void EigenDecomposition( Image const& in, Image& out, Image& eigenvectors ) {
       DataType outtype;
       std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
       if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
-         switch( n ) {
-            case 2:
-               scanLineFilter = NewTensorDyadicScanLineFilter< dfloat, dfloat >(
-                     []( auto const& pin, auto const& pout1, auto const& pout2 ) { SymmetricEigenDecomposition2( pin, pout1, pout2 ); }, 600 * n // cost of decomposition???
-               );
-               break;
-            case 3:
-               scanLineFilter = NewTensorDyadicScanLineFilter< dfloat, dfloat >(
-                     []( auto const& pin, auto const& pout1, auto const& pout2 ) { SymmetricEigenDecomposition3( pin, pout1, pout2 ); }, 600 * n // cost of decomposition???
-               );
-               break;
-            default:
-               scanLineFilter = NewTensorDyadicScanLineFilter< dfloat, dfloat >(
-                     [ n ]( auto const& pin, auto const& pout1, auto const& pout2 ) { SymmetricEigenDecomposition( n, pin, pout1, pout2 ); }, 600 * n // cost of decomposition???
-               );
-               break;
-         }
+         scanLineFilter = NewTensorDyadicScanLineFilter< dfloat, dfloat >(
+               [ n ]( auto const& pin, auto const& pout1, auto const& pout2 ) { SymmetricEigenDecomposition( n, pin, pout1, pout2 ); }, 600 * n // cost of decomposition???
+         );
          inbuffertype = outbuffertype = DT_DFLOAT;
          outtype = DataType::SuggestFlex( intype );
       } else {
@@ -790,6 +1153,11 @@ void LargestEigenVector( Image const& in, Image& out ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( in.TensorShape() != Tensor::Shape::SYMMETRIC_MATRIX, "The image is not a symmetric matrix" );
    DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   if( UseClosedFormSymmetricEigen( in )) {
+      ImageRefArray outar{ out };
+      DIP_STACK_TRACE_THIS( ClosedFormSymmetricEigen( in, outar, SymmetricEigenOutput::LARGEST_VECTOR ));
+      return;
+   }
    dip::uint n = in.TensorRows();
    DataType dataType = DataType::SuggestFlex( in.DataType() );
    std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
@@ -805,6 +1173,11 @@ void SmallestEigenVector( Image const& in, Image& out ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( in.TensorShape() != Tensor::Shape::SYMMETRIC_MATRIX, "The image is not a symmetric matrix" );
    DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   if( UseClosedFormSymmetricEigen( in )) {
+      ImageRefArray outar{ out };
+      DIP_STACK_TRACE_THIS( ClosedFormSymmetricEigen( in, outar, SymmetricEigenOutput::SMALLEST_VECTOR ));
+      return;
+   }
    dip::uint n = in.TensorRows();
    DataType dataType = DataType::SuggestFlex( in.DataType() );
    std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
@@ -1140,3 +1513,88 @@ void MeanTensorElement( Image const& in, Image& out ) {
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the closed-form symmetric eigendecomposition") {
+   for( dip::uint n = 2; n <= 3; ++n ) {
+      for( dip::DataType dt : { dip::DT_DFLOAT, dip::DT_SFLOAT } ) {
+         dip::uint nElem = n * ( n + 1 ) / 2;
+         dip::Image in( { 30, 20 }, nElem, dt );
+         in.ReshapeTensor( dip::Tensor( dip::Tensor::Shape::SYMMETRIC_MATRIX, n, n ));
+         in.Fill( 0 );
+         dip::Random random( 0 );
+         dip::UniformNoise( in, in, random, -10.0, 10.0 );
+         // Some special cases: zero, diagonal, repeated eigenvalues
+         in.At( 0, 0 ) = 0;
+         if( n == 2 ) {
+            in.At( 1, 0 ) = { 3, -1, 0 };
+            in.At( 2, 0 ) = { 2, 2, 0 };
+            in.At( 3, 0 ) = { 1, 1, 1 };
+         } else {
+            in.At( 1, 0 ) = { 3, -1, 5, 0, 0, 0 };
+            in.At( 2, 0 ) = { 2, 1, 1, 0, 0, 1 };    // eigenvalues 2, 2, 0
+            in.At( 3, 0 ) = { 1, 1, 1, 1, 1, 1 };    // eigenvalues 3, 0, 0
+            in.At( 4, 0 ) = { 1.0, 1.0, 1e-9, 1e-9, 0.0, 0.0 };
+         }
+         dip::Image lambdas;
+         dip::Image vectors;
+         dip::EigenDecomposition( in, lambdas, vectors );
+         dip::Image values = dip::Eigenvalues( in );
+         dip::Image largest = dip::LargestEigenvalue( in );
+         dip::Image smallest = dip::SmallestEigenvalue( in );
+         dip::Image largestVector = dip::LargestEigenVector( in );
+         dip::Image smallestVector = dip::SmallestEigenVector( in );
+         DOCTEST_CHECK( lambdas.DataType() == dt );
+         DOCTEST_CHECK( vectors.TensorRows() == n );
+         DOCTEST_CHECK( vectors.TensorColumns() == n );
+         dip::dfloat tolerance = dt == dip::DT_SFLOAT ? 1e-4 : 1e-10;
+         bool valuesOK = true;
+         bool vectorsOK = true;
+         for( dip::uint y = 0; y < 20; ++y ) {
+            for( dip::uint x = 0; x < 30; ++x ) {
+               dip::Image::Pixel pixel = in.At( x, y );
+               std::vector< dip::dfloat > matrix( n * n );
+               for( dip::uint ii = 0; ii < n; ++ii ) {
+                  for( dip::uint jj = 0; jj < n; ++jj ) {
+                     matrix[ ii + jj * n ] = pixel[ in.Tensor().Index( { ii, jj } ) ].As< dip::dfloat >();
+                  }
+               }
+               std::vector< dip::dfloat > expected( n );
+               dip::SymmetricEigenDecomposition( n, matrix.data(), expected.data() );
+               dip::dfloat scale = std::max( std::abs( expected[ 0 ] ), 1.0 );
+               for( dip::uint ii = 0; ii < n; ++ii ) {
+                  dip::dfloat lambda = lambdas.At( x, y )[ ii ].As< dip::dfloat >(); // diagonal matrix, only the diagonal is stored
+                  valuesOK &= std::abs( lambda - expected[ ii ] ) < tolerance * scale;
+                  valuesOK &= std::abs( values.At( x, y )[ ii ].As< dip::dfloat >() - lambda ) < tolerance * scale;
+                  // A v = lambda v, |v| = 1
+                  dip::dfloat norm = 0;
+                  for( dip::uint jj = 0; jj < n; ++jj ) {
+                     dip::dfloat Av = 0;
+                     for( dip::uint kk = 0; kk < n; ++kk ) {
+                        Av += matrix[ jj + kk * n ] * vectors.At( x, y )[ kk + ii * n ].As< dip::dfloat >();
+                     }
+                     dip::dfloat v = vectors.At( x, y )[ jj + ii * n ].As< dip::dfloat >();
+                     vectorsOK &= std::abs( Av - lambda * v ) < tolerance * scale * 10;
+                     norm += v * v;
+                  }
+                  vectorsOK &= std::abs( norm - 1.0 ) < tolerance;
+               }
+               valuesOK &= largest.At( x, y )[ 0 ].As< dip::dfloat >() == values.At( x, y )[ 0 ].As< dip::dfloat >();
+               valuesOK &= smallest.At( x, y )[ 0 ].As< dip::dfloat >() == values.At( x, y )[ n - 1 ].As< dip::dfloat >();
+               for( dip::uint jj = 0; jj < n; ++jj ) {
+                  vectorsOK &= largestVector.At( x, y )[ jj ].As< dip::dfloat >() == vectors.At( x, y )[ jj ].As< dip::dfloat >();
+                  vectorsOK &= smallestVector.At( x, y )[ jj ].As< dip::dfloat >() == vectors.At( x, y )[ jj + ( n - 1 ) * n ].As< dip::dfloat >();
+               }
+            }
+         }
+         DOCTEST_CHECK( valuesOK );
+         DOCTEST_CHECK( vectorsOK );
+      }
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
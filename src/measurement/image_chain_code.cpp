@@ -19,12 +19,14 @@
  */
 
 #include <array>
-#include <map>
+#include <atomic>
 
 #include "diplib.h"
 #include "diplib/chain_code.h"
 #include "diplib/regions.h"
 #include "diplib/overload.h"
+#include "diplib/multithreading.h"
+#include "../regions/label_map.h"
 
 namespace dip {
 
@@ -34,9 +36,6 @@ constexpr VertexInteger ChainCode::deltas8[8];
 
 namespace {
 
-struct ObjectData { dip::uint index; bool done; };
-using ObjectIdList = std::map< dip::uint, ObjectData >; // key is the objectID (label)
-
 template< typename TPI >
 static ChainCode dip__OneChainCode(
       void const* data_ptr,
@@ -94,45 +93,78 @@ static ChainCode dip__OneChainCode(
    return out;
 }
 
+// Finds the first pixel in raster order of each of the objects in `objectIndices`, and traces their contours.
+// The raster scan is split by rows over threads, each thread recording the first pixel it sees for each object.
+// The contours are traced concurrently, each thread writing to different elements of the output array.
 template< typename TPI >
 static ChainCodeArray dip__ChainCodes(
       Image const& labels,
-      ObjectIdList& objectIDs,
-      dip::uint nObjects, // potentially different from the number of entries in objectIDs, if there were repeated elements in the original list.
+      LabelMap< dip::uint > const& objectIndices, // maps a label to its index + 1, 0 for labels not requested
+      dip::uint nObjects, // potentially larger than the number of elements in objectIndices, if there were repeated elements in the original list.
       dip::uint connectivity,
       ChainCode::CodeTable const& codeTable
 ) {
    DIP_ASSERT( labels.DataType() == DataType( TPI( 0 ) ) );
-   TPI* data = static_cast< TPI* >( labels.Origin() );
+   TPI const* data = static_cast< TPI const* >( labels.Origin() );
    ChainCodeArray ccArray( nObjects );  // output array
+   if( nObjects == 0 ) {
+      return ccArray;
+   }
    VertexInteger dims = { static_cast< dip::sint >( labels.Size( 0 ) - 1 ), static_cast< dip::sint >( labels.Size( 1 ) - 1 ) }; // our local copy of `dims` now contains the largest coordinates
    IntegerArray const& strides = labels.Strides();
+   dip::uint width = labels.Size( 0 );
+   dip::uint height = labels.Size( 1 );
+   constexpr dip::uint notFound = std::numeric_limits< dip::uint >::max();
 
-   // Find first pixel of requested label
-   dip::uint label = 0;
-   VertexInteger coord;
-   for( coord.y = 0; coord.y <= dims.y; ++coord.y ) {
-      dip::sint pos = coord.y * strides[ 1 ];
-      for( coord.x = 0; coord.x <= dims.x; ++coord.x ) {
-         bool process = false;
-         dip::uint index = 0;
-         dip::uint newlabel = data[ pos ];
-         if( ( newlabel != 0 ) && ( newlabel != label ) ) {
-            // Check whether newlabel is start of not processed object
-            auto it = objectIDs.find( newlabel );
-            if( ( it != objectIDs.end() ) && !it->second.done ) {
-               it->second.done = true;
-               index = it->second.index;
+   dip::uint nThreads = 1;
+   if( width * height * 2 >= threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), height );
+   }
+
+   // Find first pixel of each requested label, as a linear index y * width + x
+   std::vector< std::vector< dip::uint >> startPixels( nThreads ); // one for each thread
+   ParallelFor( nThreads, [ & ]( dip::uint thread ) {
+      std::vector< dip::uint >& start = startPixels[ thread ];
+      start.resize( nObjects, notFound );
+      for( dip::uint y = height * thread / nThreads; y < height * ( thread + 1 ) / nThreads; ++y ) {
+         TPI const* ptr = data + static_cast< dip::sint >( y ) * strides[ 1 ];
+         dip::uint label = 0;
+         for( dip::uint x = 0; x < width; ++x, ptr += strides[ 0 ] ) {
+            dip::uint newlabel = *ptr;
+            if(( newlabel != 0 ) && ( newlabel != label )) {
                label = newlabel;
-               process = true;
+               dip::uint index = objectIndices.Get( label );
+               if(( index > 0 ) && ( start[ index - 1 ] == notFound )) {
+                  start[ index - 1 ] = y * width + x;
+               }
             }
          }
-         if( process ) {
-            ccArray[ index ] = dip__OneChainCode< TPI >( data + pos, coord, dims, connectivity, codeTable, true );
-         }
-         pos += strides[ 0 ];
+      }
+   } );
+   // Merge the results of all threads
+   std::vector< dip::uint >& start = startPixels[ 0 ];
+   for( dip::uint ii = 1; ii < nThreads; ++ii ) {
+      for( dip::uint jj = 0; jj < nObjects; ++jj ) {
+         start[ jj ] = std::min( start[ jj ], startPixels[ ii ][ jj ] );
       }
    }
+
+   // Trace the contours, the threads take blocks of 16 objects at the time
+   constexpr dip::uint blockSize = 16;
+   nThreads = std::min( nThreads, nObjects );
+   std::atomic< dip::uint > nextObject{ 0 };
+   ParallelFor( nThreads, [ & ]( dip::uint ) {
+      for( dip::uint first = nextObject.fetch_add( blockSize ); first < nObjects; first = nextObject.fetch_add( blockSize )) {
+         for( dip::uint ii = first; ii < std::min( first + blockSize, nObjects ); ++ii ) {
+            dip::uint pixel = start[ ii ];
+            if( pixel != notFound ) {
+               VertexInteger coord = { static_cast< dip::sint >( pixel % width ), static_cast< dip::sint >( pixel / width ) };
+               TPI const* ptr = data + coord.x * strides[ 0 ] + coord.y * strides[ 1 ];
+               ccArray[ ii ] = dip__OneChainCode< TPI >( ptr, coord, dims, connectivity, codeTable, true );
+            }
+         }
+      }
+   } );
    return ccArray;
 }
 
@@ -151,26 +183,24 @@ ChainCodeArray GetImageChainCodes(
    // Initialize freeman codes
    ChainCode::CodeTable codeTable = ChainCode::PrepareCodeTable( connectivity, labels.Strides() );
 
-   // Create a map for the object IDs
-   ObjectIdList objectIdList;
-   dip::uint nObjects;
+   // Create a look-up table for the object IDs
+   UnsignedArray allObjectIDs;
    if( objectIDs.empty() ) {
-      UnsignedArray allObjectIDs = GetObjectLabels( labels, Image(), S::EXCLUDE );
-      for( dip::uint ii = 0; ii < allObjectIDs.size(); ++ii ) {
-         objectIdList.emplace( allObjectIDs[ ii ], ObjectData{ ii, false } );
-      }
-      nObjects = allObjectIDs.size();
-   } else {
-      for( dip::uint ii = 0; ii < objectIDs.size(); ++ii ) {
-         objectIdList.emplace( objectIDs[ ii ], ObjectData{ ii, false } );
+      allObjectIDs = GetObjectLabels( labels, Image(), S::EXCLUDE );
+   }
+   UnsignedArray const& ids = objectIDs.empty() ? allObjectIDs : objectIDs;
+   LabelMap< dip::uint > objectIndices;
+   for( dip::uint ii = 0; ii < ids.size(); ++ii ) {
+      dip::uint& index = objectIndices[ ids[ ii ]];
+      if( index == 0 ) { // If a label is repeated, we use the first one
+         index = ii + 1;
       }
-      nObjects = objectIDs.size();
    }
 
    // Get the chain code for each label
    ChainCodeArray ccArray;
    DIP_OVL_CALL_ASSIGN_UINT( ccArray,
-                             dip__ChainCodes, ( labels, objectIdList, nObjects, connectivity, codeTable ),
+                             dip__ChainCodes, ( labels, objectIndices, ids.size(), connectivity, codeTable ),
                              labels.DataType() );
    return ccArray;
 }
@@ -311,4 +341,47 @@ DOCTEST_TEST_CASE("[DIPlib] testing ChainCode::Offset") {
    }
 }
 
+#include "diplib/generation.h"
+#include "diplib/multithreading.h"
+#include "diplib/linear.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing GetImageChainCodes") {
+   // A label image with many objects, some of which touch the image edge
+   dip::Image img( { 300, 200 }, 1, dip::DT_SFLOAT );
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::GaussianNoise( img, img, random, 1.0 );
+   img = dip::Gauss( img, { 3 } ) > 0;
+   dip::Image labels = dip::Label( img, 2 );
+   dip::UnsignedArray ids = dip::GetObjectLabels( labels, {}, dip::S::EXCLUDE );
+   DOCTEST_REQUIRE( ids.size() > 10 );
+   // The first pixel in raster order of each object
+   std::vector< dip::VertexInteger > start( ids.size() + 1, { -1, -1 } );
+   for( dip::sint y = 199; y >= 0; --y ) {
+      for( dip::sint x = 299; x >= 0; --x ) {
+         start[ static_cast< dip::uint >( labels.At( static_cast< dip::uint >( x ), static_cast< dip::uint >( y )).As< dip::uint >() ) ] = { x, y };
+      }
+   }
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::ChainCodeArray ref = dip::GetImageChainCodes( labels, {}, 2 );
+   DOCTEST_REQUIRE( ref.size() == ids.size() );
+   for( dip::uint ii = 0; ii < ref.size(); ++ii ) {
+      DOCTEST_CHECK( ref[ ii ].objectID == ids[ ii ] );
+      DOCTEST_CHECK( ref[ ii ].start == start[ ids[ ii ]] );
+   }
+   // Multithreaded, with a repeated label and a label that is not in the image
+   dip::SetNumberOfThreads( 4 );
+   dip::ChainCodeArray out = dip::GetImageChainCodes( labels, { ids[ 5 ], 100000, ids[ 3 ], ids[ 5 ] }, 2 );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_REQUIRE( out.size() == 4 );
+   DOCTEST_CHECK( out[ 0 ].objectID == ids[ 5 ] );
+   DOCTEST_CHECK( out[ 0 ].start == ref[ 5 ].start );
+   DOCTEST_CHECK( out[ 0 ].codes.size() == ref[ 5 ].codes.size() );
+   DOCTEST_CHECK( out[ 1 ].codes.empty() );
+   DOCTEST_CHECK( out[ 2 ].objectID == ids[ 3 ] );
+   DOCTEST_CHECK( out[ 2 ].codes.size() == ref[ 3 ].codes.size() );
+   DOCTEST_CHECK( out[ 3 ].codes.empty() );
+}
+
 #endif // DIP__ENABLE_DOCTEST
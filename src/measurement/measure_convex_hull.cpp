@@ -147,6 +147,92 @@ FeretValues ConvexHull::Feret() const {
    return feret;
 }
 
+BoundingRectangle ConvexHull::MinimumBoundingRectangle() const {
+
+   BoundingRectangle rect;
+
+   auto const& vertices = Vertices();
+   dip::uint n = vertices.size();
+
+   if( n < 3 ) {
+      // Nothing to do, give some meaningful values
+      if( n == 2 ) {
+         rect.center = ( vertices[ 0 ] + vertices[ 1 ] ) / 2.0;
+         rect.length = Distance( vertices[ 0 ], vertices[ 1 ] );
+         rect.angle = Angle( vertices[ 0 ], vertices[ 1 ] );
+      } else if( n == 1 ) {
+         rect.center = vertices[ 0 ];
+      }
+   } else {
+      // Rotating calipers: for each edge `ii` of the hull we find the vertex furthest along the edge (`jj`),
+      // the vertex furthest away from the edge (`kk`), and the vertex furthest back along the edge (`ll`).
+      // These three indices only ever move forward as we walk along the edges, so the whole process is O(n).
+      // The indices are not taken modulo `n`, so that we can easily enforce their order.
+      dip::uint jj = 1;
+      dip::uint kk = 1;
+      dip::uint ll = 1;
+      dfloat minArea = std::numeric_limits< dfloat >::max();
+      for( dip::uint ii = 0; ii < n; ++ii ) {
+         VertexFloat const& origin = vertices[ ii ];
+         VertexFloat edge = vertices[ ( ii + 1 ) % n ] - origin;
+         dfloat edgeLength = Norm( edge );
+         if( edgeLength == 0.0 ) {
+            continue; // Repeated vertex
+         }
+         VertexFloat unit = edge / edgeLength;
+         auto Projection = [ & ]( dip::uint index ) {
+            VertexFloat v = vertices[ index % n ] - origin;
+            return v.x * unit.x + v.y * unit.y;
+         };
+         auto Height = [ & ]( dip::uint index ) {
+            return std::abs( CrossProduct( unit, vertices[ index % n ] - origin ));
+         };
+         jj = std::max( jj, ii + 1 );
+         while(( jj + 1 < ii + n ) && ( Projection( jj + 1 ) >= Projection( jj ))) {
+            ++jj;
+         }
+         kk = std::max( kk, jj );
+         while(( kk + 1 < ii + n ) && ( Height( kk + 1 ) >= Height( kk ))) {
+            ++kk;
+         }
+         ll = std::max( ll, kk );
+         while(( ll + 1 <= ii + n ) && ( Projection( ll + 1 ) <= Projection( ll ))) {
+            ++ll;
+         }
+         dfloat maxProjection = Projection( jj );
+         dfloat minProjection = Projection( ll );
+         dfloat height = Height( kk );
+         dfloat area = ( maxProjection - minProjection ) * height;
+         if( area < minArea ) {
+            minArea = area;
+            // The normal to the edge, pointing towards the inside of the hull
+            VertexFloat normal{ -unit.y, unit.x };
+            if( CrossProduct( unit, vertices[ kk % n ] - origin ) < 0 ) {
+               normal *= -1.0;
+            }
+            rect.center = origin + unit * (( maxProjection + minProjection ) / 2.0 ) + normal * ( height / 2.0 );
+            rect.length = maxProjection - minProjection;
+            rect.width = height;
+            rect.angle = std::atan2( unit.y, unit.x );
+            if( rect.width > rect.length ) {
+               std::swap( rect.length, rect.width );
+               rect.angle += pi / 2.0;
+            }
+         }
+      }
+   }
+
+   // Bring the angle to the range [0,pi)
+   while( rect.angle < 0.0 ) {
+      rect.angle += pi;
+   }
+   while( rect.angle >= pi ) {
+      rect.angle -= pi;
+   }
+
+   return rect;
+}
+
 
 } // namespace dip
 
@@ -192,6 +278,31 @@ DOCTEST_TEST_CASE("[DIPlib] testing chain code polygons") {
    DOCTEST_CHECK( h.Area() == doctest::Approx( 1 ));
    DOCTEST_CHECK( h.Perimeter() == doctest::Approx( 4 ));
    DOCTEST_CHECK( h.IsClockWise() );
+   auto r = h.MinimumBoundingRectangle();
+   DOCTEST_CHECK( r.Area() == doctest::Approx( 1 ));
+   DOCTEST_CHECK( r.center.x == doctest::Approx( 0.5 ));
+   DOCTEST_CHECK( r.center.y == doctest::Approx( 0.5 ));
+
+   // A rotated rectangle with some points inside
+   p.vertices = {{ 0, 0 }, { 3, 4 }, { 6, 8 }, { 2, 11 }, { 1, 5 }, { -4, 3 }, { -2, 1.5 }};
+   h = p.ConvexHull();
+   DOCTEST_CHECK( h.Vertices().size() == 4 );
+   r = h.MinimumBoundingRectangle();
+   DOCTEST_CHECK( r.length == doctest::Approx( 10 ));
+   DOCTEST_CHECK( r.width == doctest::Approx( 5 ));
+   DOCTEST_CHECK( r.angle == doctest::Approx( std::atan2( 4, 3 )));
+   DOCTEST_CHECK( r.center.x == doctest::Approx( 1 ));
+   DOCTEST_CHECK( r.center.y == doctest::Approx( 5.5 ));
+   f = h.Feret();
+   DOCTEST_CHECK( f.minDiameter == doctest::Approx( 5 ));
+   DOCTEST_CHECK( f.maxPerpendicular == doctest::Approx( 10 ));
+
+   // The little square from above: the rectangle is axis-aligned, not along the diagonal
+   cc.codes = { 0, 6, 4, 2 };
+   r = cc.ConvexHull().MinimumBoundingRectangle();
+   DOCTEST_CHECK( r.Area() == doctest::Approx( 4 ));
+   DOCTEST_CHECK( r.length == doctest::Approx( 2 ));
+   DOCTEST_CHECK( r.width == doctest::Approx( 2 ));
 }
 
 #endif // DIP__ENABLE_DOCTEST
@@ -18,12 +18,15 @@
  * limitations under the License.
  */
 
+#include <atomic>
+
 #include "diplib.h"
 #include "diplib/measurement.h"
 #include "diplib/iterators.h"
 #include "diplib/chain_code.h"
 #include "diplib/framework.h"
 #include "diplib/regions.h"
+#include "diplib/multithreading.h"
 
 // FEATURES:
 // Size
@@ -297,30 +300,58 @@ Measurement MeasurementTool::Measure(
    // Let the chaincode based functions do their work
    if( doChaincodeBased || doPolygonBased || doConvHullBased ) {
       ChainCodeArray chainCodeArray = GetImageChainCodes( label, measurement.Objects(), connectivity );
-      auto itCC = chainCodeArray.begin();
-      auto itObj = measurement.FirstObject(); // these two arrays are ordered the same way
-      do {
-         Polygon polygon;
-         ConvexHull convexHull;
-         if( doPolygonBased || doConvHullBased ) {
-            polygon = itCC->Polygon();
-         }
-         if( doConvHullBased ) {
-            convexHull = polygon.ConvexHull();
+      // Find the first column for each of the features, so we can write directly into the table
+      std::vector< std::pair< Feature::Base*, dip::sint >> objectFeatures;
+      for( auto const& feature : featureArray ) {
+         if(( feature->type == Feature::Type::CHAINCODE_BASED ) ||
+            ( feature->type == Feature::Type::POLYGON_BASED ) ||
+            ( feature->type == Feature::Type::CONVEXHULL_BASED )) {
+            objectFeatures.emplace_back( feature, static_cast< dip::sint >( measurement.ValueIndex( feature->information.name )));
          }
-         for( auto const& feature : featureArray ) {
-            if( feature->type == Feature::Type::CHAINCODE_BASED ) {
-               auto cell = itObj[ feature->information.name ];
-               dynamic_cast< Feature::ChainCodeBased* >( feature )->Measure( *itCC, cell.data() );
-            } else if( feature->type == Feature::Type::POLYGON_BASED ) {
-               auto cell = itObj[ feature->information.name ];
-               dynamic_cast< Feature::PolygonBased* >( feature )->Measure( polygon, cell.data() );
-            } else if( feature->type == Feature::Type::CONVEXHULL_BASED ) {
-               auto cell = itObj[ feature->information.name ];
-               dynamic_cast< Feature::ConvexHullBased* >( feature )->Measure( convexHull, cell.data() );
+      }
+      Measurement::ValueIterator data = measurement.Data();
+      dip::sint stride = measurement.Stride();
+      dip::uint nObjects = measurement.NumberOfObjects(); // the chain codes are ordered the same way as the objects
+      // Each object is processed independently, and writes only to its own row of the table. The threads take
+      // blocks of 16 objects at the time.
+      dip::uint nThreads = 1;
+      if( label.NumberOfPixels() * objectFeatures.size() >= threadingThreshold ) {
+         nThreads = std::min( GetNumberOfThreads(), nObjects );
+      }
+      constexpr dip::uint blockSize = 16;
+      std::atomic< dip::uint > nextObject{ 0 };
+      ParallelFor( nThreads, [ & ]( dip::uint ) {
+         for( dip::uint first = nextObject.fetch_add( blockSize ); first < nObjects; first = nextObject.fetch_add( blockSize )) {
+            for( dip::uint ii = first; ii < std::min( first + blockSize, nObjects ); ++ii ) {
+               ChainCode const& chainCode = chainCodeArray[ ii ];
+               Measurement::ValueIterator row = data + static_cast< dip::sint >( ii ) * stride;
+               Polygon polygon;
+               ConvexHull convexHull;
+               if( doPolygonBased || doConvHullBased ) {
+                  polygon = chainCode.Polygon();
+               }
+               if( doConvHullBased ) {
+                  convexHull = polygon.ConvexHull();
+               }
+               for( auto const& feature : objectFeatures ) {
+                  Measurement::ValueIterator cell = row + feature.second;
+                  switch( feature.first->type ) {
+                     case Feature::Type::CHAINCODE_BASED:
+                        static_cast< Feature::ChainCodeBased* >( feature.first )->Measure( chainCode, cell );
+                        break;
+                     case Feature::Type::POLYGON_BASED:
+                        static_cast< Feature::PolygonBased* >( feature.first )->Measure( polygon, cell );
+                        break;
+                     case Feature::Type::CONVEXHULL_BASED:
+                        static_cast< Feature::ConvexHullBased* >( feature.first )->Measure( convexHull, cell );
+                        break;
+                     default:
+                        break;
+                  }
+               }
             }
          }
-      } while( ++itCC, ++itObj );
+      } );
    }
 
    // Let the composite functions do their work
@@ -345,3 +376,39 @@ Measurement MeasurementTool::Measure(
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/linear.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the MeasurementTool with multiple threads") {
+   dip::Image img( { 300, 200 }, 1, dip::DT_SFLOAT );
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::GaussianNoise( img, img, random, 1.0 );
+   img = dip::Gauss( img, { 3 } ) > 0;
+   dip::Image label = dip::Label( img, 2 );
+   dip::MeasurementTool tool;
+   dip::StringArray features{ "Perimeter", "Feret", "ConvexArea", "SolidArea", "Radius", "BendingEnergy" };
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Measurement ref = tool.Measure( label, {}, features );
+   dip::SetNumberOfThreads( 4 );
+   dip::Measurement msr = tool.Measure( label, {}, features );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_REQUIRE( msr.NumberOfObjects() == ref.NumberOfObjects() );
+   DOCTEST_REQUIRE( msr.NumberOfValues() == ref.NumberOfValues() );
+   DOCTEST_CHECK( msr.NumberOfObjects() > 10 );
+   dip::uint n = msr.NumberOfObjects() * msr.NumberOfValues();
+   dip::uint errors = 0;
+   for( dip::uint ii = 0; ii < n; ++ii ) {
+      if( msr.Data()[ ii ] != ref.Data()[ ii ] ) {
+         ++errors;
+      }
+   }
+   DOCTEST_CHECK( errors == 0 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
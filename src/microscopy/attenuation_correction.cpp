@@ -1066,54 +1066,49 @@ void SimulatedAttenuation(
    dip::sint depth = static_cast< dip::sint >( fIn.Size( 2 ));
    dip::uint rad = 2 * static_cast< dip::uint >( zxratio * static_cast< dfloat >( depth - 1 ) * std::tan( theta )) + 1;
 
-#ifdef _OPENMP
-   dip::uint nThreads = std::min( GetNumberOfThreads(), fIn.Size( 2 ) /* ==depth */ );
-#endif
-   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
-   {
+   // Each slice is independent of the others
+   ParallelFor( static_cast< dip::uint >( depth - 1 ), [ & ]( dip::uint slice ) {
+      dip::sint z = static_cast< dip::sint >( slice ) + 1;
       FloatArray cosine( rad * rad );
-      #pragma omp for schedule( dynamic, 1 )
-      for( dip::sint z = 1; z < depth; ++z ) {
-         dip::sint radius;
-         sfloat norm_cos, norm_cossq;
-         std::tie( radius, norm_cos, norm_cossq ) = AttSimDrawLightCone( cosine, zxratio, theta, z );
-         for( dip::sint y = 0; y < height; ++y ) {
-            for( dip::sint x = 0; x < width; ++x ) {
-               dip::sint srcPos = x * fIn.Stride( 0 ) + y * fIn.Stride( 1 ) + z * fIn.Stride( 2 );
-               dip::sint dstPos = x * fOut.Stride( 0 ) + y * fOut.Stride( 1 ) + z * fOut.Stride( 2 );
-               if( src[ srcPos ] != 0.0 ) {
-                  sfloat g1 = 0.0;
-                  sfloat g2 = 0.0;
-                  for( dip::sint yy = -radius; yy <= radius; ++yy ) {
-                     for( dip::sint xx = -radius; xx <= radius; ++xx ) {
-                        dfloat factor = cosine[ static_cast< dip::uint >( xx + radius + ( yy + radius ) * ( 2 * radius + 1 )) ];
-                        if( factor != 0.0 ) {
-                           Vector vecStart{
-                                 static_cast< dfloat >( x + xx ),
-                                 static_cast< dfloat >( y + yy ),
-                                 0.0,
-                           };
-                           Vector vecEnd{
-                                 static_cast< dfloat >( x ),
-                                 static_cast< dfloat >( y ),
-                                 static_cast< dfloat >( z ) * zxratio,
-                           };
-                           dfloat rayTotal = AttSimArbTrace( vecStart, vecEnd, src, width - 1, height - 1, fIn.Strides(), interArr, zxratio, pixAdd, trace );
-                           g1 += static_cast< sfloat >( factor * factor * std::exp( fAttenuation * rayTotal ));
-                           g2 += static_cast< sfloat >( factor * std::exp( bAttenuation * rayTotal ));
-                        }
+      dip::sint radius;
+      sfloat norm_cos, norm_cossq;
+      std::tie( radius, norm_cos, norm_cossq ) = AttSimDrawLightCone( cosine, zxratio, theta, z );
+      for( dip::sint y = 0; y < height; ++y ) {
+         for( dip::sint x = 0; x < width; ++x ) {
+            dip::sint srcPos = x * fIn.Stride( 0 ) + y * fIn.Stride( 1 ) + z * fIn.Stride( 2 );
+            dip::sint dstPos = x * fOut.Stride( 0 ) + y * fOut.Stride( 1 ) + z * fOut.Stride( 2 );
+            if( src[ srcPos ] != 0.0 ) {
+               sfloat g1 = 0.0;
+               sfloat g2 = 0.0;
+               for( dip::sint yy = -radius; yy <= radius; ++yy ) {
+                  for( dip::sint xx = -radius; xx <= radius; ++xx ) {
+                     dfloat factor = cosine[ static_cast< dip::uint >( xx + radius + ( yy + radius ) * ( 2 * radius + 1 )) ];
+                     if( factor != 0.0 ) {
+                        Vector vecStart{
+                              static_cast< dfloat >( x + xx ),
+                              static_cast< dfloat >( y + yy ),
+                              0.0,
+                        };
+                        Vector vecEnd{
+                              static_cast< dfloat >( x ),
+                              static_cast< dfloat >( y ),
+                              static_cast< dfloat >( z ) * zxratio,
+                        };
+                        dfloat rayTotal = AttSimArbTrace( vecStart, vecEnd, src, width - 1, height - 1, fIn.Strides(), interArr, zxratio, pixAdd, trace );
+                        g1 += static_cast< sfloat >( factor * factor * std::exp( fAttenuation * rayTotal ));
+                        g2 += static_cast< sfloat >( factor * std::exp( bAttenuation * rayTotal ));
                      }
                   }
-                  g1 /= norm_cossq;
-                  g2 /= norm_cos;
-                  dst[ dstPos ] = src[ srcPos ] * g1 * g2;
-               } else {
-                  dst[ dstPos ] = 0.0;
                }
+               g1 /= norm_cossq;
+               g2 /= norm_cos;
+               dst[ dstPos ] = src[ srcPos ] * g1 * g2;
+            } else {
+               dst[ dstPos ] = 0.0;
             }
          }
       }
-   }
+   } );
    // Copy data over to `out` if `out` wasn't DT_SFLOAT
    if( fOut.Origin() != out.Origin() ) {
       out.Copy( fOut );
@@ -18,6 +18,8 @@
  * limitations under the License.
  */
 
+#include <atomic>
+
 #include "diplib.h"
 #include "diplib/nonlinear.h"
 #include "diplib/linear.h"
@@ -26,6 +28,8 @@
 #include "diplib/generic_iterators.h"
 #include "diplib/pixel_table.h"
 #include "diplib/overload.h"
+#include "diplib/multithreading.h"
+#include "summed_area_table.h"
 
 namespace dip {
 
@@ -100,30 +104,20 @@ class SelectionLineFilter : public SelectionLineFilterBase {
       }
 };
 
-} // namespace
-
-void SelectionFilter(
+void PixelTableSelectionFilter(
       Image const& c_in,
       Image const& c_control,
       Image& out,
       Kernel const& kernel,
       dfloat threshold,
-      String const& mode,
-      StringArray const& boundaryCondition
+      bool minimum,
+      BoundaryConditionArray const& bc
 ) {
    // We are not using a framework here, because this is the only pixel table filter that uses two input images.
    // So we've copied things over from Framework::Full, and changed (simplified) them a bit. There's no multi-threading
    // here yet.
    // TODO: add multithreading.
 
-   DIP_THROW_IF( !c_in.IsForged() || !c_control.IsForged(), E::IMAGE_NOT_FORGED );
-   DIP_THROW_IF( c_in.Sizes() != c_control.Sizes(), E::SIZES_DONT_MATCH );
-   DIP_THROW_IF( !c_control.IsScalar(), E::IMAGE_NOT_SCALAR );
-   DIP_THROW_IF( !c_control.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
-   DIP_THROW_IF( kernel.HasWeights(), E::KERNEL_NOT_BINARY );
-   bool minimum;
-   DIP_STACK_TRACE_THIS( minimum = BooleanFromString( mode, S::MINIMUM, S::MAXIMUM ));
-
    // Determine boundary sizes
    UnsignedArray kernelSizes;
    DIP_STACK_TRACE_THIS( kernelSizes = kernel.Sizes( c_in.Dimensionality() ));
@@ -135,7 +129,6 @@ void SelectionFilter(
    control.SetDataType( DT_DFLOAT );
    control.Protect();
    DIP_START_STACK_TRACE
-      BoundaryConditionArray bc = StringArrayToBoundaryConditionArray( boundaryCondition );
       ExtendImage( c_in, in, boundary, bc, Option::ExtendImage::Masked );
       ExtendImage( c_control, control, boundary, bc, Option::ExtendImage::Masked );
    DIP_END_STACK_TRACE
@@ -197,6 +190,307 @@ void SelectionFilter(
    } while( ++it );
 }
 
+// The best candidate found so far for a pixel: its control value, its square distance to the
+// pixel, and its offset w.r.t. the pixel (in samples of the control image).
+struct SelectionCandidate {
+   dfloat value;
+   dip::uint distance;
+   dip::sint offset;
+};
+
+struct GatherLineFilterParameters {
+   void const* inBuffer;
+   dfloat const* controlBuffer;
+   SelectionCandidate const* candidate;
+   void* outBuffer;
+   dip::sint inStride;
+   dip::sint inTensorStride; // == 1
+   dip::sint controlStride;
+   dip::sint outStride;
+   dip::sint outTensorStride;
+   dip::uint tensorLength;
+   dip::uint bufferLength;
+   dfloat threshold;
+   bool minimum;
+};
+
+class GatherLineFilterBase {
+   public:
+      virtual void Filter( GatherLineFilterParameters const& params ) = 0;
+      virtual ~GatherLineFilterBase() {};
+};
+
+template< typename TPI >
+class GatherLineFilter : public GatherLineFilterBase {
+   public:
+      virtual void Filter( GatherLineFilterParameters const& params ) override {
+         TPI const* in = static_cast< TPI const* >( params.inBuffer );
+         dfloat const* control = params.controlBuffer;
+         SelectionCandidate const* candidate = params.candidate;
+         TPI* out = static_cast< TPI* >( params.outBuffer );
+         for( dip::uint ii = 0; ii < params.bufferLength; ++ii ) {
+            dip::sint bestOffset = 0;
+            if( params.minimum ? candidate->value + params.threshold < *control
+                               : candidate->value - params.threshold > *control ) {
+               bestOffset = candidate->offset * static_cast< dip::sint >( params.tensorLength );
+            }
+            out[ 0 ] = in[ bestOffset ];
+            for( dip::sint jj = 1; jj < static_cast< dip::sint >( params.tensorLength ); ++jj ) {
+               out[ jj * params.outTensorStride ] = in[ bestOffset + jj * params.inTensorStride ];
+            }
+            in += params.inStride;
+            control += params.controlStride;
+            candidate += params.controlStride;
+            out += params.outStride;
+         }
+      }
+};
+
+// Calls `function( index )` for each image line along `dim` within the box `[ start, stop )`, where
+// `index` is the linear index of the first pixel of the line, given `strides`.
+template< typename F >
+void ForEachLine(
+      UnsignedArray const& start,
+      UnsignedArray const& stop,
+      IntegerArray const& strides,
+      dip::uint dim,
+      F const& function
+) {
+   dip::uint nDims = start.size();
+   UnsignedArray coords = start;
+   dip::sint index = 0;
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      index += static_cast< dip::sint >( start[ ii ] ) * strides[ ii ];
+   }
+   while( true ) {
+      function( index );
+      dip::uint ii = 0;
+      for( ; ii < nDims; ++ii ) {
+         if( ii == dim ) {
+            continue;
+         }
+         ++coords[ ii ];
+         index += strides[ ii ];
+         if( coords[ ii ] < stop[ ii ] ) {
+            break;
+         }
+         index -= static_cast< dip::sint >( coords[ ii ] - start[ ii ] ) * strides[ ii ];
+         coords[ ii ] = start[ ii ];
+      }
+      if( ii == nDims ) {
+         break;
+      }
+   }
+}
+
+// The number of pixels in a slab that we aim for, slabs are taller if the kernel is.
+constexpr dip::uint selectionSlabPixels = 1u << 16;
+
+// For a rectangular kernel, the selection can be made separably: the best candidate along each row of the kernel
+// is found first, then the best of these candidates along each column, etc. This is exact because the square
+// distance to the central pixel is the sum of the square distances along each dimension. The cost is proportional
+// to the sum of the kernel sizes, rather than the product.
+//
+// The image is processed in slabs along the last dimension, in parallel. The candidates are only stored for
+// the pixels of one slab (plus the kernel's extent) at the time.
+void RectangularSelectionFilter(
+      Image const& c_in,
+      Image const& c_control,
+      Image& out,
+      Kernel const& kernel,
+      dfloat threshold,
+      bool minimum,
+      BoundaryConditionArray const& bc
+) {
+   UnsignedArray sizes = c_in.Sizes();
+   dip::uint nDims = sizes.size();
+   detail::KernelBox box;
+   DIP_STACK_TRACE_THIS( box = detail::RectangularKernelBox( kernel, nDims ));
+   UnsignedArray boundary = box.Boundary();
+
+   // Copy input images with boundary extension
+   Image in;
+   Image control;
+   control.SetDataType( DT_DFLOAT );
+   control.Protect();
+   DIP_START_STACK_TRACE
+      ExtendImage( c_in, in, boundary, bc );
+      ExtendImage( c_control, control, boundary, bc );
+   DIP_END_STACK_TRACE
+   // We have created a new `in` and `control`, so we expect normal strides here.
+   DIP_ASSERT( control.HasNormalStrides() );
+   DIP_ASSERT( in.TensorStride() == 1 );
+#ifdef DIP__ENABLE_ASSERT
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      DIP_ASSERT( in.Stride( ii ) == control.Stride( ii ) * static_cast< dip::sint >( in.TensorElements() ));
+   }
+#endif
+   UnsignedArray const& extSizes = control.Sizes();
+   IntegerArray const& strides = control.Strides();
+   RangeArray window( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      window[ ii ] = Range{ static_cast< dip::sint >( boundary[ ii ] ), -static_cast< dip::sint >( boundary[ ii ] ) - 1 };
+   }
+
+   // Adjust output if necessary (and possible)
+   // NOTE: Don't use c_in any more from here on. It has possibly been reforged!
+   DIP_START_STACK_TRACE
+      out.ReForge( sizes, in.TensorElements(), in.DataType(), Option::AcceptDataTypeChange::DONT_ALLOW );
+      out.ReshapeTensor( in.Tensor() );
+      out.SetPixelSize( in.PixelSize() );
+      if( in.IsColor() ) {
+         out.SetColorSpace( in.ColorSpace() );
+      }
+   DIP_END_STACK_TRACE
+
+   // Get the line filter of the right type
+   std::unique_ptr< GatherLineFilterBase > lineFilter;
+   DIP_OVL_NEW_ALL( lineFilter, GatherLineFilter, (), in.DataType() );
+   Image inView = in.At( window );
+   Image controlView = control.At( window );
+   dfloat const* controlData = static_cast< dfloat const* >( control.Origin() );
+
+   // Split the image into slabs along the last dimension
+   dip::uint lastDim = nDims - 1;
+   dip::uint length = sizes[ lastDim ];
+   dip::uint crossSection = static_cast< dip::uint >( strides[ lastDim ] );
+   dip::uint operations = sizes.product() * ( 4 * box.sizes.sum() + 3 * in.TensorElements() );
+   dip::uint nThreads = GetThreadingCostModel().NumberOfThreads( operations, GetNumberOfThreads() );
+   dip::uint slabLength = std::max( selectionSlabPixels / crossSection, box.sizes[ lastDim ] );
+   slabLength = clamp( slabLength, dip::uint( 1 ), div_ceil( length, nThreads ));
+   dip::uint nSlabs = div_ceil( length, slabLength );
+   nThreads = std::min( nThreads, nSlabs );
+
+   std::atomic< dip::uint > nextSlab( 0 );
+   DIP_START_STACK_TRACE
+      ParallelFor( nThreads, [ & ]( dip::uint ) {
+         std::vector< SelectionCandidate > previous;
+         std::vector< SelectionCandidate > current;
+         dip::uint slab;
+         while(( slab = nextSlab.fetch_add( 1 )) < nSlabs ) {
+            dip::uint slabBegin = slab * slabLength;
+            dip::uint slabEnd = std::min( slabBegin + slabLength, length );
+            // The candidates are stored for the rows `[ slabBegin, slabEnd + 2 * boundary )` of the extended
+            // image along the last dimension, which contain the kernels for all pixels in the slab.
+            dip::sint base = static_cast< dip::sint >( slabBegin * crossSection );
+            dip::uint bufferSize = ( slabEnd - slabBegin + 2 * boundary[ lastDim ] ) * crossSection;
+            previous.resize( bufferSize );
+            current.resize( bufferSize );
+
+            // Find the best candidate one dimension at a time. After processing dimension `dd`, the candidates are
+            // valid for all pixels in the box `[ start, stop )`, which is the image domain along dimensions up to
+            // `dd`, and the extended image domain along the other dimensions (limited to the slab's rows).
+            UnsignedArray start( nDims, 0 );
+            UnsignedArray stop = extSizes;
+            start[ lastDim ] = slabBegin;
+            stop[ lastDim ] = slabEnd + 2 * boundary[ lastDim ];
+            for( dip::uint dd = 0; dd < nDims; ++dd ) {
+               start[ dd ] += boundary[ dd ];
+               stop[ dd ] -= boundary[ dd ];
+               dip::sint stride = strides[ dd ];
+               dip::uint lineLength = stop[ dd ] - start[ dd ];
+               dip::sint lower = box.lower[ dd ];
+               dip::sint upper = lower + static_cast< dip::sint >( box.sizes[ dd ] );
+               bool first = dd == 0;
+               ForEachLine( start, stop, strides, dd, [ & ]( dip::sint index ) {
+                  for( dip::uint ii = 0; ii < lineLength; ++ii, index += stride ) {
+                     dfloat bestValue = minimum ? std::numeric_limits< dfloat >::max() : std::numeric_limits< dfloat >::lowest();
+                     dip::uint bestDistance = std::numeric_limits< dip::uint >::max();
+                     dip::sint bestOffset = 0;
+                     for( dip::sint kk = lower; kk < upper; ++kk ) {
+                        dip::sint source = index + kk * stride;
+                        dip::uint kk2 = static_cast< dip::uint >( kk * kk );
+                        dfloat value;
+                        dip::uint distance;
+                        dip::sint offset;
+                        if( first ) {
+                           value = controlData[ source ];
+                           distance = kk2;
+                           offset = kk * stride;
+                        } else {
+                           SelectionCandidate const& candidate = previous[ static_cast< dip::uint >( source - base ) ];
+                           value = candidate.value;
+                           distance = candidate.distance + kk2;
+                           offset = candidate.offset + kk * stride;
+                        }
+                        if(( minimum ? ( value < bestValue ) : ( value > bestValue )) ||
+                              (( value == bestValue ) && ( distance < bestDistance ))) {
+                           bestValue = value;
+                           bestDistance = distance;
+                           bestOffset = offset;
+                        }
+                     }
+                     current[ static_cast< dip::uint >( index - base ) ] = { bestValue, bestDistance, bestOffset };
+                  }
+               } );
+               std::swap( previous, current );
+            }
+            // `previous` now contains the best candidates for all pixels in the slab
+
+            // Loop over all image lines in the slab
+            RangeArray slabWindow( nDims );
+            slabWindow[ lastDim ] = Range{ static_cast< dip::sint >( slabBegin ), static_cast< dip::sint >( slabEnd ) - 1 };
+            Image inSlab = inView.At( slabWindow );
+            Image controlSlab = controlView.At( slabWindow );
+            Image outSlab = out.At( slabWindow );
+            dip::sint controlSlabStart = static_cast< dfloat const* >( controlSlab.Origin() ) - controlData - base;
+            dip::uint processingDim = Framework::OptimalProcessingDim( inSlab );
+            GatherLineFilterParameters params = {
+                  nullptr,
+                  nullptr,
+                  nullptr,
+                  nullptr,
+                  inSlab.Stride( processingDim ),
+                  inSlab.TensorStride(),
+                  controlSlab.Stride( processingDim ),
+                  outSlab.Stride( processingDim ),
+                  outSlab.TensorStride(),
+                  inSlab.TensorElements(),
+                  inSlab.Size( processingDim ),
+                  threshold,
+                  minimum
+            };
+            GenericJointImageIterator< 3 > it( { inSlab, controlSlab, outSlab }, processingDim );
+            do {
+               params.inBuffer = inSlab.Pointer( it.Offset< 0 >() );
+               params.controlBuffer = static_cast< dfloat const* >( controlSlab.Pointer( it.Offset< 1 >() ));
+               params.candidate = previous.data() + controlSlabStart + it.Offset< 1 >();
+               params.outBuffer = outSlab.Pointer( it.Offset< 2 >() );
+               lineFilter->Filter( params );
+            } while( ++it );
+         }
+      } );
+   DIP_END_STACK_TRACE
+}
+
+} // namespace
+
+void SelectionFilter(
+      Image const& in,
+      Image const& control,
+      Image& out,
+      Kernel const& kernel,
+      dfloat threshold,
+      String const& mode,
+      StringArray const& boundaryCondition
+) {
+   DIP_THROW_IF( !in.IsForged() || !control.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( in.Sizes() != control.Sizes(), E::SIZES_DONT_MATCH );
+   DIP_THROW_IF( !control.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !control.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( kernel.HasWeights(), E::KERNEL_NOT_BINARY );
+   bool minimum;
+   DIP_STACK_TRACE_THIS( minimum = BooleanFromString( mode, S::MINIMUM, S::MAXIMUM ));
+   DIP_START_STACK_TRACE
+      BoundaryConditionArray bc = StringArrayToBoundaryConditionArray( boundaryCondition );
+      if( kernel.IsRectangular() ) {
+         RectangularSelectionFilter( in, control, out, kernel, threshold, minimum, bc );
+      } else {
+         PixelTableSelectionFilter( in, control, out, kernel, threshold, minimum, bc );
+      }
+   DIP_END_STACK_TRACE
+}
+
 void Kuwahara(
       Image const& in,
       Image& out,
@@ -205,8 +499,29 @@ void Kuwahara(
       StringArray const& boundaryCondition
 ) {
    DIP_START_STACK_TRACE
-      Image value = dip::Uniform( in, kernel, boundaryCondition );
-      Image control = dip::VarianceFilter( in, kernel, boundaryCondition );
+      Image value;
+      Image control;
+      if( kernel.IsRectangular() && in.DataType().IsReal() ) {
+         // Mean and variance are both obtained from the same summed-area tables
+         BoundaryConditionArray bc = StringArrayToBoundaryConditionArray( boundaryCondition );
+         detail::KernelBox box = detail::RectangularKernelBox( kernel, in.Dimensionality() );
+         UnsignedArray boundary = box.Boundary();
+         DataType dtype = DataType::SuggestFlex( in.DataType() );
+         value.ReForge( in.Sizes(), in.TensorElements(), dtype );
+         value.ReshapeTensor( in.Tensor() );
+         value.SetPixelSize( in.PixelSize() );
+         value.SetColorSpace( in.ColorSpace() );
+         control.ReForge( in.Sizes(), in.TensorElements(), dtype );
+         for( dip::uint ii = 0; ii < in.TensorElements(); ++ii ) {
+            detail::SummedAreaTable table( in[ ii ], boundary, bc );
+            Image mean = value[ ii ];
+            Image variance = control[ ii ];
+            table.BoxMeanAndVariance( mean, variance, box );
+         }
+      } else {
+         value = dip::Uniform( in, kernel, boundaryCondition );
+         control = dip::VarianceFilter( in, kernel, boundaryCondition );
+      }
       if( !control.IsScalar() ) {
          control = MaximumTensorElement( control );
       }
@@ -216,3 +531,39 @@ void Kuwahara(
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/random.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the rectangular paths of VarianceFilter and SelectionFilter") {
+   dip::Random random( 0 );
+   dip::Image img{ dip::UnsignedArray{ 40, 30 }, 1, dip::DT_SFLOAT };
+   img.Fill( 50.0 );
+   dip::UniformNoise( img, img, random, 0.0, 100.0 );
+   dip::Image control = dip::UniformNoise( img, random, 0.0, 10.0 );
+   dip::Image shape{ dip::UnsignedArray{ 5, 4 }, 1, dip::DT_BIN };
+   shape.Fill( 1 );
+   dip::Kernel rect( dip::FloatArray{ 5, 4 }, "rectangular" );
+   dip::Kernel custom( shape );
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::VarianceFilter( img, rect ), dip::VarianceFilter( img, custom ), 1e-2 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::SelectionFilter( img, control, rect ), dip::SelectionFilter( img, control, custom )));
+   rect.Mirror();
+   custom.Mirror();
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::VarianceFilter( img, rect ), dip::VarianceFilter( img, custom ), 1e-2 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::SelectionFilter( img, control, rect, 1.0, "maximum" ),
+                                               dip::SelectionFilter( img, control, custom, 1.0, "maximum" )));
+   // An image large enough to be processed in multiple slabs
+   img = dip::Image{ dip::UnsignedArray{ 300, 500 }, 1, dip::DT_UINT8 };
+   img.Fill( 0 );
+   dip::UniformNoise( img, img, random, 0.0, 255.0 );
+   control = dip::UniformNoise( dip::Convert( img, dip::DT_SFLOAT ), random, 0.0, 10.0 );
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::VarianceFilter( img, rect ), dip::VarianceFilter( img, custom ), 1e-2 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::SelectionFilter( img, control, rect ), dip::SelectionFilter( img, control, custom )));
+   img = dip::Convert( img, dip::DT_DFLOAT );
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::VarianceFilter( img, rect ), dip::VarianceFilter( img, custom ), 1e-6 ));
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -0,0 +1,287 @@
+/*
+ * DIPlib 3.0
+ * This file contains the definitions for an internal class for computing box sums through a summed-area table.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cmath>
+
+#include "diplib.h"
+#include "summed_area_table.h"
+#include "diplib/framework.h"
+#include "diplib/statistics.h"
+#include "diplib/math.h"
+#include "diplib/multithreading.h"
+
+namespace dip {
+
+namespace detail {
+
+KernelBox RectangularKernelBox( Kernel const& kernel, dip::uint nDims ) {
+   DIP_ASSERT( kernel.IsRectangular() );
+   KernelBox box;
+   DIP_STACK_TRACE_THIS( box.sizes = kernel.Sizes( nDims ));
+   IntegerArray shift = kernel.Shift();
+   if( shift.empty() ) {
+      shift.resize( nDims, 0 );
+   } else {
+      DIP_STACK_TRACE_THIS( ArrayUseParameter( shift, nDims, dip::sint( 0 )));
+   }
+   // This must match what `dip::PixelTable` does for a rectangular kernel, see `dip::Kernel::PixelTable`.
+   box.lower.resize( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      dip::sint size = static_cast< dip::sint >( box.sizes[ ii ] );
+      box.lower[ ii ] = -( size / 2 ) - shift[ ii ];
+      if( kernel.IsMirrored() ) {
+         box.lower[ ii ] = -( box.lower[ ii ] + size - 1 );
+      }
+   }
+   return box;
+}
+
+SummedAreaTable::SummedAreaTable(
+      Image const& in,
+      UnsignedArray const& boundary,
+      BoundaryConditionArray const& bc
+) : boundary_( boundary ) {
+   DIP_ASSERT( in.IsForged() );
+   DIP_ASSERT( in.IsScalar() );
+   DIP_ASSERT( in.DataType().IsReal() );
+   DIP_ASSERT( boundary_.size() == in.Dimensionality() );
+   DIP_STACK_TRACE_THIS( ExtendImage( in, extended_, boundary_, bc ));
+   smallIntegers_ = in.DataType().IsInteger() && ( in.DataType().SizeOf() <= 2 );
+}
+
+namespace {
+
+// The number of pixels in a slab that we aim for, slabs are taller if the box is.
+constexpr dip::uint summedAreaTableSlabPixels = 1u << 16;
+
+// All integers below this value are exactly representable in a single-precision float.
+constexpr dfloat sfloatExactIntegerLimit = 16777216.0; // 2^24
+
+// Computes the summed-area table of `in - shift`, with a leading plane of zeros along each dimension,
+// such that the sum over a box always is a linear combination of 2^nDims table values.
+Image MakeTable( Image const& in, dfloat shift, DataType dataType, bool squares ) {
+   dip::uint nDims = in.Dimensionality();
+   UnsignedArray sizes = in.Sizes();
+   RangeArray window( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      ++sizes[ ii ];
+      window[ ii ] = Range{ 1, -1 };
+   }
+   Image table( sizes, 1, dataType );
+   table.Fill( 0 );
+   Image interior = table.At( window );
+   interior.Protect();
+   Subtract( in, shift, interior, dataType );
+   if( squares ) {
+      MultiplySampleWise( interior, interior, interior, dataType );
+   }
+   CumulativeSum( table, {}, table );
+   DIP_ASSERT( table.DataType() == dataType );
+   return table;
+}
+
+template< typename TPI >
+class BoxStatisticLineFilter : public Framework::ScanLineFilter {
+   public:
+      BoxStatisticLineFilter(
+            Image const& sum,
+            Image const& sumSquares,
+            dfloat shift,
+            UnsignedArray const& sizes,
+            bool variance
+      ) : sum_( static_cast< TPI const* >( sum.Origin() )),
+          sumSquares_( variance ? static_cast< dfloat const* >( sumSquares.Origin() ) : nullptr ),
+          sumStrides_( sum.Strides() ), sumSquaresStrides_( variance ? sumSquares.Strides() : sum.Strides() ),
+          shift_( shift ), n_( static_cast< dfloat >( sizes.product() )), variance_( variance ) {
+         // Each corner of the box is identified by a bit pattern: bit `ii` set means we use the upper corner
+         // along dimension `ii`. The sign of each term is negative if the number of lower corners is odd.
+         dip::uint nDims = sizes.size();
+         dip::uint nCorners = dip::uint( 1 ) << nDims;
+         cornerOffsets_.resize( nCorners );
+         cornerSquaresOffsets_.resize( nCorners );
+         cornerSigns_.resize( nCorners );
+         for( dip::uint corner = 0; corner < nCorners; ++corner ) {
+            dip::sint offset = 0;
+            dip::sint squaresOffset = 0;
+            dip::uint nLower = 0;
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               if( corner & ( dip::uint( 1 ) << ii )) {
+                  offset += static_cast< dip::sint >( sizes[ ii ] ) * sumStrides_[ ii ];
+                  squaresOffset += static_cast< dip::sint >( sizes[ ii ] ) * sumSquaresStrides_[ ii ];
+               } else {
+                  ++nLower;
+               }
+            }
+            cornerOffsets_[ corner ] = offset;
+            cornerSquaresOffsets_[ corner ] = squaresOffset;
+            cornerSigns_[ corner ] = ( nLower & 1 ) ? -1.0 : 1.0;
+         }
+      }
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override {
+         return cornerOffsets_.size() * ( variance_ ? 4 : 2 ) + 5;
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         dfloat* out = static_cast< dfloat* >( params.outBuffer[ 0 ].buffer );
+         dip::sint outStride = params.outBuffer[ 0 ].stride;
+         dip::uint bufferLength = params.bufferLength;
+         dip::uint nCorners = cornerOffsets_.size();
+         // The box for the pixel at `position` starts at `position` in the table
+         dip::sint offset = 0;
+         for( dip::uint ii = 0; ii < sumStrides_.size(); ++ii ) {
+            offset += static_cast< dip::sint >( params.position[ ii ] ) * sumStrides_[ ii ];
+         }
+         dip::sint stride = sumStrides_[ params.dimension ];
+         TPI const* sum = sum_ + offset;
+         if( variance_ ) {
+            dip::sint squaresOffset = 0;
+            for( dip::uint ii = 0; ii < sumSquaresStrides_.size(); ++ii ) {
+               squaresOffset += static_cast< dip::sint >( params.position[ ii ] ) * sumSquaresStrides_[ ii ];
+            }
+            dip::sint squaresStride = sumSquaresStrides_[ params.dimension ];
+            dfloat const* sumSquares = sumSquares_ + squaresOffset;
+            for( dip::uint jj = 0; jj < bufferLength; ++jj ) {
+               dfloat s = 0;
+               dfloat s2 = 0;
+               for( dip::uint ii = 0; ii < nCorners; ++ii ) {
+                  s += cornerSigns_[ ii ] * static_cast< dfloat >( sum[ cornerOffsets_[ ii ]] );
+                  s2 += cornerSigns_[ ii ] * sumSquares[ cornerSquaresOffsets_[ ii ]];
+               }
+               // Same computation as in `dip::FastVarianceAccumulator`
+               *out = n_ > 1 ? std::max( ( s2 - ( s * s ) / n_ ) / ( n_ - 1 ), 0.0 ) : 0.0;
+               sum += stride;
+               sumSquares += squaresStride;
+               out += outStride;
+            }
+         } else {
+            for( dip::uint jj = 0; jj < bufferLength; ++jj ) {
+               dfloat s = 0;
+               for( dip::uint ii = 0; ii < nCorners; ++ii ) {
+                  s += cornerSigns_[ ii ] * static_cast< dfloat >( sum[ cornerOffsets_[ ii ]] );
+               }
+               *out = s / n_ + shift_;
+               sum += stride;
+               out += outStride;
+            }
+         }
+      }
+   private:
+      TPI const* sum_;
+      dfloat const* sumSquares_;
+      IntegerArray sumStrides_;
+      IntegerArray sumSquaresStrides_;
+      dfloat shift_;
+      dfloat n_;
+      bool variance_;
+      std::vector< dip::sint > cornerOffsets_;
+      std::vector< dip::sint > cornerSquaresOffsets_;
+      std::vector< dfloat > cornerSigns_;
+};
+
+// Computes the statistic for `out` (a slab of the output image), given the tables for that slab
+void BoxStatisticSlab( Image& out, Image const& sum, Image const& sumSquares, dfloat shift, UnsignedArray const& sizes, bool variance ) {
+   std::unique_ptr< Framework::ScanLineFilter > lineFilter;
+   if( sum.DataType() == DT_SFLOAT ) {
+      lineFilter = std::make_unique< BoxStatisticLineFilter< sfloat >>( sum, sumSquares, shift, sizes, variance );
+   } else {
+      lineFilter = std::make_unique< BoxStatisticLineFilter< dfloat >>( sum, sumSquares, shift, sizes, variance );
+   }
+   Framework::ScanSingleOutput( out, DT_DFLOAT, *lineFilter, Framework::ScanOption::NeedCoordinates );
+}
+
+} // namespace
+
+void SummedAreaTable::BoxStatistic( Image* mean, Image* variance, KernelBox const& box ) const {
+   Image const& ref = mean ? *mean : *variance;
+   dip::uint nDims = boundary_.size();
+   DIP_ASSERT( ref.IsForged() );
+   DIP_ASSERT( ref.Dimensionality() == nDims );
+   DIP_ASSERT( !mean || !variance || ( mean->Sizes() == variance->Sizes() ));
+   DIP_ASSERT( box.sizes.size() == nDims );
+   UnsignedArray const& sizes = ref.Sizes();
+   // The box for the pixel at coordinates `pos` starts at `pos + start` in the extended image
+   IntegerArray start( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      start[ ii ] = static_cast< dip::sint >( boundary_[ ii ] ) + box.lower[ ii ];
+      DIP_ASSERT( start[ ii ] >= 0 );
+      DIP_ASSERT( static_cast< dip::uint >( start[ ii ] ) + sizes[ ii ] + box.sizes[ ii ] <= extended_.Size( ii ) + 1 );
+   }
+
+   // Split the image into slabs along the last dimension
+   dip::uint dim = nDims - 1;
+   dip::uint length = sizes[ dim ];
+   dip::uint crossSection = ref.NumberOfPixels() / length;
+   dip::uint nCorners = dip::uint( 1 ) << nDims;
+   // Building the tables (copy, square and cumulative sums), plus the look-ups
+   dip::uint operations = ref.NumberOfPixels() * (( variance ? 2 : 1 ) * ( 2 + nDims ) + nCorners * ( variance ? 4 : 2 ) + 5 );
+   dip::uint nThreads = GetThreadingCostModel().NumberOfThreads( operations, GetNumberOfThreads() );
+   dip::uint slabLength = std::max( summedAreaTableSlabPixels / crossSection, box.sizes[ dim ] );
+   slabLength = clamp( slabLength, dip::uint( 1 ), div_ceil( length, nThreads ));
+   dip::uint nSlabs = div_ceil( length, slabLength );
+   nThreads = std::min( nThreads, nSlabs );
+
+   std::atomic< dip::uint > nextSlab( 0 );
+   DIP_START_STACK_TRACE
+      ParallelFor( nThreads, [ & ]( dip::uint ) {
+         dip::uint slab;
+         while(( slab = nextSlab.fetch_add( 1 )) < nSlabs ) {
+            dip::uint first = slab * slabLength;
+            dip::uint last = std::min( first + slabLength, length );
+            // The part of the extended image covered by the boxes of the pixels in the slab, and the slab itself
+            RangeArray inWindow( nDims );
+            RangeArray outWindow( nDims );
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               inWindow[ ii ] = Range{ start[ ii ], start[ ii ] + static_cast< dip::sint >( sizes[ ii ] + box.sizes[ ii ] ) - 2 };
+            }
+            inWindow[ dim ] = Range{ start[ dim ] + static_cast< dip::sint >( first ),
+                                     start[ dim ] + static_cast< dip::sint >( last + box.sizes[ dim ] ) - 2 };
+            outWindow[ dim ] = Range{ static_cast< dip::sint >( first ), static_cast< dip::sint >( last ) - 1 };
+            Image region = extended_.At( inWindow );
+            dfloat shift = Mean( region ).As< dfloat >();
+            DataType sumType = DT_DFLOAT;
+            if( smallIntegers_ ) {
+               // The table values are integers, bounded by the number of pixels times the largest deviation
+               shift = std::round( shift );
+               MinMaxAccumulator minmax = MaximumAndMinimum( region );
+               dfloat deviation = std::max( minmax.Maximum() - shift, shift - minmax.Minimum() );
+               if( deviation * static_cast< dfloat >( region.NumberOfPixels() ) < sfloatExactIntegerLimit ) {
+                  sumType = DT_SFLOAT;
+               }
+            }
+            Image sum = MakeTable( region, shift, sumType, false );
+            Image sumSquares;
+            if( variance ) {
+               sumSquares = MakeTable( region, shift, DT_DFLOAT, true );
+            }
+            if( mean ) {
+               Image out = mean->At( outWindow );
+               BoxStatisticSlab( out, sum, sumSquares, shift, box.sizes, false );
+            }
+            if( variance ) {
+               Image out = variance->At( outWindow );
+               BoxStatisticSlab( out, sum, sumSquares, shift, box.sizes, true );
+            }
+         }
+      } );
+   DIP_END_STACK_TRACE
+}
+
+} // namespace detail
+
+} // namespace dip
@@ -0,0 +1,97 @@
+/*
+ * DIPlib 3.0
+ * This file declares an internal class for computing box sums through a summed-area table.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_SUMMED_AREA_TABLE_H
+#define DIP_SUMMED_AREA_TABLE_H
+
+#include "diplib.h"
+#include "diplib/kernel.h"
+#include "diplib/boundary.h"
+
+namespace dip {
+
+namespace detail {
+
+// Describes the box covered by a rectangular kernel: the box covers offsets `lower[ii]` to
+// `lower[ii] + sizes[ii] - 1` along dimension `ii`, w.r.t. the pixel being processed. This takes the
+// kernel's shift and mirroring into account, and matches the pixel table generated by `dip::Kernel`.
+struct DIP_NO_EXPORT KernelBox {
+   IntegerArray lower;
+   UnsignedArray sizes;
+
+   // The boundary extension needed to fit the box over each image pixel
+   UnsignedArray Boundary() const {
+      UnsignedArray boundary( sizes.size() );
+      for( dip::uint ii = 0; ii < sizes.size(); ++ii ) {
+         dip::sint upper = lower[ ii ] + static_cast< dip::sint >( sizes[ ii ] ) - 1;
+         boundary[ ii ] = static_cast< dip::uint >( std::max( std::max( -lower[ ii ], upper ), dip::sint( 0 )));
+      }
+      return boundary;
+   }
+};
+
+// Returns the box for a rectangular kernel, adjusted to `nDims` dimensions.
+DIP_NO_EXPORT KernelBox RectangularKernelBox( Kernel const& kernel, dip::uint nDims );
+
+// Box statistics through summed-area tables (integral images), for a real-valued, scalar image.
+//
+// The input image is extended by `boundary` using boundary condition `bc`, such that the sum over any box
+// that fits within the extended image is obtained with 2^nDims look-ups, independently of the size of the box.
+// A second table with the sums of squared values allows to compute also the variance within boxes.
+//
+// The output is computed in slabs along the last dimension, which are processed in parallel. Each slab gets
+// its own tables, covering only the slab and the boxes around its pixels. This limits the memory used, as well
+// as the magnitude of the sums, which, together with subtracting the mean value of the slab before summing,
+// preserves precision. For 8-bit and 16-bit integer input, the (rounded) mean is subtracted, and the table of
+// sums is kept in single precision if all its values are integers that fit in the mantissa, such that it is
+// exact. Otherwise, and for the table of sums of squares, double precision is used: rounding errors in the sums
+// are amplified when computing the variance, even single-precision input needs double-precision tables.
+class DIP_NO_EXPORT SummedAreaTable {
+   public:
+      SummedAreaTable( Image const& in, UnsignedArray const& boundary, BoundaryConditionArray const& bc );
+
+      // Computes, for each pixel, the mean value within `box`. `out` must be forged, real-valued, scalar,
+      // and of the same sizes as the input image.
+      void BoxMean( Image& out, KernelBox const& box ) const {
+         BoxStatistic( &out, nullptr, box );
+      }
+
+      // Computes, for each pixel, the sample variance within `box`. `out` as above.
+      void BoxVariance( Image& out, KernelBox const& box ) const {
+         BoxStatistic( nullptr, &out, box );
+      }
+
+      // Computes both the mean and the variance, building the tables only once.
+      void BoxMeanAndVariance( Image& mean, Image& variance, KernelBox const& box ) const {
+         BoxStatistic( &mean, &variance, box );
+      }
+
+   private:
+      Image extended_;        // The input image extended by `boundary_`
+      UnsignedArray boundary_;
+      bool smallIntegers_;    // The input is 8-bit or 16-bit integer, the table of sums can be single precision
+
+      void BoxStatistic( Image* mean, Image* variance, KernelBox const& box ) const;
+};
+
+} // namespace detail
+
+} // namespace dip
+
+#endif // DIP_SUMMED_AREA_TABLE_H
@@ -24,6 +24,7 @@
 #include "diplib/pixel_table.h"
 #include "diplib/overload.h"
 #include "diplib/accumulators.h"
+#include "summed_area_table.h"
 
 namespace dip {
 
@@ -63,6 +64,33 @@ class VarianceLineFilter : public Framework::FullLineFilter {
       }
 };
 
+void RectangularVarianceFilter(
+      Image const& c_in,
+      Image& out,
+      Kernel const& kernel,
+      BoundaryConditionArray const& bc
+) {
+   Image in = c_in.QuickCopy();
+   PixelSize pixelSize = c_in.PixelSize();
+   String colorSpace = c_in.ColorSpace();
+   detail::KernelBox box = detail::RectangularKernelBox( kernel, in.Dimensionality() );
+   UnsignedArray boundary = box.Boundary();
+   if( out.Aliases( in )) {
+      out.Strip(); // We cannot work in-place
+   }
+   out.ReForge( in.Sizes(), in.TensorElements(), DataType::SuggestFlex( in.DataType() ), Option::AcceptDataTypeChange::DO_ALLOW );
+   out.ReshapeTensor( in.Tensor() );
+   out.SetPixelSize( pixelSize );
+   if( !colorSpace.empty() ) {
+      out.SetColorSpace( colorSpace );
+   }
+   for( dip::uint ii = 0; ii < in.TensorElements(); ++ii ) {
+      detail::SummedAreaTable table( in[ ii ], boundary, bc );
+      Image tmp = out[ ii ];
+      table.BoxVariance( tmp, box );
+   }
+}
+
 } // namespace
 
 void VarianceFilter(
@@ -75,10 +103,15 @@ void VarianceFilter(
    DIP_THROW_IF( kernel.HasWeights(), E::KERNEL_NOT_BINARY );
    DIP_START_STACK_TRACE
       BoundaryConditionArray bc = StringArrayToBoundaryConditionArray( boundaryCondition );
-      DataType dtype = DataType::SuggestFlex( in.DataType() );
-      std::unique_ptr< Framework::FullLineFilter > lineFilter;
-      DIP_OVL_NEW_FLOAT( lineFilter, VarianceLineFilter, (), dtype );
-      Framework::Full( in, out, dtype, dtype, dtype, 1, bc, kernel, *lineFilter, Framework::FullOption::AsScalarImage );
+      if( kernel.IsRectangular() && in.DataType().IsReal() ) {
+         // Summed-area tables make the cost independent of the kernel size
+         RectangularVarianceFilter( in, out, kernel, bc );
+      } else {
+         DataType dtype = DataType::SuggestFlex( in.DataType() );
+         std::unique_ptr< Framework::FullLineFilter > lineFilter;
+         DIP_OVL_NEW_FLOAT( lineFilter, VarianceLineFilter, (), dtype );
+         Framework::Full( in, out, dtype, dtype, dtype, 1, bc, kernel, *lineFilter, Framework::FullOption::AsScalarImage );
+      }
    DIP_END_STACK_TRACE
 }
 
@@ -18,29 +18,28 @@
  * limitations under the License.
  */
 
-#include <set>
-#include <unordered_map>
-
 #include "diplib.h"
 #include "diplib/regions.h"
-#include "diplib/measurement.h"
 #include "diplib/framework.h"
 #include "diplib/overload.h"
+#include "label_map.h"
 
 namespace dip {
 
-using LabelSet = std::set< dip::uint >;
-
 namespace {
 
 template< typename TPI >
 class dip__GetLabels: public Framework::ScanLineFilter {
    public:
-      // not defining GetNumberOfOperations(), always called in a single thread
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override { return 2; }
+      virtual void SetNumberOfThreads( dip::uint threads ) override {
+         objectIDs_.resize( threads );
+      }
       virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
          TPI const* data = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
          dip::sint stride = params.inBuffer[ 0 ].stride;
          dip::uint bufferLength = params.bufferLength;
+         LabelSet& objectIDs = objectIDs_[ params.thread ];
          if( params.inBuffer.size() > 1 ) {
             bin* mask = static_cast< bin* >( params.inBuffer[ 1 ].buffer );
             dip::sint mask_stride = params.inBuffer[ 1 ].stride;
@@ -51,7 +50,7 @@ class dip__GetLabels: public Framework::ScanLineFilter {
                   if( !setPrevID || ( *data != prevID ) ) {
                      prevID = *data;
                      setPrevID = true;
-                     objectIDs_.insert( prevID );
+                     objectIDs.Insert( prevID );
                   }
                }
                data += stride;
@@ -62,15 +61,15 @@ class dip__GetLabels: public Framework::ScanLineFilter {
             for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
                if( *data != prevID ) {
                   prevID = *data;
-                  objectIDs_.insert( prevID );
+                  objectIDs.Insert( prevID );
                }
                data += stride;
             }
          }
       }
-      dip__GetLabels( LabelSet& objectIDs ): objectIDs_( objectIDs ) {}
+      dip__GetLabels( std::vector< LabelSet >& objectIDs ) : objectIDs_( objectIDs ) {}
    private:
-      LabelSet& objectIDs_;
+      std::vector< LabelSet >& objectIDs_; // one for each thread
 };
 
 } // namespace
@@ -90,41 +89,61 @@ UnsignedArray GetObjectLabels(
    bool nullIsObject;
    DIP_STACK_TRACE_THIS( nullIsObject = BooleanFromString( background, S::INCLUDE, S::EXCLUDE ));
 
-   LabelSet objectIDs; // output
+   std::vector< LabelSet > objectIDs; // one for each thread
 
    // Get pointer to overloaded scan function
-   std::unique_ptr< Framework::ScanLineFilter >scanLineFilter;
+   std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
    DIP_OVL_NEW_UINT( scanLineFilter, dip__GetLabels, ( objectIDs ), label.DataType() );
 
    // Do the scan
-   DIP_STACK_TRACE_THIS( Framework::ScanSingleInput( label, mask, label.DataType(), *scanLineFilter, Framework::ScanOption::NoMultiThreading ));
+   DIP_STACK_TRACE_THIS( Framework::ScanSingleInput( label, mask, label.DataType(), *scanLineFilter ));
 
-   // Count the number of unique labels
-   dip::uint count = 0;
-   for( auto id : objectIDs ) {
-      if( nullIsObject || ( id != 0 )) {
-         ++count;
-      }
+   // Merge the results of all threads, and copy the labels to output array
+   for( dip::uint ii = 1; ii < objectIDs.size(); ++ii ) {
+      objectIDs[ 0 ].Merge( objectIDs[ ii ] );
    }
-
-   // Copy the labels to output array
-   UnsignedArray out( count );
-   count = 0;
-   for( auto id : objectIDs ) {
-      if( nullIsObject || ( id != 0 )) {
-         out[ count ] = id;
-         ++count;
-      }
-   }
-   return out;
+   return objectIDs[ 0 ].Labels( nullIsObject );
 }
 
 namespace {
 
+// Collects the number of pixels for each label.
+template< typename TPI >
+class dip__CountLabels: public Framework::ScanLineFilter {
+   public:
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override { return 2; }
+      virtual void SetNumberOfThreads( dip::uint threads ) override {
+         counts_.resize( threads );
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         TPI const* in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint stride = params.inBuffer[ 0 ].stride;
+         dip::uint bufferLength = params.bufferLength;
+         LabelMap< dip::uint >& counts = counts_[ params.thread ];
+         // Count runs of equal labels, to avoid looking up the label for every pixel
+         TPI label = *in;
+         dip::uint runLength = 0;
+         for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+            if( *in != label ) {
+               counts[ label ] += runLength;
+               label = *in;
+               runLength = 0;
+            }
+            ++runLength;
+            in += stride;
+         }
+         counts[ label ] += runLength;
+      }
+      dip__CountLabels( std::vector< LabelMap< dip::uint >>& counts ) : counts_( counts ) {}
+   private:
+      std::vector< LabelMap< dip::uint >>& counts_; // one for each thread
+};
+
+// Replaces each label with the value in the look-up table. The background label is not changed.
 template< typename TPI >
-class dip__Relabel: public Framework::ScanLineFilter {
+class dip__MapLabels: public Framework::ScanLineFilter {
    public:
-      // not defining GetNumberOfOperations(), always called in a single thread
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override { return 2; }
       virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
          TPI const* in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
          TPI* out = static_cast< TPI* >( params.outBuffer[ 0 ].buffer );
@@ -132,32 +151,20 @@ class dip__Relabel: public Framework::ScanLineFilter {
          dip::sint outStride = params.outBuffer[ 0 ].stride;
          dip::uint bufferLength = params.bufferLength;
          TPI inLabel = 0;       // last label seen, initialize to background label
-         TPI outLabel = 0;      // new label assigned to prevID
+         TPI outLabel = 0;      // new label assigned to inLabel
          for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
-            if( *in == 0 ) {
-               // The background label is processed differently
-               *out = 0;
-            } else if( *in == inLabel ) {
-               *out = outLabel;
-            } else {
+            if( *in != inLabel ) {
                inLabel = *in;
-               auto it = objectIDs_.find( inLabel );
-               if( it == objectIDs_.end() ) {
-                  // It's a new label
-                  outLabel = ++lastLabel_;
-                  objectIDs_.emplace( inLabel, outLabel );
-               } else {
-                  outLabel = it->second;
-               }
-               *out = outLabel;
+               outLabel = static_cast< TPI >( lut_.Get( inLabel ));
             }
+            *out = outLabel;
             in += inStride;
             out += outStride;
          }
       }
+      dip__MapLabels( LabelMap< dip::uint > const& lut ) : lut_( lut ) {}
    private:
-      std::unordered_map< TPI, TPI > objectIDs_;
-      TPI lastLabel_ = 0;
+      LabelMap< dip::uint > const& lut_;
 };
 
 } // namespace
@@ -167,12 +174,19 @@ void Relabel( Image const& label, Image& out ) {
    DIP_THROW_IF( !label.IsScalar(), E::IMAGE_NOT_SCALAR );
    DIP_THROW_IF( !label.DataType().IsUInt(), E::DATA_TYPE_NOT_SUPPORTED );
 
+   // Find all labels, and assign consecutive new labels in the same order
+   UnsignedArray objectIDs = GetObjectLabels( label, {}, S::EXCLUDE );
+   LabelMap< dip::uint > lut;
+   for( dip::uint ii = 0; ii < objectIDs.size(); ++ii ) {
+      lut[ objectIDs[ ii ]] = ii + 1;
+   }
+
    // Get pointer to overloaded scan function
-   std::unique_ptr< Framework::ScanLineFilter >scanLineFilter;
-   DIP_OVL_NEW_UINT( scanLineFilter, dip__Relabel, (), label.DataType() );
+   std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
+   DIP_OVL_NEW_UINT( scanLineFilter, dip__MapLabels, ( lut ), label.DataType() );
 
    // Do the scan
-   DIP_STACK_TRACE_THIS( Framework::ScanMonadic( label, out, label.DataType(), label.DataType(), 1, *scanLineFilter, Framework::ScanOption::NoMultiThreading ));
+   DIP_STACK_TRACE_THIS( Framework::ScanMonadic( label, out, label.DataType(), label.DataType(), 1, *scanLineFilter ));
 }
 
 void SmallObjectsRemove(
@@ -187,15 +201,81 @@ void SmallObjectsRemove(
       Image tmp = Label( in, connectivity, threshold, 0 );
       NotEqual( tmp, Image( 0, tmp.DataType() ), out );
    } else if( in.DataType().IsUnsigned() ) {
-      MeasurementTool msr;
-      Measurement sizes = msr.Measure( in, {}, { "Size" }, {}, 1 );
-      // TODO: It would be more efficient to copy the ObjectToMeasurement function, and make a LUT that does all of the following in a single pass through the image.
-      Image tmp = ObjectToMeasurement( in, sizes[ "Size" ] );
-      tmp = tmp >= threshold;
-      MultiplySampleWise( in, tmp, out, in.DataType() );
+      // Count the number of pixels for each label
+      std::vector< LabelMap< dip::uint >> counts; // one for each thread
+      std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
+      DIP_OVL_NEW_UINT( scanLineFilter, dip__CountLabels, ( counts ), in.DataType() );
+      DIP_STACK_TRACE_THIS( Framework::ScanSingleInput( in, {}, in.DataType(), *scanLineFilter ));
+      for( dip::uint ii = 1; ii < counts.size(); ++ii ) {
+         counts[ 0 ].Merge( counts[ ii ] );
+      }
+      // Make a look-up table that keeps the large objects
+      LabelMap< dip::uint > lut;
+      counts[ 0 ].ForEach( [ & ]( dip::uint id, dip::uint count ) {
+         if( count >= threshold ) {
+            lut[ id ] = id;
+         }
+      } );
+      // Apply the look-up table
+      DIP_OVL_NEW_UINT( scanLineFilter, dip__MapLabels, ( lut ), in.DataType() );
+      DIP_STACK_TRACE_THIS( Framework::ScanMonadic( in, out, in.DataType(), in.DataType(), 1, *scanLineFilter ));
    } else {
       DIP_THROW( E::DATA_TYPE_NOT_SUPPORTED );
    }
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/multithreading.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing GetObjectLabels, Relabel and SmallObjectsRemove") {
+   dip::Image label( { 300, 200 }, 1, dip::DT_UINT32 );
+   label.Fill( 0 );
+   label.At( dip::Range{ 10, 19 }, dip::Range{ 10, 19 } ).Fill( 5 );        // 100 pixels
+   label.At( dip::Range{ 100, 104 }, dip::Range{ 50, 53 } ).Fill( 3 );      // 20 pixels
+   label.At( dip::Range{ 200, 289 }, dip::Range{ 100, 189 } ).Fill( 4000000000u ); // 8100 pixels, a sparse label
+   label.At( dip::Range{ 0, 0 }, dip::Range{ 199, 199 } ).Fill( 70000 );    // 1 pixel
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   for( dip::uint threads : { 1u, 4u } ) {
+      // The results must not depend on the number of threads
+      dip::SetNumberOfThreads( threads );
+      dip::UnsignedArray ids = dip::GetObjectLabels( label, {}, dip::S::EXCLUDE );
+      DOCTEST_REQUIRE( ids.size() == 4 );
+      DOCTEST_CHECK( ids[ 0 ] == 3 );
+      DOCTEST_CHECK( ids[ 1 ] == 5 );
+      DOCTEST_CHECK( ids[ 2 ] == 70000 );
+      DOCTEST_CHECK( ids[ 3 ] == 4000000000u );
+      ids = dip::GetObjectLabels( label, {}, dip::S::INCLUDE );
+      DOCTEST_REQUIRE( ids.size() == 5 );
+      DOCTEST_CHECK( ids[ 0 ] == 0 );
+      dip::Image mask = label.Similar( dip::DT_BIN );
+      mask.Fill( 0 );
+      mask.At( dip::Range{ 0, 150 }, dip::Range{} ).Fill( 1 );
+      ids = dip::GetObjectLabels( label, mask, dip::S::EXCLUDE );
+      DOCTEST_REQUIRE( ids.size() == 3 );
+      DOCTEST_CHECK( ids[ 2 ] == 70000 );
+
+      dip::Image out = dip::Relabel( label );
+      DOCTEST_CHECK( out.DataType() == dip::DT_UINT32 );
+      DOCTEST_CHECK( out.At( 15, 15 ) == 2 );
+      DOCTEST_CHECK( out.At( 102, 51 ) == 1 );
+      DOCTEST_CHECK( out.At( 250, 150 ) == 4 );
+      DOCTEST_CHECK( out.At( 0, 199 ) == 3 );
+      DOCTEST_CHECK( out.At( 150, 150 ) == 0 );
+
+      out = dip::SmallObjectsRemove( label, 20 );
+      ids = dip::GetObjectLabels( out, {}, dip::S::EXCLUDE );
+      DOCTEST_REQUIRE( ids.size() == 3 );
+      DOCTEST_CHECK( ids[ 0 ] == 3 );
+      DOCTEST_CHECK( ids[ 1 ] == 5 );
+      DOCTEST_CHECK( ids[ 2 ] == 4000000000u );
+      DOCTEST_CHECK( out.At( 0, 199 ) == 0 );
+      DOCTEST_CHECK( out.At( 250, 150 ) == 4000000000u );
+   }
+   dip::SetNumberOfThreads( nThreads );
+}
+
+#endif // DIP__ENABLE_DOCTEST
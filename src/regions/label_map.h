@@ -0,0 +1,150 @@
+/*
+ * DIPlib 3.0
+ * This file contains support for collecting and mapping label IDs.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_LABEL_MAP_H
+#define DIP_LABEL_MAP_H
+
+#include <algorithm>
+#include <bitset>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "diplib.h"
+
+namespace dip {
+
+// Labels below these values are recorded in dense arrays, larger labels in hash tables. Label images typically
+// have consecutive labels, but can have a few very large labels, for which we don't want to allocate memory.
+constexpr dip::uint denseLabelSetLimit = 1u << 24; // 2 MB bitmap
+constexpr dip::uint denseLabelMapLimit = 1u << 20; // 8 MB array for `dip::uint` values
+
+// A set of labels. Each thread collects labels in its own set, and these are merged at the end. Labels
+// below `denseLabelSetLimit` are stored in a bitmap, which grows as needed.
+class LabelSet {
+   public:
+      void Insert( dip::uint label ) {
+         if( label < denseLabelSetLimit ) {
+            dip::uint word = label / 64;
+            if( word >= bitmap_.size() ) {
+               bitmap_.resize( std::max( word + 1, 2 * bitmap_.size() ), 0 );
+            }
+            bitmap_[ word ] |= std::uint64_t( 1 ) << ( label % 64 );
+         } else {
+            sparse_.insert( label );
+         }
+      }
+      void Merge( LabelSet const& other ) {
+         if( other.bitmap_.size() > bitmap_.size() ) {
+            bitmap_.resize( other.bitmap_.size(), 0 );
+         }
+         for( dip::uint ii = 0; ii < other.bitmap_.size(); ++ii ) {
+            bitmap_[ ii ] |= other.bitmap_[ ii ];
+         }
+         sparse_.insert( other.sparse_.begin(), other.sparse_.end() );
+      }
+      // Returns the labels in increasing order
+      UnsignedArray Labels( bool includeZero ) const {
+         dip::uint n = sparse_.size();
+         for( auto word : bitmap_ ) {
+            n += static_cast< dip::uint >( std::bitset< 64 >( word ).count() );
+         }
+         bool skipZero = !includeZero && !bitmap_.empty() && ( bitmap_[ 0 ] & 1u );
+         if( skipZero ) {
+            --n;
+         }
+         UnsignedArray out( n );
+         dip::uint kk = 0;
+         for( dip::uint ii = 0; ii < bitmap_.size(); ++ii ) {
+            std::uint64_t word = bitmap_[ ii ];
+            if( ( ii == 0 ) && skipZero ) {
+               word &= ~std::uint64_t( 1 );
+            }
+            for( dip::uint jj = 0; word != 0; ++jj, word >>= 1 ) {
+               if( word & 1u ) {
+                  out[ kk++ ] = ii * 64 + jj;
+               }
+            }
+         }
+         auto sparseBegin = out.begin() + kk;
+         std::copy( sparse_.begin(), sparse_.end(), sparseBegin );
+         std::sort( sparseBegin, out.end() );
+         return out;
+      }
+   private:
+      std::vector< std::uint64_t > bitmap_;
+      std::unordered_set< dip::uint > sparse_;
+};
+
+// Maps labels to a value, the mapping for labels below `denseLabelMapLimit` is stored in an array. It is used
+// both to count pixels (each thread has its own map, these are merged at the end), and as a look-up table.
+template< typename T >
+class LabelMap {
+   public:
+      T& operator[]( dip::uint label ) {
+         if( label < denseLabelMapLimit ) {
+            if( label >= dense_.size() ) {
+               dense_.resize( std::max( label + 1, 2 * dense_.size() ), T( 0 ));
+            }
+            return dense_[ label ];
+         }
+         return sparse_[ label ];
+      }
+      // Returns 0 for labels not in the map
+      T Get( dip::uint label ) const {
+         if( label < denseLabelMapLimit ) {
+            return label < dense_.size() ? dense_[ label ] : T( 0 );
+         }
+         auto it = sparse_.find( label );
+         return it == sparse_.end() ? T( 0 ) : it->second;
+      }
+      // Calls `func( label, value )` for each label with a non-zero value
+      template< typename F >
+      void ForEach( F const& func ) const {
+         for( dip::uint ii = 0; ii < dense_.size(); ++ii ) {
+            if( dense_[ ii ] != T( 0 )) {
+               func( ii, dense_[ ii ] );
+            }
+         }
+         for( auto const& v : sparse_ ) {
+            if( v.second != T( 0 )) {
+               func( v.first, v.second );
+            }
+         }
+      }
+      // Adds the values in `other` to the values in `this`
+      void Merge( LabelMap const& other ) {
+         if( other.dense_.size() > dense_.size() ) {
+            dense_.resize( other.dense_.size(), T( 0 ));
+         }
+         for( dip::uint ii = 0; ii < other.dense_.size(); ++ii ) {
+            dense_[ ii ] += other.dense_[ ii ];
+         }
+         for( auto const& v : other.sparse_ ) {
+            sparse_[ v.first ] += v.second;
+         }
+      }
+   private:
+      std::vector< T > dense_;
+      std::unordered_map< dip::uint, T > sparse_;
+};
+
+} // namespace dip
+
+#endif // DIP_LABEL_MAP_H